@@ -55,41 +55,33 @@ echo "Building C predictor..."
 cd "$C_SRC_DIR"
 make -s
 
-echo "Warm-up sweep (not logged)..."
-for EXP in "${EXPS[@]}"; do
-  n_str=$(python3 - <<PY
-from decimal import Decimal, getcontext
-exp = int("${EXP}")
-getcontext().prec = exp + 10
-print((Decimal(10) ** exp).to_integral_exact())
+# One batch run over all inputs: the process and context are set up once
+# and each record carries its own in-process timing. Single worker so the
+# timings are not contended.
+IN_FILE="$(mktemp)"
+BATCH_CSV="$(mktemp)"
+trap 'rm -f "$IN_FILE" "$BATCH_CSV"' EXIT
+python3 - "${EXPS[@]}" > "$IN_FILE" <<'PY'
+import sys
+for e in sys.argv[1:]:
+    print(10 ** int(e))
 PY
-)
-  # Run once to warm instruction/data paths; discard output.
-  "$CLI" "$n_str" >/dev/null
-done
+
+echo "Warm-up sweep (not logged)..."
+"$CLI" --batch -w 1 "$IN_FILE" >/dev/null
 echo "Warm-up done. Running measured sweep..."
+"$CLI" --batch --csv -w 1 "$IN_FILE" > "$BATCH_CSV"
 
 echo "n,elapsed_ms,prime_digits" > "$OUT_CSV"
-
-for EXP in "${EXPS[@]}"; do
-  n_str=$(python3 - <<PY
-from decimal import Decimal, getcontext
-exp = int("${EXP}")
-getcontext().prec = exp + 10
-print((Decimal(10) ** exp).to_integral_exact())
-PY
-)
-
-  start_ns=$(date +%s%N)
-  output=$("$CLI" "$n_str")
-  end_ns=$(date +%s%N)
-  elapsed_ms=$(( (end_ns - start_ns) / 1000000 ))
-
-  prime=$(echo "$output" | awk '/Predicted prime:/ {print $3}')
+# Batch columns: seq,n,prediction,prime,ms,error
+tail -n +2 "$BATCH_CSV" | while IFS=, read -r seq n_str pred prime ms err; do
+  if [ -n "$err" ]; then
+    echo "input $seq: $err" >&2
+    exit 1
+  fi
   digits=${#prime}
-
-  echo "10^$EXP: ${elapsed_ms} ms, digits=$digits"
-  echo "$n_str,$elapsed_ms,$digits" >> "$OUT_CSV"
+  echo "10^$((${#n_str} - 1)): ${ms} ms, digits=$digits"
+  echo "$n_str,$ms,$digits" >> "$OUT_CSV"
 done
 
 echo "Results written to $OUT_CSV"
@@ -19,6 +19,9 @@
 #ifndef Z_FRAMEWORK_PARAMS_H
 #define Z_FRAMEWORK_PARAMS_H
 
+/* The Z_5D calibration (c, kappa*) is the predictor library's default */
+#include "z5d_predictor.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -69,12 +72,12 @@ extern "C" {
 /* Z_5D calibration factor for e-term scaling */
 /* Reverted to optimal value for ultra-low Z_5D errors (<0.01% at k=10^5) */
 /* Context: Enhanced prediction with curvature correction */
-#define ZF_KAPPA_STAR_DEFAULT       0.06500  /* *** KEY PARAMETER from params.py *** */
+#define ZF_KAPPA_STAR_DEFAULT       (Z5D_KAPPA_STAR_LITERAL)  /* *** KEY PARAMETER from params.py *** */
 #define ZF_MIN_KAPPA_STAR           0.001
 #define ZF_MAX_KAPPA_STAR           1.0
 
 /* Z_5D additional calibration parameters */
-#define ZF_Z5D_C_CALIBRATED         -0.00016667  /* From calibration 2025-12-14 (large-n focus) */
+#define ZF_Z5D_C_CALIBRATED         (Z5D_C_CAL_LITERAL)  /* From calibration 2025-12-14 (large-n focus) */
 #define ZF_Z5D_VARIANCE_TARGET      0.118     /* Target variance for geodesic scaling */
 
 /* ========================================================================================
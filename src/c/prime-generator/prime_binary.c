@@ -0,0 +1,294 @@
+// prime_binary.c — Writer and memory-mapped reader for gap-encoded prime files
+//
+// See prime_binary.h for the layout. The writer streams varints through a
+// buffered FILE and keeps only the index in memory (16 bytes per block); the
+// header is rewritten with the final counts on close. The reader checks the
+// header and the whole index on open, and bounds every varint by its block,
+// so a truncated or corrupt file is refused rather than read past its end.
+
+#include "prime_binary.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define WRITER_BUFFER (1 << 20)
+
+// ----------------------- Varints -----------------------
+
+static size_t varint_put(unsigned char* buf, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        buf[n++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (unsigned char)v;
+    return n;
+}
+
+// Next half gap in [*pos, end); -1 if it runs past end or does not fit a gap
+static int varint_get(const unsigned char** pos, const unsigned char* end, uint64_t* v) {
+    uint64_t x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= end) return -1;
+        unsigned char b = *(*pos)++;
+        x |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            if (x >> 63) return -1;   // 2x must fit in 64 bits
+            *v = x;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// ----------------------- Writer -----------------------
+
+static int writer_put(prime_writer_t* w, const void* data, size_t size) {
+    if (fwrite(data, 1, size, w->f) != size) {
+        w->failed = 1;
+        return -1;
+    }
+    w->offset += size;
+    return 0;
+}
+
+int prime_writer_open(prime_writer_t* w, const char* path, uint32_t block) {
+    memset(w, 0, sizeof(*w));
+    w->block = block ? block : PRIME_BINARY_BLOCK;
+    w->f = fopen(path, "wb");
+    if (!w->f) return -1;
+    setvbuf(w->f, NULL, _IOFBF, WRITER_BUFFER);
+    mpz_inits(w->base, w->last, w->gap, NULL);
+    prime_binary_header_t h;
+    memset(&h, 0, sizeof(h));   // placeholder until close
+    writer_put(w, &h, sizeof(h));
+    return w->failed ? -1 : 0;
+}
+
+static int writer_add_block(prime_writer_t* w) {
+    if (w->count / w->block == w->index_cap) {
+        size_t cap = w->index_cap ? 2 * w->index_cap : 64;
+        prime_binary_block_t* index = realloc(w->index, cap * sizeof(*index));
+        if (!index) return -1;
+        w->index = index;
+        w->index_cap = cap;
+    }
+    prime_binary_block_t* e = &w->index[w->count / w->block];
+    e->offset = w->offset;
+    e->delta = w->delta;
+    return 0;
+}
+
+int prime_writer_push(prime_writer_t* w, const mpz_t prime) {
+    if (w->failed) return -1;
+    uint64_t half = 0;
+    if (w->count == 0) {
+        if (mpz_sgn(prime) <= 0 || mpz_even_p(prime)) goto reject;
+        mpz_set(w->base, prime);
+    } else {
+        mpz_sub(w->gap, prime, w->last);
+        if (mpz_sgn(w->gap) <= 0 || mpz_odd_p(w->gap) || mpz_sizeinbase(w->gap, 2) > 64) {
+            goto reject;
+        }
+        uint64_t gap = (uint64_t)mpz_get_ui(w->gap);
+        if (w->delta > UINT64_MAX - gap) goto reject;   // beyond 2^64 of the first prime
+        w->delta += gap;
+        half = gap / 2;
+    }
+    if (w->count % w->block == 0) {
+        if (writer_add_block(w) != 0) goto reject;
+    } else {
+        unsigned char buf[10];
+        if (writer_put(w, buf, varint_put(buf, half)) != 0) return -1;
+    }
+    mpz_set(w->last, prime);
+    w->count++;
+    return 0;
+
+reject:
+    w->failed = 1;
+    return -1;
+}
+
+int prime_writer_close(prime_writer_t* w) {
+    if (!w->f) return -1;
+    prime_binary_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, PRIME_BINARY_MAGIC, 8);
+    h.version = PRIME_BINARY_VERSION;
+    h.block = w->block;
+    h.count = w->count;
+    h.base_offset = w->offset;
+
+    size_t bytes = 0;
+    unsigned char* base = w->count ? mpz_export(NULL, &bytes, -1, 1, 0, 0, w->base) : NULL;
+    h.base_bytes = bytes;
+    if (bytes) writer_put(w, base, bytes);
+    if (base) {
+        void (*free_fn)(void*, size_t);
+        mp_get_memory_functions(NULL, NULL, &free_fn);
+        free_fn(base, bytes);
+    }
+    static const unsigned char zeros[8];
+    writer_put(w, zeros, (8 - w->offset % 8) % 8);   // align the index
+    h.index_offset = w->offset;
+    uint64_t blocks = (w->count + w->block - 1) / w->block;
+    if (blocks) writer_put(w, w->index, blocks * sizeof(prime_binary_block_t));
+
+    if (fseek(w->f, 0, SEEK_SET) != 0) w->failed = 1;
+    if (!w->failed) writer_put(w, &h, sizeof(h));
+    if (fclose(w->f) != 0) w->failed = 1;
+    w->f = NULL;
+    free(w->index);
+    w->index = NULL;
+    mpz_clears(w->base, w->last, w->gap, NULL);
+    return w->failed ? -1 : 0;
+}
+
+// ----------------------- Reader -----------------------
+
+static int reader_check(const prime_reader_t* r, const prime_binary_header_t* h) {
+    const prime_binary_block_t* idx = r->index;
+    uint64_t end = h->base_offset;
+    for (uint64_t b = 0; b < r->blocks; b++) {
+        uint64_t next = b + 1 < r->blocks ? idx[b + 1].offset : end;
+        if (idx[b].offset < sizeof(*h) || idx[b].offset > next) return -1;
+        if (b ? idx[b].delta <= idx[b - 1].delta : idx[b].delta != 0) return -1;
+    }
+    return r->blocks ? (idx[0].offset == sizeof(*h) ? 0 : -1) : 0;
+}
+
+int prime_reader_open(prime_reader_t* r, const char* path) {
+    memset(r, 0, sizeof(*r));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(prime_binary_header_t)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);   // the mapping keeps the file referenced
+    if (map == MAP_FAILED) return -1;
+
+    const prime_binary_header_t* h = (const prime_binary_header_t*)map;
+    uint64_t blocks = h->block ? h->count / h->block + (h->count % h->block != 0) : 0;
+    // A byte-swapped file fails the version check
+    if (memcmp(h->magic, PRIME_BINARY_MAGIC, 8) != 0 || h->version != PRIME_BINARY_VERSION ||
+        h->block == 0 || h->base_offset < sizeof(*h) || h->base_offset > h->index_offset ||
+        h->base_bytes > h->index_offset - h->base_offset || (h->count && !h->base_bytes) ||
+        h->index_offset % 8 != 0 || h->index_offset > size ||
+        (size - h->index_offset) / sizeof(prime_binary_block_t) != blocks ||
+        (size - h->index_offset) % sizeof(prime_binary_block_t) != 0) {
+        munmap(map, size);
+        return -1;
+    }
+    r->map = map;
+    r->map_size = size;
+    r->block = h->block;
+    r->count = h->count;
+    r->blocks = blocks;
+    r->index = (const prime_binary_block_t*)((const unsigned char*)map + h->index_offset);
+    if (reader_check(r, h) != 0) {
+        munmap(map, size);
+        memset(r, 0, sizeof(*r));
+        return -1;
+    }
+    mpz_init(r->base);
+    mpz_import(r->base, h->base_bytes, -1, 1, 0, 0, r->map + h->base_offset);
+    return 0;
+}
+
+void prime_reader_close(prime_reader_t* r) {
+    if (r->map) {
+        munmap((void*)r->map, r->map_size);
+        mpz_clear(r->base);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+// Varint range of block b
+static void block_range(const prime_reader_t* r, uint64_t b, const unsigned char** pos,
+                        const unsigned char** end) {
+    const prime_binary_header_t* h = (const prime_binary_header_t*)r->map;
+    *pos = r->map + r->index[b].offset;
+    *end = r->map + (b + 1 < r->blocks ? r->index[b + 1].offset : h->base_offset);
+}
+
+void prime_cursor_init(prime_cursor_t* c, const prime_reader_t* r) {
+    c->r = r;
+    c->k = 0;
+    c->pos = c->end = NULL;
+    mpz_init(c->cur);
+}
+
+void prime_cursor_clear(prime_cursor_t* c) {
+    mpz_clear(c->cur);
+}
+
+int prime_cursor_seek(prime_cursor_t* c, uint64_t k) {
+    const prime_reader_t* r = c->r;
+    if (k >= r->count) return -1;
+    uint64_t b = k / r->block, delta = r->index[b].delta, half;
+    block_range(r, b, &c->pos, &c->end);
+    for (uint64_t i = b * r->block; i < k; i++) {
+        if (varint_get(&c->pos, c->end, &half) != 0) return -1;
+        delta += 2 * half;
+    }
+    mpz_add_ui(c->cur, r->base, (unsigned long)delta);
+    c->k = k;
+    return 0;
+}
+
+int prime_cursor_next(prime_cursor_t* c) {
+    const prime_reader_t* r = c->r;
+    if (c->k + 1 >= r->count) return 0;
+    uint64_t k = c->k + 1;
+    if (k % r->block == 0) {
+        block_range(r, k / r->block, &c->pos, &c->end);
+        mpz_add_ui(c->cur, r->base, (unsigned long)r->index[k / r->block].delta);
+    } else {
+        uint64_t half;
+        if (varint_get(&c->pos, c->end, &half) != 0) return -1;
+        mpz_add_ui(c->cur, c->cur, (unsigned long)(2 * half));
+    }
+    c->k = k;
+    return 1;
+}
+
+int prime_reader_find(const prime_reader_t* r, const mpz_t x, uint64_t* k_out) {
+    *k_out = 0;
+    if (r->count == 0 || mpz_cmp(x, r->base) <= 0) return 0;
+    mpz_t d;
+    mpz_init(d);
+    mpz_sub(d, x, r->base);
+    int beyond = mpz_sizeinbase(d, 2) > 64;
+    uint64_t target = beyond ? 0 : (uint64_t)mpz_get_ui(d);
+    mpz_clear(d);
+    *k_out = r->count;
+    if (beyond) return 0;   // every prime is within 2^64 of the first
+
+    // Last block whose first prime is below x; the answer is in it or starts the next
+    uint64_t lo = 0, hi = r->blocks;
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (r->index[mid].delta < target) lo = mid;
+        else hi = mid;
+    }
+    const unsigned char *pos, *end;
+    block_range(r, lo, &pos, &end);
+    uint64_t delta = r->index[lo].delta, half;
+    uint64_t k = lo * r->block, last = k + r->block < r->count ? k + r->block : r->count;
+    for (k++; k < last; k++) {
+        if (varint_get(&pos, end, &half) != 0) return -1;
+        delta += 2 * half;
+        if (delta >= target) break;
+    }
+    *k_out = k;   // the first prime of the next block, or count, when the block ends below x
+    return 0;
+}
@@ -10,7 +10,8 @@
 // Enhanced features (addressing issue requirements):
 // - Z5D-powered intelligent candidate jumping using prime-density predictions
 // - Adaptive reps count for mpz_probab_prime_p based on number size
-// - Pre-filtering with mpz_probab_prime_p(n, 1) before full verification
+// - Incremental presieve: residues mod small primes tracked across the wheel-30
+//   stream, so only survivors are materialized and sent to Miller-Rabin
 // - Geodesic-informed optimization using ZF_KAPPA_GEO_DEFAULT
 // - Maintains deterministic output while drastically reducing search time
 //
@@ -29,7 +30,10 @@
 // - We *scan* primes starting from --start upward, returning --count primes.
 // - Enhanced primality test: adaptive reps + pre-filtering optimization.
 // - Mersenne detection: check n+1 is a power of two, then run Lucas–Lehmer for exponent p.
-// - We avoid thread parallelism to keep deterministic, clean output at extreme scales.
+// - --threads N scans equal-width segments in parallel (OpenMP); a reorder window
+//   prints primes in scan order, so the output matches the serial run.
+// - --binary FILE writes the primes as varint gaps in indexed blocks instead of
+//   text (prime_binary.h); prime_read seeks in the file and prints it back.
 //
 // -----------------------------------------------------------------------------
 
@@ -40,6 +44,7 @@
 #include <stdint.h>
 #include <time.h>
 #include <math.h>
+#include <sched.h>
 
 // OpenMP support for M1 Max parallelization (following parent pattern)
 #ifdef _OPENMP
@@ -67,6 +72,8 @@
 // Parameter constants (shared)
 #include "z_framework_params.h"
 
+#include "prime_binary.h"
+
 // Vectorized timing integration - Attribution: Dionisio Alberto Lopez III (D.A.L. III)
 #if __has_include("z_framework_params.h")
 #  define BOOTSTRAP_ENABLED 1
@@ -81,8 +88,10 @@ typedef struct {
     mpz_t start;      // starting candidate (inclusive)
     unsigned long count;  // how many primes to output
     int csv;          // flag
+    int threads;      // >1: parallel segments (OpenMP builds)
     int verbose;      // verbose output for performance analysis
     int show_stats;   // show optimization statistics
+    prime_writer_t* writer;   // --binary: primes go here instead of stdout
 } config_t;
 
 // Parse strings like "10^1234" or plain decimal into mpz_t.
@@ -129,61 +138,39 @@ static int parse_bigint(const char* s, mpz_t out) {
 
 static void print_usage(const char* prog) {
     fprintf(stderr,
-        "Usage: %s --start <BIGINT|a^b> --count <N> [--csv] [--verbose] [--stats]\n"
+        "Usage: %s --start <BIGINT|a^b> --count <N> [--csv | --binary FILE] [--verbose] [--stats]\n"
+        "       [--threads N]\n"
         "Example: %s --start 10^1234 --count 5 --csv\n"
         "Options:\n"
+        "  --binary FILE Write gap-encoded primes to FILE (read back with prime_read)\n"
         "  --verbose   Show detailed timing and Z5D optimization info\n"
-        "  --stats     Show candidate generation statistics\n",
+        "  --stats     Show candidate generation statistics\n"
+        "  --threads N Scan segments on N threads, output stays in order (0 = all cores)\n",
         prog, prog);
 }
 
 // ----------------------- Mersenne / Lucas–Lehmer -----------------------
-// Lucas–Lehmer for M_p = 2^p - 1, with p >= 2 (p should be prime for M_p to be prime).
-static int is_mersenne_prime_ll(unsigned long p) {
-    if (p == 2) return 1; // M_2 = 3
-    if (p < 2) return 0;
-
-    mpz_t Mp, s, tmp;
-    mpz_inits(Mp, s, tmp, NULL);
-
-    // Mp = 2^p - 1
-    mpz_ui_pow_ui(Mp, 2, p);
-    mpz_sub_ui(Mp, Mp, 1);
-
-    // s = 4
-    mpz_set_ui(s, 4);
-
-    for (unsigned long i = 0; i < p - 2; i++) {
-        // s = (s^2 - 2) mod Mp
-        mpz_mul(tmp, s, s);      // s^2
-        mpz_sub_ui(tmp, tmp, 2); // s^2 - 2
-        mpz_mod(s, tmp, Mp);
-    }
-
-    int is_prime = (mpz_cmp_ui(s, 0) == 0);
-    mpz_clears(Mp, s, tmp, NULL);
-    return is_prime;
+// Lucas–Lehmer for M_p = 2^p - 1 via the library engine: the square is folded
+// at bit p instead of divided, and past Z5D_LL_FFT_THRESHOLD it is taken with
+// a weighted FFT on `threads` threads.
+static int is_mersenne_prime_ll(unsigned long p, int threads) {
+    z5d_ll_config_t config;
+    z5d_ll_config_init(&config);
+    config.threads = threads > 1 ? (unsigned int)threads : 1;
+    return z5d_lucas_lehmer(p, &config, NULL) == Z5D_LL_PRIME;
 }
 
 // Check if n = 2^p - 1 for some unsigned long p, and if so run LL test.
-static int detect_mersenne_and_test(const mpz_t n) {
+static int detect_mersenne_and_test(const mpz_t n, int threads) {
     if (mpz_cmp_ui(n, 3) < 0) return 0; // smallest Mersenne is 3
-    mpz_t t; mpz_init(t);
-    mpz_add_ui(t, n, 1); // t = n + 1
-    // Check if t is a power of two: true iff popcount(t)==1
-    int is_power_two = (mpz_popcount(t) == 1);
-    if (!is_power_two) { mpz_clear(t); return 0; }
-
-    // p = log2(t), but exact; since t is power of two, find index of highest bit.
-    // mpz_sizeinbase(t, 2) returns floor(log2(t)) + 1; for powers of two, that's p+1.
-    unsigned long p = mpz_sizeinbase(t, 2) - 1;
-    mpz_clear(t);
-
-    // If p is composite, M_p is composite; quick probable primality on p (fits in UL here).
-    // For p up to ~1e6 fits UL; in our expected ranges (around 10^1234 -> p ≈ 4097) it's fine.
-    // Perform LL regardless; p primality quickly pre-checked with simple sieve is optional.
-
-    return is_mersenne_prime_ll(p);
+    // n = 2^p - 1 iff every one of its bits is set; no n + 1 temporary, so
+    // the per-prime check allocates nothing.
+    size_t bits = mpz_sizeinbase(n, 2);
+    if (mpz_popcount(n) != bits) return 0;
+    unsigned long p = (unsigned long)bits;
+
+    // Composite p gives composite M_p; the engine answers that without iterating.
+    return is_mersenne_prime_ll(p, threads);
 }
 
 // ----------------------- Prime scanning with LIS-Corrector pipeline -----------------------
@@ -193,35 +180,22 @@ static void next_odd(mpz_t n) {
 }
 
 
-// High-precision safe modular arithmetic for GMP Miller-Rabin
-static void mpz_mulmod(mpz_t result, const mpz_t a, const mpz_t b, const mpz_t mod) {
-    mpz_mul(result, a, b);
-    mpz_mod(result, result, mod);
-}
-
-static void mpz_powmod_safe(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
-    mpz_powm(result, base, exp, mod);
-}
-
 // Size-aware Miller-Rabin using GMP's mpz_probab_prime_p with sufficient rounds for large n.
+// Candidates come from the presieve stream, so no small-factor checks are repeated here.
+// With the Z5D library, inputs of up to 64 bits take its deterministic word-sized test.
 // Returns 1 if probable prime, 0 if composite.
 static int is_prime_mr_gmp(const mpz_t n) {
     if (mpz_cmp_ui(n, 2) < 0) return 0;
-    if (mpz_cmp_ui(n, 2) == 0 || mpz_cmp_ui(n, 3) == 0 || mpz_cmp_ui(n, 5) == 0) return 1;
-
-    // Check divisibility by 2, 3, 5
-    if (mpz_even_p(n)) return 0;
-    mpz_t tmp;
-    mpz_init(tmp);
-    mpz_mod_ui(tmp, n, 3); if (mpz_cmp_ui(tmp, 0) == 0) { mpz_clear(tmp); return 0; }
-    mpz_mod_ui(tmp, n, 5); if (mpz_cmp_ui(tmp, 0) == 0) { mpz_clear(tmp); return 0; }
-    mpz_clear(tmp);
 
     // Pick rounds based on size to keep error < 2^-128 even for huge n
     size_t bits = mpz_sizeinbase(n, 2);
     int reps;
     if (bits <= 64) {
+#if Z5D_ENHANCED
+        return z5d_is_prime_u64(mpz_get_ui(n));   // deterministic word-sized test
+#else
         reps = 10;      // much stronger than needed for 64-bit range
+#endif
     } else if (bits <= 512) {
         reps = 25;
     } else if (bits <= 4096) {
@@ -234,181 +208,205 @@ static int is_prime_mr_gmp(const mpz_t n) {
     return r > 0;  // 1 = probable, 2 = definitely prime (for small n)
 }
 
-// Wheel-30 optimization for GMP
-static int is_wheel30_candidate(const mpz_t n) {
-    mpz_t mod_result;
-    mpz_init(mod_result);
-    mpz_mod_ui(mod_result, n, 30);
-    unsigned long mod = mpz_get_ui(mod_result);
-    mpz_clear(mod_result);
-
-    // candidate must be ≡ {1,11,13,17,19,23,29,31} mod 30
-    return (mod == 1 || mod == 11 || mod == 13 || mod == 17 ||
-            mod == 19 || mod == 23 || mod == 29 || mod == 31);
+// ----------------------- Residue-tracking presieve -----------------------
+// The candidate stream walks the wheel mod 30 from base + off. Residues of
+// the current candidate mod the small primes 7..p_max are computed once per
+// seek, then advanced by the wheel gap with 16-bit adds and one conditional
+// subtract per prime (gap < 7 <= p), a loop the compiler vectorizes. Only
+// candidates with no zero residue reach is_prime_mr_gmp; the bignum is
+// touched only to materialize those survivors.
+
+#define PRESIEVE_MAX_PRIMES 2048   // 7..17881: ~21% of wheel candidates survive
+#define PRESIEVE_MIN_PRIMES 64
+#define PRESIEVE_REBASE (1ULL << 32)
+#define PRESIEVE_DIRECT_BOUND 20000UL   // below: candidates may equal a sieving prime
+
+static const unsigned wheel30[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+static const unsigned wheel30_gaps[8] = {6, 4, 2, 4, 2, 4, 6, 2};
+
+typedef struct {
+    size_t np;               // primes in use
+    uint16_t* primes;        // 7, 11, 13, ...
+    uint16_t* res;           // (base + off) mod primes[i]
+    mpz_t base;
+    uint64_t off;
+    uint64_t end;            // stream stops at base + end (UINT64_MAX: unbounded)
+    int wheel;               // index of (base + off) mod 30 in wheel30
+    unsigned long seeks;     // residue vectors computed from scratch
+} presieve_t;
+
+// Primes 7..p for the stream, fewer for small candidates where MR is cheap
+static size_t presieve_primes_for(const mpz_t n) {
+    size_t np = mpz_sizeinbase(n, 2) / 2;
+    if (np < PRESIEVE_MIN_PRIMES) np = PRESIEVE_MIN_PRIMES;
+    if (np > PRESIEVE_MAX_PRIMES) np = PRESIEVE_MAX_PRIMES;
+    return np;
 }
 
-// Lucas pre-filter for GMP
-static int lucas_prefilter_gmp(const mpz_t n) {
-    // Quick divisibility checks by small primes
-    mpz_t tmp;
-    mpz_init(tmp);
-
-    unsigned long small_primes[] = {7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
-    int num_primes = sizeof(small_primes) / sizeof(unsigned long);
-
-    for (int i = 0; i < num_primes; i++) {
-        mpz_mod_ui(tmp, n, small_primes[i]);
-        if (mpz_cmp_ui(tmp, 0) == 0) {
-            // Check if n equals the prime itself
-            if (mpz_cmp_ui(n, small_primes[i]) == 0) {
-                mpz_clear(tmp);
-                return 1; // n is this prime
-            }
-            mpz_clear(tmp);
-            return 0; // n is divisible by this prime
+static int presieve_init(presieve_t* ps) {
+    memset(ps, 0, sizeof(*ps));
+    ps->primes = malloc(PRESIEVE_MAX_PRIMES * sizeof(uint16_t));
+    ps->res = malloc(PRESIEVE_MAX_PRIMES * sizeof(uint16_t));
+    if (!ps->primes || !ps->res) {
+        free(ps->primes);
+        free(ps->res);
+        return -1;
+    }
+    size_t k = 0;
+    for (unsigned c = 7; k < PRESIEVE_MAX_PRIMES; c += 2) {
+        int prime = 1;
+        for (unsigned d = 3; d * d <= c; d += 2) {
+            if (c % d == 0) { prime = 0; break; }
         }
+        if (prime) ps->primes[k++] = (uint16_t)c;
     }
+    mpz_init(ps->base);
+    return 0;
+}
 
-    mpz_clear(tmp);
-    return 1; // Passed Lucas filter
+static void presieve_clear(presieve_t* ps) {
+    free(ps->primes);
+    free(ps->res);
+    mpz_clear(ps->base);
 }
 
-// LIS-Corrector full pipeline: Wheel-30 + Lucas + Miller-Rabin
-static int __attribute__((unused)) is_probable_prime(const mpz_t n) {
-    // Step 1: Wheel-30 optimization
-    if (!is_wheel30_candidate(n)) {
-        return 0;
+// Position the stream at the first wheel candidate >= start (start > 5); with
+// width > 0 the stream covers [start, start + width) only
+static void presieve_seek(presieve_t* ps, const mpz_t start, uint64_t width) {
+    mpz_set(ps->base, start);
+    unsigned long m = mpz_fdiv_ui(ps->base, 30);
+    unsigned long skip;
+    int w = 0;
+    while (w < 8 && wheel30[w] < m) w++;
+    if (w == 8) {                       // past 29: next block's 1
+        skip = 31 - m;
+        w = 0;
+    } else {
+        skip = wheel30[w] - m;
     }
-
-    // Step 2: Lucas pre-filter
-    if (!lucas_prefilter_gmp(n)) {
-        return 0;
+    mpz_add_ui(ps->base, ps->base, skip);
+    ps->wheel = w;
+    ps->off = 0;
+    ps->end = width == 0 ? UINT64_MAX : (width > skip ? width - skip : 0);
+    ps->np = presieve_primes_for(ps->base);
+
+    // One bignum division per four primes: the product of four 15-bit primes fits a limb
+    for (size_t i = 0; i < ps->np; i += 4) {
+        unsigned long prod = 1;
+        size_t j_end = (i + 4 < ps->np) ? i + 4 : ps->np;
+        for (size_t j = i; j < j_end; j++) prod *= ps->primes[j];
+        unsigned long r = mpz_fdiv_ui(ps->base, prod);
+        for (size_t j = i; j < j_end; j++) ps->res[j] = (uint16_t)(r % ps->primes[j]);
     }
-
-    // Step 3: High-precision deterministic Miller-Rabin
-    return is_prime_mr_gmp(n);
+    ps->seeks++;
 }
 
-// Enhanced wheel-30 candidate generation with OpenMP
-// Align candidate to the nearest wheel-30 residue at or above current value (inclusive).
-static void align_wheel30_candidate(mpz_t candidate) {
-    static const unsigned long wheel30[] = {1,11,13,17,19,23,29,31};
-
-    mpz_t mod_result;
-    mpz_init(mod_result);
-    mpz_mod_ui(mod_result, candidate, 30);
-    unsigned long mod = mpz_get_ui(mod_result);
-    mpz_clear(mod_result);
-
-    for (int i = 0; i < 8; i++) {
-        if (mod == wheel30[i]) {
-            return; // already aligned
-        } else if (mod < wheel30[i]) {
-            mpz_add_ui(candidate, candidate, wheel30[i] - mod);
-            return;
-        }
+// Advance one wheel position; returns 1 if no sieving prime divides the new candidate
+static int presieve_step(presieve_t* ps) {
+    const uint16_t gap = (uint16_t)wheel30_gaps[ps->wheel];
+    ps->wheel = (ps->wheel + 1) & 7;
+    ps->off += gap;
+
+    uint16_t* restrict res = ps->res;
+    const uint16_t* restrict primes = ps->primes;
+    const size_t np = ps->np;
+    unsigned zero = 0;
+    for (size_t i = 0; i < np; i++) {
+        uint16_t r = (uint16_t)(res[i] + gap);
+        r = (uint16_t)(r >= primes[i] ? r - primes[i] : r);
+        res[i] = r;
+        zero |= (r == 0);
     }
+    return !zero;
+}
 
-    // If we're past 31, jump to next 30-block + 1
-    unsigned long gap_to_next = 30 - mod + 1;
-    mpz_add_ui(candidate, candidate, gap_to_next);
+// Whether the current candidate has no zero residue (for the first position)
+static int presieve_clean(const presieve_t* ps) {
+    unsigned zero = 0;
+    for (size_t i = 0; i < ps->np; i++) zero |= (ps->res[i] == 0);
+    return !zero;
 }
 
-static void next_wheel30_candidate(mpz_t candidate) {
-    // Move to next wheel-30 position: {1,11,13,17,19,23,29,31} mod 30
-    static const unsigned long wheel30[] = {1,11,13,17,19,23,29,31};
-    static const unsigned long wheel30_gaps[] = {10,2,4,2,4,6,2,6}; // gaps to next position
-
-    mpz_t mod_result;
-    mpz_init(mod_result);
-    mpz_mod_ui(mod_result, candidate, 30);
-    unsigned long mod = mpz_get_ui(mod_result);
-    mpz_clear(mod_result);
-
-    // Find current position in wheel and advance to next
-    for (int i = 0; i < 8; i++) {
-        if (mod == wheel30[i]) {
-            mpz_add_ui(candidate, candidate, wheel30_gaps[i]);
-            return;
-        } else if (mod < wheel30[i]) {
-            mpz_add_ui(candidate, candidate, wheel30[i] - mod);
-            return;
-        }
+// Current candidate base + off into out; folds off into base now and then
+static void presieve_get(presieve_t* ps, mpz_t out) {
+    if (ps->off >= PRESIEVE_REBASE) {
+        mpz_add_ui(ps->base, ps->base, (unsigned long)ps->off);
+        if (ps->end != UINT64_MAX) ps->end -= ps->off;
+        ps->off = 0;
     }
-
-    // If we're past 31, jump to next 30-block + 1
-    unsigned long gap_to_next = 30 - mod + 1;
-    mpz_add_ui(candidate, candidate, gap_to_next);
+    mpz_add_ui(out, ps->base, (unsigned long)ps->off);
 }
 
-// Enhanced prime search with LIS-Corrector pipeline and OpenMP
-static void next_prime_from(const mpz_t start, mpz_t out, int verbose, int show_stats) {
-    mpz_set(out, start);
+// Statistics for optimization tracking; one per thread in parallel mode
+typedef struct {
+    unsigned long candidates;         // wheel-30 positions visited
+    unsigned long presieve_filtered;  // rejected by a zero residue
+    unsigned long mr_calls;
+} scan_stats_t;
+
+static void scan_stats_add(scan_stats_t* dst, const scan_stats_t* src) {
+    dst->candidates += src->candidates;
+    dst->presieve_filtered += src->presieve_filtered;
+    dst->mr_calls += src->mr_calls;
+}
 
-    // Statistics for optimization tracking
-    static unsigned long total_candidates_tested = 0;
-    static unsigned long total_wheel_filtered = 0;
-    static unsigned long total_lucas_filtered = 0;
-    static unsigned long total_mr_calls = 0;
+static void print_scan_stats(const scan_stats_t* local, const scan_stats_t* total, size_t np) {
+    fprintf(stderr, "LIS-Corrector pipeline performance:\n");
+    fprintf(stderr, "  Wheel-30 candidates: %lu (total: %lu)\n",
+           local->candidates, total->candidates);
+    fprintf(stderr, "  Presieve filtered (%zu primes): %lu (total: %lu)\n",
+           np, local->presieve_filtered, total->presieve_filtered);
+    fprintf(stderr, "  Miller-Rabin calls: %lu (total: %lu)\n",
+           local->mr_calls, total->mr_calls);
+
+    double reduction_pct = (local->candidates > 0) ?
+        100.0 * (1.0 - (double)local->mr_calls / (double)local->candidates) : 0.0;
+    fprintf(stderr, "  Pre-filter reduction: %.2f%%\n", reduction_pct);
+}
 
+// Next probable prime of the stream into out, counted into st; the stream then
+// continues after it. Returns 0 once the stream passes its end.
+static int next_prime_from(presieve_t* ps, mpz_t out, scan_stats_t* st, int verbose) {
     unsigned long local_candidates = 0;
-    unsigned long local_wheel_filtered = 0;
-    unsigned long local_lucas_filtered = 0;
-    unsigned long local_mr_calls = 0;
-
-    // Align to first wheel-30 residue at or above the start (inclusive)
-    align_wheel30_candidate(out);
 
+    int clean = presieve_clean(ps);
     for (;;) {
+        if (ps->off >= ps->end) return 0;
         local_candidates++;
-        total_candidates_tested++;
-
-        // Step 1: Wheel-30 check (already guaranteed by next_wheel30_candidate)
-        // Track how many candidates were advanced purely by wheel skipping
-        // (every loop except when a prime is returned counts as wheel-filtered
-        // because the generator only yields wheel residues)
-        local_wheel_filtered++;
-        total_wheel_filtered++;
-
-        // Step 2: Lucas pre-filter
-        if (!lucas_prefilter_gmp(out)) {
-            local_lucas_filtered++;
-            total_lucas_filtered++;
-            next_wheel30_candidate(out);
-            continue;
-        }
+        st->candidates++;
 
-    // Step 3: Miller-Rabin verification (size-aware rounds)
-    local_mr_calls++;
-    total_mr_calls++;
-
-    if (is_prime_mr_gmp(out)) {
-            if (verbose || show_stats) {
-                fprintf(stderr, "LIS-Corrector pipeline performance:\n");
-                fprintf(stderr, "  Candidates tested: %lu (total: %lu)\n",
-                       local_candidates, total_candidates_tested);
-                fprintf(stderr, "  Wheel-30 filtered: %lu (total: %lu)\n",
-                       local_wheel_filtered, total_wheel_filtered);
-                fprintf(stderr, "  Lucas filtered: %lu (total: %lu)\n",
-                       local_lucas_filtered, total_lucas_filtered);
-                fprintf(stderr, "  Miller-Rabin calls: %lu (total: %lu)\n",
-                       local_mr_calls, total_mr_calls);
-
-                double reduction_pct = (local_candidates > 0) ?
-                    100.0 * (1.0 - (double)local_mr_calls / (double)local_candidates) : 0.0;
-                fprintf(stderr, "  Pre-filter reduction: %.2f%%\n", reduction_pct);
-            }
-            return;
+        if (!clean) {
+            st->presieve_filtered++;
+        } else {
+            st->mr_calls++;
+            presieve_get(ps, out);
+            if (is_prime_mr_gmp(out)) break;
         }
-
-        // Move to next wheel-30 candidate
-        next_wheel30_candidate(out);
+        clean = presieve_step(ps);
 
         if (verbose && local_candidates % 1000 == 0) {
+            presieve_get(ps, out);
             gmp_fprintf(stderr, "Debug: Tested %lu candidates, current: %Zd\n",
                        local_candidates, out);
         }
     }
+    presieve_step(ps);   // resume after the prime on the next call
+    return 1;
+}
+
+// Next prime >= start below PRESIEVE_DIRECT_BOUND, where candidates may be sieving primes
+static void next_prime_direct(const mpz_t start, mpz_t out) {
+    if (mpz_cmp_ui(start, 2) <= 0) {
+        mpz_set_ui(out, 2);
+        return;
+    }
+#if Z5D_ENHANCED
+    mpz_set_ui(out, z5d_next_prime_u64(mpz_get_ui(start), NULL));
+#else
+    mpz_set(out, start);
+    if (mpz_even_p(out)) mpz_add_ui(out, out, 1);
+    while (!is_prime_mr_gmp(out)) mpz_add_ui(out, out, 2);
+#endif
 }
 
 // ----------------------- CSV printing -----------------------
@@ -445,10 +443,7 @@ static double global_timing_samples[1000];
 static int global_sample_count = 0;
 #endif
 
-static void log_prime_time_bootstrap(const mpz_t prime, clock_t start, unsigned long prime_index) {
-    clock_t end = clock();
-    double ms = ((double)(end - start)) * 1000 / CLOCKS_PER_SEC;
-
+static void log_prime_time_bootstrap(const mpz_t prime, double ms, unsigned long prime_index) {
     // Enhanced logging with bootstrap tracking
     gmp_printf("%lu) prime=%Zd*  (%.3f ms)\n", prime_index, prime, ms);
 
@@ -486,6 +481,171 @@ static void calculate_bootstrap_ci(double *samples, int count, double *ci_lower,
     *ci_upper = mean + 1.96 * std_dev / sqrt(count);
 }
 #endif
+// Print one prime in the selected format
+static void emit_prime(const config_t* cfg, unsigned long idx, const mpz_t prime, int is_mers,
+                       double ms) {
+    if (cfg->writer) {
+        prime_writer_push(cfg->writer, prime);   // errors are reported on close
+    } else if (cfg->csv) {
+        print_csv_row(idx, prime, is_mers, ms);
+    } else {
+        // Use vectorized timing logger with bootstrap integration
+        log_prime_time_bootstrap(prime, ms, idx);
+        if (is_mers) {
+            printf("  [Mersenne detected]\n");
+        }
+    }
+}
+
+// ----------------------- Parallel segments -----------------------
+#ifdef _OPENMP
+// With --threads N the range from the first candidate is cut into segments
+// of equal width. Threads claim segments in order and scan each with their
+// own presieve stream and stats. Finished segments wait in a window of slots
+// until every earlier one is done, so primes come out in the order the
+// serial scan finds them; the ms column is the segment's time per prime.
+// The Lucas-Lehmer check for Mersenne candidates runs in the segment's
+// thread, so emitting under the lock only prints.
+
+#define SEGMENT_PRIMES 32            // expected primes per segment, at most
+#define SEGMENT_SLOTS_PER_THREAD 4   // reorder window
+
+typedef struct {
+    mpz_t* primes;    // initialized up to cap, kept across reuse
+    unsigned char* mersenne;   // per prime: Mersenne prime (LL-tested)
+    size_t n, cap;
+    double ms;        // wall time spent scanning the segment
+    int done;
+} segment_t;
+
+static int segment_push(segment_t* seg, const mpz_t p, int is_mers) {
+    if (seg->n == seg->cap) {
+        size_t cap = seg->cap ? 2 * seg->cap : 16;
+        unsigned char* flags = realloc(seg->mersenne, cap);
+        if (!flags) return -1;
+        seg->mersenne = flags;
+        mpz_t* grown = realloc(seg->primes, cap * sizeof(mpz_t));
+        if (!grown) return -1;
+        for (size_t i = seg->cap; i < cap; i++) mpz_init(grown[i]);
+        seg->primes = grown;
+        seg->cap = cap;
+    }
+    seg->mersenne[seg->n] = (unsigned char)is_mers;
+    mpz_set(seg->primes[seg->n++], p);
+    return 0;
+}
+
+// Segment width: a multiple of 30 holding about SEGMENT_PRIMES primes near
+// start (gap ~ ln start), fewer when the whole run would fit one window
+static uint64_t segment_width(const mpz_t start, unsigned long remaining, int threads) {
+    double gap = 0.6931471805599453 * (double)mpz_sizeinbase(start, 2);
+    unsigned long per = remaining / ((unsigned long)threads * SEGMENT_SLOTS_PER_THREAD);
+    if (per < 1) per = 1;
+    if (per > SEGMENT_PRIMES) per = SEGMENT_PRIMES;
+    return ((uint64_t)(gap * (double)per) / 30 + 1) * 30;
+}
+
+// Primes first_idx..cfg->count from base (odd, >= PRESIEVE_DIRECT_BOUND) on
+// cfg->threads threads; stats are summed into totals. Returns 0 or -1.
+static int generate_parallel(const config_t* cfg, const mpz_t base, unsigned long first_idx,
+                             scan_stats_t* totals) {
+    const int threads = cfg->threads;
+    const size_t window = (size_t)threads * SEGMENT_SLOTS_PER_THREAD;
+    const uint64_t width = segment_width(base, cfg->count - first_idx + 1, threads);
+    segment_t* slots = calloc(window, sizeof(segment_t));
+    if (!slots) return -1;
+
+    unsigned long next_idx = first_idx;   // shared; guarded by pg_reorder
+    unsigned long next_seg = 0, emit_seg = 0;
+    int stop = 0, failed = 0;
+    size_t np = 0;
+    scan_stats_t par = {0, 0, 0};
+
+    #pragma omp parallel num_threads(threads)
+    {
+        presieve_t ps;
+        int ready = presieve_init(&ps) == 0;
+        scan_stats_t local = {0, 0, 0};
+        mpz_t lo, p;
+        mpz_inits(lo, p, NULL);
+
+        while (ready) {
+            unsigned long seg = 0;
+            int claimed = 0, quit;
+            #pragma omp critical(pg_reorder)
+            {
+                quit = stop;
+                if (!stop && next_seg < emit_seg + window) {
+                    seg = next_seg++;
+                    claimed = 1;
+                }
+            }
+            if (quit) break;
+            if (!claimed) {        // window full: an earlier segment is still running
+                sched_yield();
+                continue;
+            }
+
+            segment_t* slot = &slots[seg % window];
+            double t0 = now_ms();
+            mpz_set_ui(lo, seg);
+            mpz_mul_ui(lo, lo, (unsigned long)width);
+            mpz_add(lo, lo, base);
+            presieve_seek(&ps, lo, width);
+            int ok = 1;
+            // One LL thread: the other threads keep scanning meanwhile
+            while (ok && next_prime_from(&ps, p, &local, 0)) {
+                ok = segment_push(slot, p, detect_mersenne_and_test(p, 1)) == 0;
+            }
+            slot->ms = now_ms() - t0;
+
+            #pragma omp critical(pg_reorder)
+            {
+                slot->done = 1;
+                if (!ok) failed = stop = 1;
+                np = ps.np;
+                // Emit every finished segment at the head of the window
+                while (!stop && slots[emit_seg % window].done) {
+                    segment_t* head = &slots[emit_seg % window];
+                    double per_ms = head->n ? head->ms / (double)head->n : 0.0;
+                    for (size_t k = 0; k < head->n && next_idx <= cfg->count; k++) {
+                        emit_prime(cfg, next_idx++, head->primes[k], head->mersenne[k], per_ms);
+                    }
+                    head->n = 0;
+                    head->done = 0;
+                    emit_seg++;
+                    if (next_idx > cfg->count) stop = 1;
+                }
+            }
+        }
+        if (!ready) {
+            #pragma omp critical(pg_reorder)
+            failed = stop = 1;
+        }
+
+        #pragma omp critical(pg_reorder)
+        scan_stats_add(&par, &local);
+        mpz_clears(lo, p, NULL);
+        if (ready) presieve_clear(&ps);
+    }
+
+    scan_stats_add(totals, &par);
+    if (cfg->verbose || cfg->show_stats) {
+        fprintf(stderr, "Parallel scan: %d threads, %lu segments of width %llu\n",
+                threads, next_seg, (unsigned long long)width);
+        print_scan_stats(&par, totals, np);
+    }
+
+    for (size_t i = 0; i < window; i++) {
+        for (size_t k = 0; k < slots[i].cap; k++) mpz_clear(slots[i].primes[k]);
+        free(slots[i].primes);
+        free(slots[i].mersenne);
+    }
+    free(slots);
+    return failed ? -1 : 0;
+}
+#endif
+
 // ----------------------- main -----------------------
 
 int main(int argc, char** argv) {
@@ -495,6 +655,9 @@ int main(int argc, char** argv) {
     cfg.csv = 0;
     cfg.verbose = 0;
     cfg.show_stats = 0;
+    cfg.threads = 1;
+    cfg.writer = NULL;
+    const char* binary_path = NULL;
 
     // Parse args
     for (int i = 1; i < argc; ++i) {
@@ -515,10 +678,21 @@ int main(int argc, char** argv) {
             cfg.count = c;
         } else if (strcmp(argv[i], "--csv") == 0) {
             cfg.csv = 1;
+        } else if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc) {
+            binary_path = argv[++i];
         } else if (strcmp(argv[i], "--verbose") == 0) {
             cfg.verbose = 1;
         } else if (strcmp(argv[i], "--stats") == 0) {
             cfg.show_stats = 1;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            char* end = NULL;
+            long t = strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || t < 0 || t > 1024) {
+                fprintf(stderr, "Invalid --threads value.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+            cfg.threads = (int)t;
         } else if (strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             return 0;
@@ -529,15 +703,33 @@ int main(int argc, char** argv) {
         }
     }
 
-    if (mpz_sgn(cfg.start) == 0 || cfg.count == 0) {
+    if (mpz_sgn(cfg.start) == 0 || cfg.count == 0 || (cfg.csv && binary_path)) {
         print_usage(argv[0]);
         return 1;
     }
 
+#ifdef _OPENMP
+    if (cfg.threads == 0) cfg.threads = omp_get_max_threads();
+#else
+    if (cfg.threads != 1) {
+        fprintf(stderr, "Built without OpenMP; --threads ignored.\n");
+        cfg.threads = 1;
+    }
+#endif
+
     // Ensure we start at an odd candidate >= 3
     if (mpz_cmp_ui(cfg.start, 3) < 0) mpz_set_ui(cfg.start, 3);
     next_odd(cfg.start);
 
+    prime_writer_t writer;
+    if (binary_path) {
+        if (prime_writer_open(&writer, binary_path, PRIME_BINARY_BLOCK) != 0) {
+            fprintf(stderr, "Cannot create %s\n", binary_path);
+            return 1;
+        }
+        cfg.writer = &writer;
+    }
+
     if (cfg.csv) print_csv_header();
     
     if (cfg.verbose) {
@@ -551,7 +743,8 @@ int main(int argc, char** argv) {
         fprintf(stderr, "Z5D Support: FALLBACK (geodesic-informed jumping only)\n");
         #endif
         fprintf(stderr, "Adaptive reps: ENABLED\n");
-        fprintf(stderr, "Pre-filtering: ENABLED\n");
+        fprintf(stderr, "Threads: %d\n", cfg.threads);
+        fprintf(stderr, "Presieve: ENABLED (incremental residues)\n");
         gmp_fprintf(stderr, "Starting from: %Zd\n", cfg.start);
         fprintf(stderr, "Generating %lu primes\n\n", cfg.count);
     }
@@ -559,29 +752,50 @@ int main(int argc, char** argv) {
     mpz_t candidate, prime;
     mpz_inits(candidate, prime, NULL);
     mpz_set(candidate, cfg.start);
+    presieve_t ps;
+    if (presieve_init(&ps) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    int streaming = 0;
 
-    for (unsigned long i = 1; i <= cfg.count; ++i) {
-        clock_t t0 = clock();
-        double start_ms = now_ms();
-        next_prime_from(candidate, prime, cfg.verbose, cfg.show_stats);
+    scan_stats_t totals = {0, 0, 0};
+    unsigned long i = 1;
 
-        int is_mers = detect_mersenne_and_test(prime);
+    for (; i <= cfg.count; ++i) {
+        // Parallel mode takes over once the presieve stream can be used
+        if (cfg.threads > 1 && mpz_cmp_ui(candidate, PRESIEVE_DIRECT_BOUND) >= 0) break;
 
-        if (cfg.csv) {
-            double elapsed_ms = now_ms() - start_ms;
-            print_csv_row(i, prime, is_mers, elapsed_ms);
+        clock_t t0 = clock();
+        double start_ms = now_ms();
+        if (!streaming && mpz_cmp_ui(candidate, PRESIEVE_DIRECT_BOUND) < 0) {
+            next_prime_direct(candidate, prime);
         } else {
-            // Use vectorized timing logger with bootstrap integration
-            log_prime_time_bootstrap(prime, t0, i);
-            if (is_mers) {
-                printf("  [Mersenne detected]\n");
-            }
+            if (!streaming) presieve_seek(&ps, candidate, 0);
+            streaming = 1;
+            scan_stats_t local = {0, 0, 0};
+            next_prime_from(&ps, prime, &local, cfg.verbose);
+            scan_stats_add(&totals, &local);
+            if (cfg.verbose || cfg.show_stats) print_scan_stats(&local, &totals, ps.np);
         }
 
+        int is_mers = detect_mersenne_and_test(prime, cfg.threads);
+        double ms = cfg.csv ? now_ms() - start_ms
+                            : ((double)(clock() - t0)) * 1000 / CLOCKS_PER_SEC;
+        emit_prime(&cfg, i, prime, is_mers, ms);
+
         // Prepare next candidate
         mpz_add_ui(candidate, prime, 2);
     }
 
+    int status = 0;
+#ifdef _OPENMP
+    if (i <= cfg.count && generate_parallel(&cfg, candidate, i, &totals) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        status = 1;
+    }
+#endif
+
     // Bootstrap Performance Analysis - Attribution: Dionisio Alberto Lopez III (D.A.L. III)
     #if BOOTSTRAP_ENABLED
     if ((cfg.verbose || cfg.show_stats) && !cfg.csv && global_sample_count >= 3) {
@@ -598,6 +812,12 @@ int main(int argc, char** argv) {
     }
     #endif
 
+    if (cfg.writer && prime_writer_close(cfg.writer) != 0) {
+        fprintf(stderr, "Error writing %s\n", binary_path);
+        status = 1;
+    }
+
+    presieve_clear(&ps);
     mpz_clears(candidate, prime, cfg.start, NULL);
-    return 0;
+    return status;
 }
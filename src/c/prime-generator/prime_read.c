@@ -0,0 +1,186 @@
+// prime_read.c — Stream primes back out of a prime_generator --binary file
+//
+// Usage:
+//   ./prime_read primes.bin --info
+//   ./prime_read primes.bin --from 1000000 --count 10 --csv
+//   ./prime_read primes.bin --at-least 10^1234+5000 --count 1
+//
+// The file is memory-mapped; --from seeks by index (1-based, the n column of
+// the CSV) and --at-least by value, each decoding at most one block. Output is
+// one decimal prime per line, or n,prime,is_mersenne with --csv (the timing
+// column is not stored). Every value in the file is prime, so is_mersenne is
+// just "all bits set".
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prime_binary.h"
+
+static void print_usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s FILE [--info] [--from N] [--at-least <BIGINT|a^b[+c]>] [--count N] [--csv]\n"
+        "Options:\n"
+        "  --info      Show the count, range and size of the file\n"
+        "  --from N    Start at the N-th prime of the file (1-based)\n"
+        "  --at-least X Start at the first prime >= X\n"
+        "  --count N   Print at most N primes (default: to the end)\n"
+        "  --csv       Print n,prime,is_mersenne rows\n",
+        prog);
+}
+
+// buf split in place at '+' and '^'
+static int parse_parts(char* buf, mpz_t out) {
+    char* plus = strchr(buf, '+');
+    if (plus) *plus++ = '\0';
+    char* caret = strchr(buf, '^');
+    if (caret) {
+        *caret++ = '\0';
+        char* end = NULL;
+        unsigned long e = strtoul(caret, &end, 10);
+        if (end == caret || *end != '\0' || e > 100000 || mpz_set_str(out, buf, 10) != 0) return -1;
+        mpz_pow_ui(out, out, e);
+    } else if (mpz_set_str(out, buf, 10) != 0) {
+        return -1;
+    }
+    if (plus) {
+        mpz_t c;
+        mpz_init(c);
+        int ok = mpz_set_str(c, plus, 10) == 0;
+        mpz_add(out, out, c);
+        mpz_clear(c);
+        if (!ok) return -1;
+    }
+    return 0;
+}
+
+// Decimal, a^b or a^b+c into out
+static int parse_value(const char* s, mpz_t out) {
+    size_t len = strlen(s);
+    if (len == 0) return -1;
+    char* buf = malloc(len + 1);
+    if (!buf) return -1;
+    memcpy(buf, s, len + 1);
+    int rc = parse_parts(buf, out);
+    free(buf);
+    return rc;
+}
+
+static int parse_count(const char* s, unsigned long long* out) {
+    char* end = NULL;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (end == s || *end != '\0') return -1;
+    *out = v;
+    return 0;
+}
+
+static void print_info(const char* path, const prime_reader_t* r) {
+    printf("file: %s\n", path);
+    printf("primes: %llu in %llu blocks of %u\n", (unsigned long long)r->count,
+           (unsigned long long)r->blocks, r->block);
+    printf("bytes: %zu (%.3f per prime)\n", r->map_size,
+           r->count ? (double)r->map_size / (double)r->count : 0.0);
+    if (!r->count) return;
+    prime_cursor_t c;
+    prime_cursor_init(&c, r);
+    gmp_printf("first: %Zd\n", r->base);
+    if (prime_cursor_seek(&c, r->count - 1) == 0) {
+        gmp_printf("last: %Zd (%zu bits)\n", c.cur, mpz_sizeinbase(c.cur, 2));
+    }
+    prime_cursor_clear(&c);
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    int info = 0, csv = 0, have_from = 0, have_value = 0;
+    unsigned long long from = 1, count = ~0ULL;
+    mpz_t value;
+    mpz_init(value);
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--info") == 0) {
+            info = 1;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = 1;
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            if (parse_count(argv[++i], &from) != 0 || from == 0) {
+                fprintf(stderr, "Invalid --from value.\n");
+                return 1;
+            }
+            have_from = 1;
+        } else if (strcmp(argv[i], "--at-least") == 0 && i + 1 < argc) {
+            if (parse_value(argv[++i], value) != 0) {
+                fprintf(stderr, "Invalid --at-least value.\n");
+                return 1;
+            }
+            have_value = 1;
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            if (parse_count(argv[++i], &count) != 0) {
+                fprintf(stderr, "Invalid --count value.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path || (have_from && have_value)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    prime_reader_t r;
+    if (prime_reader_open(&r, path) != 0) {
+        fprintf(stderr, "Cannot read %s as a prime file.\n", path);
+        return 1;
+    }
+    if (info) {
+        print_info(path, &r);
+        prime_reader_close(&r);
+        mpz_clear(value);
+        return 0;
+    }
+
+    uint64_t k = from - 1;
+    if (have_value && prime_reader_find(&r, value, &k) != 0) {
+        fprintf(stderr, "Corrupt block in %s.\n", path);
+        prime_reader_close(&r);
+        return 1;
+    }
+
+    static char out_buf[1 << 16];
+    setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+    if (csv) printf("n,prime,is_mersenne\n");
+    int status = 0;
+    if (count && k < r.count) {
+        prime_cursor_t c;
+        prime_cursor_init(&c, &r);
+        int more = prime_cursor_seek(&c, k) == 0 ? 1 : -1;
+        for (unsigned long long i = 0; more == 1 && i < count; i++) {
+            if (csv) printf("%llu,", (unsigned long long)c.k + 1);
+            mpz_out_str(stdout, 10, c.cur);
+            if (csv) {
+                int mers = mpz_cmp_ui(c.cur, 3) >= 0 &&
+                           mpz_popcount(c.cur) == mpz_sizeinbase(c.cur, 2);
+                printf(",%d", mers);
+            }
+            putchar('\n');
+            if (i + 1 < count) more = prime_cursor_next(&c);
+        }
+        if (more < 0) {
+            fprintf(stderr, "Corrupt block in %s.\n", path);
+            status = 1;
+        }
+        prime_cursor_clear(&c);
+    }
+    fflush(stdout);
+    prime_reader_close(&r);
+    mpz_clear(value);
+    return status;
+}
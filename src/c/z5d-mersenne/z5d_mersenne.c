@@ -9,15 +9,18 @@
  * - High-precision arithmetic (configurable MPFR precision)
  * - Wave-ratio scanning with R = window/step invariant
  * - Self-tuning algorithm to lock onto resonance valleys
- * - Wheel-based coprime offset scanning (mod 210)
+ * - Wheel-based coprime offset scanning (any primorial modulus, tables built at startup)
+ * - Bitmap presieve of the scan window, survivors tested in parallel (OpenMP)
  * - JSON telemetry output for scientific analysis
  * - Miller-Rabin primality testing with configurable rounds
+ * - Lucas-Lehmer test of 2^p - 1 (--lucas-lehmer), resumable from a checkpoint
  *
  * Build: see Makefile in this folder (Apple Silicon / Homebrew MPFR+GMP)
  *
  * Usage Examples:
  *   ./z5d_mersenne 1e100 --prec=4096 --scan --window=4200 --step=18
  *   ./z5d_mersenne 1e100 --auto-tune --target=1 --wheel=210 --json
+ *   ./z5d_mersenne 216091 --lucas-lehmer --threads=4 --checkpoint=m216091.ck
  *
  * @author Unified Framework Team
  * @version 1.0 (Wave-Knob Initial Implementation)
@@ -35,6 +38,12 @@
 #include <math.h>
 #include <time.h>
 #include <getopt.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include <mpfr.h>
 #include <gmp.h>
 #include "z5d_predictor.h"
@@ -46,12 +55,16 @@
 #define DEFAULT_STEP 2
 #define DEFAULT_MAX_ITERS 100
 #define DEFAULT_WHEEL 210
+#define MAX_WHEEL_MODULUS 9699690UL   // 19#, 1658880 residues
+#define PRESIEVE_LIMIT 65536          // window presieve primes below this
+#define SCAN_CHUNK 64                 // survivors tested per parallel round
+#define MEMO_MAX_OFFSET (1UL << 24)   // auto-tune memo covers |k| below this
 
 // Wave-knob scanning configuration
 typedef struct {
     unsigned long window;        // aperture around prediction
     unsigned long step;          // scanning increment
-    unsigned long wheel_mod;     // coprime wheel modulus (30, 210, 2310)
+    unsigned long wheel_mod;     // coprime wheel modulus (30, 210, 2310, ...)
     unsigned long max_iters;     // max adjustment iterations
     unsigned int target_count;   // target prime count (usually 1)
     unsigned int mr_rounds;      // Miller-Rabin test rounds
@@ -59,6 +72,10 @@ typedef struct {
     int auto_tune;              // enable self-tuning mode
     int json_output;            // JSON telemetry output
     int verbose;                // verbose output
+    int threads;                // test threads (0 = OpenMP default)
+    int window_set;             // --window given: auto-tune starts there
+    int lucas_lehmer;           // k is an exponent p: test 2^p - 1 instead of scanning
+    char *checkpoint_file;      // Lucas-Lehmer checkpoint (resumed if present)
     char *output_file;          // output file path
 } wave_config_t;
 
@@ -68,9 +85,11 @@ typedef struct {
     unsigned long window;        // final window used
     unsigned long step;          // final step used
     double ratio;               // R = window/step
+    unsigned long seed_window;   // auto-tune starting window
     unsigned int prime_count;    // number of primes found
     unsigned int iterations;     // tuning iterations needed
     unsigned long mr_calls;      // total Miller-Rabin calls
+    unsigned long memo_hits;     // auto-tune positions answered from earlier iterations
     double elapsed_ms;          // elapsed time in milliseconds
     mpz_t prime_found;          // the prime found (if count=1)
     int locked;                 // 1 if successfully locked to target
@@ -80,23 +99,26 @@ typedef struct {
 // Wheel definitions for coprime scanning
 typedef struct {
     unsigned long modulus;
-    unsigned long *offsets;
+    unsigned long *offsets;     // residues coprime to modulus, ascending
     size_t count;
 } wheel_t;
 
-// Pre-computed wheel offsets (coprime residues)
-static unsigned long wheel_30[] = {1, 7, 11, 13, 17, 19, 23, 29};
-static unsigned long wheel_210[] = {
-    1, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97,
-    101, 103, 107, 109, 113, 121, 127, 131, 137, 139, 143, 149, 151, 157, 163, 167, 169,
-    173, 179, 181, 187, 191, 193, 197, 199, 209
-};
+// Wheel of the selected modulus, generated by get_wheel
+static wheel_t g_wheel = {0, NULL, 0};
 
-static wheel_t wheels[] = {
-    {30, wheel_30, sizeof(wheel_30)/sizeof(wheel_30[0])},
-    {210, wheel_210, sizeof(wheel_210)/sizeof(wheel_210[0])},
-    {0, NULL, 0} // sentinel
-};
+// Presieve primes below PRESIEVE_LIMIT
+static unsigned int *g_sieve_primes = NULL;
+static size_t g_sieve_count = 0;
+
+// Results of one auto-tune run, keyed by the signed offset k of a candidate
+// center + k*modulus. The center is fixed for the run, so a position seen
+// at one (window, step) is not tested again at the next.
+typedef struct {
+    uint64_t *tested[2];        // [0]: k >= 0, [1]: k < 0; bit |k|
+    uint64_t *prime[2];
+    size_t words[2];
+    unsigned long hits;
+} scan_memo_t;
 
 // Global statistics
 static unsigned long g_total_mr_calls = 0;
@@ -111,15 +133,17 @@ static void cleanup_wave_config(wave_config_t *config);
 static void init_wave_result(wave_result_t *result);
 static void cleanup_wave_result(wave_result_t *result);
 static wheel_t *get_wheel(unsigned long modulus);
-static int miller_rabin_test(const mpz_t n, unsigned int rounds);
+static void free_wheel(void);
+static int init_sieve_primes(void);
 static int scan_prime_count(const mpfr_t prediction, unsigned long window, unsigned long step, 
                           wheel_t *wheel, unsigned int mr_rounds, mpz_t *found_primes, 
-                          unsigned int max_primes);
+                          unsigned int max_primes, scan_memo_t *memo);
 static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_result_t *result);
 static int manual_scan(const mpfr_t prediction, wave_config_t *config, wave_result_t *result);
 static void output_json_result(const wave_result_t *result, FILE *fp);
 static void output_human_result(const wave_result_t *result, const wave_config_t *config);
 static double compute_z5d_prediction_mpfr(const mpfr_t k, mpfr_t result, mpfr_prec_t prec);
+static int run_lucas_lehmer(const char *p_string, const wave_config_t *config);
 
 int main(int argc, char **argv) {
     wave_config_t config;
@@ -141,6 +165,13 @@ int main(int argc, char **argv) {
         cleanup_wave_config(&config);
         return (parse_ret > 0) ? 0 : 1;
     }
+
+    if (config.lucas_lehmer) {
+        ret = run_lucas_lehmer(argv[1], &config);
+        cleanup_wave_config(&config);
+        free_wheel();
+        return ret;
+    }
     
     // Now initialize MPFR with correct precision
     mpfr_init2(k_input, config.precision);
@@ -157,6 +188,17 @@ int main(int argc, char **argv) {
     // Initialize result structure
     init_wave_result(&result);
     result_inited = 1;
+
+    if (init_sieve_primes() != 0) {
+        fprintf(stderr, "Error: out of memory\n");
+        ret = 1;
+        goto cleanup;
+    }
+#ifdef _OPENMP
+    if (config.threads > 0) {
+        omp_set_num_threads(config.threads);
+    }
+#endif
     
     if (config.verbose) {
         printf("Wave-Knob Prime Scanner v%s\n", VERSION);
@@ -204,6 +246,8 @@ int main(int argc, char **argv) {
     
 cleanup:
     cleanup_wave_config(&config);
+    free_wheel();
+    free(g_sieve_primes);
     if (result_inited) {
         cleanup_wave_result(&result);
     }
@@ -231,12 +275,18 @@ static void print_usage(const char *prog_name) {
     printf("  --window=N            Search window size (default: %d)\n", DEFAULT_WINDOW);
     printf("  --step=N              Scanning step size (default: %d)\n", DEFAULT_STEP);
     printf("  --target=N            Target prime count (default: 1)\n");
-    printf("  --wheel=N             Coprime wheel modulus: 30, 210 (default: %d)\n", DEFAULT_WHEEL);
+    printf("  --wheel=N             Primorial wheel modulus: 30, 210, 2310, ... 9699690 (default: %d)\n", DEFAULT_WHEEL);
     printf("  --max-iters=N         Max tuning iterations (default: %d)\n", DEFAULT_MAX_ITERS);
+
+    printf("\nMersenne options:\n");
+    printf("  --lucas-lehmer        Treat k as an exponent p and test 2^p - 1\n");
+    printf("  --checkpoint=FILE     Save Lucas-Lehmer progress to FILE, resuming it if present\n");
     
     printf("\nPrecision options:\n");
     printf("  --prec=N              MPFR precision in bits (default: %d)\n", DEFAULT_PRECISION);
     printf("  --mr-rounds=N         Miller-Rabin test rounds (default: %d)\n", DEFAULT_MR_ROUNDS);
+    printf("  --threads=N           Threads testing presieve survivors or running the\n");
+    printf("                        Lucas-Lehmer FFT (default: all cores)\n");
     
     printf("\nOutput options:\n");
     printf("  --json                Output results in JSON format\n");
@@ -249,6 +299,7 @@ static void print_usage(const char *prog_name) {
     printf("  %s 1e100 --prec=6144 --scan --window=4200 --step=18\n", prog_name);
     printf("  %s 1e100 --auto-tune --target=1 --wheel=210 --json\n", prog_name);
     printf("  %s 1e300 --prec=8192 --auto-tune --max-iters=200 --verbose\n", prog_name);
+    printf("  %s 216091 --lucas-lehmer --threads=4 --checkpoint=m216091.ck\n", prog_name);
 }
 
 static void print_version(void) {
@@ -269,6 +320,10 @@ static void init_wave_config(wave_config_t *config) {
     config->auto_tune = 1; // default to auto-tune
     config->json_output = 0;
     config->verbose = 0;
+    config->threads = 0;
+    config->window_set = 0;
+    config->lucas_lehmer = 0;
+    config->checkpoint_file = NULL;
     config->output_file = NULL;
 }
 
@@ -277,6 +332,10 @@ static void cleanup_wave_config(wave_config_t *config) {
         free(config->output_file);
         config->output_file = NULL;
     }
+    if (config->checkpoint_file) {
+        free(config->checkpoint_file);
+        config->checkpoint_file = NULL;
+    }
 }
 
 static void init_wave_result(wave_result_t *result) {
@@ -288,6 +347,8 @@ static void init_wave_result(wave_result_t *result) {
     result->prime_count = 0;
     result->iterations = 0;
     result->mr_calls = 0;
+    result->memo_hits = 0;
+    result->seed_window = 0;
     result->elapsed_ms = 0.0;
     result->locked = 0;
     strcpy(result->wheel_residue, "none");
@@ -310,6 +371,9 @@ static int parse_arguments(int argc, char **argv, wave_config_t *config, mpfr_t
         {"max-iters", required_argument, 0, 'i'},
         {"prec", required_argument, 0, 'p'},
         {"mr-rounds", required_argument, 0, 'm'},
+        {"threads", required_argument, 0, 'n'},
+        {"lucas-lehmer", no_argument, 0, 'L'},
+        {"checkpoint", required_argument, 0, 'c'},
         {"json", no_argument, 0, 'j'},
         {"output", required_argument, 0, 'o'},
         {"verbose", no_argument, 0, 'v'},
@@ -344,7 +408,7 @@ static int parse_arguments(int argc, char **argv, wave_config_t *config, mpfr_t
     optind = 2;  // Skip program name and k value
     
     // Parse options first to get precision
-    while ((c = getopt_long(argc, argv, "saw:t:T:W:i:p:m:jo:vhV", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "saw:t:T:W:i:p:m:n:Lc:jo:vhV", long_options, &option_index)) != -1) {
         switch (c) {
             case 's':
                 config->auto_tune = 0;
@@ -354,6 +418,7 @@ static int parse_arguments(int argc, char **argv, wave_config_t *config, mpfr_t
                 break;
             case 'w':
                 config->window = strtoul(optarg, NULL, 10);
+                config->window_set = 1;
                 break;
             case 't':
                 config->step = strtoul(optarg, NULL, 10);
@@ -373,6 +438,16 @@ static int parse_arguments(int argc, char **argv, wave_config_t *config, mpfr_t
             case 'm':
                 config->mr_rounds = strtoul(optarg, NULL, 10);
                 break;
+            case 'n':
+                config->threads = (int)strtol(optarg, NULL, 10);
+                break;
+            case 'L':
+                config->lucas_lehmer = 1;
+                break;
+            case 'c':
+                free(config->checkpoint_file);
+                config->checkpoint_file = strdup(optarg);
+                break;
             case 'j':
                 config->json_output = 1;
                 break;
@@ -423,6 +498,11 @@ static int parse_arguments(int argc, char **argv, wave_config_t *config, mpfr_t
         return -1;
     }
     
+    if (config->threads < 0) {
+        fprintf(stderr, "Error: threads must be >= 0\n");
+        return -1;
+    }
+
     if (config->precision < 64 || config->precision > 131072) {
         fprintf(stderr, "Error: precision must be between 64 and 131072 bits\n");
         return -1;
@@ -431,20 +511,107 @@ static int parse_arguments(int argc, char **argv, wave_config_t *config, mpfr_t
     // Validate wheel modulus
     wheel_t *wheel = get_wheel(config->wheel_mod);
     if (!wheel) {
-        fprintf(stderr, "Error: unsupported wheel modulus %lu (supported: 30, 210)\n", config->wheel_mod);
+        fprintf(stderr, "Error: unsupported wheel modulus %lu (primorials 30 .. %lu)\n",
+                config->wheel_mod, MAX_WHEEL_MODULUS);
         return -1;
     }
     
     return 0;
 }
 
+// Monotonic wall clock; scans run on several threads, so clock() would sum them
+static double wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1.0e6;
+}
+
+// Largest prime factor of a primorial modulus 2*3*5*..., 0 if modulus is not
+// one in [30, MAX_WHEEL_MODULUS]
+static unsigned long primorial_top(unsigned long modulus) {
+    static const unsigned long small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19};
+    unsigned long prod = 1;
+    for (size_t i = 0; i < sizeof(small_primes) / sizeof(small_primes[0]); i++) {
+        prod *= small_primes[i];
+        if (prod == modulus) return (prod >= 30) ? small_primes[i] : 0;
+        if (prod > modulus) break;
+    }
+    return 0;
+}
+
+// Wheel for a primorial modulus; the residue table is generated on first use
 static wheel_t *get_wheel(unsigned long modulus) {
-    for (int i = 0; wheels[i].modulus != 0; i++) {
-        if (wheels[i].modulus == modulus) {
-            return &wheels[i];
+    if (g_wheel.modulus == modulus) {
+        return &g_wheel;
+    }
+    unsigned long top = primorial_top(modulus);
+    if (top == 0) {
+        return NULL;
+    }
+
+    unsigned char *divisible = calloc(modulus, 1);
+    if (!divisible) {
+        return NULL;
+    }
+    size_t count = 0;
+    for (unsigned long p = 2; p <= top; p++) {
+        if (divisible[p]) continue;   // composite, a multiple of a smaller prime
+        for (unsigned long m = p; m < modulus; m += p) {
+            divisible[m] = 1;
+        }
+    }
+    divisible[0] = 1;
+    for (unsigned long r = 1; r < modulus; r++) {
+        if (!divisible[r]) count++;
+    }
+    unsigned long *offsets = malloc(count * sizeof(unsigned long));
+    if (!offsets) {
+        free(divisible);
+        return NULL;
+    }
+    count = 0;
+    for (unsigned long r = 1; r < modulus; r++) {
+        if (!divisible[r]) offsets[count++] = r;
+    }
+    free(divisible);
+
+    free_wheel();
+    g_wheel.modulus = modulus;
+    g_wheel.offsets = offsets;
+    g_wheel.count = count;
+    return &g_wheel;
+}
+
+static void free_wheel(void) {
+    free(g_wheel.offsets);
+    g_wheel.modulus = 0;
+    g_wheel.offsets = NULL;
+    g_wheel.count = 0;
+}
+
+// Primes below PRESIEVE_LIMIT for the window presieve
+static int init_sieve_primes(void) {
+    if (g_sieve_primes) {
+        return 0;
+    }
+    unsigned char *composite = calloc(PRESIEVE_LIMIT, 1);
+    g_sieve_primes = malloc(PRESIEVE_LIMIT / 2 * sizeof(unsigned int));
+    if (!composite || !g_sieve_primes) {
+        free(composite);
+        free(g_sieve_primes);
+        g_sieve_primes = NULL;
+        return -1;
+    }
+    g_sieve_count = 0;
+    for (unsigned int p = 2; p < PRESIEVE_LIMIT; p++) {
+        if (composite[p]) continue;
+        g_sieve_primes[g_sieve_count++] = p;
+        for (unsigned long m = (unsigned long)p * p; m < PRESIEVE_LIMIT; m += p) {
+            composite[m] = 1;
         }
     }
-    return NULL;
+    free(composite);
+    return 0;
 }
 
 // Placeholder implementations - will implement the core scanning logic next
@@ -488,86 +655,259 @@ static double compute_z5d_prediction_mpfr(const mpfr_t k, mpfr_t result, mpfr_pr
     return (double)(clock() - start) / CLOCKS_PER_SEC;
 }
 
-static int miller_rabin_test(const mpz_t n, unsigned int rounds) {
-    g_total_mr_calls++;
-    return mpz_probab_prime_p(n, rounds);
+// Candidate at window position q: 0 is the center, then +1, -1, +2, -2, ...
+// steps of d
+static void position_value(mpz_t out, const mpz_t center, unsigned long d, size_t q) {
+    mpz_set_ui(out, d);
+    mpz_mul_ui(out, out, (unsigned long)((q + 1) / 2));
+    if (q % 2) {
+        mpz_add(out, center, out);
+    } else {
+        mpz_sub(out, center, out);
+    }
+}
+
+// Inverse of a mod p (p prime, a not divisible by p)
+static unsigned long inverse_mod(unsigned long a, unsigned long p) {
+    long t = 0, new_t = 1;
+    long r = (long)p, new_r = (long)(a % p);
+    while (new_r != 0) {
+        long q = r / new_r, tmp;
+        tmp = t - q * new_t; t = new_t; new_t = tmp;
+        tmp = r - q * new_r; r = new_r; new_r = tmp;
+    }
+    return (unsigned long)(t < 0 ? t + (long)p : t);
+}
+
+// Mark window positions divisible by a presieve prime. Positions j on
+// either side are center +/- j*d, so each prime hits one arithmetic
+// progression of j per side. Skipped when the window reaches down to the
+// presieve primes themselves.
+static void presieve_window(const mpz_t center, unsigned long window, unsigned long d,
+                            uint64_t *composite) {
+    mpz_t lowest;
+    mpz_init(lowest);
+    position_value(lowest, center, d, 2 * (size_t)window);
+    int small = mpz_cmp_ui(lowest, PRESIEVE_LIMIT) <= 0;
+    mpz_clear(lowest);
+    if (small || !g_sieve_primes) {
+        return;
+    }
+
+    const size_t positions = 2 * (size_t)window + 1;
+    for (size_t i = 0; i < g_sieve_count; i++) {
+        unsigned long p = g_sieve_primes[i];
+        unsigned long r = mpz_fdiv_ui(center, p);
+        unsigned long dm = d % p;
+        if (dm == 0) {
+            // Every position is congruent to the center; wheel primes land here with r != 0
+            if (r == 0) {
+                for (size_t q = 0; q < positions; q++) composite[q / 64] |= 1ULL << (q % 64);
+            }
+            continue;
+        }
+        unsigned long inv = inverse_mod(dm, p);
+        unsigned long fwd = (p - r) % p * inv % p;   // center + j*d == 0 mod p
+        unsigned long bwd = r * inv % p;             // center - j*d == 0 mod p
+        for (unsigned long j = fwd; j <= window; j += p) {
+            size_t q = j ? 2 * (size_t)j - 1 : 0;
+            composite[q / 64] |= 1ULL << (q % 64);
+        }
+        for (unsigned long j = bwd; j <= window; j += p) {
+            size_t q = 2 * (size_t)j;
+            composite[q / 64] |= 1ULL << (q % 64);
+        }
+    }
+}
+
+// Probable-prime flags for the candidates at the given positions, on all threads
+static void test_positions(const mpz_t center, unsigned long d, const size_t *order, size_t len,
+                           unsigned int mr_rounds, unsigned char *is_prime) {
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        mpz_t candidate;
+        mpz_init(candidate);
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 1)
+#endif
+        for (size_t i = 0; i < len; i++) {
+            position_value(candidate, center, d, order[i]);
+            is_prime[i] = mpz_cmp_ui(candidate, 3) > 0 &&
+                          mpz_probab_prime_p(candidate, (int)mr_rounds) >= 1;
+        }
+        mpz_clear(candidate);
+    }
 }
 
+static void memo_init(scan_memo_t *memo) {
+    memset(memo, 0, sizeof(*memo));
+}
+
+static void memo_clear(scan_memo_t *memo) {
+    for (int side = 0; side < 2; side++) {
+        free(memo->tested[side]);
+        free(memo->prime[side]);
+    }
+    memo_init(memo);
+}
+
+// Side and |k| of window position q at the given step; 0 if not memoized
+static int memo_key(size_t q, unsigned long step, int *side, unsigned long *k) {
+    unsigned long j = (unsigned long)((q + 1) / 2);
+    if (j > (MEMO_MAX_OFFSET - 1) / step) return 0;
+    *side = (q % 2 || q == 0) ? 0 : 1;
+    *k = j * step;
+    return 1;
+}
+
+// 1 prime, 0 composite, -1 not tested yet
+static int memo_lookup(scan_memo_t *memo, size_t q, unsigned long step) {
+    int side;
+    unsigned long k;
+    if (!memo || !memo_key(q, step, &side, &k) || k / 64 >= memo->words[side]) return -1;
+    if (!(memo->tested[side][k / 64] & (1ULL << (k % 64)))) return -1;
+    memo->hits++;
+    return (memo->prime[side][k / 64] >> (k % 64)) & 1;
+}
+
+static void memo_store(scan_memo_t *memo, size_t q, unsigned long step, int is_prime) {
+    int side;
+    unsigned long k;
+    if (!memo || !memo_key(q, step, &side, &k)) return;
+    if (k / 64 >= memo->words[side]) {
+        size_t words = memo->words[side] ? memo->words[side] : 64;
+        while (words <= k / 64) words *= 2;
+        uint64_t *tested = realloc(memo->tested[side], words * sizeof(uint64_t));
+        if (!tested) return;
+        memo->tested[side] = tested;
+        uint64_t *prime = realloc(memo->prime[side], words * sizeof(uint64_t));
+        if (!prime) return;   // tested[] grew but words did not: still consistent
+        memo->prime[side] = prime;
+        memset(tested + memo->words[side], 0, (words - memo->words[side]) * sizeof(uint64_t));
+        memset(prime + memo->words[side], 0, (words - memo->words[side]) * sizeof(uint64_t));
+        memo->words[side] = words;
+    }
+    memo->tested[side][k / 64] |= 1ULL << (k % 64);
+    if (is_prime) memo->prime[side][k / 64] |= 1ULL << (k % 64);
+}
+
+// Count primes among center +/- j*step*modulus, j = 0..window, where center is
+// the prediction moved up to the next residue coprime to the wheel. The
+// window is presieved as a bitmap, then survivors are tested SCAN_CHUNK at a
+// time in parallel and collected in position order (0, +1, -1, ...) up to
+// max_primes, so the result depends on the arguments alone. Positions found
+// in memo (if given) are not tested again; new results are added to it.
 static int scan_prime_count(const mpfr_t prediction, unsigned long window, unsigned long step,
                           wheel_t *wheel, unsigned int mr_rounds, mpz_t *found_primes,
-                          unsigned int max_primes) {
-    mpz_t center, candidate;
-    unsigned int count = 0;
-    static unsigned int wheel_index = 0; // cycle through wheel offsets
-    
+                          unsigned int max_primes, scan_memo_t *memo) {
+    if (step > ULONG_MAX / wheel->modulus || window >= SIZE_MAX / (2 * sizeof(size_t))) {
+        return 0;
+    }
+    const unsigned long d = step * wheel->modulus;
+    const size_t positions = 2 * (size_t)window + 1;
+    uint64_t *composite = calloc((positions + 63) / 64, sizeof(uint64_t));
+    size_t *order = malloc(positions * sizeof(size_t));
+    unsigned char is_prime[SCAN_CHUNK], tested[SCAN_CHUNK];
+    size_t pending[SCAN_CHUNK], pending_slot[SCAN_CHUNK];
+    if (!composite || !order) {
+        free(composite);
+        free(order);
+        return 0;
+    }
+
+    mpz_t center;
     mpz_init(center);
-    mpz_init(candidate);
-    
-    // Convert prediction to integer center
     mpfr_get_z(center, prediction, MPFR_RNDN);
-    
-    // Use one wheel offset at a time (cycle through them)
-    unsigned long wheel_offset = wheel->offsets[wheel_index % wheel->count];
-    wheel_index++;
-    
-    // Adjust center to be congruent to wheel offset
+
+    // Smallest coprime residue >= center mod modulus (wrapping to the next block)
     unsigned long remainder = mpz_fdiv_ui(center, wheel->modulus);
-    if (remainder != wheel_offset) {
-        long adjust = (long)wheel_offset - (long)remainder;
-        if (adjust < 0) {
-            adjust += wheel->modulus;
-        }
-        mpz_add_ui(center, center, adjust);
-    }
-    
-    // Search in window around the adjusted center with given step
-    for (unsigned long offset = 0; offset <= window && count < max_primes; offset += step) {
-        // Forward direction
-        if (offset == 0 || count < max_primes) {
-            mpz_set(candidate, center);
-            if (offset > 0) mpz_add_ui(candidate, candidate, offset * wheel->modulus);
-            
-            if (mpz_cmp_ui(candidate, 3) > 0 && miller_rabin_test(candidate, mr_rounds) >= 1) {
-                if (found_primes) {
-                    mpz_set(found_primes[count], candidate);
-                }
-                count++;
+    size_t lo = 0, hi = wheel->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (wheel->offsets[mid] < remainder) lo = mid + 1; else hi = mid;
+    }
+    unsigned long target = (lo < wheel->count) ? wheel->offsets[lo]
+                                               : wheel->offsets[0] + wheel->modulus;
+    mpz_add_ui(center, center, target - remainder);
+
+    presieve_window(center, window, d, composite);
+    size_t survivors = 0;
+    for (size_t q = 0; q < positions; q++) {
+        if (!(composite[q / 64] & (1ULL << (q % 64)))) order[survivors++] = q;
+    }
+
+    unsigned int count = 0;
+    for (size_t base = 0; base < survivors && count < max_primes; base += SCAN_CHUNK) {
+        size_t len = survivors - base < SCAN_CHUNK ? survivors - base : SCAN_CHUNK;
+        size_t npending = 0;
+        for (size_t i = 0; i < len; i++) {
+            int known = memo_lookup(memo, order[base + i], step);
+            if (known < 0) {
+                pending_slot[npending] = i;
+                pending[npending++] = order[base + i];
+            } else {
+                is_prime[i] = (unsigned char)known;
             }
         }
-        
-        // Backward direction (if offset > 0)
-        if (offset > 0 && count < max_primes) {
-            mpz_set(candidate, center);
-            mpz_sub_ui(candidate, candidate, offset * wheel->modulus);
-            
-            if (mpz_cmp_ui(candidate, 3) > 0 && miller_rabin_test(candidate, mr_rounds) >= 1) {
-                if (found_primes) {
-                    mpz_set(found_primes[count], candidate);
-                }
-                count++;
+        test_positions(center, d, pending, npending, mr_rounds, tested);
+        g_total_mr_calls += npending;
+        for (size_t t = 0; t < npending; t++) {
+            is_prime[pending_slot[t]] = tested[t];
+            memo_store(memo, pending[t], step, tested[t]);
+        }
+        for (size_t i = 0; i < len && count < max_primes; i++) {
+            if (!is_prime[i]) continue;
+            if (found_primes) {
+                position_value(found_primes[count], center, d, order[base + i]);
             }
+            count++;
         }
     }
-    
+
     mpz_clear(center);
-    mpz_clear(candidate);
-    
+    free(composite);
+    free(order);
+
     return count;
 }
 
+// Window whose 2*window+1 positions hold target primes on average. The
+// prediction carries no error bound, so the seed comes from the prime
+// density of a coprime residue class there: modulus / (phi(modulus) * ln c).
+static unsigned long seed_window(const mpfr_t prediction, const wheel_t *wheel,
+                                 unsigned int target) {
+    mpfr_t log_c;
+    mpfr_init2(log_c, 64);
+    mpfr_log(log_c, prediction, MPFR_RNDN);
+    double ln_c = mpfr_get_d(log_c, MPFR_RNDN);
+    mpfr_clear(log_c);
+    if (!(ln_c > 1.0)) ln_c = 1.0;
+
+    double positions = (double)(target ? target : 1) * (double)wheel->count * ln_c /
+                       (double)wheel->modulus;
+    double window = ceil((positions - 1.0) / 2.0);
+    return window < 1.0 ? 1 : (unsigned long)window;
+}
+
 static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_result_t *result) {
-    clock_t start = clock();
+    double start = wall_ms();
     wheel_t *wheel = get_wheel(config->wheel_mod);
     
     if (!wheel) {
         return -1;
     }
     
-    // TODO[2025-11-21]: Seed window/step from z5d error: window = clamp(ceil(c*error), min,max), adjust step accordingly; keep R invariant.
-    unsigned long window = config->window;
+    unsigned long window = config->window_set ? config->window
+                                              : seed_window(prediction, wheel, config->target_count);
     unsigned long step = config->step;
     unsigned int iteration = 0;
     int found_target = 0;
+    unsigned long below = 0, above = 0;   // windows with fewer / more primes at this step
+    scan_memo_t memo;
+    memo_init(&memo);
+    result->seed_window = window;
     
     mpz_t *candidates = malloc(sizeof(mpz_t) * 10); // up to 10 candidates
     for (int i = 0; i < 10; i++) {
@@ -575,13 +915,14 @@ static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_r
     }
     
     if (config->verbose) {
-        printf("\nStarting auto-tune scan (target count: %u):\n", config->target_count);
+        printf("\nStarting auto-tune scan (target count: %u, window %lu%s):\n",
+               config->target_count, window, config->window_set ? "" : " from density");
     }
     
     // Self-tuning loop
     while (iteration < config->max_iters && !found_target) {
         unsigned int count = scan_prime_count(prediction, window, step, wheel, 
-                                            config->mr_rounds, candidates, 10);
+                                            config->mr_rounds, candidates, 10, &memo);
         
         if (config->verbose) {
             printf("Iter %u: window=%lu, step=%lu, R=%.3f, count=%u\n", 
@@ -596,12 +937,30 @@ static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_r
                 mpz_set(result->prime_found, candidates[0]);
             }
             break;
-        } else if (count == 0) {
+        }
+
+        // Once both sides of the target are seen at this step, bisect the
+        // window instead of bouncing between them; the memo makes it cheap
+        if (count < config->target_count) {
+            below = window;
+        } else {
+            above = window;
+        }
+        if (below && above) {
+            if (above - below > 1) {
+                window = below + (above - below) / 2;
+            } else {
+                // Count jumps past the target between adjacent windows: new progression
+                step++;
+                below = above = 0;
+            }
+        } else if (count < config->target_count) {
             // No primes found - increase R (expand window first)
             if (window < 10000) {
-                window = window * 3 / 2; // grow window by 50%
+                window = (window > 1) ? window * 3 / 2 : 2; // grow window by 50%
             } else {
                 step = (step > 1) ? step - 1 : 1; // reduce step if large window
+                below = above = 0;
             }
         } else if (count > config->target_count) {
             // Too many primes - decrease R (shrink window or increase step)
@@ -609,6 +968,7 @@ static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_r
                 window = window * 2 / 3; // shrink window by 33%
             } else {
                 step++; // increase step
+                below = above = 0;
             }
         }
         
@@ -622,6 +982,8 @@ static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_r
     result->iterations = iteration;
     result->locked = found_target;
     result->mr_calls = g_total_mr_calls;
+    result->memo_hits = memo.hits;
+    memo_clear(&memo);
     
     snprintf(result->wheel_residue, sizeof(result->wheel_residue), "mod_%lu", wheel->modulus);
     
@@ -630,7 +992,7 @@ static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_r
     }
     free(candidates);
     
-    result->elapsed_ms = ((double)(clock() - start) / CLOCKS_PER_SEC) * 1000.0;
+    result->elapsed_ms = wall_ms() - start;
     
     if (config->verbose) {
         if (found_target) {
@@ -644,7 +1006,7 @@ static int auto_tune_scan(const mpfr_t prediction, wave_config_t *config, wave_r
 }
 
 static int manual_scan(const mpfr_t prediction, wave_config_t *config, wave_result_t *result) {
-    clock_t start = clock();
+    double start = wall_ms();
     wheel_t *wheel = get_wheel(config->wheel_mod);
     
     if (!wheel) {
@@ -658,7 +1020,7 @@ static int manual_scan(const mpfr_t prediction, wave_config_t *config, wave_resu
     
     // Single scan with fixed parameters
     unsigned int count = scan_prime_count(prediction, config->window, config->step, 
-                                        wheel, config->mr_rounds, candidates, 10);
+                                        wheel, config->mr_rounds, candidates, 10, NULL);
     
     // Record results
     result->window = config->window;
@@ -680,7 +1042,7 @@ static int manual_scan(const mpfr_t prediction, wave_config_t *config, wave_resu
     }
     free(candidates);
     
-    result->elapsed_ms = ((double)(clock() - start) / CLOCKS_PER_SEC) * 1000.0;
+    result->elapsed_ms = wall_ms() - start;
     
     if (config->verbose) {
         printf("Manual scan: found %u primes with R=%.6f\n", count, result->ratio);
@@ -699,6 +1061,8 @@ static void output_json_result(const wave_result_t *result, FILE *fp) {
     fprintf(fp, "  \"iterations\": %u,\n", result->iterations);
     // TODO[2025-11-21]: Include z5d telemetry fields: z5d_iterations, z5d_converged, z5d_error, z5d_K, z5d_precision.
     fprintf(fp, "  \"mr_calls\": %lu,\n", result->mr_calls);
+    fprintf(fp, "  \"memo_hits\": %lu,\n", result->memo_hits);
+    fprintf(fp, "  \"seed_window\": %lu,\n", result->seed_window);
     fprintf(fp, "  \"elapsed_ms\": %.3f,\n", result->elapsed_ms);
     fprintf(fp, "  \"locked\": %s,\n", result->locked ? "true" : "false");
     fprintf(fp, "  \"wheel_residue\": \"%s\",\n", result->wheel_residue);
@@ -719,7 +1083,7 @@ static void output_human_result(const wave_result_t *result, const wave_config_t
     printf("Prime count: %u\n", result->prime_count);
     printf("Tuning iterations: %u\n", result->iterations);
     // TODO[2025-11-21]: Print z5d predictor telemetry (converged?, iterations, error estimate, K, precision) before scanning stats.
-    printf("Miller-Rabin calls: %lu\n", result->mr_calls);
+    printf("Miller-Rabin calls: %lu (memo hits: %lu)\n", result->mr_calls, result->memo_hits);
     printf("Elapsed time: %.3f ms\n", result->elapsed_ms);
     printf("Status: %s\n", result->locked ? "LOCKED" : "FAILED");
     
@@ -727,3 +1091,71 @@ static void output_human_result(const wave_result_t *result, const wave_config_t
         printf("Prime found: %s\n", mpz_get_str(NULL, 10, result->prime_found));
     }
 }
+
+// Lucas-Lehmer mode: k is the exponent. Returns the process exit code.
+static int run_lucas_lehmer(const char *p_string, const wave_config_t *config) {
+    char *end = NULL;
+    unsigned long long p = strtoull(p_string, &end, 10);
+    if (!end || *end != '\0' || p < 2 || p > Z5D_LL_MAX_P) {
+        fprintf(stderr, "Error: --lucas-lehmer needs an exponent 2 .. %llu, got '%s'\n",
+                (unsigned long long)Z5D_LL_MAX_P, p_string);
+        return 1;
+    }
+
+    z5d_ll_config_t ll;
+    z5d_ll_config_init(&ll);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    ll.threads = config->threads > 0 ? (unsigned int)config->threads
+                                     : (unsigned int)(cores > 0 ? cores : 1);
+    ll.checkpoint_path = config->checkpoint_file;
+
+    if (config->verbose) {
+        printf("Lucas-Lehmer test of 2^%llu - 1 (%u threads%s%s)\n", p, ll.threads,
+               ll.checkpoint_path ? ", checkpoint " : "",
+               ll.checkpoint_path ? ll.checkpoint_path : "");
+    }
+
+    z5d_ll_stats_t st;
+    double t0 = wall_ms();
+    int r = z5d_lucas_lehmer(p, &ll, &st);
+    double elapsed = wall_ms() - t0;
+    if (r < 0) {
+        fprintf(stderr, "Error: Lucas-Lehmer failed (out of memory, or checkpoint %s unusable)\n",
+                ll.checkpoint_path ? ll.checkpoint_path : "-");
+        return 1;
+    }
+
+    const char *engine = st.engine == Z5D_LL_FFT ? "fft" : "gmp";
+    if (config->json_output) {
+        FILE *fp = config->output_file ? fopen(config->output_file, "w") : stdout;
+        if (!fp) return 1;
+        fprintf(fp, "{\n");
+        fprintf(fp, "  \"p\": %llu,\n", p);
+        fprintf(fp, "  \"mersenne_prime\": %s,\n", r == Z5D_LL_PRIME ? "true" : "false");
+        fprintf(fp, "  \"engine\": \"%s\",\n", engine);
+        fprintf(fp, "  \"fft_length\": %zu,\n", st.fft_length);
+        fprintf(fp, "  \"fft_grows\": %u,\n", st.fft_grows);
+        fprintf(fp, "  \"max_roundoff\": %.4f,\n", st.max_roundoff);
+        fprintf(fp, "  \"iterations\": %llu,\n", (unsigned long long)st.iterations);
+        fprintf(fp, "  \"resumed_at\": %llu,\n", (unsigned long long)st.resumed_at);
+        fprintf(fp, "  \"res64\": \"%016llx\",\n", (unsigned long long)st.res64);
+        fprintf(fp, "  \"elapsed_ms\": %.3f\n", elapsed);
+        fprintf(fp, "}\n");
+        if (fp != stdout) fclose(fp);
+    } else {
+        printf("\nLucas-Lehmer Results:\n");
+        printf("p = %llu\n", p);
+        printf("Engine: %s", engine);
+        if (st.engine == Z5D_LL_FFT) {
+            printf(" (length %zu, max roundoff %.4f, %u regrows)", st.fft_length,
+                   st.max_roundoff, st.fft_grows);
+        }
+        printf("\n");
+        if (st.resumed_at) printf("Resumed at iteration: %llu\n", (unsigned long long)st.resumed_at);
+        printf("Iterations: %llu\n", (unsigned long long)st.iterations);
+        printf("Residue (low 64 bits): %016llx\n", (unsigned long long)st.res64);
+        printf("Elapsed time: %.3f ms\n", elapsed);
+        printf("Status: 2^%llu - 1 is %s\n", p, r == Z5D_LL_PRIME ? "PRIME" : "composite");
+    }
+    return 0;
+}
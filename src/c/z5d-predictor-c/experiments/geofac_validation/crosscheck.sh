@@ -38,7 +38,7 @@ python3 "$TOOLS_DIR/run_geofac_peaks_mod.py" \
     --num-bins 100
 
 echo "=== Validating with Z5D Adapter ==="
-"$SCRIPT_DIR/z5d_adapter" < "$GEOFAC_OUT" > "$FINAL_OUT"
+"$SCRIPT_DIR/z5d_adapter" -i "$GEOFAC_OUT" -o "$FINAL_OUT"
 
 echo "=== Done ==="
 echo "Results saved to $FINAL_OUT"
@@ -1,117 +1,512 @@
+/**
+ * Z5D Geofac Adapter - Pipelined Peak Scorer
+ * ==========================================
+ *
+ * Scores the factors p and q of each Geofac peak (one JSON object per line)
+ * against the Z5D predictor: n = R(p) by the legacy 10-term Riemann sum,
+ * p' = Z5D(n), score = |p - p'|; the input line is echoed with
+ * z5d_score_p, z5d_n_est_p, z5d_score_q and z5d_n_est_q appended. Metadata
+ * lines and lines without p and q pass through unchanged.
+ *
+ * Three stages:
+ *   reader  maps a regular input file (zero copy) or reads stdin in large
+ *           blocks, and cuts it into chunks at line ends
+ *   workers one predictor context each; score every line of a chunk
+ *   writer  emits the scored chunks in input order
+ *
+ * At most ADAPTER_WINDOW chunks are in flight, so memory stays bounded
+ * however slow one chunk is. The output is byte-for-byte what the serial
+ * adapter printed.
+ *
+ * @file z5d_adapter.c
+ * @version 2.0
+ */
+
+#include "../../../include/z5d_predictor.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <gmp.h>
 #include <mpfr.h>
-#include "../../../include/z5d_predictor.h"
 
-// Simple JSON parsing helper to extract string values
-void extract_json_value(const char* json, const char* key, char* buffer, size_t max_len) {
-    char search_key[256];
-    sprintf(search_key, "\"%s\":", key);
-    char* pos = strstr(json, search_key);
-    if (!pos) {
-        // Try with space
-        sprintf(search_key, "\"%s\": ", key); 
-        pos = strstr(json, search_key);
-        if (!pos) {
-            buffer[0] = '\0';
-            return;
-        }
+#define ADAPTER_CHUNK (64 * 1024)     /* Input bytes per chunk (longer lines get their own) */
+#define ADAPTER_WINDOW 64             /* Chunks in flight */
+#define ADAPTER_MAX_DEPTH 64          /* JSON nesting the scanner follows */
+#define ADAPTER_R_TERMS 10            /* Terms of the legacy Riemann sum */
+
+typedef enum { SLOT_FREE, SLOT_PENDING, SLOT_BUSY, SLOT_DONE } slot_state_t;
+
+typedef struct {
+    char* data;
+    size_t len, cap;
+} buf_t;
+
+typedef struct {
+    slot_state_t state;
+    const char* in;          /* Chunk: whole lines, the last may lack its newline */
+    size_t in_len;
+    char* owned;             /* Read buffer behind in, or NULL inside the mapping */
+    buf_t out;               /* Scored lines */
+} slot_t;
+
+typedef struct {
+    int dps;
+    FILE* out;
+    slot_t slots[ADAPTER_WINDOW];
+    uint64_t next_read;      /* Chunks handed in by the reader */
+    uint64_t next_job;       /* Next chunk for a worker */
+    uint64_t next_emit;      /* Next chunk for the writer */
+    int eof;
+    int failed;              /* Out of memory or a write error */
+    pthread_mutex_t lock;
+    pthread_cond_t job_ready, chunk_done, slot_free;
+} pipeline_t;
+
+static int buf_reserve(buf_t* b, size_t extra) {
+    if (b->len + extra <= b->cap) return 0;
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + extra) cap *= 2;
+    char* p = realloc(b->data, cap);
+    if (!p) return -1;
+    b->data = p;
+    b->cap = cap;
+    return 0;
+}
+
+static int buf_append(buf_t* b, const char* s, size_t n) {
+    if (buf_reserve(b, n) != 0) return -1;
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    return 0;
+}
+
+/* --------- Bounded JSON field scanner --------- */
+
+typedef struct {
+    const char* p;
+    size_t len;
+} span_t;
+
+static const char* skip_ws(const char* s, const char* end) {
+    while (s < end && (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')) s++;
+    return s;
+}
+
+/* String at *s (on its opening quote); span is the raw contents */
+static int scan_string(const char** s, const char* end, span_t* span) {
+    const char* p = *s + 1;
+    const char* start = p;
+    while (p < end && *p != '"') {
+        if (*p == '\\') p++;
+        p++;
     }
-    pos += strlen(search_key);
-    while (*pos == ' ' || *pos == '"') pos++; // Skip space/quote
-    int i = 0;
-    while (*pos != '"' && *pos != ',' && *pos != '}' && i < max_len - 1) {
-        buffer[i++] = *pos++;
+    if (p >= end) return -1;
+    if (span) {
+        span->p = start;
+        span->len = (size_t)(p - start);
     }
-    buffer[i] = '\0';
+    *s = p + 1;
+    return 0;
 }
 
-int main(int argc, char** argv) {
-    z5d_init();
-    
-    // Config
-    int dps = 320;
-    // Simple arg parsing for dps
-    for (int i=1; i<argc; i++) {
-        if (strcmp(argv[i], "--dps") == 0 && i+1 < argc) {
-            dps = atoi(argv[i+1]);
+/* Any value at *s; span is a string's contents or a scalar's text */
+static int scan_value(const char** s, const char* end, span_t* span) {
+    const char* p = *s;
+    if (p >= end) return -1;
+    if (*p == '"') return scan_string(s, end, span);
+    if (*p == '{' || *p == '[') {
+        if (span) {
+            span->p = p;
+            span->len = 0;
         }
-    }
-    
-    mpfr_set_default_prec(dps);
-    
-    char line[65536]; // Large buffer for JSONL
-    while (fgets(line, sizeof(line), stdin)) {
-        if (strstr(line, "_metadata")) {
-            printf("%s", line);
-            continue;
+        char open[ADAPTER_MAX_DEPTH];
+        int depth = 0;
+        while (p < end) {
+            if (*p == '"') {
+                if (scan_string(&p, end, NULL) != 0) return -1;
+                continue;
+            }
+            if (*p == '{' || *p == '[') {
+                if (depth == ADAPTER_MAX_DEPTH) return -1;
+                open[depth++] = *p;
+            } else if (*p == '}' || *p == ']') {
+                if (depth == 0 || open[depth - 1] != (*p == '}' ? '{' : '[')) return -1;
+                if (--depth == 0) {
+                    *s = p + 1;
+                    return 0;
+                }
+            }
+            p++;
         }
-        
-        char p_str[1024], q_str[1024];
-        extract_json_value(line, "p", p_str, sizeof(p_str));
-        extract_json_value(line, "q", q_str, sizeof(q_str));
-        
-        if (p_str[0] == '\0' || q_str[0] == '\0') {
-            // Pass through if p or q not found
-            printf("%s", line); 
+        return -1;
+    }
+    const char* start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' &&
+           *p != '\r' && *p != '\n') {
+        p++;
+    }
+    if (p == start) return -1;
+    if (span) {
+        span->p = start;
+        span->len = (size_t)(p - start);
+    }
+    *s = p;
+    return 0;
+}
+
+static int key_is(const span_t* k, const char* name) {
+    size_t n = strlen(name);
+    return k->len == n && memcmp(k->p, name, n) == 0;
+}
+
+/* Top-level fields of one object line. Returns 0 for a well-formed object */
+static int scan_peak(const char* s, const char* end, span_t* p, span_t* q, int* meta) {
+    p->p = q->p = NULL;
+    p->len = q->len = 0;
+    *meta = 0;
+    s = skip_ws(s, end);
+    if (s >= end || *s != '{') return -1;
+    s = skip_ws(s + 1, end);
+    if (s < end && *s == '}') return 0;
+    for (;;) {
+        span_t key, value;
+        if (s >= end || *s != '"' || scan_string(&s, end, &key) != 0) return -1;
+        s = skip_ws(s, end);
+        if (s >= end || *s != ':') return -1;
+        s = skip_ws(s + 1, end);
+        if (scan_value(&s, end, &value) != 0) return -1;
+        if (key_is(&key, "p")) *p = value;
+        else if (key_is(&key, "q")) *q = value;
+        else if (key_is(&key, "_metadata")) *meta = 1;
+        s = skip_ws(s, end);
+        if (s < end && *s == ',') {
+            s = skip_ws(s + 1, end);
             continue;
         }
-        
-        mpz_t p, q;
-        mpz_init_set_str(p, p_str, 10);
-        mpz_init_set_str(q, q_str, 10);
-        
-        // Ranking logic
-        // 1. Estimate index n for p using R(p)
-        // 2. Predict p' = Z5D(n)
-        // 3. Score = |p - p'|
-        
-        mpfr_t p_mpfr, q_mpfr, k_est_p, k_est_q, diff_p, diff_q;
-        mpfr_inits2(dps, p_mpfr, q_mpfr, k_est_p, k_est_q, diff_p, diff_q, (mpfr_ptr)0);
-        
-        mpfr_set_z(p_mpfr, p, MPFR_RNDN);
-        mpfr_set_z(q_mpfr, q, MPFR_RNDN);
-        
-        // Inverse approx: R(x) ~ pi(x) ~ n
-        z5d_riemann_R(k_est_p, p_mpfr, 10, dps); 
-        z5d_riemann_R(k_est_q, q_mpfr, 10, dps);
-        
-        uint64_t n_p = (uint64_t)mpfr_get_d(k_est_p, MPFR_RNDN);
-        uint64_t n_q = (uint64_t)mpfr_get_d(k_est_q, MPFR_RNDN);
-        
-        z5d_result_t res_p, res_q;
-        z5d_result_init(&res_p, dps);
-        z5d_result_init(&res_q, dps);
-        
-        z5d_predict_nth_prime(&res_p, n_p);
-        z5d_predict_nth_prime(&res_q, n_q);
-        
-        mpfr_sub(diff_p, p_mpfr, res_p.predicted_prime, MPFR_RNDN);
-        mpfr_sub(diff_q, q_mpfr, res_q.predicted_prime, MPFR_RNDN);
-        
-        double score_p = mpfr_get_d(diff_p, MPFR_RNDN);
-        if(score_p < 0) score_p = -score_p;
-        
-        double score_q = mpfr_get_d(diff_q, MPFR_RNDN);
-        if(score_q < 0) score_q = -score_q;
-        
-        // Append to JSON line
-        // Remove trailing newline and potential '}'
-        size_t len = strlen(line);
-        while(len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) line[--len] = '\0';
-        if (line[len-1] == '}') line[--len] = '\0';
-        
-        printf("%s, \"z5d_score_p\": %.4f, \"z5d_n_est_p\": %llu, \"z5d_score_q\": %.4f, \"z5d_n_est_q\": %llu}\n", 
-               line, score_p, (unsigned long long)n_p, score_q, (unsigned long long)n_q);
-        
-        mpfr_clears(p_mpfr, q_mpfr, k_est_p, k_est_q, diff_p, diff_q, (mpfr_ptr)0);
-        mpz_clears(p, q, NULL);
-        z5d_result_clear(&res_p);
-        z5d_result_clear(&res_q);
-    }
-    
-    z5d_cleanup();
+        return (s < end && *s == '}') ? 0 : -1;
+    }
+}
+
+/* --------- Scoring --------- */
+
+typedef struct {
+    z5d_ctx_t ctx;
+    z5d_result_t res;
+    mpz_t z;
+    mpfr_t x, k_est, diff;
+    buf_t digits;
+} worker_state_t;
+
+/* Span as a positive decimal integer */
+static int span_to_mpz(worker_state_t* w, const span_t* s, mpz_t out) {
+    if (s->len == 0) return -1;
+    w->digits.len = 0;
+    if (buf_append(&w->digits, s->p, s->len) != 0 || buf_append(&w->digits, "", 1) != 0) return -1;
+    return mpz_set_str(out, w->digits.data, 10);
+}
+
+/* |f - Z5D(R(f))| and the index estimate, as the serial adapter computed them */
+static void score_factor(worker_state_t* w, const mpz_t f, double* score, uint64_t* n_est) {
+    mpfr_set_z(w->x, f, MPFR_RNDN);
+    z5d_riemann_R(w->k_est, w->x, ADAPTER_R_TERMS, mpfr_get_prec(w->x));
+    *n_est = (uint64_t)mpfr_get_d(w->k_est, MPFR_RNDN);
+    z5d_predict_nth_prime_ctx(&w->ctx, &w->res, *n_est);
+    mpfr_sub(w->diff, w->x, w->res.predicted_prime, MPFR_RNDN);
+    double d = mpfr_get_d(w->diff, MPFR_RNDN);
+    *score = d < 0 ? -d : d;
+}
+
+/* Score one line (newline included if present) onto out */
+static int score_line(worker_state_t* w, const char* line, size_t len, buf_t* out) {
+    span_t p, q;
+    int meta;
+    mpz_t fp, fq;
+    if (scan_peak(line, line + len, &p, &q, &meta) != 0 || meta || p.len == 0 || q.len == 0) {
+        return buf_append(out, line, len);
+    }
+    mpz_inits(fp, fq, NULL);
+    int ok = span_to_mpz(w, &p, fp) == 0 && span_to_mpz(w, &q, fq) == 0;
+    if (!ok) {
+        mpz_clears(fp, fq, NULL);
+        return buf_append(out, line, len);
+    }
+    double score_p, score_q;
+    uint64_t n_p, n_q;
+    score_factor(w, fp, &score_p, &n_p);
+    score_factor(w, fq, &score_q, &n_q);
+    mpz_clears(fp, fq, NULL);
+
+    /* Drop the line end and the closing brace, then append the fields */
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) len--;
+    if (len > 0 && line[len - 1] == '}') len--;
+    char tail[256];
+    int n = snprintf(tail, sizeof(tail),
+                     ", \"z5d_score_p\": %.4f, \"z5d_n_est_p\": %llu, \"z5d_score_q\": %.4f, "
+                     "\"z5d_n_est_q\": %llu}\n",
+                     score_p, (unsigned long long)n_p, score_q, (unsigned long long)n_q);
+    if (n < 0 || (size_t)n >= sizeof(tail)) return -1;
+    if (buf_reserve(out, len + (size_t)n) != 0) return -1;
+    buf_append(out, line, len);
+    return buf_append(out, tail, (size_t)n);
+}
+
+static int score_chunk(worker_state_t* w, const char* in, size_t len, buf_t* out) {
+    const char* end = in + len;
+    while (in < end) {
+        const char* nl = memchr(in, '\n', (size_t)(end - in));
+        const char* next = nl ? nl + 1 : end;
+        if (score_line(w, in, (size_t)(next - in), out) != 0) return -1;
+        in = next;
+    }
     return 0;
-}
\ No newline at end of file
+}
+
+/* --------- Stages --------- */
+
+static void* worker_main(void* arg) {
+    pipeline_t* pl = (pipeline_t*)arg;
+    worker_state_t w;
+    z5d_ctx_init(&w.ctx, NULL);
+    z5d_result_init(&w.res, pl->dps);
+    mpfr_inits2(pl->dps, w.x, w.k_est, w.diff, (mpfr_ptr)0);
+    memset(&w.digits, 0, sizeof(w.digits));
+
+    pthread_mutex_lock(&pl->lock);
+    for (;;) {
+        while (pl->next_job >= pl->next_read && !pl->eof) pthread_cond_wait(&pl->job_ready, &pl->lock);
+        if (pl->next_job >= pl->next_read) break;   /* eof and drained */
+        slot_t* s = &pl->slots[pl->next_job++ % ADAPTER_WINDOW];
+        s->state = SLOT_BUSY;
+        pthread_mutex_unlock(&pl->lock);
+
+        s->out.len = 0;
+        int ret = score_chunk(&w, s->in, s->in_len, &s->out);
+
+        pthread_mutex_lock(&pl->lock);
+        if (ret != 0) pl->failed = 1;
+        s->state = SLOT_DONE;
+        pthread_cond_broadcast(&pl->chunk_done);
+    }
+    pthread_mutex_unlock(&pl->lock);
+
+    free(w.digits.data);
+    mpfr_clears(w.x, w.k_est, w.diff, (mpfr_ptr)0);
+    z5d_result_clear(&w.res);
+    z5d_ctx_clear(&w.ctx);
+    z5d_cleanup();
+    return NULL;
+}
+
+static void* writer_main(void* arg) {
+    pipeline_t* pl = (pipeline_t*)arg;
+    pthread_mutex_lock(&pl->lock);
+    for (;;) {
+        slot_t* s = &pl->slots[pl->next_emit % ADAPTER_WINDOW];
+        while (!(pl->next_emit < pl->next_read && s->state == SLOT_DONE) &&
+               !(pl->eof && pl->next_emit >= pl->next_read)) {
+            pthread_cond_wait(&pl->chunk_done, &pl->lock);
+        }
+        if (pl->next_emit >= pl->next_read) break;
+        pthread_mutex_unlock(&pl->lock);
+
+        int ret = fwrite(s->out.data, 1, s->out.len, pl->out) == s->out.len ? 0 : -1;
+        free(s->owned);
+        s->owned = NULL;
+
+        pthread_mutex_lock(&pl->lock);
+        if (ret != 0) pl->failed = 1;
+        s->state = SLOT_FREE;
+        pl->next_emit++;
+        pthread_cond_broadcast(&pl->slot_free);
+    }
+    pthread_mutex_unlock(&pl->lock);
+    return NULL;
+}
+
+/* Hand one chunk to the workers; owned is freed once it is written */
+static void submit(pipeline_t* pl, const char* in, size_t len, char* owned) {
+    pthread_mutex_lock(&pl->lock);
+    slot_t* s = &pl->slots[pl->next_read % ADAPTER_WINDOW];
+    while (s->state != SLOT_FREE) pthread_cond_wait(&pl->slot_free, &pl->lock);
+    s->state = SLOT_PENDING;
+    s->in = in;
+    s->in_len = len;
+    s->owned = owned;
+    pl->next_read++;
+    pthread_cond_signal(&pl->job_ready);
+    pthread_mutex_unlock(&pl->lock);
+}
+
+/* Mapped input: chunks point into the mapping */
+static void read_mapped(pipeline_t* pl, const char* data, size_t size) {
+    size_t off = 0;
+    while (off < size) {
+        size_t cut = off + ADAPTER_CHUNK < size ? off + ADAPTER_CHUNK : size;
+        const char* nl = cut < size ? memchr(data + cut, '\n', size - cut) : NULL;
+        size_t end = nl ? (size_t)(nl - data) + 1 : size;
+        submit(pl, data + off, end - off, NULL);
+        off = end;
+    }
+}
+
+/* Stream input: blocks of ADAPTER_CHUNK, cut after the last newline; the
+   partial line moves to the next block. Returns -1 on a read error */
+static int read_stream(pipeline_t* pl, int fd) {
+    char* carry = NULL;
+    size_t carry_len = 0;
+    for (;;) {
+        size_t cap = carry_len + ADAPTER_CHUNK;
+        char* block = malloc(cap);
+        if (!block) {
+            free(carry);
+            return -1;
+        }
+        if (carry_len) memcpy(block, carry, carry_len);
+        free(carry);
+        carry = NULL;
+        size_t len = carry_len;
+        ssize_t got = 0;
+        while (len < cap && (got = read(fd, block + len, cap - len)) > 0) len += (size_t)got;
+        if (got < 0) {
+            free(block);
+            return -1;
+        }
+        int at_eof = len < cap;
+        size_t cut = len;
+        if (!at_eof) {
+            while (cut > 0 && block[cut - 1] != '\n') cut--;
+            if (cut == 0) {
+                /* One line longer than the block: keep reading it */
+                carry = block;
+                carry_len = len;
+                continue;
+            }
+        }
+        carry_len = len - cut;
+        if (carry_len) {
+            carry = malloc(carry_len);
+            if (!carry) {
+                free(block);
+                return -1;
+            }
+            memcpy(carry, block + cut, carry_len);
+        }
+        if (cut) submit(pl, block, cut, block);
+        else free(block);
+        if (at_eof) return 0;
+    }
+}
+
+static void print_usage(const char* prog_name) {
+    printf("Z5D Geofac adapter v%s\n", z5d_get_version());
+    printf("Usage: %s [options] [< peaks.jsonl] [> scored.jsonl]\n", prog_name);
+    printf("\nOptions:\n");
+    printf("  -i <file>   Input JSONL (mapped; default: stdin)\n");
+    printf("  -o <file>   Output JSONL (default: stdout)\n");
+    printf("  -j <n>      Worker threads (default: all CPUs)\n");
+    printf("  --dps <b>   MPFR precision in bits (default: 320)\n");
+    printf("  -h          Show this help\n");
+}
+
+int main(int argc, char** argv) {
+    const char* in_path = NULL;
+    const char* out_path = NULL;
+    int dps = 320, threads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "--dps") == 0 && i + 1 < argc) {
+            dps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            in_path = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Error: unknown option %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (dps < MPFR_PREC_MIN) dps = 320;
+    if (threads < 1) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    z5d_init();
+    mpfr_set_default_prec(dps);
+
+    int fd = in_path ? open(in_path, O_RDONLY) : STDIN_FILENO;
+    if (fd < 0) {
+        fprintf(stderr, "Error: cannot read %s\n", in_path);
+        return 1;
+    }
+    pipeline_t* pl = calloc(1, sizeof(*pl));
+    if (!pl) return 1;
+    pl->dps = dps;
+    pl->out = out_path ? fopen(out_path, "w") : stdout;
+    if (!pl->out) {
+        fprintf(stderr, "Error: cannot write %s\n", out_path);
+        return 1;
+    }
+    pthread_mutex_init(&pl->lock, NULL);
+    pthread_cond_init(&pl->job_ready, NULL);
+    pthread_cond_init(&pl->chunk_done, NULL);
+    pthread_cond_init(&pl->slot_free, NULL);
+
+    pthread_t writer;
+    pthread_t* tids = malloc((size_t)threads * sizeof(pthread_t));
+    if (!tids || pthread_create(&writer, NULL, writer_main, pl) != 0) return 1;
+    int started = 0;
+    for (; started < threads; started++) {
+        if (pthread_create(&tids[started], NULL, worker_main, pl) != 0) break;
+    }
+    if (started == 0) {
+        fprintf(stderr, "Error: cannot start workers\n");
+        return 1;
+    }
+
+    int ret = 0;
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (map != MAP_FAILED) {
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+        read_mapped(pl, (const char*)map, (size_t)st.st_size);
+    } else if (read_stream(pl, fd) != 0) {
+        fprintf(stderr, "Error: reading input failed\n");
+        ret = 1;
+    }
+
+    pthread_mutex_lock(&pl->lock);
+    pl->eof = 1;
+    pthread_cond_broadcast(&pl->job_ready);
+    pthread_cond_broadcast(&pl->chunk_done);
+    pthread_mutex_unlock(&pl->lock);
+    for (int i = 0; i < started; i++) pthread_join(tids[i], NULL);
+    pthread_join(writer, NULL);
+
+    if (pl->failed) {
+        fprintf(stderr, "Error: scoring or writing output failed\n");
+        ret = 1;
+    }
+    if (fflush(pl->out) != 0) ret = 1;
+    if (out_path) fclose(pl->out);
+    if (map != MAP_FAILED) munmap(map, (size_t)st.st_size);
+    if (in_path) close(fd);
+    for (int i = 0; i < ADAPTER_WINDOW; i++) free(pl->slots[i].out.data);
+    free(tids);
+    free(pl);
+    return ret;
+}
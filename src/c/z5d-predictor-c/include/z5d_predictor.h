@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <time.h>
 #include <mpfr.h>
 #include <gmp.h>
 
@@ -29,37 +30,234 @@ extern "C" {
 /* Default precision in bits (equivalent to ~96 decimal places, comfortable for 10^12+) */
 #define Z5D_DEFAULT_PRECISION 320
 
-/* Kept for API compatibility (unused in closed-form path) */
+/* Terms of the legacy z5d_riemann_R Moebius sum (unused by the engines) */
 #define Z5D_DEFAULT_K 10
 
+/* Halley steps allowed to the Riemann R engine */
+#define Z5D_DEFAULT_MAX_ITERATIONS 16
+
+/* Small-prime bound of the refinement presieve (0 disables it) */
+#define Z5D_DEFAULT_SIEVE_LIMIT 1000000
+
+/* Calibrated d- and e-term coefficients (c, kappa*) of the closed form. The
+   literals are the single source: the strings below and the framework's
+   ZF_Z5D_C_CALIBRATED / ZF_KAPPA_STAR_DEFAULT are spelled from them. */
+#define Z5D_C_CAL_LITERAL -0.00016667
+#define Z5D_KAPPA_STAR_LITERAL 0.065
+#define Z5D_STR_(x) #x
+#define Z5D_STR(x) Z5D_STR_(x)
+#define Z5D_DEFAULT_C_CAL Z5D_STR(Z5D_C_CAL_LITERAL)
+#define Z5D_DEFAULT_KAPPA_STAR Z5D_STR(Z5D_KAPPA_STAR_LITERAL)
+
 /**
  * Result structure for nth prime prediction
  */
 typedef struct {
     mpfr_t predicted_prime;  /* Predicted value (rounded MPFR) */
-    mpfr_t error;            /* Reserved / unused in closed-form path */
+    mpfr_t error;            /* Rounding-error bound of the fast tier; 0 from MPFR */
     double elapsed_ms;       /* Computation time in milliseconds */
-    int iterations;          /* Iterations performed (1 for closed form) */
-    int converged;           /* 1 if completed prediction */
+    int iterations;          /* Iterations performed (1 for closed form, Halley steps for R) */
+    int converged;           /* 1 if completed prediction (R: the last step met the tolerance) */
+    mpfr_prec_t precision_used; /* Working precision that produced the value (53/106: fast tier) */
 } z5d_result_t;
 
+/**
+ * Prime-index estimate for a value x (z5d_estimate_index). All fields are
+ * exact pi(x) below Z5D_INDEX_EXACT_MAX.
+ */
+typedef struct {
+    mpz_t n;                 /* Nearest integer to the inverse of the closed form at x */
+    mpz_t lo, hi;            /* lo <= pi(x) <= hi, unconditionally */
+    mpz_t rh_lo, rh_hi;      /* Tighter bracket inside [lo, hi], assuming the Riemann hypothesis */
+    int iterations;          /* Newton steps on the closed form */
+} z5d_index_t;
+
+/**
+ * Read-only, memory-mapped index of (n, p_n) anchors at n = i * stride,
+ * i = 1..count (see z5d_anchor_open). Safe to share between contexts and
+ * threads.
+ */
+typedef struct {
+    const void* map;         /* Whole file, PROT_READ / MAP_SHARED */
+    size_t map_size;
+    uint64_t stride;         /* Index spacing of the anchors */
+    uint64_t count;          /* Number of anchors */
+    const uint64_t* blocks;  /* p of every Z5D_ANCHOR_BLOCK-th anchor */
+    const uint32_t* deltas;  /* p gap to the previous anchor */
+} z5d_anchor_index_t;
+
+/* Anchors per absolute value in an index file */
+#define Z5D_ANCHOR_BLOCK 64
+
+/**
+ * Bounded, thread-safe memo of refined answers n -> p with an optional
+ * append-only backing store (see z5d_cache_open). One cache may be shared
+ * by any number of contexts and threads. Opaque.
+ */
+typedef struct z5d_cache z5d_cache_t;
+
+/* Independently locked parts of a cache; capacity is rounded up to a multiple */
+#define Z5D_CACHE_SHARDS 16
+
+/* Entries of the CLI and server caches unless overridden */
+#define Z5D_CACHE_DEFAULT_ENTRIES 65536
+
+/**
+ * Prediction engine of a context. The closed form is the calibrated
+ * PNT + d-term + e-term estimate; the Riemann engine solves R(x) = n by
+ * Halley steps on the Gram series from the Dusart start, slower but
+ * without calibration constants.
+ */
+typedef enum {
+    Z5D_ENGINE_CLOSED_FORM = 0,
+    Z5D_ENGINE_RIEMANN_R
+} z5d_engine_t;
+
 /**
  * Configuration for predictor
  */
 typedef struct {
     mpfr_prec_t precision;   /* MPFR precision in bits */
-    int K;                   /* Number of terms in R(x) series */
-    int max_iterations;      /* Maximum Newton-Halley iterations */
-    mpfr_t tolerance;        /* Convergence tolerance */
+    z5d_engine_t engine;     /* Prediction engine (default: closed form) */
+    int K;                   /* Terms of the legacy z5d_riemann_R sum (unused by the engines) */
+    int max_iterations;      /* Riemann engine: Halley step limit */
+    mpfr_t tolerance;        /* Riemann engine: stop when |step| <= tolerance * x
+                                (0: when |step| < 2^-16) */
+    uint32_t sieve_limit;    /* Refinement presieve uses primes up to this bound (0: off) */
+    int threads;             /* Refinement worker threads (1: serial) */
+    const z5d_anchor_index_t* anchors; /* Exact p_n from this index where it covers n (NULL: off) */
+    z5d_cache_t* cache;      /* Memo of refined big-n answers, shared (NULL: off; closed
+                                form and default calibration only, since the store records
+                                neither) */
+    mpq_t c_cal;             /* d-term coefficient c (default: Z5D_DEFAULT_C_CAL) */
+    mpq_t kappa_star;        /* e-term coefficient kappa* (default: Z5D_DEFAULT_KAPPA_STAR) */
 } z5d_config_t;
 
 /**
- * Initialize library (must be called before using library)
+ * Scratch registers and cached constants of the closed form at one working
+ * precision. Embedded in z5d_ctx_t; treat as opaque.
+ */
+typedef struct {
+    mpfr_prec_t prec;
+    mpfr_t ln_k, ln_ln_k, pnt, ln_pnt, d_term, e_term, tmp, correction;
+    mpfr_t c_cal, k_star, e_fourth, neg_third;
+    mpfr_t k_mp, pred;
+    mpq_t c_q, k_q;          /* Exact values c_cal and k_star were loaded from */
+} z5d_workspace_t;
+
+/**
+ * Small-prime table and bit-packed window of the refinement sieve.
+ * Embedded in z5d_ctx_t; treat as opaque.
+ */
+typedef struct {
+    uint32_t limit;          /* Table bound (config.sieve_limit) */
+    uint32_t* primes;        /* Odd primes 3..limit, built on first use */
+    uint32_t* offsets;       /* Per-prime first marked index in the next segment */
+    size_t num_primes;
+    uint64_t* window;        /* One bit per odd candidate, 1 = composite */
+    size_t window_words;
+    mpz_t base, cand;
+    const int* stop;         /* Searches give up once *stop != 0 (NULL: never); async jobs */
+    int stopped;             /* The last search gave up; its output was not written */
+} z5d_sieve_t;
+
+/**
+ * Allocation hooks for GMP/MPFR storage (z5d_mem_install). COUNT forwards
+ * to the previous functions and counts calls; POOL also recycles blocks of
+ * up to Z5D_MEM_MAX_CLASS_BYTES through per-thread free lists.
+ */
+typedef enum {
+    Z5D_MEM_COUNT = 0,
+    Z5D_MEM_POOL
+} z5d_mem_mode_t;
+
+/**
+ * Allocation counters of the calling thread since it started
+ */
+typedef struct {
+    uint64_t allocs;         /* GMP/MPFR allocate and reallocate calls */
+    uint64_t frees;          /* GMP/MPFR free calls */
+    uint64_t mallocs;        /* Calls that reached malloc or realloc */
+    size_t cached_bytes;     /* Bytes held in the thread's free lists */
+} z5d_mem_stats_t;
+
+/**
+ * Hot-path record of the last prediction call on a context
+ * (ctx->last_call). Filled only when the library is built with
+ * -DZ5D_ENABLE_STATS (see z5d_stats_enabled); otherwise it stays zeroed and
+ * the hot path carries no clock reads or counters. Batch calls sum their
+ * entries (precision is the largest used); z5d_predict_range_cb records its
+ * last chunk. Table, anchor and cache answers run no stages and leave it zeroed.
+ */
+typedef struct {
+    double predict_ns;       /* Closed form: fast tier or MPFR, replans included */
+    double round_ns;         /* Rounding to an integer (0 when the fast tier rounds) */
+    double refine_ns;        /* Search from the rounded prediction to the prime */
+    uint64_t distance;       /* Returned prime - rounded prediction */
+    uint64_t candidates;     /* Odd integers from the prediction through the prime */
+    uint64_t sieve_survivors;/* Candidates through the prime left by the presieve */
+    uint64_t prp_tests;      /* Full probable-prime tests (parallel searches may test past
+                                the prime); survivors and tests are 0 from 65 to 127 bits,
+                                where GMP's mpz_nextprime runs the search */
+    mpfr_prec_t precision;   /* Working bits of the closed form (53 / 106: fast tier) */
+} z5d_call_stats_t;
+
+/**
+ * Counters accumulated by a context across calls
+ */
+typedef struct {
+    uint64_t calls;          /* z5d_predict_* calls served */
+    uint64_t predictions;    /* Closed-form or Riemann R evaluations */
+    uint64_t halley_steps;   /* Halley steps taken by the Riemann engine */
+    uint64_t index_steps;    /* Newton steps of z5d_estimate_index */
+    uint64_t known_hits;     /* Answers served from the built-in table */
+    uint64_t refinements;    /* Refinements to a probable prime */
+    uint64_t fast_hits;      /* Closed forms settled by the double / double-double tier */
+    uint64_t fast_fallbacks; /* Fast-tier results too close to .5 to round; redone in MPFR */
+    uint64_t replans;        /* Planned precision too close to .5; redone at fallback precision */
+    uint64_t prp_tests;      /* Probable-prime tests run on sieve survivors */
+    uint64_t pi_evaluations; /* pi(x) evaluations by the exact nth-prime mode */
+    uint64_t anchor_hits;    /* Exact p_n walked from the anchor index */
+    uint64_t cache_hits;     /* Refined answers served by config.cache (memory or store) */
+    uint64_t cache_misses;   /* Refinements run after a cache miss */
+    uint64_t gmp_allocs;     /* GMP/MPFR allocations inside the calls (0 without z5d_mem_install) */
+    uint64_t gmp_mallocs;    /* ... of which reached malloc (0 in steady state with Z5D_MEM_POOL) */
+    double elapsed_ms;       /* Wall time spent inside the calls */
+    /* Sums of z5d_call_stats_t over calls (-DZ5D_ENABLE_STATS only) */
+    double predict_ns, round_ns, refine_ns;
+    uint64_t distance;
+    uint64_t candidates;
+    uint64_t sieve_survivors;
+    mpfr_prec_t max_precision;
+} z5d_ctx_stats_t;
+
+/**
+ * Reentrant predictor context. Owns its precision, cached constants,
+ * scratch registers and stats; nothing is shared with other contexts, so
+ * one context per thread needs no locking. A context must not be used by
+ * two threads at the same time.
+ */
+typedef struct {
+    z5d_config_t config;     /* Private copy of the configuration */
+    z5d_workspace_t ws;      /* Cached constants + scratch registers */
+    z5d_sieve_t sieve;       /* Refinement presieve tables */
+    mpz_t n_tmp;             /* Scratch index for the uint64/string entry points */
+    mpz_t stat_from, stat_tmp; /* Scratch for the refinement stage record */
+    void* walk;              /* Exact-mode prime walker, created on first use */
+    void* riemann;           /* Riemann engine state, created on first use */
+    z5d_ctx_stats_t stats;   /* Accumulated counters */
+    z5d_call_stats_t last_call; /* Stages of the last prediction call */
+    z5d_mem_stats_t mem_mark;   /* Thread allocation counters at the call start */
+} z5d_ctx_t;
+
+/**
+ * Initialize library (optional; sets up the calling thread's default context)
  */
 void z5d_init(void);
 
 /**
- * Cleanup library (call when done)
+ * Cleanup library: release the calling thread's default context and its
+ * MPFR constant caches (other threads are unaffected)
  */
 void z5d_cleanup(void);
 
@@ -82,6 +280,25 @@ void z5d_config_init(z5d_config_t* config);
  */
 void z5d_config_clear(z5d_config_t* config);
 
+/**
+ * Set the closed-form coefficients from decimal strings ("-0.00016667",
+ * "6.5e-2"). They are kept exact, so every working precision sees the
+ * correctly rounded value. May also be applied to ctx->config between calls.
+ * Any other calibration than the default turns off the hardware-float tier
+ * and the result cache, whose answers assume the built-in one.
+ *
+ * @param config Configuration to update
+ * @param c d-term coefficient c (NULL: leave unchanged)
+ * @param kappa_star e-term coefficient kappa* (NULL: leave unchanged)
+ * @return 0 on success, -1 if a string is not a decimal number (config unchanged)
+ */
+int z5d_config_set_calibration(z5d_config_t* config, const char* c, const char* kappa_star);
+
+/**
+ * Whether config carries the built-in calibration
+ */
+int z5d_config_default_calibration(const z5d_config_t* config);
+
 /**
  * Initialize result structure
  * 
@@ -97,6 +314,43 @@ void z5d_result_init(z5d_result_t* result, mpfr_prec_t precision);
  */
 void z5d_result_clear(z5d_result_t* result);
 
+/**
+ * Initialize a context
+ *
+ * @param ctx Context to initialize
+ * @param config Configuration to copy (NULL for defaults)
+ */
+void z5d_ctx_init(z5d_ctx_t* ctx, const z5d_config_t* config);
+
+/**
+ * Cleanup a context
+ *
+ * @param ctx Context to cleanup
+ */
+void z5d_ctx_clear(z5d_ctx_t* ctx);
+
+/**
+ * Zero the accumulated counters and the last-call record of a context
+ *
+ * @param ctx Context
+ */
+void z5d_ctx_reset_stats(z5d_ctx_t* ctx);
+
+/**
+ * Whether this build gathers the per-call stages of z5d_call_stats_t
+ *
+ * @return 1 if built with -DZ5D_ENABLE_STATS, 0 otherwise
+ */
+int z5d_stats_enabled(void);
+
+/**
+ * Default context of the calling thread, used by the context-free entry
+ * points. Created on first use and released by z5d_cleanup() or thread exit.
+ *
+ * @return Context pointer, or NULL on allocation failure
+ */
+z5d_ctx_t* z5d_default_ctx(void);
+
 /**
  * Predict the nth prime (approximate MPFR value) using default configuration
  * 
@@ -126,10 +380,605 @@ int z5d_predict_nth_prime_ex(z5d_result_t* result, uint64_t n, const z5d_config_
  */
 int z5d_predict_nth_prime_mpz(mpz_t prime_out, uint64_t n);
 
+/**
+ * Rounded closed form (the predicted_prime of z5d_predict_nth_prime) on the
+ * grid n = start + i * stride, i < count, written straight to out. Below
+ * 2^53 the hardware tier steps its series state along the grid instead of
+ * re-evaluating every point; values are identical to the pointwise path.
+ *
+ * @param start First index (>= 1; the closed form is negative below n = 5)
+ * @param stride Index spacing (0 repeats start)
+ * @param count Number of points
+ * @param out count outputs
+ * @return 0 on success, -1 on bad arguments or a prediction that is not a
+ *         uint64_t (n < 5; every 5 <= n <= Z5D_EXACT_MAX_N fits)
+ */
+int z5d_predict_range(uint64_t start, uint64_t stride, size_t count, uint64_t* out);
+
+/**
+ * Consumer of z5d_predict_range_cb: values[j] is the prediction for
+ * first_n + j * stride. A nonzero return stops the sweep.
+ */
+typedef int (*z5d_range_fn)(uint64_t first_n, uint64_t stride, const uint64_t* values,
+                            size_t count, void* arg);
+
+/* Points handed to a z5d_range_fn per call (stack buffer) */
+#define Z5D_RANGE_CHUNK 1024
+
+/**
+ * z5d_predict_range for grids too long to hold: delivers the values in
+ * chunks of up to Z5D_RANGE_CHUNK points, in order.
+ *
+ * @return 0 on success, -1 as for z5d_predict_range, otherwise the nonzero
+ *         value returned by fn
+ */
+int z5d_predict_range_cb(uint64_t start, uint64_t stride, size_t count,
+                         z5d_range_fn fn, void* arg);
+
+/*
+ * Bulk approximate predictor. The unrounded closed form in double precision
+ * for arrays of uint64 indices, evaluated by SIMD kernels without MPFR.
+ */
+
+#define Z5D_APPROX_MIN_N 5   /* The closed form is negative below this */
+
+typedef enum {
+    Z5D_APPROX_AUTO = 0,     /* Widest kernel the CPU runs */
+    Z5D_APPROX_GENERIC,      /* Two-lane baseline kernel, any CPU */
+    Z5D_APPROX_AVX2,         /* x86-64 with AVX2 and FMA */
+    Z5D_APPROX_AVX512,       /* x86-64 with AVX-512F */
+    Z5D_APPROX_NEON          /* AArch64 Advanced SIMD */
+} z5d_approx_kernel_t;
+
+/**
+ * out[i] = closed form at n[i] (PNT + d-term + e-term, before rounding), as
+ * z5d_closed_form_ctx computes it in MPFR with the built-in calibration
+ * (Z5D_DEFAULT_C_CAL, Z5D_DEFAULT_KAPPA_STAR). Relative error at most 2^-50
+ * (8 units of 2^-53) for n >= 100 and 2^-48 for 5 <= n < 100, where the
+ * PNT bracket cancels; measured worst cases are 4.2 and 15.8 units. Kernels
+ * may differ from each other in the last bits.
+ *
+ * @param n count indices
+ * @param out count outputs
+ * @param count Number of entries
+ * @return 0 on success, -1 if some n < Z5D_APPROX_MIN_N (those outputs are
+ *         NaN, the rest are filled) or n / out is NULL
+ */
+int z5d_predict_approx_u64(const uint64_t* n, double* out, size_t count);
+
+/**
+ * z5d_predict_approx_u64 on a chosen kernel, for tests and benchmarks.
+ *
+ * @return As z5d_predict_approx_u64; also -1 if the CPU cannot run kernel
+ */
+int z5d_predict_approx_u64_with(z5d_approx_kernel_t kernel, const uint64_t* n, double* out,
+                                size_t count);
+
+/**
+ * Kernel picked for Z5D_APPROX_AUTO on this CPU (checked once).
+ */
+z5d_approx_kernel_t z5d_approx_kernel(void);
+
+/**
+ * Whether this CPU and build can run kernel.
+ */
+int z5d_approx_kernel_supported(z5d_approx_kernel_t kernel);
+
+/**
+ * Short kernel name: "generic", "avx2", "avx512" or "neon".
+ */
+const char* z5d_approx_kernel_name(z5d_approx_kernel_t kernel);
+
 /* Big-n entry points */
 int z5d_predict_nth_prime_mpz_big(mpz_t prime_out, const mpz_t n);
 int z5d_predict_nth_prime_str(mpz_t prime_out, const char* n_dec_str);
 
+/**
+ * Closed-form prediction (no refinement) for arbitrary n. The working
+ * precision comes from z5d_plan_precision and is reported in
+ * result->precision_used; result->predicted_prime is widened if it cannot
+ * hold the rounded value exactly.
+ *
+ * @param result Output result structure (must be initialized)
+ * @param n Index of prime to predict (n >= 1)
+ * @return 0 on success, negative on error
+ */
+int z5d_predict_nth_prime_big(z5d_result_t* result, const mpz_t n);
+
+/**
+ * Minimum MPFR working precision for which the big-n path rounds the closed
+ * form correctly: the integer bits of the largest term, the worst-case error
+ * amplification of the formula, and guard bits for the rounding decision.
+ * Values that still land too close to a half-integer are redone at a
+ * fallback precision, so the rounded output never depends on the plan.
+ *
+ * @param n Index of prime (n >= 1)
+ * @return Working precision in bits
+ */
+mpfr_prec_t z5d_plan_precision(const mpz_t n);
+
+/**
+ * Stage entry points, for benchmarks and diagnostics. z5d_closed_form_ctx
+ * evaluates the unrounded closed form at the planned working precision
+ * (MPFR only: no fast tier, table lookup or replan); out is resized to that
+ * precision. z5d_refine_ctx runs the refinement stage: the first probable
+ * prime >= start.
+ *
+ * @return 0 on success, -1 if n <= 0
+ */
+int z5d_closed_form_ctx(z5d_ctx_t* ctx, mpfr_t out, const mpz_t n);
+int z5d_refine_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const mpz_t start);
+
+/**
+ * Batch variant of z5d_predict_nth_prime_mpz_big. One MPFR workspace (scratch
+ * registers, parsed calibration constants, e^4 and -1/3) is prepared per
+ * distinct working precision and reused across the whole array.
+ *
+ * @param out Array of count output mpz_t (must be initialized by caller)
+ * @param n Array of count indices (n >= 1)
+ * @param count Number of entries
+ * @return 0 on success, -1 if any n <= 0 (that entry's output is set to 0)
+ */
+int z5d_predict_nth_prime_batch(mpz_t* out, const mpz_t* n, size_t count);
+
+/*
+ * Context versions of every prediction entry point. Semantics match the
+ * context-free functions above; the context's precision is used where those
+ * use Z5D_DEFAULT_PRECISION (for the big-n path it is the precision floor).
+ * For _ex_ctx, a NULL config means the context's own configuration.
+ */
+int z5d_predict_nth_prime_ctx(z5d_ctx_t* ctx, z5d_result_t* result, uint64_t n);
+int z5d_predict_nth_prime_ex_ctx(z5d_ctx_t* ctx, z5d_result_t* result, uint64_t n,
+                                 const z5d_config_t* config);
+int z5d_predict_nth_prime_mpz_ctx(z5d_ctx_t* ctx, mpz_t prime_out, uint64_t n);
+int z5d_predict_nth_prime_mpz_big_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const mpz_t n);
+int z5d_predict_nth_prime_big_ctx(z5d_ctx_t* ctx, z5d_result_t* result, const mpz_t n);
+int z5d_predict_nth_prime_str_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const char* n_dec_str);
+int z5d_predict_nth_prime_batch_ctx(z5d_ctx_t* ctx, mpz_t* out, const mpz_t* n, size_t count);
+int z5d_predict_range_ctx(z5d_ctx_t* ctx, uint64_t start, uint64_t stride, size_t count,
+                          uint64_t* out);
+int z5d_predict_range_cb_ctx(z5d_ctx_t* ctx, uint64_t start, uint64_t stride, size_t count,
+                             z5d_range_fn fn, void* arg);
+
+/*
+ * Packed buffers. Flat-array forms of the refined predictions for language
+ * bindings: each prime is written as width little-endian unsigned bytes,
+ * zero-padded, entry i at byte i * width, with no per-element allocation.
+ */
+
+#define Z5D_PACKED_U64_WIDTH 16   /* Bytes that hold p_n for every uint64_t n */
+
+/**
+ * out entry i = z5d_predict_nth_prime_mpz_ctx(ctx, ., n[i]).
+ *
+ * @param ctx Calling thread's context
+ * @param n count indices
+ * @param count Number of entries
+ * @param out count * width bytes
+ * @param width Bytes per output entry
+ * @return 0 on success, -1 on bad arguments or if some n is 0 or its prime
+ *         does not fit in width bytes (those entries are zero, the rest are
+ *         filled)
+ */
+int z5d_predict_nth_prime_packed(z5d_ctx_t* ctx, const uint64_t* n, size_t count, void* out,
+                                 size_t width);
+
+/**
+ * Big-n form: index i is n_width little-endian unsigned bytes at
+ * n + i * n_width, predicted by z5d_predict_nth_prime_mpz_big_ctx.
+ *
+ * @return As z5d_predict_nth_prime_packed
+ */
+int z5d_predict_nth_prime_packed_big(z5d_ctx_t* ctx, const void* n, size_t n_width, size_t count,
+                                     void* out, size_t out_width);
+
+/*
+ * Inverse: prime-index estimates. The closed form F maps n to about p_n;
+ * z5d_estimate_index solves F(n) = x for n by Newton steps, which answers
+ * "about which index is x" and, as a difference of two estimates, "about
+ * how many primes lie in [a, b]". The brackets are rigorous bounds on
+ * pi(x) itself, independent of the calibration:
+ *
+ *   lo, hi        Dusart (2010): x/L (1 + 1/L) <= pi(x) <= x/L (1 + 1/L + 2.51/L^2),
+ *                 L = ln x, for x >= 355991
+ *   rh_lo, rh_hi  Schoenfeld (1976): |pi(x) - li(x)| < sqrt(x) L / (8 pi) under the
+ *                 Riemann hypothesis, intersected with [lo, hi]
+ */
+
+#define Z5D_INDEX_EXACT_MAX (1ULL << 19)   /* Below this every field is pi(x) by a sieve */
+#define Z5D_INDEX_MAX_STEPS 64
+
+/**
+ * Initialize / release an index estimate
+ */
+void z5d_index_init(z5d_index_t* est);
+void z5d_index_clear(z5d_index_t* est);
+
+/**
+ * Index estimate and pi(x) brackets for x. Newton runs on the unrounded
+ * closed form at the precision z5d_plan_precision gives for x, from the
+ * start x / (L - 1 - 1/L), until a step is below 2^-16.
+ *
+ * @param est Output (must be initialized)
+ * @param x Value (>= 0; all fields are 0 for x < 2)
+ * @return 0 on success, -1 if x < 0 or on allocation failure
+ */
+int z5d_estimate_index(z5d_index_t* est, const mpz_t x);
+int z5d_estimate_index_ctx(z5d_ctx_t* ctx, z5d_index_t* est, const mpz_t x);
+
+/*
+ * Word-sized primality, exact below 2^64: Miller-Rabin to bases {2, 7, 61}
+ * below 2^32 and BPSW above, in Montgomery form on 128-bit products (no
+ * GMP). Refinement uses it whenever the rounded prediction fits in 64 bits.
+ */
+
+/**
+ * Whether n is prime (exact, no probable-prime caveat)
+ */
+int z5d_is_prime_u64(uint64_t n);
+
+/**
+ * Smallest prime >= start, with 64 odd candidates presieved per word by the
+ * primes up to 251.
+ *
+ * @param start Lower bound (any 64-bit value)
+ * @param tests If not NULL, incremented by the candidates tested
+ * @return The prime, or 0 if start exceeds 18446744073709551557 (the largest
+ *         prime below 2^64)
+ */
+uint64_t z5d_next_prime_u64(uint64_t start, uint64_t* tests);
+
+/*
+ * Exact mode. p_n must fit in 64 bits, so n is limited to pi(2^64).
+ */
+#define Z5D_EXACT_MAX_N 425656284035217743ULL
+
+/**
+ * Count the primes <= x with the Lagarias-Miller-Odlyzko method
+ * (O(x^(2/3)) time, O(x^(1/3) log^2 x) memory; plain sieve below 10^7).
+ *
+ * @param x Upper bound (any 64-bit value)
+ * @param count Output pi(x)
+ * @return 0 on success, -1 on allocation failure
+ */
+int z5d_prime_pi(uint64_t x, uint64_t* count);
+
+/**
+ * Exact nth prime: pi() at the closed-form prediction, Newton steps on pi()
+ * while the residual exceeds a few thousand primes, then a presieved walk.
+ *
+ * @param n Index of prime (1 <= n <= Z5D_EXACT_MAX_N)
+ * @param prime_out Output p_n
+ * @return 0 on success, -1 if n is out of range or on allocation failure
+ */
+int z5d_nth_prime_exact(uint64_t n, uint64_t* prime_out);
+int z5d_nth_prime_exact_ctx(z5d_ctx_t* ctx, uint64_t n, uint64_t* prime_out);
+
+/*
+ * Anchor index. File layout (native byte order, 64-byte header):
+ *   char magic[8] = "Z5DANCH1", uint32 version = 1, uint32 block = 64,
+ *   uint64 stride, uint64 count, uint64 reserved[4],
+ *   uint64 p[ceil(count / 64)]   p of anchors 1, 65, 129, ...
+ *   uint32 delta[count]          p_(i*stride) - p_((i-1)*stride), 0 at block starts
+ * About 4 bytes per anchor: every 2^20 indices up to 10^12 is ~3.8 MB.
+ */
+
+/**
+ * Map an anchor index file read-only.
+ *
+ * @param index Index to fill
+ * @param path File written by z5d_anchor_build (or tools: z5d_anchor_gen)
+ * @return 0 on success, -1 if the file cannot be mapped or is malformed
+ */
+int z5d_anchor_open(z5d_anchor_index_t* index, const char* path);
+
+/**
+ * Unmap an anchor index.
+ *
+ * @param index Index to release
+ */
+void z5d_anchor_close(z5d_anchor_index_t* index);
+
+/**
+ * Anchor nearest to n. Covers 1 <= n <= (count + 1/2) * stride.
+ *
+ * @param index Anchor index
+ * @param n Index of prime
+ * @param anchor_n Output anchor index (a multiple of stride)
+ * @param anchor_p Output p_(anchor_n)
+ * @return 0 on success, -1 if n is outside the index
+ */
+int z5d_anchor_nearest(const z5d_anchor_index_t* index, uint64_t n,
+                       uint64_t* anchor_n, uint64_t* anchor_p);
+
+/**
+ * Build an anchor index file by sieving through p_(max_n).
+ *
+ * @param path Output file
+ * @param stride Index spacing of the anchors (>= 1)
+ * @param max_n Last index to cover (count = max_n / stride anchors)
+ * @param progress Optional callback after each block (done, total anchors)
+ * @param arg Passed through to progress
+ * @return 0 on success, -1 on I/O or allocation failure or if a gap
+ *         overflows 32 bits
+ */
+int z5d_anchor_build(const char* path, uint64_t stride, uint64_t max_n,
+                     void (*progress)(uint64_t done, uint64_t total, void* arg), void* arg);
+
+/*
+ * Result cache. Holds the answers of z5d_predict_nth_prime_mpz_big and the
+ * entry points built on it (mpz, str, batch) that come from the closed form
+ * plus refinement; table and anchor answers are not cached. Contexts with
+ * config.cache set look up n before predicting and insert after refining.
+ */
+
+/**
+ * Cache statistics, summed over the shards
+ */
+typedef struct {
+    uint64_t hits;           /* Answered from memory */
+    uint64_t store_hits;     /* Answered from the store (then promoted to memory) */
+    uint64_t misses;         /* Answered by neither */
+    uint64_t inserts;        /* Entries written to memory */
+    uint64_t evictions;      /* Entries replaced by the CLOCK hand */
+    uint64_t store_appends;  /* Records appended to the store since open */
+    size_t entries;          /* Entries in memory */
+    size_t capacity;         /* Memory entries (rounded up to Z5D_CACHE_SHARDS) */
+    size_t store_entries;    /* Distinct n in the store */
+} z5d_cache_stats_t;
+
+/**
+ * Create a cache, optionally backed by an append-only store file. An
+ * existing store is mapped and indexed, so every n in it is answered by a
+ * lookup; a torn record at its tail is cut off. The store is created if
+ * missing and must be used by one process at a time.
+ *
+ * @param cache Output cache
+ * @param capacity Entries kept in memory (>= 1)
+ * @param store_path Store file, or NULL for a memory-only cache
+ * @return 0 on success, -1 on allocation or I/O failure, or if the store was
+ *         written by another library version or is not a store
+ */
+int z5d_cache_open(z5d_cache_t** cache, size_t capacity, const char* store_path);
+
+/**
+ * Release a cache and close its store. No context may be using it.
+ *
+ * @param cache Cache (NULL is ignored)
+ */
+void z5d_cache_close(z5d_cache_t* cache);
+
+/**
+ * Look up n in memory, then in the store.
+ *
+ * @param cache Cache
+ * @param prime_out Output p (untouched on a miss)
+ * @param n Index
+ * @return 1 on a hit, 0 on a miss
+ */
+int z5d_cache_lookup(z5d_cache_t* cache, mpz_t prime_out, const mpz_t n);
+
+/**
+ * Insert n -> prime into memory (evicting by CLOCK when full) and append it
+ * to the store unless already stored.
+ *
+ * @return 0 on success, -1 on bad arguments or a failed store append
+ */
+int z5d_cache_insert(z5d_cache_t* cache, const mpz_t n, const mpz_t prime);
+
+/**
+ * Snapshot of the cache counters.
+ *
+ * @param cache Cache
+ * @param stats Output statistics
+ */
+void z5d_cache_get_stats(z5d_cache_t* cache, z5d_cache_stats_t* stats);
+
+/*
+ * Asynchronous big-n predictions with deadlines. Jobs run on a pool of
+ * worker threads owned by the library; each worker has its own queue, and
+ * an idle worker steals the oldest job from the longest other queue. The
+ * refinement checks for cancellation before every probable-prime test, so
+ * a cancelled job releases its worker within one test. A waiter whose
+ * deadline passes during refinement gets the rounded closed form at once
+ * while the search goes on (or is cancelled).
+ */
+
+#define Z5D_JOB_DONE 0                   /* prime_out: the refined prime */
+#define Z5D_JOB_ESTIMATE 1               /* Refinement incomplete; prime_out: the rounded
+                                            closed form */
+#define Z5D_JOB_PENDING 2                /* No prediction yet; prime_out untouched */
+#define Z5D_JOB_CANCELLED 3              /* Cancelled before it finished; prime_out untouched */
+#define Z5D_ASYNC_MAX_THREADS 256        /* Upper bound on pool workers */
+
+/**
+ * Handle of a submitted prediction. Opaque.
+ */
+typedef struct z5d_job z5d_job_t;
+
+/**
+ * Start the pool. z5d_submit starts it on first use with one worker per
+ * online CPU, so this is only needed to choose the size.
+ *
+ * @param threads Workers (0: one per online CPU; capped at Z5D_ASYNC_MAX_THREADS)
+ * @return 0 on success, -1 if the pool is already running or no worker started
+ */
+int z5d_async_start(int threads);
+
+/**
+ * Cancel every queued and running job, then stop the workers. Handles stay
+ * valid until released, and unfinished jobs read Z5D_JOB_CANCELLED. The
+ * pool can be started again afterwards.
+ */
+void z5d_async_stop(void);
+
+/**
+ * Queue the refined prediction of p_n (the z5d_predict_nth_prime_mpz_big
+ * answer). The configuration is copied, so the caller may clear it. Jobs
+ * without a configuration reuse the worker's warm context. A stoppable
+ * search always runs in the sieve, which tests every odd candidate when
+ * sieve_limit is 0.
+ *
+ * @param job Output handle, released with z5d_job_release
+ * @param n Index (n >= 1)
+ * @param config Configuration, or NULL for the defaults
+ * @return 0 on success, -1 if n <= 0, on allocation failure, or while the
+ *         pool is stopping
+ */
+int z5d_submit(z5d_job_t** job, const mpz_t n, const z5d_config_t* config);
+
+/**
+ * Wait for a job until an absolute CLOCK_REALTIME deadline (the clock of
+ * pthread_cond_timedwait; see z5d_deadline_after).
+ *
+ * @param job Handle
+ * @param deadline Absolute deadline, or NULL to wait until the job ends
+ * @param prime_out Output (may be NULL), per the Z5D_JOB_* status
+ * @return Z5D_JOB_DONE, Z5D_JOB_CANCELLED, or at the deadline
+ *         Z5D_JOB_ESTIMATE / Z5D_JOB_PENDING with the job still running
+ */
+int z5d_wait_until(z5d_job_t* job, const struct timespec* deadline, mpz_t prime_out);
+
+/**
+ * Status of a job without waiting; z5d_wait_until with a deadline already
+ * past.
+ */
+int z5d_poll(z5d_job_t* job, mpz_t prime_out);
+
+/**
+ * Ask a job to stop and return without waiting. A queued job ends at once;
+ * a running one at its next probable-prime test. The closed form, table,
+ * anchor and cache stages are short and not interrupted, so a job may still
+ * end Z5D_JOB_DONE.
+ *
+ * @param job Handle
+ * @return 0 if the job had not ended, 1 if it had already ended
+ */
+int z5d_cancel(z5d_job_t* job);
+
+/**
+ * Drop the caller's handle. An unfinished job is cancelled; its memory is
+ * freed when its worker lets go of it.
+ *
+ * @param job Handle (NULL is ignored)
+ */
+void z5d_job_release(z5d_job_t* job);
+
+/**
+ * CLOCK_REALTIME deadline ms milliseconds from now, for z5d_wait_until.
+ *
+ * @param deadline Output deadline
+ * @param ms Milliseconds from now (<= 0: now)
+ */
+void z5d_deadline_after(struct timespec* deadline, double ms);
+
+/*
+ * Lucas-Lehmer test of M_p = 2^p - 1. The GMP engine folds the square at
+ * bit p instead of dividing; the FFT engine squares with an irrational-base
+ * weighted transform whose cyclic wrap is the reduction mod 2^p - 1.
+ * Long runs can be checkpointed and resumed.
+ */
+
+#define Z5D_LL_COMPOSITE 0
+#define Z5D_LL_PRIME 1
+#define Z5D_LL_STOPPED 2                 /* stop_after reached, checkpoint saved */
+#define Z5D_LL_FFT_THRESHOLD 200000      /* AUTO picks the FFT engine from this p */
+#define Z5D_LL_CHECKPOINT_EVERY 10000    /* Default iterations between saves */
+#define Z5D_LL_MAX_P 2000000000ULL       /* Largest exponent accepted */
+
+typedef enum {
+    Z5D_LL_AUTO = 0,  /* GMP below Z5D_LL_FFT_THRESHOLD, FFT above */
+    Z5D_LL_GMP,       /* mpz_mul with the fold at bit p */
+    Z5D_LL_FFT        /* Weighted four-step FFT (GMP for p < 128) */
+} z5d_ll_engine_t;
+
+/**
+ * Lucas-Lehmer options
+ */
+typedef struct {
+    z5d_ll_engine_t engine;
+    unsigned int threads;          /* FFT worker threads (1 = serial) */
+    const char* checkpoint_path;   /* Resume from and save to this file, or NULL */
+    uint64_t checkpoint_every;     /* Iterations between saves, 0 for the default */
+    uint64_t stop_after;           /* Return Z5D_LL_STOPPED after this many, 0 = run to the end */
+} z5d_ll_config_t;
+
+/**
+ * Lucas-Lehmer run report
+ */
+typedef struct {
+    z5d_ll_engine_t engine;   /* Engine that ran */
+    size_t fft_length;        /* Final transform length (0 for GMP) */
+    uint64_t resumed_at;      /* Iteration loaded from the checkpoint, 0 if none */
+    uint64_t iterations;      /* Iterations done so far, of p - 2 */
+    double max_roundoff;      /* Worst accepted distance to an integer (FFT) */
+    unsigned int fft_grows;   /* Times the length was doubled for roundoff */
+    uint64_t res64;           /* Low 64 bits of the residue */
+} z5d_ll_stats_t;
+
+/**
+ * Default options: AUTO engine, one thread, no checkpoint.
+ *
+ * @param config Options to initialize
+ */
+void z5d_ll_config_init(z5d_ll_config_t* config);
+
+/**
+ * Lucas-Lehmer test of 2^p - 1. Composite p is answered without iterating.
+ * With a checkpoint path, an existing file for the same p is resumed and a
+ * save is written every checkpoint_every iterations and on return.
+ *
+ * @param p Exponent (<= Z5D_LL_MAX_P)
+ * @param config Options, or NULL for the defaults
+ * @param stats Output report, or NULL
+ * @return Z5D_LL_PRIME, Z5D_LL_COMPOSITE, Z5D_LL_STOPPED, or -1 on
+ *         allocation or I/O failure, p too large, or a checkpoint for
+ *         another p or not a checkpoint
+ */
+int z5d_lucas_lehmer(uint64_t p, const z5d_ll_config_t* config, z5d_ll_stats_t* stats);
+
+/*
+ * Allocation hooks. GMP and MPFR take all limb storage, MPFR's scratch
+ * included, through mp_set_memory_functions; installing a hook there lets
+ * the context stats count allocations per call, and the pool keeps the
+ * steady state of repeated predictions off malloc.
+ */
+
+#define Z5D_MEM_MAX_CLASS_BYTES 65536    /* Larger blocks go straight to malloc */
+#define Z5D_MEM_CACHE_BLOCKS 64          /* Free blocks kept per size class and thread */
+
+/**
+ * Install the allocation hook once per process. COUNT may be installed at
+ * any time. POOL must be installed before the first GMP or MPFR allocation
+ * of the process (first thing in main): a block allocated by another
+ * allocator must never reach the pool. Installing the installed mode again
+ * is a no-op.
+ *
+ * @param mode Hook to install
+ * @return 0 on success, -1 if a different mode is already installed
+ */
+int z5d_mem_install(z5d_mem_mode_t mode);
+
+/**
+ * Installed hook.
+ *
+ * @return z5d_mem_mode_t value, or -1 when none is installed
+ */
+int z5d_mem_mode(void);
+
+/**
+ * Allocation counters of the calling thread.
+ *
+ * @param stats Output counters
+ */
+void z5d_mem_thread_stats(z5d_mem_stats_t* stats);
+
+/**
+ * Return the calling thread's cached blocks to malloc. Called by
+ * z5d_cleanup() and at thread exit.
+ */
+void z5d_mem_thread_trim(void);
+
 /* Legacy helpers retained for compatibility with existing math utilities */
 int z5d_mobius(int n);
 void z5d_riemann_R(mpfr_t rop, const mpfr_t x, int K, mpfr_prec_t prec);
@@ -0,0 +1,175 @@
+/**
+ * Z5D Anchor Index - Memory-Mapped (n, p_n) Checkpoints
+ * =====================================================
+ *
+ * A compact file of exact p_n at every stride-th index, mapped read-only so
+ * that processes share one page-cache copy. Anchors are delta-encoded: one
+ * absolute uint64 per Z5D_ANCHOR_BLOCK anchors plus a uint32 gap per anchor,
+ * so decoding an anchor sums at most 63 gaps. The spacing is uniform, so the
+ * nearest anchor is found by division rather than a search.
+ *
+ * The exact nth-prime mode walks from the nearest anchor to p_n with the
+ * complete segmented sieve of z5d_exact.c, skipping pi() entirely.
+ *
+ * @file z5d_anchor.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include "z5d_exact.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ANCHOR_MAGIC "Z5DANCH1"
+#define ANCHOR_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t block;
+    uint64_t stride;
+    uint64_t count;
+    uint64_t reserved[4];
+} anchor_header_t;
+
+static uint64_t anchor_blocks(uint64_t count) {
+    return (count + Z5D_ANCHOR_BLOCK - 1) / Z5D_ANCHOR_BLOCK;
+}
+
+int z5d_anchor_open(z5d_anchor_index_t* index, const char* path) {
+    memset(index, 0, sizeof(*index));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(anchor_header_t)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);   /* the mapping keeps the file referenced */
+    if (map == MAP_FAILED) return -1;
+
+    const anchor_header_t* h = (const anchor_header_t*)map;
+    uint64_t nblocks = anchor_blocks(h->count);
+    /* A byte-swapped file fails the version / block check */
+    if (memcmp(h->magic, ANCHOR_MAGIC, 8) != 0 || h->version != ANCHOR_VERSION ||
+        h->block != Z5D_ANCHOR_BLOCK || h->stride == 0 || h->count == 0 ||
+        h->count > (UINT64_MAX / 2) / h->stride ||
+        size != sizeof(anchor_header_t) + nblocks * sizeof(uint64_t) +
+                h->count * sizeof(uint32_t)) {
+        munmap(map, size);
+        return -1;
+    }
+    index->map = map;
+    index->map_size = size;
+    index->stride = h->stride;
+    index->count = h->count;
+    index->blocks = (const uint64_t*)((const char*)map + sizeof(anchor_header_t));
+    index->deltas = (const uint32_t*)(index->blocks + nblocks);
+    return 0;
+}
+
+void z5d_anchor_close(z5d_anchor_index_t* index) {
+    if (index->map) munmap((void*)index->map, index->map_size);
+    memset(index, 0, sizeof(*index));
+}
+
+/* p of anchor i (1-based) */
+static uint64_t anchor_value(const z5d_anchor_index_t* index, uint64_t i) {
+    uint64_t j = i - 1;
+    uint64_t first = j - j % Z5D_ANCHOR_BLOCK;
+    uint64_t p = index->blocks[j / Z5D_ANCHOR_BLOCK];
+    for (uint64_t t = first + 1; t <= j; t++) p += index->deltas[t];
+    return p;
+}
+
+int z5d_anchor_nearest(const z5d_anchor_index_t* index, uint64_t n,
+                       uint64_t* anchor_n, uint64_t* anchor_p) {
+    if (!index->map || n == 0) return -1;
+    uint64_t i = n / index->stride;
+    if (n % index->stride >= index->stride - index->stride / 2) i++;   /* round half up */
+    if (i == 0) i = 1;
+    if (i > index->count) {
+        /* Past the last anchor by more than half a stride */
+        if (n - index->count * index->stride > index->stride / 2) return -1;
+        i = index->count;
+    }
+    *anchor_n = i * index->stride;
+    *anchor_p = anchor_value(index, i);
+    return 0;
+}
+
+/* --------- Building an index --------- */
+
+/* pi(65536) and the largest prime below it: where the walker can start */
+#define ANCHOR_WALK_START_N 6542ULL
+#define ANCHOR_WALK_START_P 65521ULL
+
+int z5d_anchor_build(const char* path, uint64_t stride, uint64_t max_n,
+                     void (*progress)(uint64_t done, uint64_t total, void* arg), void* arg) {
+    if (stride == 0 || max_n < stride || max_n > Z5D_EXACT_MAX_N) return -1;
+    uint64_t count = max_n / stride;
+    uint64_t nblocks = anchor_blocks(count);
+    uint64_t* blocks = calloc(nblocks, sizeof(uint64_t));
+    uint32_t* deltas = calloc(count, sizeof(uint32_t));
+    if (!blocks || !deltas) {
+        free(blocks);
+        free(deltas);
+        return -1;
+    }
+
+    z5d_walk_t w;
+    z5d_walk_init(&w);
+    int ret = 0;
+    uint64_t cur_n = ANCHOR_WALK_START_N, cur_p = ANCHOR_WALK_START_P, prev_p = 0;
+    for (uint64_t i = 1; i <= count; i++) {
+        uint64_t n = i * stride, p;
+        if (n <= ANCHOR_WALK_START_N) {
+            p = z5d_exact_nth_prime_small(n);
+        } else {
+            p = z5d_walk(&w, cur_p, n - cur_n, 1);
+            cur_n = n;
+            cur_p = p;
+        }
+        if (p == 0 || (prev_p && p - prev_p > UINT32_MAX)) {
+            ret = -1;
+            break;
+        }
+        uint64_t j = i - 1;
+        if (j % Z5D_ANCHOR_BLOCK == 0) blocks[j / Z5D_ANCHOR_BLOCK] = p;
+        else deltas[j] = (uint32_t)(p - prev_p);
+        prev_p = p;
+        if (progress && (i % Z5D_ANCHOR_BLOCK == 0 || i == count)) progress(i, count, arg);
+    }
+    z5d_walk_clear(&w);
+
+    if (ret == 0) {
+        anchor_header_t h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, ANCHOR_MAGIC, 8);
+        h.version = ANCHOR_VERSION;
+        h.block = Z5D_ANCHOR_BLOCK;
+        h.stride = stride;
+        h.count = count;
+        FILE* f = fopen(path, "wb");
+        if (!f) {
+            ret = -1;
+        } else {
+            if (fwrite(&h, sizeof(h), 1, f) != 1 ||
+                fwrite(blocks, sizeof(uint64_t), nblocks, f) != nblocks ||
+                fwrite(deltas, sizeof(uint32_t), count, f) != count) {
+                ret = -1;
+            }
+            if (fclose(f) != 0) ret = -1;
+        }
+    }
+    free(blocks);
+    free(deltas);
+    return ret;
+}
@@ -0,0 +1,96 @@
+/**
+ * Z5D nth-Prime Predictor - Anchor Index Generator
+ * ================================================
+ *
+ * Writes the memory-mapped (n, p_n) anchor index read by z5d_anchor_open.
+ * Sieves from the first anchor through p_(max_n) on one core; every 2^20
+ * indices up to 10^12 means sieving to ~3 * 10^13 and takes hours, so build
+ * it once and share the file.
+ *
+ * @file z5d_anchor_gen.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+static double now_s(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+typedef struct {
+    double t0;
+    uint64_t stride;
+} progress_t;
+
+static void report(uint64_t done, uint64_t total, void* arg) {
+    progress_t* pr = (progress_t*)arg;
+    static double last = 0.0;
+    double t = now_s() - pr->t0;
+    if (done != total && t - last < 5.0) return;
+    last = t;
+    double eta = (done > 0) ? t * (double)(total - done) / (double)done : 0.0;
+    fprintf(stderr, "\r  %llu / %llu anchors (n = %llu), %.0f s elapsed, ~%.0f s left   ",
+            (unsigned long long)done, (unsigned long long)total,
+            (unsigned long long)(done * pr->stride), t, eta);
+    if (done == total) fprintf(stderr, "\n");
+}
+
+static void print_usage(const char* prog_name) {
+    printf("Z5D anchor index generator v%s\n", z5d_get_version());
+    printf("Usage: %s [options] <output file>\n", prog_name);
+    printf("\nOptions:\n");
+    printf("  -s <stride>   Index spacing of the anchors (default: 1048576)\n");
+    printf("  -n <max_n>    Last index covered (default: 1000000000000)\n");
+    printf("  -h            Show this help\n");
+    printf("\nExamples:\n");
+    printf("  %s anchors.z5d\n", prog_name);
+    printf("  %s -s 65536 -n 1000000000 anchors-1e9.z5d\n", prog_name);
+}
+
+int main(int argc, char** argv) {
+    uint64_t stride = 1ULL << 20;
+    uint64_t max_n = 1000000000000ULL;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            stride = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            max_n = strtoull(argv[++i], NULL, 10);
+        } else if (argv[i][0] != '-') {
+            path = argv[i];
+        }
+    }
+    if (!path || stride == 0 || max_n < stride) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    printf("Building anchor index: stride %llu, %llu anchors up to n = %llu\n",
+           (unsigned long long)stride, (unsigned long long)(max_n / stride),
+           (unsigned long long)max_n);
+    progress_t pr = { now_s(), stride };
+    if (z5d_anchor_build(path, stride, max_n, report, &pr) != 0) {
+        fprintf(stderr, "Error: could not build %s\n", path);
+        return 1;
+    }
+
+    z5d_anchor_index_t index;
+    if (z5d_anchor_open(&index, path) != 0) {
+        fprintf(stderr, "Error: %s does not read back\n", path);
+        return 1;
+    }
+    printf("Wrote %s: %zu bytes, %.1f s\n", path, index.map_size, now_s() - pr.t0);
+    z5d_anchor_close(&index);
+    return 0;
+}
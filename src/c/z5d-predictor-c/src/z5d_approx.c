@@ -0,0 +1,170 @@
+/**
+ * Z5D Bulk Approximate Predictor
+ * ==============================
+ *
+ * The unrounded closed form as a double for whole arrays of uint64 indices,
+ * for consumers that need the estimate and not a confirmed prime: QMC seed
+ * grids, band summaries, calibration residual maps. No MPFR, no error bound
+ * per value and no rounding; see z5d_predict_approx_u64 for the accuracy.
+ *
+ * The kernel body is z5d_approx_kernel.h, instantiated here once per
+ * instruction set: a two-lane baseline kernel, AVX2 + FMA and AVX-512F on
+ * x86-64, and Advanced SIMD on AArch64. The widest kernel the CPU runs is
+ * picked on first use.
+ *
+ * @file z5d_approx.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define APPROX_HAVE_X86 1
+#else
+#define APPROX_HAVE_X86 0
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define APPROX_HAVE_NEON 1
+#else
+#define APPROX_HAVE_NEON 0
+#endif
+
+/* fdlibm e_log.c: ln 2 split so that k * LN2_HI is exact, and the
+   coefficients of R(z) ~ ln(1 + f) - f + f^2 / 2 in z = s^2 */
+#define APPROX_LN2_HI 6.93147180369123816490e-01
+#define APPROX_LN2_LO 1.90821492927058770002e-10
+#define APPROX_LG1 6.666666666666735130e-01
+#define APPROX_LG2 3.999999999940941908e-01
+#define APPROX_LG3 2.857142874366239149e-01
+#define APPROX_LG4 2.222219843214978396e-01
+#define APPROX_LG5 1.818357216161805012e-01
+#define APPROX_LG6 1.531383769920937332e-01
+#define APPROX_LG7 1.479819860511658591e-01
+
+#define APPROX_LOG2E 0x1.71547652b82fep0
+#define APPROX_SHIFT 0x1.8p52                    /* Adds round-to-integer */
+#define APPROX_SHIFT_BITS 0x4338000000000000LL   /* Its bit pattern */
+
+/* Calibration constants, as in z5d_fast.c */
+#define APPROX_INV_E4 0x1.2c155b8213cf4p-6       /* exp(-4) */
+#define APPROX_C_CAL (Z5D_C_CAL_LITERAL)
+#define APPROX_KAPPA_STAR (Z5D_KAPPA_STAR_LITERAL)
+
+#define APPROX_WIDTH 2
+#define APPROX_NAME approx_generic
+#define APPROX_TARGET
+#include "z5d_approx_kernel.h"
+#undef APPROX_WIDTH
+#undef APPROX_NAME
+#undef APPROX_TARGET
+
+#if APPROX_HAVE_X86
+#define APPROX_WIDTH 4
+#define APPROX_NAME approx_avx2
+#define APPROX_TARGET __attribute__((target("avx2,fma")))
+#include "z5d_approx_kernel.h"
+#undef APPROX_WIDTH
+#undef APPROX_NAME
+#undef APPROX_TARGET
+
+#define APPROX_WIDTH 8
+#define APPROX_NAME approx_avx512
+#define APPROX_TARGET __attribute__((target("avx512f")))
+#include "z5d_approx_kernel.h"
+#undef APPROX_WIDTH
+#undef APPROX_NAME
+#undef APPROX_TARGET
+#endif
+
+#if APPROX_HAVE_NEON
+/* Advanced SIMD is baseline on AArch64; four lanes keep two 128-bit
+   operations in flight per step */
+#define APPROX_WIDTH 4
+#define APPROX_NAME approx_neon
+#define APPROX_TARGET
+#include "z5d_approx_kernel.h"
+#undef APPROX_WIDTH
+#undef APPROX_NAME
+#undef APPROX_TARGET
+#endif
+
+typedef void (*approx_fn)(const uint64_t* n, double* out, size_t count);
+
+static pthread_once_t approx_once = PTHREAD_ONCE_INIT;
+static z5d_approx_kernel_t approx_best = Z5D_APPROX_GENERIC;
+
+static void approx_pick(void) {
+#if APPROX_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        approx_best = Z5D_APPROX_AVX512;
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        approx_best = Z5D_APPROX_AVX2;
+    }
+#elif APPROX_HAVE_NEON
+    approx_best = Z5D_APPROX_NEON;
+#endif
+}
+
+z5d_approx_kernel_t z5d_approx_kernel(void) {
+    pthread_once(&approx_once, approx_pick);
+    return approx_best;
+}
+
+int z5d_approx_kernel_supported(z5d_approx_kernel_t kernel) {
+    if (kernel == Z5D_APPROX_AUTO || kernel == Z5D_APPROX_GENERIC) return 1;
+    z5d_approx_kernel_t best = z5d_approx_kernel();
+    if (kernel == Z5D_APPROX_AVX2) return best == Z5D_APPROX_AVX2 || best == Z5D_APPROX_AVX512;
+    return kernel == best;
+}
+
+const char* z5d_approx_kernel_name(z5d_approx_kernel_t kernel) {
+    switch (kernel) {
+        case Z5D_APPROX_AUTO: return z5d_approx_kernel_name(z5d_approx_kernel());
+        case Z5D_APPROX_GENERIC: return "generic";
+        case Z5D_APPROX_AVX2: return "avx2";
+        case Z5D_APPROX_AVX512: return "avx512";
+        case Z5D_APPROX_NEON: return "neon";
+    }
+    return "unknown";
+}
+
+static approx_fn approx_lookup(z5d_approx_kernel_t kernel) {
+    if (kernel == Z5D_APPROX_AUTO) kernel = z5d_approx_kernel();
+    if (!z5d_approx_kernel_supported(kernel)) return NULL;
+    switch (kernel) {
+#if APPROX_HAVE_X86
+        case Z5D_APPROX_AVX2: return approx_avx2;
+        case Z5D_APPROX_AVX512: return approx_avx512;
+#endif
+#if APPROX_HAVE_NEON
+        case Z5D_APPROX_NEON: return approx_neon;
+#endif
+        case Z5D_APPROX_GENERIC: return approx_generic;
+        default: return NULL;
+    }
+}
+
+int z5d_predict_approx_u64_with(z5d_approx_kernel_t kernel, const uint64_t* n, double* out,
+                                size_t count) {
+    approx_fn fn = approx_lookup(kernel);
+    if (!fn || (count && (!n || !out))) return -1;
+    fn(n, out, count);
+
+    /* The kernels assume n >= 5; the closed form is negative below that */
+    uint64_t small = 0;
+    for (size_t i = 0; i < count; i++) small |= (n[i] < Z5D_APPROX_MIN_N);
+    if (!small) return 0;
+    for (size_t i = 0; i < count; i++) {
+        if (n[i] < Z5D_APPROX_MIN_N) out[i] = NAN;
+    }
+    return -1;
+}
+
+int z5d_predict_approx_u64(const uint64_t* n, double* out, size_t count) {
+    return z5d_predict_approx_u64_with(Z5D_APPROX_AUTO, n, out, count);
+}
@@ -0,0 +1,141 @@
+/**
+ * Z5D Bulk Approximate Predictor - Kernel Template
+ * ================================================
+ *
+ * Closed form (PNT + d-term + e-term) over APPROX_WIDTH lanes of GCC/Clang
+ * vector extensions, so one body serves every instruction set. Included by
+ * z5d_approx.c once per kernel with:
+ *
+ *   APPROX_WIDTH   lanes per vector (1, 2, 4 or 8)
+ *   APPROX_NAME    name of the generated kernel function
+ *   APPROX_TARGET  function attributes selecting the instruction set
+ *
+ * Every step is lane-wise arithmetic, compares and bit operations; no libm
+ * call and no gather, so the compiler keeps the whole formula in vector
+ * registers. Elementary functions:
+ *
+ *   log  fdlibm's reduction m in [sqrt(2)/2, sqrt(2)), s = f / (2 + f) and
+ *        its degree-14 minimax polynomial; below 1 ulp
+ *   exp  t = k ln 2 + r, |r| <= ln 2 / 2, Taylor to r^13 (tail < 2^-57),
+ *        scaled by adding k to the exponent field; below 1 ulp
+ *
+ * The e-term's pnt^(2/3) is exp(2/3 ln pnt), reusing the logarithm the
+ * d-term needs rather than a third function. Lanes need n >= 5, where pnt
+ * and every logarithm argument are positive normal doubles; the caller
+ * fixes up smaller n.
+ *
+ * @file z5d_approx_kernel.h
+ * @version 1.0
+ */
+
+#define APPROX_CAT_(a, b) a##b
+#define APPROX_CAT(a, b) APPROX_CAT_(a, b)
+#define APPROX_FN(suffix) APPROX_CAT(APPROX_NAME, suffix)
+
+#define VD APPROX_FN(_vd)
+#define VI APPROX_FN(_vi)
+#define VU APPROX_FN(_vu)
+
+typedef double VD __attribute__((vector_size(APPROX_WIDTH * 8)));
+typedef int64_t VI __attribute__((vector_size(APPROX_WIDTH * 8)));
+typedef uint64_t VU __attribute__((vector_size(APPROX_WIDTH * 8)));
+
+/* Signed integer to double for |e| < 2^51 */
+static inline APPROX_TARGET VD APPROX_FN(_i2d)(VI e) {
+    return (VD)(e + APPROX_SHIFT_BITS) - APPROX_SHIFT;
+}
+
+/* uint64 to double, correctly rounded: both halves convert exactly and the
+   sum rounds once */
+static inline APPROX_TARGET VD APPROX_FN(_u2d)(VU n) {
+    VD lo = (VD)((n & 0xffffffffULL) | 0x4330000000000000ULL) - 0x1p52;
+    VD hi = (VD)((n >> 32) | 0x4530000000000000ULL) - 0x1p84;
+    return hi + lo;
+}
+
+/* ln x for positive normal x */
+static inline APPROX_TARGET VD APPROX_FN(_log)(VD x) {
+    VI bits = (VI)x;
+    VI mant = bits & 0x000fffffffffffffLL;
+    VI halve = mant > 0x6a09e667f3bccLL;                 /* m > sqrt(2): take m / 2 */
+    VI e = (VI)((VU)bits >> 52) - 1023 - halve;          /* halve is -1 or 0 */
+    VD m = (VD)(mant | (0x3ff0000000000000LL + (halve & -0x0010000000000000LL)));
+
+    VD f = m - 1.0;
+    VD s = f / (f + 2.0);
+    VD z = s * s;
+    VD w = z * z;
+    VD t1 = w * (APPROX_LG2 + w * (APPROX_LG4 + w * APPROX_LG6));
+    VD t2 = z * (APPROX_LG1 + w * (APPROX_LG3 + w * (APPROX_LG5 + w * APPROX_LG7)));
+    VD R = t2 + t1;
+    VD hfsq = 0.5 * f * f;
+    VD dk = APPROX_FN(_i2d)(e);
+    return dk * APPROX_LN2_HI - ((hfsq - (s * (hfsq + R) + dk * APPROX_LN2_LO)) - f);
+}
+
+/* e^t for |t| < 700 */
+static inline APPROX_TARGET VD APPROX_FN(_exp)(VD t) {
+    VD kd = t * APPROX_LOG2E + APPROX_SHIFT;             /* k = round(t / ln 2) */
+    VD kf = kd - APPROX_SHIFT;
+    VI k = (VI)kd - APPROX_SHIFT_BITS;
+    VD r = (t - kf * APPROX_LN2_HI) - kf * APPROX_LN2_LO;
+
+    VD p = r * (1.0 / 6227020800.0) + 1.0 / 479001600.0;
+    p = 1.0 / 39916800.0 + r * p;
+    p = 1.0 / 3628800.0 + r * p;
+    p = 1.0 / 362880.0 + r * p;
+    p = 1.0 / 40320.0 + r * p;
+    p = 1.0 / 5040.0 + r * p;
+    p = 1.0 / 720.0 + r * p;
+    p = 1.0 / 120.0 + r * p;
+    p = 1.0 / 24.0 + r * p;
+    p = 1.0 / 6.0 + r * p;
+    p = 0.5 + r * p;
+    p = 1.0 + r * p;
+    p = 1.0 + r * p;
+    return (VD)((VI)p + (k << 52));
+}
+
+/* Unrounded closed form at each lane's n */
+static inline APPROX_TARGET VD APPROX_FN(_closed_form)(VU n) {
+    VD k = APPROX_FN(_u2d)(n);
+    VD L = APPROX_FN(_log)(k);
+    VD LL = APPROX_FN(_log)(L);
+    VD B = (L + LL - 1.0) + (LL - 2.0) / L;
+    VD pnt = k * B;
+
+    VD lp = APPROX_FN(_log)(pnt);
+    VD q = lp * APPROX_INV_E4;
+    VD d = q * q * pnt * APPROX_C_CAL;
+    d = (VD)((VI)d & (lp > 0.0));                        /* No d-term for pnt <= 1 (n = 5) */
+    VD e = APPROX_FN(_exp)(lp * (2.0 / 3.0)) * APPROX_KAPPA_STAR;
+    return (pnt + d) + e;
+}
+
+static APPROX_TARGET void APPROX_NAME(const uint64_t* n, double* out, size_t count) {
+    size_t i = 0;
+    for (; i + APPROX_WIDTH <= count; i += APPROX_WIDTH) {
+        VU v;
+        memcpy(&v, n + i, sizeof(v));
+        VD r = APPROX_FN(_closed_form)(v);
+        memcpy(out + i, &r, sizeof(r));
+    }
+    if (i < count) {
+        /* Tail through a padded vector */
+        uint64_t pad[APPROX_WIDTH];
+        double res[APPROX_WIDTH];
+        for (size_t l = 0; l < APPROX_WIDTH; l++) pad[l] = i + l < count ? n[i + l] : 5;
+        VU v;
+        memcpy(&v, pad, sizeof(v));
+        VD r = APPROX_FN(_closed_form)(v);
+        memcpy(res, &r, sizeof(r));
+        for (size_t l = 0; i + l < count; l++) out[i + l] = res[l];
+    }
+}
+
+#undef VD
+#undef VI
+#undef VU
+#undef APPROX_FN
+#undef APPROX_CAT
+#undef APPROX_CAT_
@@ -0,0 +1,410 @@
+/**
+ * Z5D Asynchronous Jobs - Deadline-Bounded, Cancellable Predictions
+ * =================================================================
+ *
+ * A library-owned pool of worker threads runs big-n predictions in the
+ * background. Each worker owns a FIFO queue and a warm context for jobs
+ * without a configuration. Submissions are dealt round-robin; a worker
+ * whose queue is empty steals the oldest job from the longest other queue,
+ * so a job never waits behind a long refinement while a worker is idle.
+ *
+ * A job runs z5d_predict_staged_ctx with its context's sieve.stop pointed
+ * at the job's cancel flag. The rounded closed form is published as soon
+ * as it is known, so a waiter whose deadline passes gets it with
+ * Z5D_JOB_ESTIMATE while the refinement goes on. z5d_cancel raises the
+ * flag; the search reads it before every probable-prime test.
+ *
+ * A job is referenced by its handle and, until it ends, by the pool; the
+ * last of the two to let go frees it.
+ *
+ * Lock order: pool lock, then a worker's queue lock, then a job lock.
+ *
+ * @file z5d_async.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include "z5d_async.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define JOB_QUEUED 0
+#define JOB_RUNNING 1
+#define JOB_ENDED 2
+
+struct z5d_job {
+    z5d_job_t* next;         /* Queue link */
+    mpz_t n, prime, estimate;
+    z5d_ctx_t* ctx;          /* Own context (config given), or NULL for the worker's */
+    int cancel;              /* Raised by z5d_cancel; read by the search */
+    /* Guarded by lock */
+    pthread_mutex_t lock;
+    pthread_cond_t ended;
+    int state;
+    int status;              /* Z5D_JOB_DONE / Z5D_JOB_CANCELLED once ended */
+    int has_estimate;
+    int refs;
+};
+
+typedef struct {
+    pthread_t tid;
+    int started;
+    pthread_mutex_t lock;    /* Guards the queue and current */
+    z5d_job_t *head, *tail;
+    size_t length;           /* Written under lock, read by thieves without it */
+    z5d_job_t* current;      /* Job running on this worker */
+    z5d_ctx_t ctx;           /* Warm context for jobs without a configuration */
+} pool_worker_t;
+
+static struct {
+    pthread_mutex_t lock;    /* Guards start/stop and the sleep on wake */
+    pthread_cond_t wake;
+    pool_worker_t* workers;
+    int threads;
+    int running;
+    int stopping;
+    _Atomic long queued;     /* Jobs in all queues (may dip below 0 for an instant) */
+    _Atomic unsigned next;   /* Round-robin submission cursor */
+} g_pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, 0, 0, 0, 0, 0};
+
+/* --------- Jobs --------- */
+
+static void job_unref(z5d_job_t* job) {
+    pthread_mutex_lock(&job->lock);
+    int last = --job->refs == 0;
+    pthread_mutex_unlock(&job->lock);
+    if (!last) return;
+    if (job->ctx) {
+        z5d_ctx_clear(job->ctx);
+        free(job->ctx);
+    }
+    mpz_clears(job->n, job->prime, job->estimate, NULL);
+    pthread_cond_destroy(&job->ended);
+    pthread_mutex_destroy(&job->lock);
+    free(job);
+}
+
+/* Record the outcome, wake waiters and drop the pool's reference */
+static void job_end(z5d_job_t* job, int status) {
+    pthread_mutex_lock(&job->lock);
+    if (job->state != JOB_ENDED) {
+        job->state = JOB_ENDED;
+        job->status = status;
+        pthread_cond_broadcast(&job->ended);
+    }
+    pthread_mutex_unlock(&job->lock);
+    job_unref(job);
+}
+
+static void job_publish_estimate(void* arg, const mpz_t estimate) {
+    z5d_job_t* job = (z5d_job_t*)arg;
+    pthread_mutex_lock(&job->lock);
+    mpz_set(job->estimate, estimate);
+    job->has_estimate = 1;
+    pthread_mutex_unlock(&job->lock);
+}
+
+/* Forget w's current job before the pool's reference to it is dropped,
+   so z5d_async_stop never raises the flag of a freed job */
+static void worker_release_current(pool_worker_t* w) {
+    pthread_mutex_lock(&w->lock);
+    w->current = NULL;
+    pthread_mutex_unlock(&w->lock);
+}
+
+static void job_run(pool_worker_t* w, z5d_job_t* job) {
+    pthread_mutex_lock(&job->lock);
+    int skip = job->state == JOB_ENDED;   /* Cancelled while queued */
+    if (!skip) job->state = JOB_RUNNING;
+    pthread_mutex_unlock(&job->lock);
+    if (skip) {
+        worker_release_current(w);
+        job_unref(job);
+        return;
+    }
+
+    /* A job stolen while z5d_async_stop scanned the workers missed its flag */
+    if (__atomic_load_n(&g_pool.stopping, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&job->cancel, 1, __ATOMIC_RELAXED);
+    }
+    z5d_ctx_t* ctx = job->ctx ? job->ctx : &w->ctx;
+    ctx->sieve.stop = &job->cancel;
+    int rc = __atomic_load_n(&job->cancel, __ATOMIC_RELAXED)
+                 ? 1
+                 : z5d_predict_staged_ctx(ctx, job->prime, job->n, job_publish_estimate, job);
+    ctx->sieve.stop = NULL;
+    worker_release_current(w);
+    job_end(job, rc == 0 ? Z5D_JOB_DONE : Z5D_JOB_CANCELLED);
+}
+
+/* --------- Queues --------- */
+
+static void queue_push(pool_worker_t* w, z5d_job_t* job) {
+    job->next = NULL;
+    if (w->tail) w->tail->next = job;
+    else w->head = job;
+    w->tail = job;
+    __atomic_store_n(&w->length, w->length + 1, __ATOMIC_RELAXED);
+}
+
+/* Oldest job of w, or NULL; caller holds w->lock */
+static z5d_job_t* queue_pop(pool_worker_t* w) {
+    z5d_job_t* job = w->head;
+    if (!job) return NULL;
+    w->head = job->next;
+    if (!w->head) w->tail = NULL;
+    __atomic_store_n(&w->length, w->length - 1, __ATOMIC_RELAXED);
+    atomic_fetch_sub(&g_pool.queued, 1);
+    return job;
+}
+
+/* Own queue first, then the longest other queue. The lengths are read
+   without locks, so a steal may find the victim already emptied. */
+static z5d_job_t* take_job(pool_worker_t* self) {
+    pthread_mutex_lock(&self->lock);
+    z5d_job_t* job = queue_pop(self);
+    if (job) self->current = job;
+    pthread_mutex_unlock(&self->lock);
+    if (job) return job;
+
+    pool_worker_t* victim = NULL;
+    size_t longest = 0;
+    for (int i = 0; i < g_pool.threads; i++) {
+        pool_worker_t* v = &g_pool.workers[i];
+        size_t len = __atomic_load_n(&v->length, __ATOMIC_RELAXED);
+        if (v != self && len > longest) {
+            longest = len;
+            victim = v;
+        }
+    }
+    if (!victim) return NULL;
+    pthread_mutex_lock(&victim->lock);
+    job = queue_pop(victim);
+    pthread_mutex_unlock(&victim->lock);
+    if (job) {
+        pthread_mutex_lock(&self->lock);
+        self->current = job;
+        pthread_mutex_unlock(&self->lock);
+    }
+    return job;
+}
+
+static void* worker_main(void* p) {
+    pool_worker_t* w = (pool_worker_t*)p;
+    z5d_ctx_init(&w->ctx, NULL);
+    for (;;) {
+        z5d_job_t* job = take_job(w);
+        if (job) {
+            job_run(w, job);
+            continue;
+        }
+        pthread_mutex_lock(&g_pool.lock);
+        while (atomic_load(&g_pool.queued) <= 0 && !g_pool.stopping) {
+            pthread_cond_wait(&g_pool.wake, &g_pool.lock);
+        }
+        int stop = g_pool.stopping;
+        pthread_mutex_unlock(&g_pool.lock);
+        if (stop) break;
+    }
+    z5d_ctx_clear(&w->ctx);
+    z5d_cleanup();
+    return NULL;
+}
+
+/* --------- Pool --------- */
+
+/* Caller holds g_pool.lock */
+static int pool_start_locked(int threads) {
+    if (g_pool.running) return -1;
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)(cpus < Z5D_ASYNC_MAX_THREADS ? cpus : Z5D_ASYNC_MAX_THREADS)
+                           : 1;
+    }
+    if (threads > Z5D_ASYNC_MAX_THREADS) threads = Z5D_ASYNC_MAX_THREADS;
+
+    pool_worker_t* workers = calloc((size_t)threads, sizeof(*workers));
+    if (!workers) return -1;
+    g_pool.workers = workers;
+    g_pool.threads = threads;
+    g_pool.stopping = 0;
+    atomic_store(&g_pool.queued, 0);
+    for (int i = 0; i < threads; i++) pthread_mutex_init(&workers[i].lock, NULL);
+
+    /* Workers scan g_pool.workers, so all slots exist before any thread runs */
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        workers[i].started = pthread_create(&workers[i].tid, NULL, worker_main, &workers[i]) == 0;
+        started += workers[i].started;
+    }
+    if (started == 0) {
+        for (int i = 0; i < threads; i++) pthread_mutex_destroy(&workers[i].lock);
+        free(workers);
+        g_pool.workers = NULL;
+        g_pool.threads = 0;
+        return -1;
+    }
+    g_pool.running = 1;
+    return 0;
+}
+
+int z5d_async_start(int threads) {
+    pthread_mutex_lock(&g_pool.lock);
+    int rc = pool_start_locked(threads);
+    pthread_mutex_unlock(&g_pool.lock);
+    return rc;
+}
+
+void z5d_async_stop(void) {
+    pthread_mutex_lock(&g_pool.lock);
+    if (!g_pool.running || g_pool.stopping) {
+        pthread_mutex_unlock(&g_pool.lock);
+        return;
+    }
+    __atomic_store_n(&g_pool.stopping, 1, __ATOMIC_RELAXED);
+    /* Raise every flag so a job taken before the workers notice still stops */
+    for (int i = 0; i < g_pool.threads; i++) {
+        pool_worker_t* w = &g_pool.workers[i];
+        pthread_mutex_lock(&w->lock);
+        if (w->current) __atomic_store_n(&w->current->cancel, 1, __ATOMIC_RELAXED);
+        for (z5d_job_t* job = w->head; job; job = job->next) {
+            __atomic_store_n(&job->cancel, 1, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+    pthread_cond_broadcast(&g_pool.wake);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    /* Submissions are refused while stopping, so nothing is added meanwhile */
+    for (int i = 0; i < g_pool.threads; i++) {
+        if (g_pool.workers[i].started) pthread_join(g_pool.workers[i].tid, NULL);
+    }
+    for (int i = 0; i < g_pool.threads; i++) {
+        pool_worker_t* w = &g_pool.workers[i];
+        z5d_job_t* job;
+        while ((job = queue_pop(w)) != NULL) job_end(job, Z5D_JOB_CANCELLED);
+        pthread_mutex_destroy(&w->lock);
+    }
+
+    pthread_mutex_lock(&g_pool.lock);
+    free(g_pool.workers);
+    g_pool.workers = NULL;
+    g_pool.threads = 0;
+    g_pool.running = 0;
+    g_pool.stopping = 0;
+    pthread_mutex_unlock(&g_pool.lock);
+}
+
+/* --------- Public API --------- */
+
+int z5d_submit(z5d_job_t** job_out, const mpz_t n, const z5d_config_t* config) {
+    *job_out = NULL;
+    if (mpz_sgn(n) <= 0) return -1;
+
+    z5d_job_t* job = calloc(1, sizeof(*job));
+    if (!job) return -1;
+    if (config) {
+        job->ctx = malloc(sizeof(*job->ctx));
+        if (!job->ctx) {
+            free(job);
+            return -1;
+        }
+        z5d_ctx_init(job->ctx, config);
+    }
+    mpz_init_set(job->n, n);
+    mpz_inits(job->prime, job->estimate, NULL);
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_cond_init(&job->ended, NULL);
+    job->state = JOB_QUEUED;
+    job->refs = 2;   /* Handle + pool */
+
+    pthread_mutex_lock(&g_pool.lock);
+    if (g_pool.stopping || (!g_pool.running && pool_start_locked(0) != 0)) {
+        pthread_mutex_unlock(&g_pool.lock);
+        job->refs = 1;
+        job_unref(job);
+        return -1;
+    }
+    /* Round-robin over workers whose thread started */
+    pool_worker_t* w;
+    do {
+        w = &g_pool.workers[atomic_fetch_add(&g_pool.next, 1) % (unsigned)g_pool.threads];
+    } while (!w->started);
+    pthread_mutex_lock(&w->lock);
+    queue_push(w, job);
+    pthread_mutex_unlock(&w->lock);
+    atomic_fetch_add(&g_pool.queued, 1);
+    pthread_cond_signal(&g_pool.wake);
+    pthread_mutex_unlock(&g_pool.lock);
+
+    *job_out = job;
+    return 0;
+}
+
+/* Status of an unended or ended job; caller holds job->lock */
+static int job_status_locked(z5d_job_t* job, mpz_t prime_out) {
+    if (job->state == JOB_ENDED) {
+        if (job->status == Z5D_JOB_DONE && prime_out) mpz_set(prime_out, job->prime);
+        return job->status;
+    }
+    if (!job->has_estimate) return Z5D_JOB_PENDING;
+    if (prime_out) mpz_set(prime_out, job->estimate);
+    return Z5D_JOB_ESTIMATE;
+}
+
+int z5d_wait_until(z5d_job_t* job, const struct timespec* deadline, mpz_t prime_out) {
+    pthread_mutex_lock(&job->lock);
+    while (job->state != JOB_ENDED) {
+        if (!deadline) {
+            pthread_cond_wait(&job->ended, &job->lock);
+        } else if (pthread_cond_timedwait(&job->ended, &job->lock, deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    int status = job_status_locked(job, prime_out);
+    pthread_mutex_unlock(&job->lock);
+    return status;
+}
+
+int z5d_poll(z5d_job_t* job, mpz_t prime_out) {
+    pthread_mutex_lock(&job->lock);
+    int status = job_status_locked(job, prime_out);
+    pthread_mutex_unlock(&job->lock);
+    return status;
+}
+
+int z5d_cancel(z5d_job_t* job) {
+    __atomic_store_n(&job->cancel, 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&job->lock);
+    int ended = job->state == JOB_ENDED;
+    if (job->state == JOB_QUEUED) {
+        /* End it now; the worker that dequeues it only drops its reference */
+        job->state = JOB_ENDED;
+        job->status = Z5D_JOB_CANCELLED;
+        pthread_cond_broadcast(&job->ended);
+    }
+    pthread_mutex_unlock(&job->lock);
+    return ended;
+}
+
+void z5d_job_release(z5d_job_t* job) {
+    if (!job) return;
+    z5d_cancel(job);
+    job_unref(job);
+}
+
+void z5d_deadline_after(struct timespec* deadline, double ms) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    if (ms <= 0) return;
+    long long ns = (long long)(ms * 1e6);
+    deadline->tv_sec += (time_t)(ns / 1000000000LL);
+    deadline->tv_nsec += (long)(ns % 1000000000LL);
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
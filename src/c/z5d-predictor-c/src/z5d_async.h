@@ -0,0 +1,36 @@
+/**
+ * Z5D Asynchronous Jobs - Internal Header
+ * =======================================
+ *
+ * Staged big-n prediction used by the job pool in z5d_async.c: the rounded
+ * closed form is handed out before refinement starts, and the refinement
+ * stops when the context's sieve.stop flag is raised.
+ *
+ * @file z5d_async.h
+ * @version 1.0
+ */
+
+#ifndef Z5D_ASYNC_H
+#define Z5D_ASYNC_H
+
+#include "../include/z5d_predictor.h"
+
+/* Receives the rounded prediction of n before refinement starts */
+typedef void (*z5d_estimate_fn)(void* arg, const mpz_t estimate);
+
+/**
+ * z5d_predict_nth_prime_mpz_big_ctx with a hook between the stages. Table,
+ * anchor and cache answers skip the hook. With ctx->sieve.stop set, the
+ * refinement checks it before every probable-prime test.
+ *
+ * @param ctx Context (its sieve.stop may be set)
+ * @param prime_out Output prime, or the rounded prediction if stopped
+ * @param n Index (n >= 1)
+ * @param estimate Hook, or NULL
+ * @param arg Passed to the hook
+ * @return 0 when refined, 1 if stopped, -1 if n <= 0
+ */
+int z5d_predict_staged_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const mpz_t n,
+                           z5d_estimate_fn estimate, void* arg);
+
+#endif /* Z5D_ASYNC_H */
@@ -1,107 +1,569 @@
 /**
- * Z5D nth-Prime Predictor - Benchmark Tool
- * ========================================
- * 
- * Benchmarking tool for Z5D predictor performance testing.
- * 
+ * Z5D nth-Prime Predictor - Benchmark Harness
+ * ===========================================
+ *
+ * Repeated, warmed-up timings on a monotonic clock, reported as min /
+ * median / p90 / p99 per stage:
+ *
+ *   predict  unrounded closed form at the planned MPFR precision
+ *   round    rounding that value to an integer
+ *   refine   forward search to the next probable prime
+ *   total    the production entry point (fast tier, known table, anchors)
+ *
+ * Refinement takes seconds near 10^1233, so big-n points above
+ * --refine-max-exp time the first two stages only.
+ *
+ * Sweeps: uint64 indices 10^k + 1, k = 1..19 (off the known-value table),
+ * big-n exponents on the grid of scripts/benchmark_big_n.sh, and thread
+ * scaling of the full pipeline with one context per thread, and the bulk
+ * approximate predictor per SIMD kernel (time per value). Output as a text table, CSV or JSON, so release
+ * runs can be diffed for regressions.
+ *
+ * `--big-n` keeps the planned vs. bits(n) + 2048 precision comparison.
+ *
  * @file z5d_bench.c
- * @version 1.0
+ * @version 2.0
  */
 
 #include "../include/z5d_predictor.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <mpfr.h>
 
-/* Known prime values for validation */
-static const struct {
-    uint64_t n;
-    const char* prime_str;
-} known_primes[] = {
-    {10, "29"},
-    {100, "541"},
-    {1000, "7919"},
-    {10000, "104729"},
-    {100000, "1299709"},
-    {1000000, "15485863"},
-    {10000000, "179424673"},
-    {100000000, "2038074743"},
-    {1000000000, "22801763489"},
-    {0, NULL}  // Sentinel
-};
-
-static void run_benchmark(uint64_t n, const char* expected) {
-    z5d_config_t config;
-    z5d_result_t result;
-    
-    z5d_config_init(&config);
-    z5d_result_init(&result, Z5D_DEFAULT_PRECISION);
-    
-    printf("\n--- n = %llu ---\n", (unsigned long long)n);
-    
-    z5d_predict_nth_prime_ex(&result, n, &config);
-    
-    printf("Predicted: ");
-    mpfr_out_str(stdout, 10, 0, result.predicted_prime, MPFR_RNDN);
-    printf("\n");
-    
-    if (expected) {
-        printf("Expected:  %s\n", expected);
-        
-        // Calculate error
-        mpfr_t expected_mpfr, error, abs_error, rel_error;
-        mpfr_init2(expected_mpfr, Z5D_DEFAULT_PRECISION);
-        mpfr_init2(error, Z5D_DEFAULT_PRECISION);
-        mpfr_init2(abs_error, Z5D_DEFAULT_PRECISION);
-        mpfr_init2(rel_error, Z5D_DEFAULT_PRECISION);
-        
-        mpfr_set_str(expected_mpfr, expected, 10, MPFR_RNDN);
-        mpfr_sub(error, result.predicted_prime, expected_mpfr, MPFR_RNDN);
-        mpfr_abs(abs_error, error, MPFR_RNDN);
-        
-        // Relative error in ppm
-        mpfr_div(rel_error, error, expected_mpfr, MPFR_RNDN);
-        mpfr_mul_ui(rel_error, rel_error, 1000000, MPFR_RNDN);
-        
-        printf("Abs Error: ");
-        mpfr_out_str(stdout, 10, 0, abs_error, MPFR_RNDN);
-        printf("\n");
-        
-        printf("Rel Error: ");
-        mpfr_out_str(stdout, 10, 6, rel_error, MPFR_RNDN);
-        printf(" ppm\n");
-        
-        mpfr_clear(expected_mpfr);
-        mpfr_clear(error);
-        mpfr_clear(abs_error);
-        mpfr_clear(rel_error);
-    }
-    
-    printf("Converged: %s\n", result.converged ? "Yes" : "No");
-    printf("Iterations: %d\n", result.iterations);
-    printf("Time: %.3f ms\n", result.elapsed_ms);
-    
-    z5d_result_clear(&result);
-    z5d_config_clear(&config);
-}
-
-int main(int argc __attribute__((unused)), char** argv __attribute__((unused))) {
-    printf("Z5D nth-Prime Predictor Benchmark\n");
-    printf("==================================\n");
-    printf("Version: %s\n", z5d_get_version());
-    
+#define BENCH_DEFAULT_WARMUP 3
+#define BENCH_DEFAULT_RUNS 31
+#define BENCH_DEFAULT_REFINE_MAX_EXP 300
+#define BENCH_THREAD_BASE_N 1000000000000ULL
+#define BENCH_THREAD_OPS_PER_RUN 64   /* Thread sweep: calls per thread per timed run */
+#define BENCH_MAX_EXPS 64
+#define BENCH_APPROX_COUNT 65536   /* Approx sweep: values per timed call */
+
+typedef enum { FORMAT_TEXT, FORMAT_CSV, FORMAT_JSON } bench_format_t;
+
+typedef struct {
+    int warmup;
+    int runs;
+    int max_threads;
+    int refine_max_exp;
+    int exps[BENCH_MAX_EXPS];
+    int num_exps;
+    int sweep_u64, sweep_big, sweep_threads, sweep_approx;
+    bench_format_t format;
+    FILE* out;
+} bench_opts_t;
+
+/* One reported row */
+typedef struct {
+    const char* sweep;
+    char n_label[24];
+    const char* stage;
+    int threads;
+    int runs;
+    double min_ns, median_ns, p90_ns, p99_ns;
+    double ops_per_sec;      /* Thread sweep only; 0 elsewhere */
+} bench_row_t;
+
+static int rows_written = 0;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static double percentile(const double* sorted, int count, double p) {
+    int rank = (int)(p * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static void summarize(bench_row_t* row, double* samples, int count) {
+    qsort(samples, count, sizeof(double), cmp_double);
+    row->runs = count;
+    row->min_ns = samples[0];
+    row->median_ns = percentile(samples, count, 0.50);
+    row->p90_ns = percentile(samples, count, 0.90);
+    row->p99_ns = percentile(samples, count, 0.99);
+}
+
+/* --------- Output --------- */
+
+static void emit_header(const bench_opts_t* o) {
+    if (o->format == FORMAT_CSV) {
+        fprintf(o->out, "sweep,n,stage,threads,runs,min_ns,median_ns,p90_ns,p99_ns,ops_per_sec\n");
+    } else if (o->format == FORMAT_JSON) {
+        fprintf(o->out, "{\n  \"version\": \"%s\",\n  \"warmup\": %d,\n  \"runs\": %d,\n"
+                "  \"results\": [", z5d_get_version(), o->warmup, o->runs);
+    } else {
+        fprintf(o->out, "Z5D nth-Prime Predictor Benchmark\n");
+        fprintf(o->out, "==================================\n");
+        fprintf(o->out, "Version: %s, %d warmup + %d timed runs per point\n\n",
+                z5d_get_version(), o->warmup, o->runs);
+        fprintf(o->out, "%-8s %-9s %-8s %7s %12s %12s %12s %12s %12s\n", "sweep", "n", "stage",
+                "threads", "min_us", "median_us", "p90_us", "p99_us", "ops/s");
+    }
+}
+
+static void emit_row(const bench_opts_t* o, const bench_row_t* r) {
+    if (o->format == FORMAT_CSV) {
+        fprintf(o->out, "%s,%s,%s,%d,%d,%.0f,%.0f,%.0f,%.0f,%.1f\n", r->sweep, r->n_label,
+                r->stage, r->threads, r->runs, r->min_ns, r->median_ns, r->p90_ns, r->p99_ns,
+                r->ops_per_sec);
+    } else if (o->format == FORMAT_JSON) {
+        fprintf(o->out, "%s\n    {\"sweep\": \"%s\", \"n\": \"%s\", \"stage\": \"%s\", "
+                "\"threads\": %d, \"runs\": %d, \"min_ns\": %.0f, \"median_ns\": %.0f, "
+                "\"p90_ns\": %.0f, \"p99_ns\": %.0f, \"ops_per_sec\": %.1f}",
+                rows_written ? "," : "", r->sweep, r->n_label, r->stage, r->threads, r->runs,
+                r->min_ns, r->median_ns, r->p90_ns, r->p99_ns, r->ops_per_sec);
+    } else {
+        fprintf(o->out, "%-8s %-9s %-8s %7d %12.3f %12.3f %12.3f %12.3f %12.0f\n", r->sweep,
+                r->n_label, r->stage, r->threads, r->min_ns / 1e3, r->median_ns / 1e3,
+                r->p90_ns / 1e3, r->p99_ns / 1e3, r->ops_per_sec);
+    }
+    rows_written++;
+    fflush(o->out);
+}
+
+static void emit_footer(const bench_opts_t* o) {
+    if (o->format == FORMAT_JSON) fprintf(o->out, "\n  ]\n}\n");
+}
+
+/* --------- Stage sweeps --------- */
+
+typedef struct {
+    z5d_ctx_t ctx;
+    mpfr_t value, scratch;
+    mpz_t rounded, prime;
+    double* samples;
+} stage_bench_t;
+
+static void time_stages(const bench_opts_t* o, stage_bench_t* b, const char* sweep,
+                        const char* label, const mpz_t n, int with_refine) {
+    enum { PREDICT, ROUND, REFINE, TOTAL, NUM_STAGES };
+    static const char* names[NUM_STAGES] = {"predict", "round", "refine", "total"};
+    int total_runs = o->warmup + o->runs;
+
+    for (int stage = 0; stage < NUM_STAGES; stage++) {
+        if (stage >= REFINE && !with_refine) continue;
+        /* The later stages start from the earlier stages' output */
+        z5d_closed_form_ctx(&b->ctx, b->value, n);
+        mpfr_set_prec(b->scratch, mpfr_get_prec(b->value));
+        mpfr_round(b->scratch, b->value);
+        mpfr_get_z(b->rounded, b->scratch, MPFR_RNDN);
+
+        for (int rep = 0; rep < total_runs; rep++) {
+            double t0 = 0.0, t1 = 0.0;
+            switch (stage) {
+            case PREDICT:
+                t0 = now_ns();
+                z5d_closed_form_ctx(&b->ctx, b->value, n);
+                t1 = now_ns();
+                break;
+            case ROUND:
+                mpfr_set(b->scratch, b->value, MPFR_RNDN);
+                t0 = now_ns();
+                mpfr_round(b->scratch, b->scratch);
+                mpfr_get_z(b->rounded, b->scratch, MPFR_RNDN);
+                t1 = now_ns();
+                break;
+            case REFINE:
+                t0 = now_ns();
+                z5d_refine_ctx(&b->ctx, b->prime, b->rounded);
+                t1 = now_ns();
+                break;
+            default:
+                t0 = now_ns();
+                z5d_predict_nth_prime_mpz_big_ctx(&b->ctx, b->prime, n);
+                t1 = now_ns();
+                break;
+            }
+            if (rep >= o->warmup) b->samples[rep - o->warmup] = t1 - t0;
+        }
+
+        bench_row_t row;
+        memset(&row, 0, sizeof(row));
+        row.sweep = sweep;
+        snprintf(row.n_label, sizeof(row.n_label), "%s", label);
+        row.stage = names[stage];
+        row.threads = 1;
+        summarize(&row, b->samples, o->runs);
+        emit_row(o, &row);
+    }
+}
+
+static int run_stage_sweeps(const bench_opts_t* o) {
+    stage_bench_t b;
+    z5d_ctx_init(&b.ctx, NULL);
+    mpfr_inits2(Z5D_DEFAULT_PRECISION, b.value, b.scratch, (mpfr_ptr)0);
+    mpz_inits(b.rounded, b.prime, NULL);
+    b.samples = malloc((size_t)o->runs * sizeof(double));
+    if (!b.samples) return -1;
+
+    mpz_t n;
+    mpz_init(n);
+    char label[24];
+    if (o->sweep_u64) {
+        for (int e = 1; e <= 19; e++) {
+            mpz_ui_pow_ui(n, 10, (unsigned long)e);
+            mpz_add_ui(n, n, 1);
+            snprintf(label, sizeof(label), "10^%d+1", e);
+            time_stages(o, &b, "uint64", label, n, 1);
+        }
+    }
+    if (o->sweep_big) {
+        for (int i = 0; i < o->num_exps; i++) {
+            mpz_ui_pow_ui(n, 10, (unsigned long)o->exps[i]);
+            snprintf(label, sizeof(label), "10^%d", o->exps[i]);
+            time_stages(o, &b, "big-n", label, n, o->exps[i] <= o->refine_max_exp);
+        }
+    }
+    mpz_clear(n);
+
+    free(b.samples);
+    mpz_clears(b.rounded, b.prime, NULL);
+    mpfr_clears(b.value, b.scratch, (mpfr_ptr)0);
+    z5d_ctx_clear(&b.ctx);
+    return 0;
+}
+
+/* --------- Thread scaling --------- */
+
+typedef struct {
+    const bench_opts_t* opts;
+    int id;
+    double* samples;         /* opts->runs * BENCH_THREAD_OPS_PER_RUN per thread */
+    pthread_mutex_t* lock;
+    pthread_cond_t* go_cond;
+    int* go;
+} thread_arg_t;
+
+/* Full pipeline on a private context; each thread predicts its own indices */
+static void* thread_main(void* p) {
+    thread_arg_t* a = (thread_arg_t*)p;
+    const bench_opts_t* o = a->opts;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    mpz_t prime;
+    mpz_init(prime);
+    uint64_t base = BENCH_THREAD_BASE_N + (uint64_t)a->id * 1000003ULL;
+
+    for (int rep = 0; rep < o->warmup; rep++) {
+        z5d_predict_nth_prime_mpz_ctx(&ctx, prime, base + (uint64_t)rep);
+    }
+    pthread_mutex_lock(a->lock);
+    while (!*a->go) pthread_cond_wait(a->go_cond, a->lock);
+    pthread_mutex_unlock(a->lock);
+
+    int ops = o->runs * BENCH_THREAD_OPS_PER_RUN;
+    for (int rep = 0; rep < ops; rep++) {
+        double t0 = now_ns();
+        z5d_predict_nth_prime_mpz_ctx(&ctx, prime, base + (uint64_t)(o->warmup + rep));
+        a->samples[rep] = now_ns() - t0;
+    }
+    mpz_clear(prime);
+    z5d_ctx_clear(&ctx);
+    return NULL;
+}
+
+static int run_thread_sweep(const bench_opts_t* o) {
+    int ops = o->runs * BENCH_THREAD_OPS_PER_RUN;
+    double* samples = malloc((size_t)o->max_threads * (size_t)ops * sizeof(double));
+    pthread_t* tids = malloc((size_t)o->max_threads * sizeof(pthread_t));
+    thread_arg_t* args = malloc((size_t)o->max_threads * sizeof(thread_arg_t));
+    if (!samples || !tids || !args) {
+        free(samples);
+        free(tids);
+        free(args);
+        return -1;
+    }
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t go_cond = PTHREAD_COND_INITIALIZER;
+
+    for (int t = 1; t <= o->max_threads; t = (t * 2 <= o->max_threads || t == o->max_threads)
+                                                 ? t * 2 : o->max_threads) {
+        int go = 0;
+        for (int i = 0; i < t; i++) {
+            args[i] = (thread_arg_t){o, i, samples + (size_t)i * ops, &lock, &go_cond, &go};
+            pthread_create(&tids[i], NULL, thread_main, &args[i]);
+        }
+        /* Threads warm up, then wait at the gate; the wall clock starts here */
+        usleep(10000);
+        double t0 = now_ns();
+        pthread_mutex_lock(&lock);
+        go = 1;
+        pthread_cond_broadcast(&go_cond);
+        pthread_mutex_unlock(&lock);
+        for (int i = 0; i < t; i++) pthread_join(tids[i], NULL);
+        double wall = now_ns() - t0;
+
+        bench_row_t row;
+        memset(&row, 0, sizeof(row));
+        row.sweep = "threads";
+        snprintf(row.n_label, sizeof(row.n_label), "10^12+i");
+        row.stage = "total";
+        row.threads = t;
+        summarize(&row, samples, t * ops);
+        row.ops_per_sec = (double)t * ops / (wall / 1e9);
+        emit_row(o, &row);
+        if (t == o->max_threads) break;
+    }
+    free(samples);
+    free(tids);
+    free(args);
+    return 0;
+}
+
+/* --------- Bulk approximate predictor --------- */
+
+/* One row per kernel this CPU runs; times are per value */
+static int run_approx_sweep(const bench_opts_t* o) {
+    uint64_t* n = malloc(BENCH_APPROX_COUNT * sizeof(uint64_t));
+    double* out = malloc(BENCH_APPROX_COUNT * sizeof(double));
+    double* samples = malloc((size_t)o->runs * sizeof(double));
+    if (!n || !out || !samples) {
+        free(n);
+        free(out);
+        free(samples);
+        return -1;
+    }
+    for (size_t i = 0; i < BENCH_APPROX_COUNT; i++) n[i] = BENCH_THREAD_BASE_N + i;
+
+    static const z5d_approx_kernel_t kernels[] = { Z5D_APPROX_GENERIC, Z5D_APPROX_AVX2,
+                                                   Z5D_APPROX_AVX512, Z5D_APPROX_NEON };
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!z5d_approx_kernel_supported(kernels[k])) continue;
+        for (int rep = 0; rep < o->warmup; rep++) {
+            z5d_predict_approx_u64_with(kernels[k], n, out, BENCH_APPROX_COUNT);
+        }
+        for (int rep = 0; rep < o->runs; rep++) {
+            double t0 = now_ns();
+            z5d_predict_approx_u64_with(kernels[k], n, out, BENCH_APPROX_COUNT);
+            samples[rep] = (now_ns() - t0) / BENCH_APPROX_COUNT;
+        }
+        bench_row_t row;
+        memset(&row, 0, sizeof(row));
+        row.sweep = "approx";
+        snprintf(row.n_label, sizeof(row.n_label), "10^12+i");
+        row.stage = z5d_approx_kernel_name(kernels[k]);
+        row.threads = 1;
+        summarize(&row, samples, o->runs);
+        row.ops_per_sec = 1e9 / row.median_ns;
+        emit_row(o, &row);
+    }
+    free(n);
+    free(out);
+    free(samples);
+    return 0;
+}
+
+/* --------- Planned vs. historic precision (--big-n) --------- */
+
+/* Best-of-3 closed-form time at the context's planned precision */
+static double time_big(z5d_ctx_t* ctx, z5d_result_t* result, const mpz_t n) {
+    double best = 0.0;
+    for (int rep = 0; rep < 3; rep++) {
+        z5d_predict_nth_prime_big_ctx(ctx, result, n);
+        if (rep == 0 || result->elapsed_ms < best) best = result->elapsed_ms;
+    }
+    return best;
+}
+
+/*
+ * Planned vs. historic (bits(n) + 2048) working precision over the exponent
+ * grid of scripts/benchmark_big_n.sh. Times the closed form only; the
+ * refinement starts from the same integer either way.
+ */
+static int run_big_n_benchmark(const bench_opts_t* o) {
+    printf("\n%-8s %10s %10s %12s %12s %8s %6s\n",
+           "n", "old_bits", "plan_bits", "old_ms", "plan_ms", "speedup", "match");
+
+    z5d_result_t old_r, plan_r;
+    z5d_result_init(&old_r, Z5D_DEFAULT_PRECISION);
+    z5d_result_init(&plan_r, Z5D_DEFAULT_PRECISION);
+    z5d_ctx_t plan_ctx;
+    z5d_ctx_init(&plan_ctx, NULL);
+    mpz_t n;
+    mpz_init(n);
+    int mismatches = 0;
+    double old_total = 0.0, plan_total = 0.0;
+
+    for (int i = 0; i < o->num_exps; i++) {
+        mpz_ui_pow_ui(n, 10, (unsigned long)o->exps[i]);
+
+        /* The historic rule, expressed as a context precision floor */
+        z5d_config_t config;
+        z5d_config_init(&config);
+        config.precision = (mpfr_prec_t)mpz_sizeinbase(n, 2) + 2048;
+        z5d_ctx_t old_ctx;
+        z5d_ctx_init(&old_ctx, &config);
+        z5d_config_clear(&config);
+
+        double old_ms = time_big(&old_ctx, &old_r, n);
+        double plan_ms = time_big(&plan_ctx, &plan_r, n);
+        int match = mpfr_equal_p(old_r.predicted_prime, plan_r.predicted_prime);
+        mismatches += !match;
+        old_total += old_ms;
+        plan_total += plan_ms;
+
+        char label[16];
+        snprintf(label, sizeof(label), "10^%d", o->exps[i]);
+        printf("%-8s %10ld %10ld %12.3f %12.3f %7.2fx %6s\n", label,
+               (long)old_r.precision_used, (long)plan_r.precision_used, old_ms, plan_ms,
+               plan_ms > 0.0 ? old_ms / plan_ms : 0.0, match ? "yes" : "NO");
+        z5d_ctx_clear(&old_ctx);
+    }
+
+    printf("\nTotal: %.3f ms -> %.3f ms (%.2fx), %d mismatches, %lu replans\n",
+           old_total, plan_total, plan_total > 0.0 ? old_total / plan_total : 0.0,
+           mismatches, (unsigned long)plan_ctx.stats.replans);
+
+    mpz_clear(n);
+    z5d_ctx_clear(&plan_ctx);
+    z5d_result_clear(&old_r);
+    z5d_result_clear(&plan_r);
+    return mismatches ? 1 : 0;
+}
+
+/* --------- Options --------- */
+
+/* Exponent grid of scripts/benchmark_big_n.sh */
+static void default_exps(bench_opts_t* o) {
+    o->num_exps = 0;
+    o->exps[o->num_exps++] = 20;
+    for (int e = 50; e <= 1200; e += 50) o->exps[o->num_exps++] = e;
+    o->exps[o->num_exps++] = 1230;
+    o->exps[o->num_exps++] = 1233;
+}
+
+/* Comma-separated exponents, as EXPS_OVERRIDE in benchmark_big_n.sh */
+static int parse_exps(bench_opts_t* o, const char* list) {
+    o->num_exps = 0;
+    const char* p = list;
+    while (*p) {
+        char* end;
+        long e = strtol(p, &end, 10);
+        if (end == p || e < 1 || o->num_exps == BENCH_MAX_EXPS) return -1;
+        o->exps[o->num_exps++] = (int)e;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    return o->num_exps ? 0 : -1;
+}
+
+static void print_usage(const char* prog_name) {
+    printf("Z5D benchmark harness v%s\n", z5d_get_version());
+    printf("Usage: %s [options]\n", prog_name);
+    printf("\nOptions:\n");
+    printf("  -w <count>            Warmup runs per point (default: %d)\n", BENCH_DEFAULT_WARMUP);
+    printf("  -r <count>            Timed runs per point (default: %d)\n", BENCH_DEFAULT_RUNS);
+    printf("  -t <threads>          Most threads in the scaling sweep (default: all CPUs)\n");
+    printf("  --sweep <list>        Comma-separated: uint64, big, threads, approx (default: all)\n");
+    printf("  --exps <list>         Big-n exponents (default: grid of benchmark_big_n.sh)\n");
+    printf("  --refine-max-exp <e>  Refine and total stages up to 10^e only (default: %d)\n",
+           BENCH_DEFAULT_REFINE_MAX_EXP);
+    printf("  --csv | --json        Machine-readable output (default: text table)\n");
+    printf("  -o <file>             Write results to file instead of stdout\n");
+    printf("  --big-n               Planned vs. bits(n) + 2048 precision comparison\n");
+    printf("  -h, --help            Show this help\n");
+    printf("\nExamples:\n");
+    printf("  %s --sweep uint64,threads\n", prog_name);
+    printf("  %s --json -o bench-1.0.0.json\n", prog_name);
+}
+
+int main(int argc, char** argv) {
+    bench_opts_t o;
+    memset(&o, 0, sizeof(o));
+    o.warmup = BENCH_DEFAULT_WARMUP;
+    o.runs = BENCH_DEFAULT_RUNS;
+    o.refine_max_exp = BENCH_DEFAULT_REFINE_MAX_EXP;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    o.max_threads = cpus > 0 ? (int)cpus : 1;
+    o.sweep_u64 = o.sweep_big = o.sweep_threads = o.sweep_approx = 1;
+    o.format = FORMAT_TEXT;
+    o.out = stdout;
+    default_exps(&o);
+    int big_n_compare = 0;
+    const char* out_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        int has_arg = i + 1 < argc;
+        if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(a, "--big-n") == 0) {
+            big_n_compare = 1;
+        } else if (strcmp(a, "--csv") == 0) {
+            o.format = FORMAT_CSV;
+        } else if (strcmp(a, "--json") == 0) {
+            o.format = FORMAT_JSON;
+        } else if (strcmp(a, "-w") == 0 && has_arg) {
+            o.warmup = atoi(argv[++i]);
+        } else if (strcmp(a, "-r") == 0 && has_arg) {
+            o.runs = atoi(argv[++i]);
+        } else if (strcmp(a, "-t") == 0 && has_arg) {
+            o.max_threads = atoi(argv[++i]);
+        } else if (strcmp(a, "-o") == 0 && has_arg) {
+            out_path = argv[++i];
+        } else if (strcmp(a, "--refine-max-exp") == 0 && has_arg) {
+            o.refine_max_exp = atoi(argv[++i]);
+        } else if (strcmp(a, "--exps") == 0 && has_arg) {
+            if (parse_exps(&o, argv[++i]) != 0) {
+                fprintf(stderr, "Error: bad exponent list\n");
+                return 1;
+            }
+        } else if (strcmp(a, "--sweep") == 0 && has_arg) {
+            const char* s = argv[++i];
+            o.sweep_u64 = strstr(s, "uint64") != NULL;
+            o.sweep_big = strstr(s, "big") != NULL;
+            o.sweep_threads = strstr(s, "threads") != NULL;
+            o.sweep_approx = strstr(s, "approx") != NULL;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (o.warmup < 0 || o.runs < 1 || o.max_threads < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
     z5d_init();
-    
-    // Run benchmarks for known values
-    for (int i = 0; known_primes[i].n != 0; i++) {
-        run_benchmark(known_primes[i].n, known_primes[i].prime_str);
-    }
-    
-    // Summary
-    printf("\n=================================\n");
-    printf("Benchmark Complete\n");
-    
+    if (big_n_compare) {
+        printf("Z5D nth-Prime Predictor Benchmark\n");
+        printf("==================================\n");
+        printf("Version: %s\n", z5d_get_version());
+        int ret = run_big_n_benchmark(&o);
+        z5d_cleanup();
+        return ret;
+    }
+
+    if (out_path) {
+        o.out = fopen(out_path, "w");
+        if (!o.out) {
+            fprintf(stderr, "Error: cannot write %s\n", out_path);
+            return 1;
+        }
+    }
+    int ret = 0;
+    emit_header(&o);
+    if ((o.sweep_u64 || o.sweep_big) && run_stage_sweeps(&o) != 0) ret = 1;
+    if (o.sweep_threads && run_thread_sweep(&o) != 0) ret = 1;
+    if (o.sweep_approx && run_approx_sweep(&o) != 0) ret = 1;
+    emit_footer(&o);
+    if (out_path) fclose(o.out);
+
     z5d_cleanup();
-    return 0;
+    return ret;
 }
@@ -0,0 +1,74 @@
+/**
+ * Z5D Packed Buffers - Flat-Array Entry Points for Bindings
+ * =========================================================
+ *
+ * Refined predictions over caller-owned flat memory: uint64 indices in, and
+ * primes out as fixed-width little-endian unsigned integers, one entry
+ * every width bytes. Bindings (CPython, JNI) pass their array storage
+ * straight through instead of building an mpz_t or a language-level
+ * integer per element; the only GMP values are two registers reused for
+ * the whole call.
+ *
+ * Little-endian entries of 8 bytes read back as native uint64 arrays on
+ * every supported target, and a width of Z5D_PACKED_U64_WIDTH holds p_n
+ * for every uint64 n.
+ *
+ * @file z5d_bulk.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <string.h>
+
+/* Store v as width little-endian bytes; -1 (entry zeroed) if it does not fit */
+static int pack(uint8_t* dst, size_t width, const mpz_t v) {
+    size_t bytes = (mpz_sizeinbase(v, 2) + 7) / 8;
+    if (mpz_sgn(v) < 0 || bytes > width) {
+        memset(dst, 0, width);
+        return -1;
+    }
+    size_t written = 0;
+    mpz_export(dst, &written, -1, 1, 0, 0, v);
+    memset(dst + written, 0, width - written);
+    return 0;
+}
+
+int z5d_predict_nth_prime_packed(z5d_ctx_t* ctx, const uint64_t* n, size_t count, void* out,
+                                 size_t width) {
+    if (!ctx || width == 0 || (count && (!n || !out))) return -1;
+    uint8_t* dst = (uint8_t*)out;
+    mpz_t p;
+    mpz_init(p);
+    int ret = 0;
+    for (size_t i = 0; i < count; i++, dst += width) {
+        if (z5d_predict_nth_prime_mpz_ctx(ctx, p, n[i]) != 0) {
+            memset(dst, 0, width);
+            ret = -1;
+        } else if (pack(dst, width, p) != 0) {
+            ret = -1;
+        }
+    }
+    mpz_clear(p);
+    return ret;
+}
+
+int z5d_predict_nth_prime_packed_big(z5d_ctx_t* ctx, const void* n, size_t n_width, size_t count,
+                                     void* out, size_t out_width) {
+    if (!ctx || n_width == 0 || out_width == 0 || (count && (!n || !out))) return -1;
+    const uint8_t* src = (const uint8_t*)n;
+    uint8_t* dst = (uint8_t*)out;
+    mpz_t idx, p;
+    mpz_inits(idx, p, NULL);
+    int ret = 0;
+    for (size_t i = 0; i < count; i++, src += n_width, dst += out_width) {
+        mpz_import(idx, n_width, -1, 1, 0, 0, src);
+        if (z5d_predict_nth_prime_mpz_big_ctx(ctx, p, idx) != 0) {
+            memset(dst, 0, out_width);
+            ret = -1;
+        } else if (pack(dst, out_width, p) != 0) {
+            ret = -1;
+        }
+    }
+    mpz_clears(idx, p, NULL);
+    return ret;
+}
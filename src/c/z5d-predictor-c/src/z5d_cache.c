@@ -0,0 +1,485 @@
+/**
+ * Z5D Result Cache - Memoized n -> p_n with an Append-Only Store
+ * ==============================================================
+ *
+ * Bounded, thread-safe memo of refined big-n answers. The table is split
+ * into Z5D_CACHE_SHARDS shards by hash, each with its own lock, bucket
+ * chains and a CLOCK ring: hits set a reference bit, and an insert into a
+ * full shard sweeps the hand past referenced slots (clearing their bits)
+ * to the first unreferenced one and replaces it.
+ *
+ * The optional store is an append-only file of (n, p) records. At open the
+ * existing records are mapped read-only and indexed by hash, so a restart
+ * answers every stored n with a lookup; records appended later are read
+ * back with pread. A torn record at the tail (crash mid-append) is cut off
+ * at open. One process per store file.
+ *
+ * Store layout (native byte order, 64-byte header):
+ *   char magic[8] = "Z5DCACH1", uint32 version = 1, uint32 reserved,
+ *   char library_version[16], uint64 reserved[4]
+ *   records: uint32 n_len, uint32 p_len, n bytes, p bytes, uint32 check
+ * n and p are big-endian magnitudes; check is FNV-1a over the lengths and
+ * bytes, truncated to 32 bits.
+ *
+ * @file z5d_cache.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CACHE_MAGIC "Z5DCACH1"
+#define CACHE_VERSION 1
+#define CACHE_MAX_KEY_BYTES (1u << 20)   /* Sanity bound on stored lengths */
+#define CACHE_STACK_KEY_BYTES 1024       /* n up to ~10^2466 hashes without malloc */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved0;
+    char library_version[16];
+    uint64_t reserved[4];
+} cache_header_t;
+
+typedef struct {
+    uint64_t hash;
+    int32_t next;            /* Bucket chain, -1 ends */
+    uint8_t used;
+    uint8_t ref;             /* CLOCK reference bit */
+    mpz_t n, p;
+} cache_slot_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    cache_slot_t* slots;
+    size_t num_slots;
+    size_t used;
+    size_t hand;
+    int32_t* buckets;        /* Chain heads, -1 empty */
+    size_t bucket_mask;
+    uint64_t hits, misses, inserts, evictions;
+} cache_shard_t;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t offset;         /* Record start; 0 = empty (records follow the header) */
+} store_entry_t;
+
+struct z5d_cache {
+    cache_shard_t shards[Z5D_CACHE_SHARDS];
+    size_t capacity;
+    /* Store; fd < 0 when memory-only */
+    pthread_mutex_t store_lock;
+    int fd;
+    const unsigned char* map;
+    size_t map_len;          /* Mapped length */
+    size_t map_size;         /* Valid records end here; later ones are read with pread */
+    uint64_t end;            /* Next append offset */
+    store_entry_t* index;
+    size_t index_mask;
+    size_t store_entries;
+    uint64_t store_hits, store_appends;
+};
+
+/* --------- Keys --------- */
+
+static uint64_t fnv1a(uint64_t h, const unsigned char* b, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= b[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+#define FNV_BASIS 0xcbf29ce484222325ULL
+
+/* Table hash of n's bytes: FNV barely mixes the last bytes into the top
+   bits, which pick the shard, so finish with the murmur3 avalanche */
+static uint64_t key_hash(const unsigned char* key, size_t len) {
+    uint64_t h = fnv1a(FNV_BASIS, key, len);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 33);
+}
+
+/* Big-endian magnitude of x; *buf is the caller's stack buffer or malloc'd */
+static unsigned char* export_bytes(const mpz_t x, unsigned char* stack, size_t* len) {
+    size_t need = (mpz_sizeinbase(x, 2) + 7) / 8;
+    unsigned char* buf = need <= CACHE_STACK_KEY_BYTES ? stack : malloc(need);
+    if (!buf) return NULL;
+    mpz_export(buf, len, 1, 1, 1, 0, x);
+    return buf;
+}
+
+static uint64_t record_check(const unsigned char* n, uint32_t n_len,
+                             const unsigned char* p, uint32_t p_len) {
+    uint32_t lens[2] = { n_len, p_len };
+    uint64_t h = fnv1a(FNV_BASIS, (const unsigned char*)lens, sizeof(lens));
+    h = fnv1a(h, n, n_len);
+    return fnv1a(h, p, p_len) & 0xffffffffULL;
+}
+
+/* --------- In-memory shards --------- */
+
+static size_t pow2_at_least(size_t x) {
+    size_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+static int shard_init(cache_shard_t* s, size_t slots) {
+    memset(s, 0, sizeof(*s));
+    size_t nb = pow2_at_least(slots);
+    s->slots = calloc(slots, sizeof(cache_slot_t));
+    s->buckets = malloc(nb * sizeof(int32_t));
+    if (!s->slots || !s->buckets) {
+        free(s->slots);
+        free(s->buckets);
+        return -1;
+    }
+    s->num_slots = slots;
+    s->bucket_mask = nb - 1;
+    for (size_t i = 0; i < nb; i++) s->buckets[i] = -1;
+    for (size_t i = 0; i < slots; i++) {
+        mpz_init(s->slots[i].n);
+        mpz_init(s->slots[i].p);
+    }
+    pthread_mutex_init(&s->lock, NULL);
+    return 0;
+}
+
+static void shard_clear(cache_shard_t* s) {
+    if (!s->slots) return;
+    for (size_t i = 0; i < s->num_slots; i++) {
+        mpz_clear(s->slots[i].n);
+        mpz_clear(s->slots[i].p);
+    }
+    free(s->slots);
+    free(s->buckets);
+    pthread_mutex_destroy(&s->lock);
+}
+
+static cache_shard_t* shard_of(z5d_cache_t* c, uint64_t hash) {
+    return &c->shards[hash >> 60 & (Z5D_CACHE_SHARDS - 1)];
+}
+
+/* Slot of n in s, or -1; caller holds the lock */
+static int32_t shard_find(const cache_shard_t* s, uint64_t hash, const mpz_t n) {
+    for (int32_t i = s->buckets[hash & s->bucket_mask]; i >= 0; i = s->slots[i].next) {
+        if (s->slots[i].hash == hash && mpz_cmp(s->slots[i].n, n) == 0) return i;
+    }
+    return -1;
+}
+
+static void shard_unlink(cache_shard_t* s, int32_t victim) {
+    int32_t* link = &s->buckets[s->slots[victim].hash & s->bucket_mask];
+    while (*link != victim) link = &s->slots[*link].next;
+    *link = s->slots[victim].next;
+}
+
+/* Insert or refresh n -> p; caller holds the lock */
+static void shard_put(cache_shard_t* s, uint64_t hash, const mpz_t n, const mpz_t p) {
+    int32_t i = shard_find(s, hash, n);
+    if (i >= 0) {
+        s->slots[i].ref = 1;
+        return;
+    }
+    if (s->used < s->num_slots) {
+        i = (int32_t)s->used++;
+    } else {
+        /* CLOCK: second chance for referenced slots */
+        while (s->slots[s->hand].ref) {
+            s->slots[s->hand].ref = 0;
+            s->hand = (s->hand + 1) % s->num_slots;
+        }
+        i = (int32_t)s->hand;
+        s->hand = (s->hand + 1) % s->num_slots;
+        shard_unlink(s, i);
+        s->evictions++;
+    }
+    cache_slot_t* slot = &s->slots[i];
+    slot->hash = hash;
+    slot->used = 1;
+    slot->ref = 0;
+    mpz_set(slot->n, n);
+    mpz_set(slot->p, p);
+    size_t b = hash & s->bucket_mask;
+    slot->next = s->buckets[b];
+    s->buckets[b] = i;
+    s->inserts++;
+}
+
+/* --------- Store --------- */
+
+static int store_index_add(z5d_cache_t* c, uint64_t hash, uint64_t offset) {
+    if (2 * (c->store_entries + 1) > c->index_mask + 1) {
+        size_t size = (c->index_mask + 1) * 2;
+        store_entry_t* grown = calloc(size, sizeof(store_entry_t));
+        if (!grown) return -1;
+        for (size_t i = 0; c->index && i <= c->index_mask; i++) {
+            if (!c->index[i].offset) continue;
+            size_t j = c->index[i].hash & (size - 1);
+            while (grown[j].offset) j = (j + 1) & (size - 1);
+            grown[j] = c->index[i];
+        }
+        free(c->index);
+        c->index = grown;
+        c->index_mask = size - 1;
+    }
+    size_t j = hash & c->index_mask;
+    while (c->index[j].offset) j = (j + 1) & c->index_mask;
+    c->index[j].hash = hash;
+    c->index[j].offset = offset;
+    c->store_entries++;
+    return 0;
+}
+
+/* Record at offset: from the mapping, or read back into *heap (caller frees) */
+static const unsigned char* store_record(const z5d_cache_t* c, uint64_t offset,
+                                         unsigned char** heap, uint32_t* n_len,
+                                         uint32_t* p_len) {
+    *heap = NULL;
+    uint32_t lens[2];
+    if (offset + sizeof(lens) <= c->map_size) {
+        memcpy(lens, c->map + offset, sizeof(lens));
+    } else if (pread(c->fd, lens, sizeof(lens), (off_t)offset) != (ssize_t)sizeof(lens)) {
+        return NULL;
+    }
+    *n_len = lens[0];
+    *p_len = lens[1];
+    size_t len = sizeof(lens) + (size_t)lens[0] + lens[1];
+    if (offset + len <= c->map_size) return c->map + offset + sizeof(lens);
+    *heap = malloc(len);
+    if (!*heap || pread(c->fd, *heap, len, (off_t)offset) != (ssize_t)len) {
+        free(*heap);
+        *heap = NULL;
+        return NULL;
+    }
+    return *heap + sizeof(lens);
+}
+
+/* Stored p for the key bytes, into p; caller holds store_lock */
+static int store_find(const z5d_cache_t* c, uint64_t hash, const unsigned char* key,
+                      size_t key_len, mpz_t p) {
+    if (!c->index) return 0;
+    for (size_t j = hash & c->index_mask; c->index[j].offset; j = (j + 1) & c->index_mask) {
+        if (c->index[j].hash != hash) continue;
+        unsigned char* heap;
+        uint32_t n_len, p_len;
+        const unsigned char* rec = store_record(c, c->index[j].offset, &heap, &n_len, &p_len);
+        int match = rec && n_len == key_len && memcmp(rec, key, key_len) == 0;
+        if (match && p) mpz_import(p, p_len, 1, 1, 1, 0, rec + n_len);
+        free(heap);
+        if (match) return 1;
+    }
+    return 0;
+}
+
+static int store_append(z5d_cache_t* c, uint64_t hash, const unsigned char* key,
+                        size_t key_len, const mpz_t p) {
+    unsigned char stack[CACHE_STACK_KEY_BYTES];
+    size_t p_len;
+    unsigned char* pb = export_bytes(p, stack, &p_len);
+    if (!pb) return -1;
+    uint32_t lens[2] = { (uint32_t)key_len, (uint32_t)p_len };
+    uint32_t check = (uint32_t)record_check(key, lens[0], pb, lens[1]);
+    size_t len = sizeof(lens) + key_len + p_len + sizeof(check);
+    unsigned char* rec = malloc(len);
+    int ret = -1;
+    if (rec) {
+        memcpy(rec, lens, sizeof(lens));
+        memcpy(rec + sizeof(lens), key, key_len);
+        memcpy(rec + sizeof(lens) + key_len, pb, p_len);
+        memcpy(rec + len - sizeof(check), &check, sizeof(check));
+        if (pwrite(c->fd, rec, len, (off_t)c->end) == (ssize_t)len &&
+            store_index_add(c, hash, c->end) == 0) {
+            c->end += len;
+            c->store_appends++;
+            ret = 0;
+        }
+        free(rec);
+    }
+    if (pb != stack) free(pb);
+    return ret;
+}
+
+/* Map and index an existing store, or write the header of a new one */
+static int store_open(z5d_cache_t* c, const char* path) {
+    c->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (c->fd < 0) return -1;
+    struct stat st;
+    if (fstat(c->fd, &st) != 0) return -1;
+    size_t size = (size_t)st.st_size;
+
+    if (size == 0) {
+        cache_header_t h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, CACHE_MAGIC, 8);
+        h.version = CACHE_VERSION;
+        strncpy(h.library_version, Z5D_PREDICTOR_VERSION, sizeof(h.library_version) - 1);
+        if (pwrite(c->fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) return -1;
+        c->end = sizeof(h);
+        return 0;
+    }
+    if (size < sizeof(cache_header_t)) return -1;
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, c->fd, 0);
+    if (map == MAP_FAILED) return -1;
+    c->map = (const unsigned char*)map;
+    c->map_len = size;
+    c->map_size = size;
+
+    /* Answers of another library version may differ: refuse, never overwrite */
+    const cache_header_t* h = (const cache_header_t*)map;
+    if (memcmp(h->magic, CACHE_MAGIC, 8) != 0 || h->version != CACHE_VERSION ||
+        strncmp(h->library_version, Z5D_PREDICTOR_VERSION, sizeof(h->library_version)) != 0) {
+        return -1;
+    }
+
+    uint64_t off = sizeof(cache_header_t);
+    while (off + 2 * sizeof(uint32_t) <= size) {
+        uint32_t lens[2], check;
+        memcpy(lens, c->map + off, sizeof(lens));
+        if (lens[0] == 0 || lens[0] > CACHE_MAX_KEY_BYTES || lens[1] == 0 ||
+            lens[1] > CACHE_MAX_KEY_BYTES) break;
+        uint64_t len = sizeof(lens) + (uint64_t)lens[0] + lens[1] + sizeof(check);
+        if (off + len > size) break;
+        const unsigned char* n = c->map + off + sizeof(lens);
+        memcpy(&check, n + lens[0] + lens[1], sizeof(check));
+        if (check != (uint32_t)record_check(n, lens[0], n + lens[0], lens[1])) break;
+        if (!store_find(c, key_hash(n, lens[0]), n, lens[0], NULL) &&
+            store_index_add(c, key_hash(n, lens[0]), off) != 0) {
+            return -1;
+        }
+        off += len;
+    }
+    /* Torn or damaged tail: later appends overwrite it */
+    if (off < size && ftruncate(c->fd, (off_t)off) != 0) return -1;
+    c->end = off;
+    if (off < size) c->map_size = off;
+    return 0;
+}
+
+/* --------- Public API --------- */
+
+int z5d_cache_open(z5d_cache_t** cache, size_t capacity, const char* store_path) {
+    *cache = NULL;
+    if (capacity == 0) return -1;
+    z5d_cache_t* c = calloc(1, sizeof(*c));
+    if (!c) return -1;
+    c->fd = -1;
+    pthread_mutex_init(&c->store_lock, NULL);
+    size_t per_shard = (capacity + Z5D_CACHE_SHARDS - 1) / Z5D_CACHE_SHARDS;
+    c->capacity = per_shard * Z5D_CACHE_SHARDS;
+    int ok = per_shard <= INT32_MAX;
+    for (int i = 0; ok && i < Z5D_CACHE_SHARDS; i++) {
+        ok = shard_init(&c->shards[i], per_shard) == 0;
+    }
+    if (ok && store_path) ok = store_open(c, store_path) == 0;
+    if (!ok) {
+        z5d_cache_close(c);
+        return -1;
+    }
+    *cache = c;
+    return 0;
+}
+
+void z5d_cache_close(z5d_cache_t* cache) {
+    if (!cache) return;
+    for (int i = 0; i < Z5D_CACHE_SHARDS; i++) shard_clear(&cache->shards[i]);
+    if (cache->map) munmap((void*)cache->map, cache->map_len);
+    if (cache->fd >= 0) close(cache->fd);
+    free(cache->index);
+    pthread_mutex_destroy(&cache->store_lock);
+    free(cache);
+}
+
+int z5d_cache_lookup(z5d_cache_t* cache, mpz_t prime_out, const mpz_t n) {
+    unsigned char stack[CACHE_STACK_KEY_BYTES];
+    size_t key_len;
+    unsigned char* key = export_bytes(n, stack, &key_len);
+    if (!key) return 0;
+    uint64_t hash = key_hash(key, key_len);
+    cache_shard_t* s = shard_of(cache, hash);
+
+    pthread_mutex_lock(&s->lock);
+    int32_t i = shard_find(s, hash, n);
+    if (i >= 0) {
+        s->slots[i].ref = 1;
+        mpz_set(prime_out, s->slots[i].p);
+        s->hits++;
+    } else {
+        s->misses++;
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    int found = i >= 0;
+    if (!found && cache->fd >= 0) {
+        pthread_mutex_lock(&cache->store_lock);
+        found = store_find(cache, hash, key, key_len, prime_out);
+        if (found) cache->store_hits++;
+        pthread_mutex_unlock(&cache->store_lock);
+        if (found) {
+            /* Promote into memory so the next hit skips the store */
+            pthread_mutex_lock(&s->lock);
+            shard_put(s, hash, n, prime_out);
+            pthread_mutex_unlock(&s->lock);
+        }
+    }
+    if (key != stack) free(key);
+    return found;
+}
+
+int z5d_cache_insert(z5d_cache_t* cache, const mpz_t n, const mpz_t prime) {
+    if (mpz_sgn(n) <= 0 || mpz_sgn(prime) <= 0) return -1;
+    unsigned char stack[CACHE_STACK_KEY_BYTES];
+    size_t key_len;
+    unsigned char* key = export_bytes(n, stack, &key_len);
+    if (!key) return -1;
+    uint64_t hash = key_hash(key, key_len);
+    cache_shard_t* s = shard_of(cache, hash);
+
+    pthread_mutex_lock(&s->lock);
+    shard_put(s, hash, n, prime);
+    pthread_mutex_unlock(&s->lock);
+
+    int ret = 0;
+    if (cache->fd >= 0) {
+        pthread_mutex_lock(&cache->store_lock);
+        if (!store_find(cache, hash, key, key_len, NULL)) {
+            ret = store_append(cache, hash, key, key_len, prime);
+        }
+        pthread_mutex_unlock(&cache->store_lock);
+    }
+    if (key != stack) free(key);
+    return ret;
+}
+
+void z5d_cache_get_stats(z5d_cache_t* cache, z5d_cache_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->capacity = cache->capacity;
+    for (int i = 0; i < Z5D_CACHE_SHARDS; i++) {
+        cache_shard_t* s = &cache->shards[i];
+        pthread_mutex_lock(&s->lock);
+        stats->hits += s->hits;
+        stats->misses += s->misses;
+        stats->inserts += s->inserts;
+        stats->evictions += s->evictions;
+        stats->entries += s->used;
+        pthread_mutex_unlock(&s->lock);
+    }
+    pthread_mutex_lock(&cache->store_lock);
+    stats->store_hits = cache->store_hits;
+    stats->store_appends = cache->store_appends;
+    stats->store_entries = cache->store_entries;
+    pthread_mutex_unlock(&cache->store_lock);
+    stats->misses -= stats->store_hits;   /* shards count store hits as misses */
+}
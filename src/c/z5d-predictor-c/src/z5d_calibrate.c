@@ -0,0 +1,583 @@
+/**
+ * Z5D nth-Prime Predictor - Calibration Sweep
+ * ===========================================
+ *
+ * Native counterpart of scripts/calibrate_de_terms.py: grid-searches the
+ * closed-form coefficients (c, kappa*) against exact (n, p_n) pairs and
+ * writes the same calibration_errors.csv / calibration_comparison.csv.
+ *
+ * The closed form is linear in its coefficients,
+ *   F(n; c, kappa*) = pnt + c * D + kappa* * E,
+ *   D = (ln pnt / e^4)^2 pnt,  E = pnt^(2/3),
+ * so each reference point is evaluated three times in MPFR up front (with
+ * the library's own formula, via z5d_config_set_calibration) and every grid
+ * cell afterwards costs three multiply-adds per point. Rows of the grid are
+ * spread over worker threads. Below 2^50 estimates are rounded to integers
+ * before the error is taken, as the script does; above, rounding moves the
+ * relative error by less than 2^-50 and is skipped.
+ *
+ * @file z5d_calibrate.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define DEFAULT_DATA "data/KNOWN_PRIMES.md"
+#define DEFAULT_ERRORS_CSV "scripts/output/calibration_errors.csv"
+#define DEFAULT_COMPARISON_CSV "scripts/output/calibration_comparison.csv"
+
+/* Estimates of points below this are rounded exactly in double */
+#define ROUND_EXACT_BELOW 1125899906842624.0   /* 2^50 */
+
+static double now_s(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* One reference point, reduced to doubles */
+typedef struct {
+    mpz_t n, p;
+    double pd;               /* p_n */
+    double pnt, d, e;        /* F = pnt + c d + kappa* e, unscaled (small p only) */
+    double r0, rd, re;       /* (pnt - p) / p, d / p, e / p */
+    double dpnt, dd, de;     /* Differences to the previous point, for monotonicity */
+} point_t;
+
+typedef struct {
+    point_t* pts;
+    size_t count, cap;
+} dataset_t;
+
+typedef struct {
+    double c, kappa_star, max_rel_ppm, rms_ppm;
+} eval_t;
+
+/* ---- Dataset ---- */
+
+/* Integer with optional , or _ separators and surrounding blanks */
+static int parse_int(mpz_t v, const char* s, size_t len) {
+    char buf[128];
+    size_t k = 0;
+    for (size_t i = 0; i < len; i++) {
+        char ch = s[i];
+        if (ch == ',' || ch == '_' || ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') continue;
+        if (ch < '0' || ch > '9' || k + 1 >= sizeof(buf)) return -1;
+        buf[k++] = ch;
+    }
+    if (k == 0) return -1;
+    buf[k] = '\0';
+    return mpz_set_str(v, buf, 10);
+}
+
+static int dataset_add(dataset_t* ds, const mpz_t n, const mpz_t p) {
+    if (ds->count == ds->cap) {
+        size_t cap = ds->cap ? 2 * ds->cap : 64;
+        point_t* pts = realloc(ds->pts, cap * sizeof(*pts));
+        if (!pts) return -1;
+        ds->pts = pts;
+        ds->cap = cap;
+    }
+    point_t* pt = &ds->pts[ds->count++];
+    mpz_init_set(pt->n, n);
+    mpz_init_set(pt->p, p);
+    return 0;
+}
+
+static void dataset_clear(dataset_t* ds) {
+    for (size_t i = 0; i < ds->count; i++) mpz_clears(ds->pts[i].n, ds->pts[i].p, NULL);
+    free(ds->pts);
+    ds->pts = NULL;
+    ds->count = ds->cap = 0;
+}
+
+/* Field i of a line split on sep (for markdown, the leading | is field 0's start) */
+static int field(const char* line, char sep, int i, const char** start, size_t* len) {
+    const char* s = line;
+    for (int f = 0; f < i; f++) {
+        s = strchr(s, sep);
+        if (!s) return -1;
+        s++;
+    }
+    const char* end = strchr(s, sep);
+    *start = s;
+    *len = end ? (size_t)(end - s) : strlen(s);
+    return 0;
+}
+
+/* Markdown table rows "| n | scientific | p_n | source |", or CSV with n and p_n columns */
+static int load_pairs(dataset_t* ds, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: cannot open %s\n", path);
+        return -1;
+    }
+    size_t len = strlen(path);
+    int csv = len >= 4 && (strcmp(path + len - 4, ".csv") == 0 || strcmp(path + len - 4, ".CSV") == 0);
+    int n_col = -1, p_col = -1;
+    size_t before = ds->count;
+    char line[4096];
+    mpz_t n, p;
+    mpz_inits(n, p, NULL);
+    while (fgets(line, sizeof(line), f)) {
+        const char *a, *b;
+        size_t al, bl;
+        if (csv) {
+            if (n_col < 0) {
+                for (int i = 0; field(line, ',', i, &a, &al) == 0; i++) {
+                    while (al && (a[al - 1] == '\n' || a[al - 1] == '\r' || a[al - 1] == ' ')) al--;
+                    if (al == 1 && a[0] == 'n') n_col = i;
+                    if (al == 3 && strncmp(a, "p_n", 3) == 0) p_col = i;
+                }
+                if (n_col < 0 || p_col < 0) {
+                    fprintf(stderr, "Error: CSV must have headers: n,p_n\n");
+                    break;
+                }
+                continue;
+            }
+            if (field(line, ',', n_col, &a, &al) != 0 || field(line, ',', p_col, &b, &bl) != 0 ||
+                parse_int(n, a, al) != 0 || parse_int(p, b, bl) != 0) {
+                continue;
+            }
+        } else {
+            const char* row = line;
+            while (*row == ' ' || *row == '\t') row++;
+            if (*row != '|') continue;
+            row++;
+            if (field(row, '|', 0, &a, &al) != 0 || field(row, '|', 2, &b, &bl) != 0 ||
+                parse_int(n, a, al) != 0 || parse_int(p, b, bl) != 0) {
+                continue;
+            }
+        }
+        if (dataset_add(ds, n, p) != 0) break;
+    }
+    mpz_clears(n, p, NULL);
+    fclose(f);
+    if (ds->count == before) {
+        fprintf(stderr, "Error: no rows parsed from %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmp_point(const void* a, const void* b) {
+    return mpz_cmp(((const point_t*)a)->n, ((const point_t*)b)->n);
+}
+
+/* F at (c, kappa*) as an mpfr, through the library at its planned precision */
+static int closed_form_at(z5d_ctx_t* ctx, mpfr_t out, const mpz_t n, long c, long kappa) {
+    mpq_set_si(ctx->config.c_cal, c, 1);
+    mpq_set_si(ctx->config.kappa_star, kappa, 1);
+    return z5d_closed_form_ctx(ctx, out, n);
+}
+
+/* pnt, D and E of every point, reduced to doubles */
+static int precompute(dataset_t* ds) {
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    mpfr_t pnt, d, e, t, pnt_prev, d_prev, e_prev;
+    mpfr_inits2(Z5D_DEFAULT_PRECISION, pnt, d, e, t, pnt_prev, d_prev, e_prev, (mpfr_ptr)0);
+    int ret = 0;
+    for (size_t i = 0; i < ds->count && ret == 0; i++) {
+        point_t* pt = &ds->pts[i];
+        if (closed_form_at(&ctx, pnt, pt->n, 0, 0) != 0 || closed_form_at(&ctx, d, pt->n, 1, 0) != 0 ||
+            closed_form_at(&ctx, e, pt->n, 0, 1) != 0) {
+            ret = -1;
+            break;
+        }
+        mpfr_prec_t prec = mpfr_get_prec(pnt);
+        mpfr_set_prec(t, prec);
+        mpfr_sub(d, d, pnt, MPFR_RNDN);
+        mpfr_sub(e, e, pnt, MPFR_RNDN);
+
+        pt->pd = mpz_get_d(pt->p);
+        pt->pnt = mpfr_get_d(pnt, MPFR_RNDN);
+        pt->d = mpfr_get_d(d, MPFR_RNDN);
+        pt->e = mpfr_get_d(e, MPFR_RNDN);
+        mpfr_sub_z(t, pnt, pt->p, MPFR_RNDN);
+        mpfr_div_z(t, t, pt->p, MPFR_RNDN);
+        pt->r0 = mpfr_get_d(t, MPFR_RNDN);
+        mpfr_div_z(t, d, pt->p, MPFR_RNDN);
+        pt->rd = mpfr_get_d(t, MPFR_RNDN);
+        mpfr_div_z(t, e, pt->p, MPFR_RNDN);
+        pt->re = mpfr_get_d(t, MPFR_RNDN);
+
+        pt->dpnt = pt->dd = pt->de = 0.0;
+        if (i > 0) {
+            mpfr_set_prec(t, prec + 64);
+            mpfr_sub(t, pnt, pnt_prev, MPFR_RNDN);
+            pt->dpnt = mpfr_get_d(t, MPFR_RNDN);
+            mpfr_sub(t, d, d_prev, MPFR_RNDN);
+            pt->dd = mpfr_get_d(t, MPFR_RNDN);
+            mpfr_sub(t, e, e_prev, MPFR_RNDN);
+            pt->de = mpfr_get_d(t, MPFR_RNDN);
+        }
+        mpfr_set_prec(pnt_prev, prec);
+        mpfr_set_prec(d_prev, prec);
+        mpfr_set_prec(e_prev, prec);
+        mpfr_set(pnt_prev, pnt, MPFR_RNDN);
+        mpfr_set(d_prev, d, MPFR_RNDN);
+        mpfr_set(e_prev, e, MPFR_RNDN);
+    }
+    mpfr_clears(pnt, d, e, t, pnt_prev, d_prev, e_prev, (mpfr_ptr)0);
+    z5d_ctx_clear(&ctx);
+    return ret;
+}
+
+/* ---- Grid ---- */
+
+/* Max and RMS relative error in ppm; both infinite if the estimates decrease */
+static eval_t eval_coeffs(const dataset_t* ds, double c, double kappa) {
+    eval_t r = { c, kappa, INFINITY, INFINITY };
+    double max_rel = -INFINITY, sum_sq = 0.0;
+    for (size_t i = 0; i < ds->count; i++) {
+        const point_t* pt = &ds->pts[i];
+        if (i > 0 && pt->dpnt + c * pt->dd + kappa * pt->de < 0.0) return r;
+        double rel;
+        if (pt->pd < ROUND_EXACT_BELOW) {
+            double est = floor(pt->pnt + c * pt->d + kappa * pt->e + 0.5);
+            rel = fabs(est - pt->pd) / pt->pd * 1e6;
+        } else {
+            rel = fabs(pt->r0 + c * pt->rd + kappa * pt->re) * 1e6;
+        }
+        if (rel > max_rel) max_rel = rel;
+        sum_sq += rel * rel;
+    }
+    r.max_rel_ppm = max_rel;
+    r.rms_ppm = sqrt(sum_sq / (double)ds->count);
+    return r;
+}
+
+static double linspace_at(double start, double stop, int num, int i) {
+    if (num == 1) return start;
+    return start + i * ((stop - start) / (num - 1));
+}
+
+typedef struct {
+    const dataset_t* ds;
+    double c_lo, c_hi, k_lo, k_hi;
+    int c_steps, k_steps, threads, id;
+    eval_t* row_best;        /* Best cell of each c row */
+} sweep_t;
+
+static void* sweep_rows(void* arg) {
+    sweep_t* sw = (sweep_t*)arg;
+    for (int i = sw->id; i < sw->c_steps; i += sw->threads) {
+        double c = linspace_at(sw->c_lo, sw->c_hi, sw->c_steps, i);
+        eval_t best = { 0.0, 0.0, INFINITY, INFINITY };
+        for (int j = 0; j < sw->k_steps; j++) {
+            eval_t r = eval_coeffs(sw->ds, c, linspace_at(sw->k_lo, sw->k_hi, sw->k_steps, j));
+            if (isfinite(r.max_rel_ppm) && r.max_rel_ppm < best.max_rel_ppm) best = r;
+        }
+        sw->row_best[i] = best;
+    }
+    return NULL;
+}
+
+/* Lowest max error over the grid; ties go to the first cell in c-major order */
+static eval_t grid_search(const dataset_t* ds, double c_lo, double c_hi, double k_lo,
+                          double k_hi, int c_steps, int k_steps, int threads) {
+    eval_t best = { 0.0, 0.0, INFINITY, INFINITY };
+    eval_t* row_best = malloc((size_t)c_steps * sizeof(*row_best));
+    sweep_t* sw = malloc((size_t)threads * sizeof(*sw));
+    pthread_t* tids = malloc((size_t)threads * sizeof(*tids));
+    if (!row_best || !sw || !tids) {
+        free(row_best);
+        free(sw);
+        free(tids);
+        return best;
+    }
+    if (threads > c_steps) threads = c_steps;
+    for (int t = 0; t < threads; t++) {
+        sw[t] = (sweep_t){ ds, c_lo, c_hi, k_lo, k_hi, c_steps, k_steps, threads, t, row_best };
+    }
+    int started = 0;
+    while (started + 1 < threads &&
+           pthread_create(&tids[started + 1], NULL, sweep_rows, &sw[started + 1]) == 0) {
+        started++;
+    }
+    /* Rows of workers that failed to start are swept here */
+    for (int t = started + 1; t < threads; t++) sweep_rows(&sw[t]);
+    sweep_rows(&sw[0]);
+    for (int t = 1; t <= started; t++) pthread_join(tids[t], NULL);
+    for (int i = 0; i < c_steps; i++) {
+        if (row_best[i].max_rel_ppm < best.max_rel_ppm) best = row_best[i];
+    }
+    free(row_best);
+    free(sw);
+    free(tids);
+    return best;
+}
+
+/* ---- Output ---- */
+
+/* Shortest decimal that reads back as v, as Python's repr */
+static void fmt_double(char* buf, size_t size, double v) {
+    for (int digits = 1; digits <= 17; digits++) {
+        snprintf(buf, size, "%.*g", digits, v);
+        if (strtod(buf, NULL) == v) break;
+    }
+    if (isinf(v)) snprintf(buf, size, v > 0 ? "inf" : "-inf");
+    else if (!strchr(buf, '.') && !strchr(buf, 'e') && !strchr(buf, 'n')) strncat(buf, ".0", size - strlen(buf) - 1);
+}
+
+/* Create the parent directories of path */
+static int make_parents(const char* path) {
+    char dir[4096];
+    snprintf(dir, sizeof(dir), "%s", path);
+    for (char* s = dir + 1; *s; s++) {
+        if (*s != '/') continue;
+        *s = '\0';
+        if (mkdir(dir, 0777) != 0 && errno != EEXIST) return -1;
+        *s = '/';
+    }
+    return 0;
+}
+
+static FILE* open_output(const char* path) {
+    FILE* f = (make_parents(path) == 0) ? fopen(path, "w") : NULL;
+    if (!f) fprintf(stderr, "Error: cannot write %s\n", path);
+    return f;
+}
+
+/* Per-n errors at (c, kappa*) from the library at full precision */
+static int write_errors_csv(const char* path, const dataset_t* ds, double c, double kappa) {
+    FILE* f = open_output(path);
+    if (!f) return -1;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    mpq_set_d(ctx.config.c_cal, c);
+    mpq_set_d(ctx.config.kappa_star, kappa);
+    mpfr_t est, rel;
+    mpfr_init2(est, Z5D_DEFAULT_PRECISION);
+    mpfr_init2(rel, 53);
+    mpz_t e, err;
+    mpz_inits(e, err, NULL);
+    fprintf(f, "n,p_n,estimate,abs_error,rel_error_ppm\n");
+    int ret = 0;
+    for (size_t i = 0; i < ds->count; i++) {
+        const point_t* pt = &ds->pts[i];
+        if (z5d_closed_form_ctx(&ctx, est, pt->n) != 0) {
+            ret = -1;
+            break;
+        }
+        mpfr_add_d(est, est, 0.5, MPFR_RNDN);
+        mpfr_get_z(e, est, MPFR_RNDD);
+        mpz_sub(err, e, pt->p);
+        mpfr_set_z(rel, err, MPFR_RNDN);
+        mpfr_abs(rel, rel, MPFR_RNDN);
+        mpfr_div_z(rel, rel, pt->p, MPFR_RNDN);
+        char ppm[40];
+        fmt_double(ppm, sizeof(ppm), mpfr_get_d(rel, MPFR_RNDN) * 1e6);
+        gmp_fprintf(f, "%Zd,%Zd,%Zd,%Zd,%s\n", pt->n, pt->p, e, err, ppm);
+    }
+    mpz_clears(e, err, NULL);
+    mpfr_clears(est, rel, (mpfr_ptr)0);
+    z5d_ctx_clear(&ctx);
+    fclose(f);
+    return ret;
+}
+
+static int write_comparison_csv(const char* path, const eval_t* rows, size_t count) {
+    FILE* f = open_output(path);
+    if (!f) return -1;
+    fprintf(f, "c,kappa_star,max_rel_ppm,rms_ppm\n");
+    for (size_t i = 0; i < count; i++) {
+        char a[40], b[40], m[40], r[40];
+        fmt_double(a, sizeof(a), rows[i].c);
+        fmt_double(b, sizeof(b), rows[i].kappa_star);
+        fmt_double(m, sizeof(m), rows[i].max_rel_ppm);
+        fmt_double(r, sizeof(r), rows[i].rms_ppm);
+        fprintf(f, "%s,%s,%s,%s\n", a, b, m, r);
+    }
+    fclose(f);
+    return 0;
+}
+
+static void print_usage(const char* prog_name) {
+    printf("Z5D calibration sweep v%s\n", z5d_get_version());
+    printf("Usage: %s [options]   (run from the repository root)\n", prog_name);
+    printf("\nOptions (as scripts/calibrate_de_terms.py):\n");
+    printf("  --data <file>            Dataset, markdown table or CSV with n,p_n (default: %s)\n",
+           DEFAULT_DATA);
+    printf("  --extra-csv <file>       Additional CSV with n,p_n to append\n");
+    printf("  --min-n <n>              Minimum n supported (default: 10000)\n");
+    printf("  --filter-below-min       Drop rows with n < --min-n instead of exiting\n");
+    printf("  --c-bounds <lo> <hi>     Range of c (default: -0.01 0.01)\n");
+    printf("  --k-bounds <lo> <hi>     Range of kappa* (default: 0.0 0.2)\n");
+    printf("  --c-steps <n>            Grid steps for c (default: 25)\n");
+    printf("  --k-steps <n>            Grid steps for kappa* (default: 25)\n");
+    printf("  --refine                 Refinement pass around the best coarse result\n");
+    printf("  --refine-factor <f>      Span as a fraction of the coarse step (default: 0.2)\n");
+    printf("  --refine-steps <n>       Grid steps of the refinement pass (default: 15)\n");
+    printf("  --compare                Also evaluate the built-in constants and perturbations\n");
+    printf("  --delta-c <d>            Perturbation of c for --compare (default: 0.0001)\n");
+    printf("  --delta-k <d>            Perturbation of kappa* for --compare (default: 0.001)\n");
+    printf("  --errors-csv <file>      Per-n errors (default: %s)\n", DEFAULT_ERRORS_CSV);
+    printf("  --comparison-csv <file>  Comparison table (default: %s)\n", DEFAULT_COMPARISON_CSV);
+    printf("  -j <threads>             Sweep threads (default: all CPUs)\n");
+    printf("  -h                       Show this help\n");
+    printf("\nExamples:\n");
+    printf("  %s --refine --compare\n", prog_name);
+    printf("  %s --c-steps 2001 --k-steps 2001 -j 8\n", prog_name);
+}
+
+int main(int argc, char** argv) {
+    const char* data_path = DEFAULT_DATA;
+    const char* extra_csv = NULL;
+    const char* errors_csv = DEFAULT_ERRORS_CSV;
+    const char* comparison_csv = DEFAULT_COMPARISON_CSV;
+    mpz_t min_n;
+    mpz_init_set_ui(min_n, 10000);
+    int filter_below_min = 0, refine = 0, compare = 0;
+    double c_bounds[2] = { -0.01, 0.01 }, k_bounds[2] = { 0.0, 0.2 };
+    int c_steps = 25, k_steps = 25, refine_steps = 15, threads = 0;
+    double refine_factor = 0.2, delta_c = 0.0001, delta_k = 0.001;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        int more = i + 1 < argc;
+        if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            print_usage(argv[0]);
+            mpz_clear(min_n);
+            return 0;
+        } else if (strcmp(a, "--data") == 0 && more) {
+            data_path = argv[++i];
+        } else if (strcmp(a, "--extra-csv") == 0 && more) {
+            extra_csv = argv[++i];
+        } else if (strcmp(a, "--min-n") == 0 && more) {
+            mpz_set_str(min_n, argv[++i], 10);
+        } else if (strcmp(a, "--filter-below-min") == 0) {
+            filter_below_min = 1;
+        } else if (strcmp(a, "--c-bounds") == 0 && i + 2 < argc) {
+            c_bounds[0] = atof(argv[++i]);
+            c_bounds[1] = atof(argv[++i]);
+        } else if (strcmp(a, "--k-bounds") == 0 && i + 2 < argc) {
+            k_bounds[0] = atof(argv[++i]);
+            k_bounds[1] = atof(argv[++i]);
+        } else if (strcmp(a, "--c-steps") == 0 && more) {
+            c_steps = atoi(argv[++i]);
+        } else if (strcmp(a, "--k-steps") == 0 && more) {
+            k_steps = atoi(argv[++i]);
+        } else if (strcmp(a, "--refine") == 0) {
+            refine = 1;
+        } else if (strcmp(a, "--refine-factor") == 0 && more) {
+            refine_factor = atof(argv[++i]);
+        } else if (strcmp(a, "--refine-steps") == 0 && more) {
+            refine_steps = atoi(argv[++i]);
+        } else if (strcmp(a, "--compare") == 0) {
+            compare = 1;
+        } else if (strcmp(a, "--delta-c") == 0 && more) {
+            delta_c = atof(argv[++i]);
+        } else if (strcmp(a, "--delta-k") == 0 && more) {
+            delta_k = atof(argv[++i]);
+        } else if (strcmp(a, "--errors-csv") == 0 && more) {
+            errors_csv = argv[++i];
+        } else if (strcmp(a, "--comparison-csv") == 0 && more) {
+            comparison_csv = argv[++i];
+        } else if (strcmp(a, "-j") == 0 && more) {
+            threads = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Error: unknown option %s\n", a);
+            print_usage(argv[0]);
+            mpz_clear(min_n);
+            return 1;
+        }
+    }
+    if (c_steps < 1 || k_steps < 1 || refine_steps < 1) {
+        fprintf(stderr, "Error: grid steps must be at least 1\n");
+        mpz_clear(min_n);
+        return 1;
+    }
+    if (threads < 1) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    dataset_t ds = { NULL, 0, 0 };
+    int ret = 1;
+    if (load_pairs(&ds, data_path) != 0 || (extra_csv && load_pairs(&ds, extra_csv) != 0)) goto out;
+    qsort(ds.pts, ds.count, sizeof(*ds.pts), cmp_point);
+
+    if (mpz_cmp(ds.pts[0].n, min_n) < 0) {
+        if (!filter_below_min) {
+            gmp_fprintf(stderr,
+                        "Dataset contains n<%Zd (min=%Zd). Small n not supported by default; "
+                        "rerun with --filter-below-min to drop them or lower --min-n if you "
+                        "intentionally want to include small n.\n", min_n, ds.pts[0].n);
+            goto out;
+        }
+        size_t keep = 0;
+        for (size_t i = 0; i < ds.count; i++) {
+            if (mpz_cmp(ds.pts[i].n, min_n) >= 0) ds.pts[keep++] = ds.pts[i];
+            else mpz_clears(ds.pts[i].n, ds.pts[i].p, NULL);
+        }
+        ds.count = keep;
+        if (ds.count == 0) {
+            gmp_fprintf(stderr, "All rows filtered out by min-n=%Zd. Provide larger-n data.\n", min_n);
+            goto out;
+        }
+    }
+
+    double t0 = now_s();
+    if (precompute(&ds) != 0) {
+        fprintf(stderr, "Error: closed form failed on the dataset\n");
+        goto out;
+    }
+    double t1 = now_s();
+
+    /* Coarse search, then an optional refinement around its best cell */
+    eval_t best = grid_search(&ds, c_bounds[0], c_bounds[1], k_bounds[0], k_bounds[1], c_steps,
+                              k_steps, threads);
+    long cells = (long)c_steps * k_steps;
+    if (refine) {
+        double c_step = (c_bounds[1] - c_bounds[0]) / (c_steps > 1 ? c_steps - 1 : 1);
+        double k_step = (k_bounds[1] - k_bounds[0]) / (k_steps > 1 ? k_steps - 1 : 1);
+        double c_span = c_step * refine_factor, k_span = k_step * refine_factor;
+        best = grid_search(&ds, best.c - c_span, best.c + c_span, best.kappa_star - k_span,
+                           best.kappa_star + k_span, refine_steps, refine_steps, threads);
+        cells += (long)refine_steps * refine_steps;
+    }
+    double t2 = now_s();
+
+    eval_t best_res = eval_coeffs(&ds, best.c, best.kappa_star);
+    if (write_errors_csv(errors_csv, &ds, best_res.c, best_res.kappa_star) != 0) goto out;
+
+    printf("Best coefficients:\n");
+    printf("  c          = %.8f\n", best_res.c);
+    printf("  kappa_star = %.8f\n", best_res.kappa_star);
+    printf("  max_rel_ppm= %.6f\n", best_res.max_rel_ppm);
+    printf("  rms_ppm    = %.6f\n", best_res.rms_ppm);
+    printf("Per-n errors written to: %s\n", errors_csv);
+
+    if (compare) {
+        eval_t rows[10];
+        size_t count = 0;
+        double c0 = atof(Z5D_DEFAULT_C_CAL), k0 = atof(Z5D_DEFAULT_KAPPA_STAR);
+        double cs[3] = { c0, c0 + delta_c, c0 - delta_c }, ks[3] = { k0, k0 + delta_k, k0 - delta_k };
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) rows[count++] = eval_coeffs(&ds, cs[i], ks[j]);
+        }
+        rows[count++] = best_res;
+        if (write_comparison_csv(comparison_csv, rows, count) != 0) goto out;
+        printf("Comparison table written to: %s\n", comparison_csv);
+    }
+    printf("%zu points prepared in %.3f s; %ld cells swept in %.3f s on %d threads\n", ds.count,
+           t1 - t0, cells, t2 - t1, threads);
+    ret = 0;
+
+out:
+    dataset_clear(&ds);
+    mpz_clear(min_n);
+    z5d_cleanup();
+    return ret;
+}
@@ -2,7 +2,9 @@
  * Z5D nth-Prime Predictor - Command Line Interface
  * ================================================
  * 
- * CLI tool for predicting nth prime using Z5D predictor.
+ * CLI tool for predicting nth prime using Z5D predictor. With --batch it
+ * streams newline-separated indices from a file or stdin through a pool of
+ * workers, one context each, and writes one NDJSON or CSV record per index.
  * 
  * @file z5d_cli.c
  * @version 1.0
@@ -13,21 +15,294 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <mpfr.h>
 #include <gmp.h>
 
 static void print_usage(const char* prog_name) {
     printf("Z5D nth-Prime Predictor v%s\n", z5d_get_version());
     printf("Usage: %s [options] <n>\n", prog_name);
+    printf("       %s --batch [options] [file]   (n per line from file or stdin)\n", prog_name);
     printf("\nOptions:\n");
-    printf("  -p <precision>  MPFR precision in bits (default: %d)\n", Z5D_DEFAULT_PRECISION);
-    printf("  -v              Verbose output\n");
+    printf("  -p <precision>  Minimum MPFR precision in bits (default: %d; raised per n as needed)\n", Z5D_DEFAULT_PRECISION);
+    printf("  -j <threads>    Refinement worker threads (default: 1)\n");
+    printf("  -r              Riemann R engine: invert R(x) = n instead of the closed form\n");
+    printf("  --c-cal <c>     Closed-form d-term coefficient (default: %s)\n", Z5D_DEFAULT_C_CAL);
+    printf("  --kappa-star <k> Closed-form e-term coefficient (default: %s)\n",
+           Z5D_DEFAULT_KAPPA_STAR);
+    printf("  -e              Exact n-th prime via prime counting (n <= %llu)\n",
+           (unsigned long long)Z5D_EXACT_MAX_N);
+    printf("  -a <file>       Anchor index (z5d_anchor_gen): exact p_n where it covers n\n");
+    printf("  -s <file>       Result store: refined answers persist across runs\n");
+    printf("  -c <entries>    In-memory result cache size (default with -s: %d)\n",
+           Z5D_CACHE_DEFAULT_ENTRIES);
+    printf("  -v              Verbose output (batch: summary on stderr)\n");
     printf("  -h              Show this help\n");
+    printf("\nBatch mode:\n");
+    printf("  --batch         Read n per line (blank and # lines skipped), one record each\n");
+    printf("  -w <workers>    Worker threads, one context each (default: all CPUs)\n");
+    printf("  --csv           CSV records instead of NDJSON\n");
+    printf("  --unordered     Emit records as they complete instead of in input order\n");
     printf("\nArguments:\n");
     printf("  <n>             Index of prime to predict (positive integer, arbitrary size)\n");
     printf("\nExamples:\n");
     printf("  %s 1000000\n", prog_name);
-    printf("  %s -k 10 -p 300 1000000000\n", prog_name);
+    printf("  %s -r -p 300 1000000000\n", prog_name);
+    printf("  %s --c-cal -0.0002 --kappa-star 0.07 1000000000\n", prog_name);
+    printf("  %s -e 1000000000000\n", prog_name);
+    printf("  %s -a anchors.z5d 123456789012\n", prog_name);
+    printf("  %s -s results.z5dc 10000000000000000000000000000000000000000\n", prog_name);
+    printf("  seq 1000000 1000 2000000 | %s --batch -w 4 > primes.ndjson\n", prog_name);
+}
+
+/* Result cache for -c / -s; none unless one of them is given */
+static int open_cache(z5d_cache_t** cache, long entries, const char* store_path) {
+    *cache = NULL;
+    if (entries <= 0 && !store_path) return 0;
+    if (entries <= 0) entries = Z5D_CACHE_DEFAULT_ENTRIES;
+    if (z5d_cache_open(cache, (size_t)entries, store_path) != 0) {
+        fprintf(stderr, "Error: cannot open result cache%s%s\n", store_path ? " store " : "",
+                store_path ? store_path : "");
+        return -1;
+    }
+    return 0;
+}
+
+static void print_cache_stats(FILE* out, z5d_cache_t* cache) {
+    z5d_cache_stats_t cs;
+    z5d_cache_get_stats(cache, &cs);
+    fprintf(out, "cache: %llu hits, %llu from the store, %llu misses; %zu/%zu entries, "
+            "%zu stored (%llu appended)\n",
+            (unsigned long long)cs.hits, (unsigned long long)cs.store_hits,
+            (unsigned long long)cs.misses, cs.entries, cs.capacity, cs.store_entries,
+            (unsigned long long)cs.store_appends);
+}
+
+/* --------- Batch mode --------- */
+
+/* Records in flight: bounds memory when an early record is slow */
+#define BATCH_WINDOW 4096
+
+typedef enum { SLOT_FREE, SLOT_PENDING, SLOT_DONE } slot_state_t;
+
+typedef struct {
+    slot_state_t state;
+    char* input;             /* Trimmed line */
+    char* output;            /* Formatted record */
+} batch_slot_t;
+
+typedef struct {
+    const z5d_config_t* config;
+    int exact, csv, ordered;
+    batch_slot_t slots[BATCH_WINDOW];
+    uint64_t next_read;      /* Sequence number of the next line read */
+    uint64_t next_job;       /* Next record handed to a worker */
+    uint64_t next_emit;      /* Next record written (ordered mode) */
+    uint64_t errors;
+    int eof;
+    pthread_mutex_t lock;
+    pthread_cond_t job_ready, slot_free;
+} batch_t;
+
+static double mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Input echoed in an error record: printable ASCII only, quotes dropped */
+static void sanitize(char* dst, size_t size, const char* src) {
+    size_t j = 0;
+    for (size_t i = 0; src[i] && j + 1 < size; i++) {
+        unsigned char c = (unsigned char)src[i];
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\' && c != ',') dst[j++] = (char)c;
+    }
+    dst[j] = '\0';
+}
+
+/* Format one record; returns a malloc'd string */
+static char* batch_record(const batch_t* b, uint64_t seq, const char* in, const mpz_t pred,
+                          const mpz_t prime, double ms, const char* error) {
+    char* out = NULL;
+    int len;
+    if (error) {
+        char n[64];
+        sanitize(n, sizeof(n), in);
+        len = b->csv ? gmp_asprintf(&out, "%llu,%s,,,,%s\n", (unsigned long long)seq, n, error)
+                     : gmp_asprintf(&out, "{\"seq\":%llu,\"n\":\"%s\",\"error\":\"%s\"}\n",
+                                (unsigned long long)seq, n, error);
+    } else {
+        len = b->csv ? gmp_asprintf(&out, "%llu,%s,%Zd,%Zd,%.3f,\n", (unsigned long long)seq,
+                                    in, pred, prime, ms)
+                     : gmp_asprintf(&out, "{\"seq\":%llu,\"n\":\"%s\",\"prediction\":\"%Zd\","
+                                    "\"prime\":\"%Zd\",\"ms\":%.3f}\n",
+                                    (unsigned long long)seq, in, pred, prime, ms);
+    }
+    return len < 0 ? NULL : out;
+}
+
+/* Rounded closed form and answer for one index, as the single-n mode prints */
+static char* batch_solve(const batch_t* b, z5d_ctx_t* ctx, z5d_result_t* r, mpz_t n,
+                         mpz_t pred, mpz_t prime, uint64_t seq, const char* in, int* failed) {
+    *failed = 1;
+    if (mpz_set_str(n, in, 10) != 0 || mpz_sgn(n) <= 0) {
+        return batch_record(b, seq, in, pred, prime, 0.0, "n must be a positive integer");
+    }
+    if (b->exact && (!mpz_fits_ulong_p(n) || mpz_get_ui(n) > Z5D_EXACT_MAX_N)) {
+        return batch_record(b, seq, in, pred, prime, 0.0, "n out of range for exact mode");
+    }
+    double t0 = mono_ms();
+    int ret = z5d_predict_nth_prime_big_ctx(ctx, r, n);
+    if (ret == 0) mpfr_get_z(pred, r->predicted_prime, MPFR_RNDN);
+    if (ret == 0 && b->exact) {
+        uint64_t p = 0;
+        ret = z5d_nth_prime_exact_ctx(ctx, mpz_get_ui(n), &p);
+        mpz_set_ui(prime, p);
+    } else if (ret == 0) {
+        ret = z5d_predict_nth_prime_mpz_big_ctx(ctx, prime, n);
+    }
+    double ms = mono_ms() - t0;
+    *failed = (ret != 0);
+    return batch_record(b, seq, in, pred, prime, ms, ret == 0 ? NULL : "prediction failed");
+}
+
+/* Write finished records in input order; caller holds the lock */
+static void batch_flush_ordered(batch_t* b) {
+    for (;;) {
+        batch_slot_t* s = &b->slots[b->next_emit % BATCH_WINDOW];
+        if (b->next_emit >= b->next_read || s->state != SLOT_DONE) break;
+        if (s->output) fputs(s->output, stdout);
+        free(s->output);
+        s->output = NULL;
+        s->state = SLOT_FREE;
+        b->next_emit++;
+        pthread_cond_broadcast(&b->slot_free);
+    }
+}
+
+static void* batch_worker(void* p) {
+    batch_t* b = (batch_t*)p;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, b->config);
+    z5d_result_t r;
+    z5d_result_init(&r, b->config->precision);
+    mpz_t n, pred, prime;
+    mpz_inits(n, pred, prime, NULL);
+
+    pthread_mutex_lock(&b->lock);
+    for (;;) {
+        while (b->next_job >= b->next_read && !b->eof) pthread_cond_wait(&b->job_ready, &b->lock);
+        if (b->next_job >= b->next_read) break;   /* eof and drained */
+        uint64_t seq = b->next_job++;
+        batch_slot_t* s = &b->slots[seq % BATCH_WINDOW];
+        char* in = s->input;
+        s->input = NULL;
+        pthread_mutex_unlock(&b->lock);
+
+        int failed;
+        char* out = batch_solve(b, &ctx, &r, n, pred, prime, seq, in, &failed);
+        free(in);
+
+        pthread_mutex_lock(&b->lock);
+        b->errors += (failed || !out);
+        if (b->ordered) {
+            s->output = out;
+            s->state = SLOT_DONE;
+            batch_flush_ordered(b);
+        } else {
+            if (out) fputs(out, stdout);
+            free(out);
+            s->state = SLOT_FREE;
+            pthread_cond_broadcast(&b->slot_free);
+        }
+    }
+    pthread_mutex_unlock(&b->lock);
+
+    mpz_clears(n, pred, prime, NULL);
+    z5d_result_clear(&r);
+    z5d_ctx_clear(&ctx);
+    return NULL;
+}
+
+/* Strip surrounding whitespace in place; NULL for blank and comment lines */
+static char* trim_line(char* line) {
+    while (isspace((unsigned char)*line)) line++;
+    size_t len = strlen(line);
+    while (len > 0 && isspace((unsigned char)line[len - 1])) line[--len] = '\0';
+    return (len == 0 || line[0] == '#') ? NULL : line;
+}
+
+static int run_batch(const z5d_config_t* config, FILE* in, int workers, int exact, int csv,
+                     int ordered, int verbose) {
+    batch_t* b = calloc(1, sizeof(*b));
+    pthread_t* tids = malloc((size_t)workers * sizeof(pthread_t));
+    if (!b || !tids) {
+        free(b);
+        free(tids);
+        return 1;
+    }
+    b->config = config;
+    b->exact = exact;
+    b->csv = csv;
+    b->ordered = ordered;
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->job_ready, NULL);
+    pthread_cond_init(&b->slot_free, NULL);
+
+    if (csv) printf("seq,n,prediction,prime,ms,error\n");
+    double t0 = mono_ms();
+    int started = 0;
+    for (; started < workers; started++) {
+        if (pthread_create(&tids[started], NULL, batch_worker, b) != 0) break;
+    }
+    if (started == 0) {
+        fprintf(stderr, "Error: cannot start batch workers\n");
+        free(tids);
+        free(b);
+        return 1;
+    }
+
+    char* line = NULL;
+    size_t cap = 0;
+    while (getline(&line, &cap, in) >= 0) {
+        char* n = trim_line(line);
+        if (!n) continue;
+        char* copy = strdup(n);
+        if (!copy) break;
+        pthread_mutex_lock(&b->lock);
+        batch_slot_t* s = &b->slots[b->next_read % BATCH_WINDOW];
+        while (s->state != SLOT_FREE) pthread_cond_wait(&b->slot_free, &b->lock);
+        s->state = SLOT_PENDING;
+        s->input = copy;
+        b->next_read++;
+        pthread_cond_signal(&b->job_ready);
+        pthread_mutex_unlock(&b->lock);
+    }
+    free(line);
+
+    pthread_mutex_lock(&b->lock);
+    b->eof = 1;
+    pthread_cond_broadcast(&b->job_ready);
+    pthread_mutex_unlock(&b->lock);
+    for (int i = 0; i < started; i++) pthread_join(tids[i], NULL);
+    fflush(stdout);
+
+    if (verbose) {
+        double s = (mono_ms() - t0) / 1e3;
+        fprintf(stderr, "%llu records (%llu errors) in %.3f s on %d workers, %.0f records/s\n",
+                (unsigned long long)b->next_read, (unsigned long long)b->errors, s, started,
+                s > 0.0 ? (double)b->next_read / s : 0.0);
+    }
+    int ret = b->errors ? 1 : 0;
+    pthread_mutex_destroy(&b->lock);
+    pthread_cond_destroy(&b->job_ready);
+    pthread_cond_destroy(&b->slot_free);
+    free(tids);
+    free(b);
+    return ret;
 }
 
 int main(int argc, char** argv) {
@@ -38,8 +313,17 @@ int main(int argc, char** argv) {
     
     // Parse command line options
     int precision = Z5D_DEFAULT_PRECISION;
+    int threads = 1;
     int verbose = 0;
+    int exact = 0;
+    int riemann = 0;
+    int batch = 0, workers = 0, csv = 0, ordered = 1;
+    const char* anchor_path = NULL;
+    const char* store_path = NULL;
+    long cache_entries = 0;
     const char* n_str = NULL;
+    const char* c_cal = NULL;
+    const char* kappa_star = NULL;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
@@ -47,13 +331,89 @@ int main(int argc, char** argv) {
             return 0;
         } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
             precision = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 1) threads = 1;
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            anchor_path = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            store_path = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            cache_entries = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--c-cal") == 0 && i + 1 < argc) {
+            c_cal = argv[++i];
+        } else if (strcmp(argv[i], "--kappa-star") == 0 && i + 1 < argc) {
+            kappa_star = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--riemann") == 0) {
+            riemann = 1;
+        } else if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--exact") == 0) {
+            exact = 1;
         } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
             verbose = 1;
-        } else if (argv[i][0] != '-') {
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = 1;
+        } else if (strcmp(argv[i], "--unordered") == 0) {
+            ordered = 0;
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
             n_str = argv[i];
         }
     }
     
+    if (c_cal || kappa_star) {
+        /* Validate once; both configs below take the same strings */
+        z5d_config_t probe;
+        z5d_config_init(&probe);
+        int bad = z5d_config_set_calibration(&probe, c_cal, kappa_star) != 0;
+        z5d_config_clear(&probe);
+        if (bad) {
+            fprintf(stderr, "Error: --c-cal / --kappa-star must be decimal numbers\n");
+            return 1;
+        }
+    }
+
+    if (batch) {
+        FILE* in = stdin;
+        if (n_str && strcmp(n_str, "-") != 0 && !(in = fopen(n_str, "r"))) {
+            fprintf(stderr, "Error: cannot open %s\n", n_str);
+            return 1;
+        }
+        z5d_anchor_index_t anchors;
+        if (anchor_path && z5d_anchor_open(&anchors, anchor_path) != 0) {
+            fprintf(stderr, "Error: cannot read anchor index %s\n", anchor_path);
+            if (in != stdin) fclose(in);
+            return 1;
+        }
+        z5d_cache_t* cache = NULL;
+        if (open_cache(&cache, cache_entries, store_path) != 0) {
+            if (anchor_path) z5d_anchor_close(&anchors);
+            if (in != stdin) fclose(in);
+            return 1;
+        }
+        if (workers < 1) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            workers = cpus > 0 ? (int)cpus : 1;
+        }
+        z5d_config_t config;
+        z5d_config_init(&config);
+        config.precision = precision;
+        config.engine = riemann ? Z5D_ENGINE_RIEMANN_R : Z5D_ENGINE_CLOSED_FORM;
+        config.threads = threads;
+        config.anchors = anchor_path ? &anchors : NULL;
+        config.cache = cache;
+        z5d_config_set_calibration(&config, c_cal, kappa_star);
+        int ret = run_batch(&config, in, workers, exact, csv, ordered, verbose);
+        if (verbose && cache) print_cache_stats(stderr, cache);
+        z5d_config_clear(&config);
+        z5d_cache_close(cache);
+        if (anchor_path) z5d_anchor_close(&anchors);
+        if (in != stdin) fclose(in);
+        return ret;
+    }
+
     if (n_str == NULL) {
         fprintf(stderr, "Error: Invalid or missing value for n\n");
         print_usage(argv[0]);
@@ -67,25 +427,61 @@ int main(int argc, char** argv) {
         mpz_clear(n_mpz);
         return 1;
     }
-    size_t bits = mpz_sizeinbase(n_mpz, 2);
-    if (precision == Z5D_DEFAULT_PRECISION) {
-        mpfr_prec_t suggested = (mpfr_prec_t)(bits + 2048);
-        if (suggested > precision) precision = suggested;
+    if (exact && (!mpz_fits_ulong_p(n_mpz) || mpz_get_ui(n_mpz) > Z5D_EXACT_MAX_N)) {
+        fprintf(stderr, "Error: exact mode needs n <= %llu\n", (unsigned long long)Z5D_EXACT_MAX_N);
+        mpz_clear(n_mpz);
+        return 1;
     }
-
-    // Initialize library
-    z5d_init();
-    
-    /* Set precision globally if user overrode */
-    if (precision != Z5D_DEFAULT_PRECISION) {
-        mpfr_set_default_prec(precision);
+    // Per-run context carries the precision floor; the library plans the
+    // working precision for n above it. No process-wide MPFR state is touched
+    z5d_anchor_index_t anchors;
+    if (anchor_path && z5d_anchor_open(&anchors, anchor_path) != 0) {
+        fprintf(stderr, "Error: cannot read anchor index %s\n", anchor_path);
+        mpz_clear(n_mpz);
+        return 1;
     }
+    z5d_cache_t* cache = NULL;
+    if (open_cache(&cache, cache_entries, store_path) != 0) {
+        if (anchor_path) z5d_anchor_close(&anchors);
+        mpz_clear(n_mpz);
+        return 1;
+    }
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.precision = precision;
+    config.engine = riemann ? Z5D_ENGINE_RIEMANN_R : Z5D_ENGINE_CLOSED_FORM;
+    config.threads = threads;
+    config.anchors = anchor_path ? &anchors : NULL;
+    config.cache = cache;
+    z5d_config_set_calibration(&config, c_cal, kappa_star);
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, &config);
+    z5d_config_clear(&config);
 
     // Print configuration if verbose
     if (verbose) {
         printf("Configuration:\n");
         gmp_printf("  n           = %Zd\n", n_mpz);
-        printf("  precision   = %d bits (~%d decimal places)\n", precision, (int)(precision * 0.30103));
+        mpfr_prec_t planned = z5d_plan_precision(n_mpz);
+        if (planned < precision) planned = precision;
+        printf("  precision   = %ld bits planned (~%d decimal places), floor %d\n",
+               (long)planned, (int)(planned * 0.30103), precision);
+        printf("  threads     = %d\n", threads);
+        if (riemann && !exact) printf("  engine      = Riemann R inversion\n");
+        if (!z5d_config_default_calibration(&ctx.config)) {
+            printf("  calibration = c %s, kappa* %s\n", c_cal ? c_cal : Z5D_DEFAULT_C_CAL,
+                   kappa_star ? kappa_star : Z5D_DEFAULT_KAPPA_STAR);
+        }
+        if (anchor_path) {
+            printf("  anchors     = %s (%llu anchors, every %llu indices)\n", anchor_path,
+                   (unsigned long long)anchors.count, (unsigned long long)anchors.stride);
+        }
+        if (cache) {
+            z5d_cache_stats_t cs;
+            z5d_cache_get_stats(cache, &cs);
+            printf("  cache       = %zu entries%s%s (%zu stored)\n", cs.capacity,
+                   store_path ? ", store " : "", store_path ? store_path : "", cs.store_entries);
+        }
         printf("\n");
     }
     
@@ -93,16 +489,47 @@ int main(int argc, char** argv) {
     printf("Predicting the n-th prime...\n");
     mpz_t prime;
     mpz_init(prime);
-    int ret = z5d_predict_nth_prime_mpz_big(prime, n_mpz);
+    int ret;
+    if (exact) {
+        uint64_t p = 0;
+        ret = z5d_nth_prime_exact_ctx(&ctx, mpz_get_ui(n_mpz), &p);
+        mpz_set_ui(prime, p);
+    } else {
+        ret = z5d_predict_nth_prime_mpz_big_ctx(&ctx, prime, n_mpz);
+    }
 
     printf("\nResults:\n");
     gmp_printf("  Predicted prime: %Zd\n", prime);
     if (verbose) {
-        printf("  Note: derived via calibrated Z5D predictor + discrete refinement\n");
+        if (ctx.stats.anchor_hits) {
+            printf("  Note: exact p_n, walked from the nearest anchor\n");
+        } else if (ctx.stats.cache_hits) {
+            printf("  Note: answered from the result cache\n");
+        } else if (exact) {
+            printf("  Note: exact p_n (%llu pi(x) evaluations)\n",
+                   (unsigned long long)ctx.stats.pi_evaluations);
+        } else if (riemann && ctx.stats.halley_steps) {
+            printf("  Note: derived via R(x) = n (%llu Halley steps) + discrete refinement\n",
+                   (unsigned long long)ctx.stats.halley_steps);
+        } else {
+            printf("  Note: derived via calibrated Z5D predictor + discrete refinement\n");
+        }
+        if (z5d_stats_enabled() && !exact && !ctx.stats.anchor_hits && !ctx.stats.cache_hits) {
+            const z5d_call_stats_t* c = &ctx.last_call;
+            printf("\nStages:\n");
+            printf("  predict     = %.3f us (%ld bits)\n", c->predict_ns / 1e3, (long)c->precision);
+            printf("  round       = %.3f us\n", c->round_ns / 1e3);
+            printf("  refine      = %.3f us: +%llu from the prediction, %llu candidates, "
+                   "%llu survivors, %llu PRP tests\n", c->refine_ns / 1e3,
+                   (unsigned long long)c->distance, (unsigned long long)c->candidates,
+                   (unsigned long long)c->sieve_survivors, (unsigned long long)c->prp_tests);
+        }
     }
 
     mpz_clear(prime);
     mpz_clear(n_mpz);
-    z5d_cleanup();
+    z5d_ctx_clear(&ctx);
+    z5d_cache_close(cache);
+    if (anchor_path) z5d_anchor_close(&anchors);
     return ret;
 }
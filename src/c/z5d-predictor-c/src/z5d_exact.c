@@ -0,0 +1,685 @@
+/**
+ * Z5D Exact Mode - Prime Counting and nth Prime
+ * =============================================
+ *
+ * pi(x) for x < 2^64 by the Lagarias-Miller-Odlyzko combinatorial method,
+ * and the exact nth prime on top of it: pi() is evaluated at the Z5D
+ * prediction, a Newton step on pi() absorbs any large residual, and the rest
+ * is walked with a presieved primality test.
+ *
+ * LMO with y = alpha * x^(1/3), z = x / y and a = pi(y):
+ *
+ *   pi(x) = phi(x, a) + a - 1 - P2(x, a),       phi(x, a) = S1 + S2
+ *
+ *   S1 = sum over squarefree n <= y with lpf(n) > p_c of mu(n) phi(x/n, c)
+ *   S2 = -sum over c <= b < a, squarefree m <= y < m p_{b+1},
+ *        lpf(m) > p_{b+1} of mu(m) phi(x / (m p_{b+1}), b)
+ *   P2 = sum over y < q <= sqrt(x) of (pi(x/q) - pi(q) + 1)
+ *
+ * phi(., c) for the first c = 6 primes comes from a 30030-entry table. S2
+ * and P2 share one segmented sieve over [1, z] with a Fenwick tree for the
+ * counts; after all a primes have been crossed off a segment, its survivors
+ * are exactly 1 and the primes in it, which is what P2 needs. Special
+ * leaves with x/(mp) below both y and p^2 are "easy": phi is read off the
+ * pi table instead of the tree.
+ *
+ * @file z5d_exact.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include "z5d_exact.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Below this pi(x) is a plain sieve */
+#define EXACT_SIEVE_MAX 10000000ULL
+/* Largest y (memory: ~9 bytes per m <= y) */
+#define EXACT_MAX_Y (1ULL << 24)
+/* Residual prime count below which the nth-prime search always walks instead
+   of evaluating pi() again */
+#define EXACT_WALK_MAX 4096
+/* Past that it still walks while the expected span diff * ln x is at most
+   x^(2/3) / EXACT_WALK_COST: pi() at x costs about as much as walking that
+   many numbers, and a walk needs no further round trip */
+#define EXACT_WALK_COST 2.0
+/* Walk segment length (odd candidates) and presieve bound */
+#define EXACT_WALK_SEGMENT 4096
+#define EXACT_WALK_PRIMES 65536
+/* Longer walks: segment length and cap on the complete-sieve bound (covers
+   every x below 2^48 without a primality test) */
+#define EXACT_WALK_LONG_SEGMENT (1u << 18)
+#define EXACT_WALK_FULL_PRIMES (1ULL << 24)
+/* Odd residues of 3*5*7*11*13: the walk window starts from this pattern */
+#define WALK_PATTERN_PERIOD 15015u
+#define WALK_PATTERN_PRIMES 5   /* table primes it replaces */
+
+#define PHI_C 6
+#define PHI_PRIMORIAL 30030ULL   /* 2*3*5*7*11*13 */
+#define PHI_TOTIENT 5760ULL
+
+typedef __int128 i128;
+
+static uint64_t isqrt64(uint64_t x) {
+    uint64_t r = (uint64_t)sqrtl((long double)x);
+    while (r > 0 && (r > UINT32_MAX || r * r > x)) r--;
+    while (r < UINT32_MAX && (r + 1) * (r + 1) <= x) r++;
+    return r;
+}
+
+static uint64_t icbrt64(uint64_t x) {
+    uint64_t r = (uint64_t)cbrtl((long double)x);
+    while (r > 0 && (i128)r * r * r > (i128)x) r--;
+    while ((i128)(r + 1) * (r + 1) * (r + 1) <= (i128)x) r++;
+    return r;
+}
+
+/* --------- pi(x) by sieving, small x --------- */
+static uint64_t pi_sieve(uint64_t x) {
+    if (x < 2) return 0;
+    unsigned char* comp = calloc(x + 1, 1);
+    if (!comp) return UINT64_MAX;
+    uint64_t count = 0;
+    for (uint64_t i = 2; i <= x; i++) {
+        if (comp[i]) continue;
+        count++;
+        for (uint64_t j = i * i; j <= x; j += i) comp[j] = 1;
+    }
+    free(comp);
+    return count;
+}
+
+/* --------- LMO tables --------- */
+typedef struct {
+    uint64_t y;
+    uint32_t* primes;   /* primes[1..a], primes[0] = 1 */
+    uint64_t a;
+    uint32_t* lpf;      /* least prime factor, lpf[1] = UINT32_MAX */
+    int8_t* mu;         /* Moebius function */
+    uint32_t* pi;       /* pi[v] for v <= y */
+    uint16_t phi_table[PHI_PRIMORIAL];   /* phi(r, PHI_C) for r < primorial */
+} lmo_tables_t;
+
+static void lmo_tables_free(lmo_tables_t* t) {
+    free(t->primes);
+    free(t->lpf);
+    free(t->mu);
+    free(t->pi);
+}
+
+static int lmo_tables_init(lmo_tables_t* t, uint64_t y) {
+    memset(t, 0, sizeof(*t));
+    t->y = y;
+    t->lpf = calloc(y + 1, sizeof(*t->lpf));
+    t->mu = malloc((y + 1) * sizeof(*t->mu));
+    t->pi = malloc((y + 1) * sizeof(*t->pi));
+    t->primes = malloc((y / 2 + 2) * sizeof(*t->primes));
+    if (!t->lpf || !t->mu || !t->pi || !t->primes) {
+        lmo_tables_free(t);
+        return -1;
+    }
+
+    t->primes[0] = 1;
+    uint64_t a = 0;
+    for (uint64_t i = 2; i <= y; i++) {
+        if (t->lpf[i] == 0) {
+            t->primes[++a] = (uint32_t)i;
+            for (uint64_t j = i; j <= y; j += i) {
+                if (t->lpf[j] == 0) t->lpf[j] = (uint32_t)i;
+            }
+        }
+        t->pi[i] = (uint32_t)a;
+    }
+    t->a = a;
+    t->lpf[1] = UINT32_MAX;
+    t->pi[0] = t->pi[1] = 0;
+
+    t->mu[1] = 1;
+    for (uint64_t m = 2; m <= y; m++) {
+        uint64_t q = m / t->lpf[m];
+        t->mu[m] = (q % t->lpf[m] == 0) ? 0 : (int8_t)-t->mu[q];
+    }
+
+    /* phi(r, 6) for r < 30030 */
+    uint16_t run = 0;
+    for (uint64_t r = 0; r < PHI_PRIMORIAL; r++) {
+        if (r > 0 && r % 2 && r % 3 && r % 5 && r % 7 && r % 11 && r % 13) run++;
+        t->phi_table[r] = run;
+    }
+    return 0;
+}
+
+static inline uint64_t phi_c(const lmo_tables_t* t, uint64_t v) {
+    return (v / PHI_PRIMORIAL) * PHI_TOTIENT + t->phi_table[v % PHI_PRIMORIAL];
+}
+
+/* --------- Segment with a Fenwick tree over survivors --------- */
+typedef struct {
+    uint64_t size;      /* power of two */
+    uint8_t* alive;
+    int32_t* tree;      /* 1-based Fenwick tree over alive[] */
+} lmo_segment_t;
+
+static void fenwick_build(lmo_segment_t* s, uint64_t len) {
+    for (uint64_t i = 1; i <= s->size; i++) s->tree[i] = (i <= len) ? s->alive[i - 1] : 0;
+    for (uint64_t i = 1; i <= s->size; i++) {
+        uint64_t j = i + (i & (~i + 1));
+        if (j <= s->size) s->tree[j] += s->tree[i];
+    }
+}
+
+static inline void fenwick_dec(lmo_segment_t* s, uint64_t pos) {
+    for (uint64_t i = pos + 1; i <= s->size; i += i & (~i + 1)) s->tree[i]--;
+}
+
+/* survivors at offsets 0..pos */
+static inline uint64_t fenwick_prefix(const lmo_segment_t* s, uint64_t pos) {
+    int64_t sum = 0;
+    for (uint64_t i = pos + 1; i > 0; i -= i & (~i + 1)) sum += s->tree[i];
+    return (uint64_t)sum;
+}
+
+/* Primes in (lo, hi] using the table primes; returns them descending. */
+static uint64_t sieve_interval_desc(const lmo_tables_t* t, uint64_t lo, uint64_t hi,
+                                    uint8_t* buf, uint64_t* out) {
+    if (hi <= lo) return 0;
+    uint64_t len = hi - lo;             /* numbers lo+1 .. hi */
+    memset(buf, 1, len);
+    for (uint64_t b = 1; b <= t->a; b++) {
+        uint64_t p = t->primes[b];
+        if (p * p > hi) break;
+        uint64_t start = ((lo + 1 + p - 1) / p) * p;
+        if (start < p * p) start = p * p;
+        for (uint64_t m = start; m <= hi; m += p) buf[m - lo - 1] = 0;
+    }
+    uint64_t n = 0;
+    for (uint64_t i = len; i > 0; i--) {
+        if (buf[i - 1] && lo + i >= 2) out[n++] = lo + i;
+    }
+    return n;
+}
+
+static uint64_t choose_y(uint64_t x) {
+    double lx = log((double)x);
+    double alpha = lx * lx / 150.0;     /* balances special leaves vs. sieve */
+    if (alpha < 1.0) alpha = 1.0;
+    uint64_t cb = icbrt64(x);
+    uint64_t y = (uint64_t)((double)cb * alpha);
+    uint64_t sq = isqrt64(x);
+    if (y < cb) y = cb;
+    if (y > sq) y = sq;
+    if (y > EXACT_MAX_Y) y = EXACT_MAX_Y;
+    if (y < 64) y = 64;
+    return y;
+}
+
+static uint64_t pi_lmo(uint64_t x) {
+    uint64_t y = choose_y(x);
+    lmo_tables_t t;
+    if (lmo_tables_init(&t, y) != 0) return UINT64_MAX;
+
+    const uint64_t a = t.a;
+    const uint64_t c = PHI_C;
+    const uint64_t z = x / y;
+    const uint64_t sqrtx = isqrt64(x);
+
+    /* S1: ordinary leaves */
+    i128 s1 = 0;
+    for (uint64_t n = 1; n <= y; n++) {
+        if (t.mu[n] != 0 && t.lpf[n] > t.primes[c]) s1 += (i128)t.mu[n] * (i128)phi_c(&t, x / n);
+    }
+
+    /* Segment size: at least sqrt(z), at most 2^22 */
+    uint64_t seg = 1ULL << 16;
+    while (seg < (1ULL << 22) && seg * seg < z) seg <<= 1;
+    while (seg < (1ULL << 22) && seg < y) seg <<= 1;
+
+    lmo_segment_t s;
+    s.size = seg;
+    s.alive = malloc(seg);
+    s.tree = malloc((seg + 1) * sizeof(*s.tree));
+    uint64_t* phi_carry = calloc(a + 1, sizeof(*phi_carry));
+    /* x/q moves by less than one per q once q > sqrt(x) - seg, so the q of
+       one segment span at most seg + 1 integers */
+    uint64_t q_cap = seg + 2;
+    uint8_t* qbuf = malloc(q_cap);
+    uint64_t* qlist = malloc(q_cap * sizeof(*qlist));
+    if (!s.alive || !s.tree || !phi_carry || !qbuf || !qlist) {
+        free(s.alive); free(s.tree); free(phi_carry); free(qbuf); free(qlist);
+        lmo_tables_free(&t);
+        return UINT64_MAX;
+    }
+
+    i128 s2 = 0, p2_sum = 0;
+    uint64_t q_count = 0;
+
+    for (uint64_t low = 1; low <= z; low += seg) {
+        uint64_t high = low + seg;                  /* segment [low, high) */
+        if (high > z + 1) high = z + 1;
+        uint64_t len = high - low;
+
+        /* Survivors of the first c primes */
+        memset(s.alive, 1, len);
+        for (uint64_t b = 1; b <= c; b++) {
+            uint64_t p = t.primes[b];
+            for (uint64_t m = ((low + p - 1) / p) * p; m < high; m += p) s.alive[m - low] = 0;
+        }
+        fenwick_build(&s, len);
+        uint64_t remaining = fenwick_prefix(&s, len - 1);
+
+        /* Leaves need p <= m <= x / (p low), so only p <= sqrt(x / low) has
+           any here; past that the counts are no longer queried and the
+           crossing skips the tree */
+        uint64_t p_leaf = isqrt64(x / low);
+        uint64_t b_leaf = (p_leaf >= y) ? a : t.pi[p_leaf];
+
+        for (uint64_t b = c; b < a; b++) {
+            uint64_t p = t.primes[b + 1];
+            if (b + 1 > b_leaf) {
+                phi_carry[b] += remaining;
+                for (uint64_t m = ((low + p - 1) / p) * p; m < high; m += p) {
+                    remaining -= s.alive[m - low];
+                    s.alive[m - low] = 0;
+                }
+                continue;
+            }
+            uint64_t xp = x / p;
+
+            /* Special leaves phi(x / (m p), b) that land in this segment */
+            uint64_t m_hi = xp / low;
+            if (m_hi > y) m_hi = y;
+            uint64_t m_lo = xp / high;
+            if (m_lo < y / p) m_lo = y / p;
+            if (m_lo < p) m_lo = p;             /* lpf(m) > p forces m > p */
+            if (m_hi > m_lo) {
+                if (p * p > y) {
+                    /* m <= y with all factors > sqrt(y) is prime */
+                    for (uint64_t k = t.pi[m_hi]; k > t.pi[m_lo]; k--) {
+                        uint64_t v = xp / t.primes[k];
+                        uint64_t phi;
+                        if (v < p * p && v <= y) {
+                            phi = (t.pi[v] > b ? t.pi[v] - b : 0) + 1;
+                        } else {
+                            phi = phi_carry[b] + fenwick_prefix(&s, v - low);
+                        }
+                        s2 += (i128)phi;        /* mu(prime) = -1 */
+                    }
+                } else {
+                    for (uint64_t m = m_hi; m > m_lo; m--) {
+                        if (t.mu[m] == 0 || t.lpf[m] <= p) continue;
+                        uint64_t v = xp / m;
+                        uint64_t phi = phi_carry[b] + fenwick_prefix(&s, v - low);
+                        s2 -= (i128)t.mu[m] * (i128)phi;
+                    }
+                }
+            }
+
+            phi_carry[b] += remaining;
+            for (uint64_t m = ((low + p - 1) / p) * p; m < high; m += p) {
+                if (s.alive[m - low]) {
+                    s.alive[m - low] = 0;
+                    fenwick_dec(&s, m - low);
+                    remaining--;
+                }
+            }
+        }
+
+        /* P2: primes q in (y, sqrt x] with x/q in this segment; survivors
+           are now 1 and the primes > p_a, so pi(v) = phi(v, a) + a - 1 */
+        uint64_t q_hi = x / low;
+        if (q_hi > sqrtx) q_hi = sqrtx;
+        uint64_t q_lo = x / high;
+        if (q_lo < y) q_lo = y;
+        if (q_hi > q_lo) {
+            if (q_hi - q_lo > q_cap) q_lo = q_hi - q_cap;   /* cannot happen */
+            uint64_t nq = sieve_interval_desc(&t, q_lo, q_hi, qbuf, qlist);
+            /* q descending makes x/q ascending: count survivors by a scan */
+            uint64_t pos = 0, seen = 0;
+            for (uint64_t i = 0; i < nq; i++) {
+                uint64_t v = x / qlist[i];
+                for (; pos <= v - low; pos++) seen += s.alive[pos];
+                p2_sum += (i128)(phi_carry[a] + seen + a - 1);
+            }
+            q_count += nq;
+        }
+        phi_carry[a] += remaining;
+    }
+
+    uint64_t big_b = a + q_count;                   /* pi(sqrt x) */
+    i128 p2 = p2_sum - ((i128)big_b * (big_b - 1) / 2 - (i128)a * (a - 1) / 2);
+    i128 result = s1 + s2 + (i128)a - 1 - p2;
+
+    free(s.alive); free(s.tree); free(phi_carry); free(qbuf); free(qlist);
+    lmo_tables_free(&t);
+    return (uint64_t)result;
+}
+
+int z5d_prime_pi(uint64_t x, uint64_t* count) {
+    uint64_t r = (x < EXACT_SIEVE_MAX) ? pi_sieve(x) : pi_lmo(x);
+    if (r == UINT64_MAX) return -1;
+    *count = r;
+    return 0;
+}
+
+/* --------- Walking to p_n --------- */
+
+void z5d_walk_init(z5d_walk_t* w) {
+    w->primes = NULL;
+    w->offsets = NULL;
+    w->num_primes = 0;
+    w->limit = 0;
+    w->alive = NULL;
+    w->alive_size = 0;
+    w->pattern = NULL;
+}
+
+void z5d_walk_clear(z5d_walk_t* w) {
+    free(w->primes);
+    free(w->offsets);
+    free(w->alive);
+    free(w->pattern);
+    w->primes = NULL;
+    w->offsets = NULL;
+    w->alive = NULL;
+    w->pattern = NULL;
+    w->num_primes = w->alive_size = 0;
+    w->limit = 0;
+}
+
+/* Grow-only: the table holds the odd primes up to at least limit. */
+static int walk_reserve_primes(z5d_walk_t* w, uint64_t limit) {
+    if (limit <= w->limit) return 0;
+    unsigned char* comp = calloc(limit + 1, 1);
+    uint32_t* primes = malloc(sizeof(uint32_t) * (size_t)(limit / 2 + 1));
+    if (!comp || !primes) {
+        free(comp);
+        free(primes);
+        return -1;
+    }
+    size_t count = 0;
+    for (uint64_t i = 3; i <= limit; i += 2) {
+        if (comp[i]) continue;
+        primes[count++] = (uint32_t)i;
+        for (uint64_t j = i * i; j <= limit; j += 2 * i) comp[j] = 1;
+    }
+    free(comp);
+    /* Sized for limit / 2 candidates; keep only the primes */
+    uint32_t* fit = realloc(primes, sizeof(uint32_t) * count);
+    if (fit) primes = fit;
+    uint32_t* offsets = malloc(sizeof(uint32_t) * count);
+    if (!offsets) {
+        free(primes);
+        return -1;
+    }
+    free(w->primes);
+    free(w->offsets);
+    w->primes = primes;
+    w->offsets = offsets;
+    w->num_primes = count;
+    w->limit = limit;
+    return 0;
+}
+
+static int walk_reserve_window(z5d_walk_t* w, size_t size) {
+    if (!w->pattern) {
+        /* Entry j of the forward half is odd value 2j + 1 (mod 2 * period);
+           the reversed half holds entry (-j) mod period */
+        w->pattern = malloc(4 * WALK_PATTERN_PERIOD);
+        if (!w->pattern) return -1;
+        uint8_t* fwd = w->pattern;
+        uint8_t* rev = w->pattern + 2 * WALK_PATTERN_PERIOD;
+        for (size_t j = 0; j < WALK_PATTERN_PERIOD; j++) {
+            uint64_t v = 2 * j + 1;
+            fwd[j] = (v % 3 && v % 5 && v % 7 && v % 11 && v % 13) ? 1 : 0;
+        }
+        for (size_t j = 0; j < WALK_PATTERN_PERIOD; j++) {
+            rev[j] = fwd[(WALK_PATTERN_PERIOD - j) % WALK_PATTERN_PERIOD];
+        }
+        memcpy(fwd + WALK_PATTERN_PERIOD, fwd, WALK_PATTERN_PERIOD);
+        memcpy(rev + WALK_PATTERN_PERIOD, rev, WALK_PATTERN_PERIOD);
+    }
+    if (size <= w->alive_size) return 0;
+    uint8_t* alive = malloc(size);
+    if (!alive) return -1;
+    free(w->alive);
+    w->alive = alive;
+    w->alive_size = size;
+    return 0;
+}
+
+/* Copy the 3..13 pattern into the window; phase is the pattern entry of
+   candidate 0 (the direction is chosen by the half) */
+static void walk_fill_pattern(uint8_t* alive, size_t seg, const uint8_t* half, size_t phase) {
+    size_t done = 0;
+    while (done < seg) {
+        size_t len = WALK_PATTERN_PERIOD;
+        if (len > seg - done) len = seg - done;
+        memcpy(alive + done, half + phase, len);
+        done += len;
+    }
+}
+
+/* Survivors in the window (bytes are 0 / 1) */
+static uint64_t walk_count(const uint8_t* alive, size_t seg) {
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= seg; i += 8) {
+        uint64_t word;
+        memcpy(&word, alive + i, 8);
+        count += (uint64_t)__builtin_popcountll(word);
+    }
+    for (; i < seg; i++) count += alive[i];
+    return count;
+}
+
+/*
+ * Candidates are odd numbers base + 2i (up) or base - 2i (down), one
+ * segment at a time; every table prime p crosses off its multiples from p^2
+ * on. A segment whose candidates all lie below limit^2 is then fully sieved
+ * and its survivors are counted as primes; otherwise they are tested.
+ */
+uint64_t z5d_walk(z5d_walk_t* w, uint64_t x, uint64_t k, int up) {
+    if (up && x == UINT64_MAX) return 0;
+    uint64_t limit = EXACT_WALK_PRIMES;
+    size_t seg = EXACT_WALK_SEGMENT;
+    if (k > EXACT_WALK_MAX) {
+        /* Expected reach ~k ln x; sieve to its square root, with headroom so
+           successive walks of a growing x reuse the table */
+        double reach = (double)x + (up ? 2.0 * (double)k * log((double)x) : 0.0);
+        double root = sqrt(reach > 18446744073709551615.0 ? 18446744073709551615.0 : reach);
+        uint64_t want = (uint64_t)(1.25 * root) + 1;
+        if (want > EXACT_WALK_FULL_PRIMES) want = EXACT_WALK_FULL_PRIMES;
+        if (want > limit) limit = want;
+        seg = EXACT_WALK_LONG_SEGMENT;
+    }
+    if (limit < w->limit) limit = w->limit;
+    if (walk_reserve_primes(w, limit) != 0 || walk_reserve_window(w, seg) != 0) return 0;
+
+    uint8_t* alive = w->alive;
+    const uint64_t full_below = w->limit * w->limit;
+    uint64_t base = up ? ((x + 1) | 1) : ((x % 2) ? x : x - 1);
+    uint64_t found = 0, last = 0;
+    size_t active = WALK_PATTERN_PRIMES;   /* primes[PATTERN_PRIMES..active) are sieving */
+    if (!up) {
+        /* Going down the window only shrinks the set; start with every
+           prime whose square is at most base */
+        while (active < w->num_primes &&
+               (uint64_t)w->primes[active] * w->primes[active] <= base) {
+            uint64_t p = w->primes[active];
+            w->offsets[active] = (uint32_t)(((base % p) * ((p + 1) / 2)) % p);
+            active++;
+        }
+    }
+    while (found < k) {
+        /* Pattern entry of candidate 0: (base - 1) / 2 forward, its negation reversed */
+        size_t phase = (size_t)(((base - 1) / 2) % WALK_PATTERN_PERIOD);
+        /* The last window up ends at 2^64 - 1 */
+        int at_top = up && (UINT64_MAX - base) / 2 < seg;
+        size_t len = at_top ? (size_t)((UINT64_MAX - base) / 2 + 1) : seg;
+        if (up) {
+            walk_fill_pattern(alive, len, w->pattern, phase);
+
+            /* Primes whose square reaches this window join with a fresh offset */
+            uint64_t top = base + 2 * (len - 1);
+            while (active < w->num_primes &&
+                   (uint64_t)w->primes[active] * w->primes[active] <= top) {
+                uint64_t p = w->primes[active];
+                uint64_t sq = p * p;
+                if (sq > base) {
+                    w->offsets[active] = (uint32_t)((sq - base) / 2);   /* both odd */
+                } else {
+                    uint64_t r = base % p;
+                    w->offsets[active] = (uint32_t)((r == 0) ? 0 : ((p - r) * ((p + 1) / 2)) % p);
+                }
+                active++;
+            }
+            for (size_t j = WALK_PATTERN_PRIMES; j < active; j++) {
+                uint64_t p = w->primes[j], i = w->offsets[j];
+                for (; i < len; i += p) alive[i] = 0;
+                w->offsets[j] = (uint32_t)(i - len);
+            }
+        } else {
+            walk_fill_pattern(alive, seg, w->pattern + 2 * WALK_PATTERN_PERIOD,
+                              (WALK_PATTERN_PERIOD - phase) % WALK_PATTERN_PERIOD);
+
+            /* Primes whose square is above this window drop out for good */
+            while (active > WALK_PATTERN_PRIMES &&
+                   (uint64_t)w->primes[active - 1] * w->primes[active - 1] > base) {
+                active--;
+            }
+            for (size_t j = WALK_PATTERN_PRIMES; j < active; j++) {
+                uint64_t p = w->primes[j], i = w->offsets[j];
+                uint64_t end = (base - p * p) / 2 + 1;   /* stop at p^2 */
+                if (end > seg) end = seg;
+                for (; i < end; i += p) alive[i] = 0;
+                w->offsets[j] = (uint32_t)((i >= seg) ? i - seg : 0);
+            }
+        }
+        uint64_t far = up ? base + 2 * (len - 1) : base;
+        int sieved = (far < full_below);
+        uint64_t survivors;
+        if (sieved && found + (survivors = walk_count(alive, len)) < k) {
+            found += survivors;   /* the k-th prime is further on */
+        } else {
+            for (uint64_t i = 0; i < len && found < k; i++) {
+                if (!alive[i]) continue;
+                uint64_t v = up ? base + 2 * i : base - 2 * i;
+                if (sieved || z5d_is_prime_u64(v)) {
+                    found++;
+                    last = v;
+                }
+            }
+        }
+        if (at_top) break;
+        base = up ? base + 2 * seg : base - 2 * seg;
+    }
+    if (found < k) return 0;   /* no k-th prime below 2^64 */
+    return last;
+}
+
+/* Small n: sieve up to a bound on p_n and count. */
+uint64_t z5d_exact_nth_prime_small(uint64_t n) {
+    double dn = (double)n;
+    uint64_t bound = (n < 6) ? 15 : (uint64_t)(dn * (log(dn) + log(log(dn)))) + 1;
+    unsigned char* comp = calloc(bound + 1, 1);
+    if (!comp) return 0;
+    uint64_t count = 0, p = 0;
+    for (uint64_t i = 2; i <= bound; i++) {
+        if (comp[i]) continue;
+        if (++count == n) { p = i; break; }
+        for (uint64_t j = i * i; j <= bound; j += i) comp[j] = 1;
+    }
+    free(comp);
+    return p;
+}
+
+/* The context's walker, created on first use and freed by z5d_ctx_clear */
+static z5d_walk_t* ctx_walker(z5d_ctx_t* ctx) {
+    if (!ctx->walk) {
+        z5d_walk_t* w = malloc(sizeof(*w));
+        if (!w) return NULL;
+        z5d_walk_init(w);
+        ctx->walk = w;
+    }
+    return (z5d_walk_t*)ctx->walk;
+}
+
+int z5d_exact_from_anchor(z5d_ctx_t* ctx, uint64_t n, uint64_t anchor_n, uint64_t anchor_p,
+                          uint64_t* prime_out) {
+    z5d_walk_t* w = ctx_walker(ctx);
+    if (!w) return -1;
+    if (n < Z5D_EXACT_SMALL_N) {
+        /* p_n < 10^7: read it off the walker's table, grown (at least
+           doubling) to an upper bound on p_n */
+        double dn = (double)n;
+        uint64_t bound = (n < 6) ? 15 : (uint64_t)(dn * (log(dn) + log(log(dn)))) + 1;
+        if (bound > w->limit) {
+            if (bound < EXACT_WALK_PRIMES) bound = EXACT_WALK_PRIMES;
+            if (bound < 2 * w->limit) bound = 2 * w->limit;
+            if (walk_reserve_primes(w, bound) != 0) return -1;
+        }
+        *prime_out = (n == 1) ? 2 : w->primes[n - 2];
+        return 0;
+    }
+    ctx->stats.anchor_hits++;
+    uint64_t p = anchor_p;
+    if (n > anchor_n) p = z5d_walk(w, anchor_p, n - anchor_n, 1);
+    else if (n < anchor_n) p = z5d_walk(w, anchor_p - 1, anchor_n - n, 0);
+    if (p == 0) return -1;
+    *prime_out = p;
+    return 0;
+}
+
+int z5d_nth_prime_exact_ctx(z5d_ctx_t* ctx, uint64_t n, uint64_t* prime_out) {
+    if (n == 0 || n > Z5D_EXACT_MAX_N) return -1;
+    /* Small n from the prime table; covered by the anchor index: walk from
+       the nearest anchor */
+    uint64_t anchor_n = 0, anchor_p = 0;
+    if (n < Z5D_EXACT_SMALL_N ||
+        (ctx->config.anchors &&
+         z5d_anchor_nearest(ctx->config.anchors, n, &anchor_n, &anchor_p) == 0)) {
+        return z5d_exact_from_anchor(ctx, n, anchor_n, anchor_p, prime_out);
+    }
+    z5d_walk_t* w = ctx_walker(ctx);
+    if (!w) return -1;
+
+    /* Closed-form start */
+    z5d_result_t result;
+    z5d_result_init(&result, ctx->config.precision);
+    if (z5d_predict_nth_prime_ctx(ctx, &result, n) != 0) {
+        z5d_result_clear(&result);
+        return -1;
+    }
+    uint64_t x = mpfr_fits_ulong_p(result.predicted_prime, MPFR_RNDN)
+                 ? (uint64_t)mpfr_get_ui(result.predicted_prime, MPFR_RNDN) : UINT64_MAX;
+    z5d_result_clear(&result);
+
+    /* Newton on pi() until walking the residual is cheaper than another pi() */
+    uint64_t count;
+    for (;;) {
+        if (z5d_prime_pi(x, &count) != 0) return -1;
+        ctx->stats.pi_evaluations++;
+        uint64_t diff = (count > n) ? count - n : n - count;
+        if (diff <= EXACT_WALK_MAX) break;
+        double step = (double)diff * log((double)x);
+        if (step <= cbrt((double)x * (double)x) / EXACT_WALK_COST) break;
+        if (count > n) {
+            x = (step >= (double)x) ? x / 2 : x - (uint64_t)step;
+        } else {
+            double nx = (double)x + step;
+            x = (nx >= 18446744073709551615.0) ? UINT64_MAX : (uint64_t)nx;
+        }
+    }
+
+    uint64_t p = (count >= n) ? z5d_walk(w, x, count - n + 1, 0) : z5d_walk(w, x, n - count, 1);
+    if (p == 0) return -1;
+    *prime_out = p;
+    return 0;
+}
+
+int z5d_nth_prime_exact(uint64_t n, uint64_t* prime_out) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_nth_prime_exact_ctx(ctx, n, prime_out);
+}
@@ -0,0 +1,72 @@
+/**
+ * Z5D Exact Mode - Internal Header
+ * ================================
+ *
+ * Prime walker shared by the exact nth-prime search and the anchor index:
+ * step over k consecutive primes from a 64-bit start. Long walks sieve
+ * completely with every prime up to the square root of the far end, so no
+ * primality test runs; short walks presieve and test the survivors.
+ *
+ * @file z5d_exact.h
+ * @version 1.0
+ */
+
+#ifndef Z5D_EXACT_H
+#define Z5D_EXACT_H
+
+#include "../include/z5d_predictor.h"
+
+/* pi(10^7): below this index p_n comes from a plain sieve */
+#define Z5D_EXACT_SMALL_N 664579ULL
+
+/* Walker state; the prime table and window are kept between walks */
+typedef struct {
+    uint32_t* primes;        /* Odd primes 3..limit */
+    uint32_t* offsets;       /* Per prime: first window index to cross off */
+    size_t num_primes;
+    uint64_t limit;
+    uint8_t* alive;          /* One byte per odd candidate of a segment */
+    size_t alive_size;
+    uint8_t* pattern;        /* Odd multiples of 3..13 cleared: two periods, then reversed */
+} z5d_walk_t;
+
+void z5d_walk_init(z5d_walk_t* w);
+void z5d_walk_clear(z5d_walk_t* w);
+
+/**
+ * Step over k >= 1 primes from x and return the last one. Up walks start
+ * after x; down walks include x. Requires x > 65536 (and, going down, at
+ * least k primes above 65536 at or below x).
+ *
+ * @param w Walker
+ * @param x Start value
+ * @param k Number of primes to step over
+ * @param up 1 to walk towards larger values, 0 towards smaller
+ * @return The k-th prime reached; 0 on allocation failure, or going up
+ *         when fewer than k primes lie between x and 2^64
+ */
+uint64_t z5d_walk(z5d_walk_t* w, uint64_t x, uint64_t k, int up);
+
+/**
+ * Exact p_n from an anchor already looked up for n: walks from it, or for
+ * n < Z5D_EXACT_SMALL_N reads the context walker's prime table (the anchor
+ * is then unused).
+ *
+ * @param ctx Context (owns the walker)
+ * @param n Index of prime (1 <= n <= Z5D_EXACT_MAX_N)
+ * @param anchor_n Anchor index from z5d_anchor_nearest
+ * @param anchor_p p_(anchor_n)
+ * @param prime_out Output p_n
+ * @return 0 on success, -1 on allocation failure
+ */
+int z5d_exact_from_anchor(z5d_ctx_t* ctx, uint64_t n, uint64_t anchor_n, uint64_t anchor_p,
+                          uint64_t* prime_out);
+
+/**
+ * p_n for n < Z5D_EXACT_SMALL_N by sieving up to an upper bound on p_n.
+ *
+ * @return p_n, 0 on allocation failure
+ */
+uint64_t z5d_exact_nth_prime_small(uint64_t n);
+
+#endif /* Z5D_EXACT_H */
@@ -0,0 +1,483 @@
+/**
+ * Z5D Hardware-Float Fast Tier
+ * ============================
+ *
+ * Evaluates the calibrated closed form (PNT + d-term + e-term) for word-sized
+ * n in plain double (n < 2^32) or double-double (n < 2^53) arithmetic, and
+ * carries an a-posteriori bound on the rounding error so the caller can tell
+ * whether the rounded integer is certain. Only results whose bound straddles
+ * a rounding boundary go to MPFR.
+ *
+ * Error model: libm log/cbrt are assumed accurate to 1 ulp (relative error
+ * <= 2^-52), which holds for the Apple and glibc implementations. The bounds
+ * below carry at least a 2x margin over a first-order analysis of every
+ * operation; double-double operations are accurate to a few 2^-104.
+ *
+ * @file z5d_fast.c
+ * @version 1.0
+ */
+
+#include "z5d_fast.h"
+#include <math.h>
+#include <string.h>
+
+#define U53 0x1p-53
+
+/* ---------------- double-double arithmetic ---------------- */
+typedef struct { double hi, lo; } dd_t;
+
+static inline dd_t dd_make(double hi, double lo) {
+    dd_t r = {hi, lo};
+    return r;
+}
+
+static inline dd_t quick_two_sum(double a, double b) {
+    double s = a + b;
+    return dd_make(s, b - (s - a));
+}
+
+static inline dd_t two_sum(double a, double b) {
+    double s = a + b;
+    double bb = s - a;
+    return dd_make(s, (a - (s - bb)) + (b - bb));
+}
+
+static inline dd_t two_prod(double a, double b) {
+    double p = a * b;
+    return dd_make(p, fma(a, b, -p));
+}
+
+static inline dd_t dd_add(dd_t a, dd_t b) {
+    dd_t s = two_sum(a.hi, b.hi);
+    dd_t t = two_sum(a.lo, b.lo);
+    s.lo += t.hi;
+    s = quick_two_sum(s.hi, s.lo);
+    s.lo += t.lo;
+    return quick_two_sum(s.hi, s.lo);
+}
+
+/* Sloppy addition: one two_sum on the high words. Accurate to ~2^-104
+   relative unless a and b nearly cancel with opposite signs in a way that
+   leaves the low words dominant; the grid updates below never do. */
+static inline dd_t dd_add_fast(dd_t a, dd_t b) {
+    dd_t s = two_sum(a.hi, b.hi);
+    s.lo += a.lo + b.lo;
+    return quick_two_sum(s.hi, s.lo);
+}
+
+static inline dd_t dd_add_d(dd_t a, double b) {
+    dd_t s = two_sum(a.hi, b);
+    s.lo += a.lo;
+    return quick_two_sum(s.hi, s.lo);
+}
+
+static inline dd_t dd_mul(dd_t a, dd_t b) {
+    dd_t p = two_prod(a.hi, b.hi);
+    p.lo += a.hi * b.lo + a.lo * b.hi;
+    return quick_two_sum(p.hi, p.lo);
+}
+
+static inline dd_t dd_mul_d(dd_t a, double b) {
+    dd_t p = two_prod(a.hi, b);
+    p.lo += a.lo * b;
+    return quick_two_sum(p.hi, p.lo);
+}
+
+static inline dd_t dd_div(dd_t a, dd_t b) {
+    double q1 = a.hi / b.hi;
+    dd_t r = dd_add(a, dd_mul_d(b, -q1));
+    double q2 = r.hi / b.hi;
+    r = dd_add(r, dd_mul_d(b, -q2));
+    double q3 = r.hi / b.hi;
+    return dd_add_d(quick_two_sum(q1, q2), q3);
+}
+
+/* ---------------- constants (generated at 80 digits) ---------------- */
+static const dd_t DD_LN2   = {0x1.62e42fefa39efp-1, 0x1.abc9e3b39803fp-56};
+static const dd_t DD_E4    = {0x1.b4c902e273a58p+5, 0x1.9e35b4eff6e4fp-49};      /* exp(4) */
+static const dd_t DD_INV_E4 = {0x1.2c155b8213cf4p-6, 0x1.dfa2bc04cb0acp-60};     /* exp(-4) */
+static const dd_t DD_C_CAL = {-0x1.5d8846600bae6p-13, 0x1.077717b9851c6p-69};    /* Z5D_DEFAULT_C_CAL */
+static const dd_t DD_THIRD = {0x1.5555555555555p-2, 0x1.5555555555555p-56};
+static const dd_t DD_FIFTH = {0x1.999999999999ap-3, -0x1.999999999999ap-57};
+static const double KAPPA_STAR = 0.065;                                   /* Z5D_DEFAULT_KAPPA_STAR */
+static const double C_CAL = -0.00016667;
+static const double E4 = 0x1.b4c902e273a58p+5;
+
+/* ln(1 + j/128) for j = 0..128 */
+static const dd_t LN_TABLE[129] = {
+    {0x0.0p+0, 0x0.0p+0},
+    {0x1.fe02a6b106789p-8, -0x1.e44b7e3711ebfp-67},
+    {0x1.fc0a8b0fc03e4p-7, -0x1.83092c59642a1p-62},
+    {0x1.7b91b07d5b11bp-6, -0x1.5b602ace3a510p-60},
+    {0x1.f829b0e783300p-6, 0x1.33e3f04f1ef23p-60},
+    {0x1.39e87b9febd60p-5, -0x1.5bfa937f551bbp-59},
+    {0x1.77458f632dcfcp-5, 0x1.18d3ca87b9296p-59},
+    {0x1.b42dd711971bfp-5, -0x1.eb9759c130499p-60},
+    {0x1.f0a30c01162a6p-5, 0x1.85f325c5bbacdp-59},
+    {0x1.16536eea37ae1p-4, -0x1.79da3e8c22cdap-60},
+    {0x1.341d7961bd1d1p-4, -0x1.b599f227becbbp-58},
+    {0x1.51b073f06183fp-4, 0x1.a49e39a1a8be4p-58},
+    {0x1.6f0d28ae56b4cp-4, -0x1.906d99184b992p-58},
+    {0x1.8c345d6319b21p-4, -0x1.4a697ab3424a9p-61},
+    {0x1.a926d3a4ad563p-4, 0x1.942f48aa70ea9p-58},
+    {0x1.c5e548f5bc743p-4, 0x1.5d617ef8161b1p-60},
+    {0x1.e27076e2af2e6p-4, -0x1.61578001e0162p-60},
+    {0x1.fec9131dbeabbp-4, -0x1.5746b9981b36cp-58},
+    {0x1.0d77e7cd08e59p-3, 0x1.9a5dc5e9030acp-57},
+    {0x1.1b72ad52f67a0p-3, 0x1.483023472cd74p-58},
+    {0x1.29552f81ff523p-3, 0x1.301771c407dbfp-57},
+    {0x1.371fc201e8f74p-3, 0x1.de6cb62af18a0p-58},
+    {0x1.44d2b6ccb7d1ep-3, 0x1.9f4f6543e1f88p-57},
+    {0x1.526e5e3a1b438p-3, -0x1.746ff8a470d3ap-57},
+    {0x1.5ff3070a793d4p-3, -0x1.bc60efafc6f6ep-58},
+    {0x1.6d60fe719d21dp-3, -0x1.caae268ecd179p-57},
+    {0x1.7ab890210d909p-3, 0x1.be36b2d6a0608p-59},
+    {0x1.87fa06520c911p-3, -0x1.bf7fdbfa08d9ap-57},
+    {0x1.9525a9cf456b4p-3, 0x1.d904c1d4e2e26p-57},
+    {0x1.a23bc1fe2b563p-3, 0x1.93711b07a998cp-59},
+    {0x1.af3c94e80bff3p-3, -0x1.398cff3641985p-58},
+    {0x1.bc286742d8cd6p-3, 0x1.4fce744870f55p-58},
+    {0x1.c8ff7c79a9a22p-3, -0x1.4f689f8434012p-57},
+    {0x1.d5c216b4fbb91p-3, 0x1.6e443597e4d40p-57},
+    {0x1.e27076e2af2e6p-3, -0x1.61578001e0162p-59},
+    {0x1.ef0adcbdc5936p-3, 0x1.48637950dc20dp-57},
+    {0x1.fb9186d5e3e2bp-3, -0x1.caaae64f21acbp-57},
+    {0x1.0402594b4d041p-2, -0x1.28ec217a5022dp-57},
+    {0x1.0a324e27390e3p-2, 0x1.7dcfde8061c03p-56},
+    {0x1.1058bf9ae4ad5p-2, 0x1.89fa0ab4cb31dp-58},
+    {0x1.1675cababa60ep-2, 0x1.ce63eab883717p-61},
+    {0x1.1c898c16999fbp-2, -0x1.0e5c62aff1c44p-60},
+    {0x1.22941fbcf7966p-2, -0x1.76f5eb09628afp-56},
+    {0x1.2895a13de86a3p-2, 0x1.7ad24c13f040ep-56},
+    {0x1.2e8e2bae11d31p-2, -0x1.8f4cdb95ebdf9p-56},
+    {0x1.347dd9a987d55p-2, -0x1.4dd4c580919f8p-57},
+    {0x1.3a64c556945eap-2, -0x1.c68651945f97cp-57},
+    {0x1.404308686a7e4p-2, -0x1.0bcfb6082ce6dp-56},
+    {0x1.4618bc21c5ec2p-2, 0x1.f42decdeccf1dp-56},
+    {0x1.4be5f957778a1p-2, -0x1.259b35b04813dp-57},
+    {0x1.51aad872df82dp-2, 0x1.3927ac19f55e3p-59},
+    {0x1.5767717455a6cp-2, 0x1.526adb283660cp-56},
+    {0x1.5d1bdbf5809cap-2, 0x1.4236383dc7fe1p-56},
+    {0x1.62c82f2b9c795p-2, 0x1.7b7af915300e5p-57},
+    {0x1.686c81e9b14afp-2, -0x1.ddea0f7f58e3dp-57},
+    {0x1.6e08eaa2ba1e4p-2, -0x1.cfb1b39ca3a0fp-56},
+    {0x1.739d7f6bbd007p-2, -0x1.8c76ceb014b04p-56},
+    {0x1.792a55fdd47a2p-2, 0x1.f057691fe9ed7p-56},
+    {0x1.7eaf83b82afc3p-2, 0x1.92ce979ed2950p-56},
+    {0x1.842d1da1e8b17p-2, 0x1.24ec519784676p-56},
+    {0x1.89a3386c1425bp-2, -0x1.29639dfbbf0fbp-56},
+    {0x1.8f11e873662c7p-2, 0x1.f85da755a61a3p-56},
+    {0x1.947941c2116fbp-2, -0x1.16cc8bae0bbe4p-56},
+    {0x1.99d958117e08bp-2, -0x1.a2b6889dc3e72p-57},
+    {0x1.9f323ecbf984cp-2, -0x1.a92e513217f5cp-59},
+    {0x1.a484090e5bb0ap-2, 0x1.5fe535b875a75p-57},
+    {0x1.a9cec9a9a084ap-2, -0x1.cadec02b436afp-56},
+    {0x1.af1293247786bp-2, 0x1.133844a15dc28p-58},
+    {0x1.b44f77bcc8f63p-2, -0x1.cd04495459c78p-56},
+    {0x1.b9858969310fbp-2, 0x1.663ec53e23bc4p-56},
+    {0x1.beb4d9da71b7cp-2, -0x1.0f3c590a887cap-59},
+    {0x1.c3dd7a7cdad4dp-2, 0x1.cecf052dea69bp-56},
+    {0x1.c8ff7c79a9a22p-2, -0x1.4f689f8434012p-56},
+    {0x1.ce1af0b85f3ebp-2, 0x1.edf4af2ab4267p-56},
+    {0x1.d32fe7e00ebd5p-2, 0x1.877b232fafa37p-56},
+    {0x1.d83e7258a2f3ep-2, 0x1.41456e8bb2511p-56},
+    {0x1.dd46a04c1c4a1p-2, -0x1.0467656d8b892p-56},
+    {0x1.e24881a7c6c26p-2, 0x1.cbd8f45954a46p-58},
+    {0x1.e744261d68788p-2, -0x1.c825c90c344b9p-58},
+    {0x1.ec399d2468cc0p-2, 0x1.75cee53f35397p-58},
+    {0x1.f128f5faf06edp-2, -0x1.328df13bb38c3p-56},
+    {0x1.f6123fa7028acp-2, 0x1.8515b0f2db341p-56},
+    {0x1.faf588f78f31fp-2, -0x1.328260d8abca0p-57},
+    {0x1.ffd2e0857f498p-2, 0x1.565f40d9321afp-56},
+    {0x1.02552a5a5d0ffp-1, -0x1.cb1cb51408c00p-56},
+    {0x1.04bdf9da926d2p-1, 0x1.97f304022c9dfp-55},
+    {0x1.0723e5c1cdf40p-1, 0x1.395e58e2445bbp-55},
+    {0x1.0986f4f573521p-1, -0x1.1b8095ac02f01p-55},
+    {0x1.0be72e4252a83p-1, -0x1.259da11330801p-55},
+    {0x1.0e44985d1cc8cp-1, -0x1.22a3442d2d384p-58},
+    {0x1.109f39e2d4c97p-1, -0x1.0e09b27a4373ap-60},
+    {0x1.12f719593efbcp-1, 0x1.4c048c671f435p-55},
+    {0x1.154c3d2f4d5eap-1, -0x1.59c33171a6876p-55},
+    {0x1.179eabbd899a1p-1, -0x1.00e7c6417e0b4p-55},
+    {0x1.19ee6b467c96fp-1, -0x1.9d1a11443f10cp-56},
+    {0x1.1c3b81f713c25p-1, -0x1.0dac1c4c810e9p-55},
+    {0x1.1e85f5e7040d0p-1, 0x1.ef62cd2f9f1e3p-56},
+    {0x1.20cdcd192ab6ep-1, -0x1.b2bf0bc229014p-55},
+    {0x1.23130d7bebf43p-1, -0x1.f48725e374d6ep-55},
+    {0x1.2555bce98f7cbp-1, 0x1.e021d6d6881e7p-56},
+    {0x1.2795e1289b11bp-1, -0x1.487c0c246978ep-57},
+    {0x1.29d37fec2b08bp-1, -0x1.bd1949a2d1982p-56},
+    {0x1.2c0e9ed448e8cp-1, -0x1.1a158f3917586p-55},
+    {0x1.2e47436e40268p-1, 0x1.0150861a4886bp-55},
+    {0x1.307d7334f10bep-1, 0x1.fb590a1f566dap-57},
+    {0x1.32b1339121d71p-1, 0x1.902ab5b3d916bp-56},
+    {0x1.34e289d9ce1d3p-1, 0x1.6eb92d885ce4fp-57},
+    {0x1.37117b54747b6p-1, -0x1.d117edbdd9103p-56},
+    {0x1.393e0d3562a1ap-1, -0x1.58eef67f2483ap-55},
+    {0x1.3b68449fffc23p-1, -0x1.41c484f9e9b26p-55},
+    {0x1.3d9026a7156fbp-1, -0x1.6fef670bd4b62p-55},
+    {0x1.3fb5b84d16f42p-1, 0x1.6d3a754172aefp-55},
+    {0x1.41d8fe84672aep-1, 0x1.9192f30bd1806p-55},
+    {0x1.43f9fe2f9ce67p-1, 0x1.e9c9ee6d83b86p-55},
+    {0x1.4618bc21c5ec2p-1, 0x1.f42decdeccf1dp-55},
+    {0x1.48353d1ea88dfp-1, 0x1.cf57a2ecc07f4p-55},
+    {0x1.4a4f85db03ebbp-1, 0x1.13dfa3d3761b6p-60},
+    {0x1.4c679afccee3ap-1, -0x1.3a5c4c8b39e41p-55},
+    {0x1.4e7d811b75bb1p-1, -0x1.8d3d9ea6e9ea9p-55},
+    {0x1.50913cc01686bp-1, 0x1.2f2ce96c2d5b1p-55},
+    {0x1.52a2d265bc5abp-1, -0x1.1883750ea4d0ap-57},
+    {0x1.54b2467999498p-1, -0x1.5baaf5d2f09f4p-55},
+    {0x1.56bf9d5b3f399p-1, 0x1.0471885cd8ff3p-55},
+    {0x1.58cadb5cd7989p-1, 0x1.849792ec98458p-56},
+    {0x1.5ad404c359f2dp-1, -0x1.35955683f7196p-59},
+    {0x1.5cdb1dc6c1765p-1, -0x1.cc2470e8a3df4p-55},
+    {0x1.5ee02a9241675p-1, 0x1.c358257f49082p-55},
+    {0x1.60e32f44788d9p-1, -0x1.ac1bb52fa589bp-56},
+    {0x1.62e42fefa39efp-1, 0x1.abc9e3b39803fp-56},
+};
+
+/* ln(x) for a positive finite double, to about 2^-104 relative.
+   x = 2^e * c_j * (1 + u) with c_j = 1 + j/128 and |u| <= 1/256, then
+   ln(1 + u) = 2 atanh(t), t = u / (2 + u), |t| < 1/511. */
+static dd_t dd_log_d(double x) {
+    int e;
+    double m = frexp(x, &e);      /* m in [0.5, 1) */
+    m *= 2.0;
+    e -= 1;                        /* m in [1, 2) */
+    int j = (int)((m - 1.0) * 128.0 + 0.5);
+    double c = 1.0 + (double)j / 128.0;
+
+    dd_t u = dd_div(dd_make(m - c, 0.0), dd_make(c, 0.0));   /* m - c is exact */
+    dd_t t = dd_div(u, dd_add_d(u, 2.0));
+    dd_t z = dd_mul(t, t);
+
+    /* S = 1 + z/3 + z^2/5 + z^3/7 + z^4/9 + z^5/11; the tail is below 2^-106 */
+    double zh = z.hi;
+    double tail = 1.0 / 7.0 + zh * (1.0 / 9.0 + zh * (1.0 / 11.0));
+    dd_t h = dd_add(DD_FIFTH, dd_mul_d(z, tail));
+    h = dd_add(DD_THIRD, dd_mul(z, h));
+    dd_t s = dd_add_d(dd_mul(z, h), 1.0);
+    dd_t ln1pu = dd_mul(t, s);
+    ln1pu.hi *= 2.0;
+    ln1pu.lo *= 2.0;
+
+    dd_t r = dd_add(dd_mul_d(DD_LN2, (double)e), LN_TABLE[j]);
+    return dd_add(r, ln1pu);
+}
+
+/* ln(a) for a positive double-double: ln(a.hi) + ln(1 + a.lo/a.hi), and the
+   second-order term of the latter is below 2^-107. */
+static dd_t dd_log(dd_t a) {
+    return dd_add_d(dd_log_d(a.hi), a.lo / a.hi);
+}
+
+/* ---------------- rounding ---------------- */
+
+/* Round v (hi + lo, v > 0) to nearest with ties away from zero, matching
+   mpfr_round. Returns 0 if the true value, known to within err, could lie on
+   the other side of the .5 boundary. */
+static int round_certain(double hi, double lo, double err, uint64_t* out) {
+    double fl = floor(hi);
+    int64_t t = (int64_t)fl;
+    double f = (hi - fl) + lo;   /* hi - fl is exact */
+    err += U53 * 4.0;             /* rounding of f itself */
+    while (f < 0.0) { f += 1.0; t--; }
+    while (f >= 1.0) { f -= 1.0; t++; }
+    if (fabs(f - 0.5) <= err) return 0;
+    *out = (uint64_t)(t + (f >= 0.5 ? 1 : 0));
+    return 1;
+}
+
+/* ---------------- tiers ---------------- */
+
+/* Plain double. Every term is evaluated once with libm; the bound is the sum
+   of per-term bounds: k*(L + |LL| + 3) covers every intermediate of the pnt
+   bracket, each touched by a handful of roundings. */
+static int fast_predict_double(uint64_t n, uint64_t* out, double* err_bound) {
+    double k = (double)n;
+    double L = log(k);
+    double LL = log(L);
+    double B = (L + LL - 1.0) + (LL - 2.0) / L;
+    double pnt = k * B;
+
+    double q = log(pnt) / E4;
+    double d = q * q * pnt * C_CAL;
+    double cr = cbrt(pnt);
+    double e = cr * cr * KAPPA_STAR;
+    double v = (pnt + d) + e;
+
+    double M = L + fabs(LL) + 3.0;
+    double err = 32.0 * U53 * k * M       /* pnt */
+               + 32.0 * U53 * fabs(d)     /* d-term incl. ln(pnt) and c */
+               + 32.0 * U53 * e           /* e-term incl. cbrt and kappa */
+               + 4.0 * U53 * v;           /* the two final additions */
+    *err_bound = err;
+    return round_certain(v, 0.0, err, out);
+}
+
+/* Double-double for every term that can reach the integer digits: the pnt
+   bracket and the d-term. The e-term is below 2^36 for n < 2^53, so a double
+   evaluation is already accurate to ~10^-5. */
+static int fast_predict_dd(uint64_t n, uint64_t* out, double* err_bound) {
+    double k = (double)n;
+    dd_t L = dd_log_d(k);
+    dd_t LL = dd_log(L);
+
+    dd_t B = dd_add_d(dd_add(L, LL), -1.0);
+    B = dd_add(B, dd_div(dd_add_d(LL, -2.0), L));
+    dd_t pnt = dd_mul_d(B, k);
+
+    dd_t q = dd_div(dd_log(pnt), DD_E4);
+    dd_t d = dd_mul(dd_mul(dd_mul(q, q), pnt), DD_C_CAL);
+    double cr = cbrt(pnt.hi);
+    double e = cr * cr * KAPPA_STAR;
+
+    dd_t v = dd_add_d(dd_add(pnt, d), e);
+
+    double M = L.hi + fabs(LL.hi) + 3.0;
+    double err = 0x1p-96 * k * M          /* pnt */
+               + 0x1p-96 * fabs(d.hi)     /* d-term */
+               + 32.0 * U53 * e           /* e-term (double) */
+               + 0x1p-100 * v.hi;         /* final additions */
+    *err_bound = err;
+    return round_certain(v.hi, v.lo, err, out);
+}
+
+int z5d_fast_predict(uint64_t n, uint64_t* out, double* err_bound) {
+    if (n < Z5D_FAST_MIN_N || n >= Z5D_FAST_MAX_N) return 0;
+    if (n < Z5D_FAST_DOUBLE_MAX_N && fast_predict_double(n, out, err_bound)) return 53;
+    return fast_predict_dd(n, out, err_bound) ? 106 : 0;
+}
+
+/* ---------------- grids ---------------- */
+
+/*
+ * Along a grid k, k + s, k + 2s, ... every log in the closed form moves by
+ * log1p of a tiny ratio, so the double-double state is stepped forward with
+ * short series instead of being recomputed (r = s / k <= 2^-20):
+ *
+ *   ln k'       = ln k + log1p(r)
+ *   ln ln k'    = ln ln k + log1p(u),            u = (ln k' - ln k) / ln k
+ *   C' = C + ((ln ln k' - ln ln k) ln k - (ln ln k - 2)(ln k' - ln k)) / (ln k ln k')
+ *                                                C = (ln ln k - 2) / ln k
+ *   ln pnt'     = ln pnt + log1p(rho),           rho = (pnt' - pnt) / pnt
+ *   d'          = d + d ((1 + rho)(1 + delta)^2 - 1),  delta = (ln pnt' - ln pnt) / ln pnt
+ *   e'          = e + e ((1 + rho)^(2/3) - 1)
+ *
+ * Only ln k needs its increment in double-double: pnt = k (ln k + ...) must
+ * be good to ~2^-96 k. The other increments are ~2^-20 of their state and
+ * enter the integer digits with at most a factor k / ln k (ln ln k, C),
+ * |d| / ln pnt (ln pnt) or 1 (d, e), so a double increment is good to
+ * ~2^-70 of the result. Series truncation is below 2^-110. The state is
+ * rebuilt from scratch every Z5D_FAST_RANGE_RESYNC points; the per-step drift is
+ * accumulated into the error bound.
+ */
+
+typedef struct {
+    double k;
+    dd_t L, LL, C, pnt, lnp, d, e;
+} grid_state_t;
+
+/* log1p(x) for |x| <= 2^-19: x - x^2/2 in double-double, the rest in double */
+static inline dd_t dd_log1p_small(dd_t x) {
+    double h = x.hi;
+    dd_t sq = two_prod(h, h);
+    sq.lo += 2.0 * h * x.lo;
+    double tail = h * sq.hi * (1.0 / 3.0 - h * (0.25 - h * (0.2 - h * (1.0 / 6.0))));
+    return dd_add_d(dd_add_fast(x, dd_make(-0.5 * sq.hi, -0.5 * sq.lo)), tail);
+}
+
+/* Same in double, |x| <= 2^-19 */
+static inline double log1p_small(double x) {
+    return x * (1.0 - x * (0.5 - x * (1.0 / 3.0 - x * (0.25 - x * 0.2))));
+}
+
+static inline dd_t grid_pnt(const grid_state_t* g) {
+    dd_t B = dd_add_d(dd_add_fast(g->L, g->LL), -1.0);
+    return dd_mul_d(dd_add_fast(B, g->C), g->k);
+}
+
+static void grid_resync(grid_state_t* g, double k) {
+    g->k = k;
+    g->L = dd_log_d(k);
+    g->LL = dd_log(g->L);
+    g->C = dd_div(dd_add_d(g->LL, -2.0), g->L);
+    g->pnt = grid_pnt(g);
+    g->lnp = dd_log(g->pnt);
+    dd_t q = dd_mul(g->lnp, DD_INV_E4);
+    g->d = dd_mul(dd_mul(dd_mul(q, q), g->pnt), DD_C_CAL);
+    double cr = cbrt(g->pnt.hi);
+    g->e = dd_make(cr * cr * KAPPA_STAR, 0.0);
+}
+
+/* Advance by s; returns |rho| for the drift bound */
+static double grid_step(grid_state_t* g, double s) {
+    double k = g->k;
+    double rh = s / k;
+    dd_t dL = dd_log1p_small(dd_make(rh, fma(-rh, k, s) / k));
+    double L0 = g->L.hi;
+    g->L = dd_add_fast(g->L, dL);
+    double dLL = log1p_small(dL.hi / L0);
+    double dC = (dLL * L0 - (g->LL.hi - 2.0) * dL.hi) / (L0 * g->L.hi);
+    g->LL = dd_add_d(g->LL, dLL);
+    g->C = dd_add_d(g->C, dC);
+    g->k = k + s;                       /* exact below 2^53 */
+
+    dd_t pnt = grid_pnt(g);
+    double rho = dd_add_fast(pnt, dd_make(-g->pnt.hi, -g->pnt.lo)).hi / g->pnt.hi;
+    /* (1 + rho)^(2/3) - 1 */
+    double ge = rho * (2.0 / 3.0 - rho * (1.0 / 9.0 - rho * (4.0 / 81.0 - rho * (7.0 / 243.0))));
+    g->e = dd_add_d(g->e, g->e.hi * ge);
+    double dlnp = log1p_small(rho);
+    double delta = dlnp / g->lnp.hi;
+    double gd = rho + delta * (2.0 + 2.0 * rho + delta * (1.0 + rho));
+    g->d = dd_add_d(g->d, g->d.hi * gd);
+    g->lnp = dd_add_d(g->lnp, dlnp);
+    g->pnt = pnt;
+    return fabs(rho);
+}
+
+size_t z5d_fast_range(uint64_t start, uint64_t stride, size_t count, uint64_t* out) {
+    size_t settled = 0;
+    if (count == 0) return 0;
+    uint64_t last = start + stride * (uint64_t)(count - 1);
+    if (start < Z5D_FAST_MIN_N || last >= Z5D_FAST_MAX_N || last < start) {
+        for (size_t i = 0; i < count; i++) out[i] = 0;
+        return 0;
+    }
+    /* Grids too coarse for the series steps go point by point */
+    if (stride == 0 || (double)stride > 0x1p-20 * (double)start) {
+        double err;
+        for (size_t i = 0; i < count; i++) {
+            if (z5d_fast_predict(start + stride * (uint64_t)i, &out[i], &err)) settled++;
+            else out[i] = 0;
+        }
+        return settled;
+    }
+
+    const double s = (double)stride;
+    grid_state_t g;
+    memset(&g, 0, sizeof(g));
+    double drift = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double rho = 0.0;
+        if (i % Z5D_FAST_RANGE_RESYNC == 0) {
+            grid_resync(&g, (double)(start + stride * (uint64_t)i));
+            drift = 0.0;
+        } else {
+            rho = grid_step(&g, s);
+        }
+        dd_t v = dd_add_fast(dd_add_fast(g.pnt, g.d), g.e);
+
+        /* Same bound as fast_predict_dd, plus the drift of the steps: each
+           adds at most a direct evaluation's pnt and d-term error, and the
+           double increments are good to ~2^-50 of themselves */
+        double M = g.L.hi + fabs(g.LL.hi) + 3.0;
+        double direct = 0x1p-96 * g.k * M + 0x1p-96 * fabs(g.d.hi);
+        if (rho > 0.0) drift += direct + 0x1p-44 * (g.k + fabs(g.d.hi) + g.e.hi) * rho;
+        double err = direct + 32.0 * U53 * g.e.hi + 0x1p-100 * v.hi + drift;
+        if (round_certain(v.hi, v.lo, err, &out[i])) settled++;
+        else out[i] = 0;
+    }
+    return settled;
+}
@@ -0,0 +1,60 @@
+/**
+ * Z5D Hardware-Float Fast Tier - Internal Header
+ * ==============================================
+ *
+ * Double / double-double evaluation of the calibrated closed form for
+ * word-sized n, with a rigorous bound on the rounding error.
+ *
+ * @file z5d_fast.h
+ * @version 1.0
+ */
+
+#ifndef Z5D_FAST_H
+#define Z5D_FAST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Below this the closed form is not yet positive; MPFR handles those n */
+#define Z5D_FAST_MIN_N 16ULL
+/* n must be exact as a double */
+#define Z5D_FAST_MAX_N (1ULL << 53)
+/* Plain double tier is tried first below this n */
+#define Z5D_FAST_DOUBLE_MAX_N (1ULL << 32)
+/* Working precisions below this ask for a less accurate answer than the fast
+   tier gives, so they stay on MPFR */
+#define Z5D_FAST_MIN_PRECISION 106
+
+/**
+ * Evaluate the closed form and round to nearest (ties away from zero, as
+ * mpfr_round does).
+ *
+ * @param n Index of prime, Z5D_FAST_MIN_N <= n < Z5D_FAST_MAX_N
+ * @param out Rounded prediction
+ * @param err_bound Bound on |computed - exact| before rounding
+ * @return Working precision in bits of the tier that settled *out (53 for
+ *         double, 106 for double-double), or 0 if the caller must fall back
+ *         to MPFR (also for n out of range)
+ */
+int z5d_fast_predict(uint64_t n, uint64_t* out, double* err_bound);
+
+/* Grid points between double-double rebuilds of the incremental state */
+#define Z5D_FAST_RANGE_RESYNC 256
+
+/**
+ * Rounded closed form at n = start + i * stride for i < count, stepping the
+ * double-double state along the grid rather than evaluating each point
+ * from scratch (grids with stride > start / 2^20 fall back to per-point
+ * z5d_fast_predict). Settled values are the correctly rounded closed form,
+ * so they agree with z5d_fast_predict and the MPFR path.
+ *
+ * @param start First index, >= Z5D_FAST_MIN_N
+ * @param stride Index spacing
+ * @param count Number of points; the last must be below Z5D_FAST_MAX_N
+ * @param out count outputs; 0 where the bound could not settle the rounding
+ *            (or every entry when the grid leaves the fast range)
+ * @return Number of settled points
+ */
+size_t z5d_fast_range(uint64_t start, uint64_t stride, size_t count, uint64_t* out);
+
+#endif /* Z5D_FAST_H */
@@ -0,0 +1,767 @@
+/**
+ * Z5D Lucas-Lehmer Engine - Mersenne Tests Without Division
+ * =========================================================
+ *
+ * s_0 = 4, s_(i+1) = s_i^2 - 2 mod M_p; M_p = 2^p - 1 is prime iff
+ * s_(p-2) = 0. Both engines reduce with 2^p = 1 (mod M_p) instead of a
+ * division:
+ *
+ * - GMP: s^2 with mpz_mul, then fold the bits above p onto the low p bits
+ *   (hi + lo), at most twice, and one compare against M_p.
+ * - FFT: irrational-base discrete weighted transform (Crandall-Fagin). s is
+ *   held as N balanced digits of ceil(p(j+1)/N) - ceil(pj/N) bits; weighting
+ *   digit j by 2^(ceil(pj/N) - pj/N) makes the cyclic convolution of length
+ *   N equal to the product mod 2^p - 1, so the reduction is the carry
+ *   wrapping from the top digit to the bottom. Digit pairs are packed into
+ *   one complex value, so the transform has length N/2; the square is
+ *   taken on the split spectrum, pairing frequency k with -k. The
+ *   transform is four-step (N/2 = N1 * N2): column FFTs, twiddles, then row
+ *   pairs are transformed, squared and transformed back in place, then the
+ *   inverse columns. Rows and columns are split across a small thread
+ *   pool. Every iteration
+ *   checks the distance of the outputs to integers; past
+ *   LL_ROUNDOFF_LIMIT the iteration is redone at twice the length.
+ *
+ * Checkpoints (native byte order, written to path.tmp then renamed):
+ *   char magic[8] = "Z5DLLCK1", uint32 version = 1, uint32 reserved,
+ *   uint64 p, uint64 iteration, uint64 nbytes, residue bytes (big-endian),
+ *   uint64 check (FNV-1a over everything before it)
+ *
+ * @file z5d_ll.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define LL_MAGIC "Z5DLLCK1"
+#define LL_VERSION 1
+#define LL_FFT_MIN_P 128               /* Below this the FFT engine defers to GMP */
+#define LL_ROUNDOFF_LIMIT 0.40         /* Largest tolerated distance to an integer */
+#define LL_PARALLEL_MIN_LENGTH 4096    /* Shorter transforms stay on one thread */
+#define LL_COLUMN_BLOCK 8              /* Columns gathered per pass */
+
+typedef struct {
+    double re, im;
+} ll_cplx_t;
+
+struct ll_pool;
+
+typedef struct {
+    uint64_t p;
+    size_t n;                    /* Digits, a power of two */
+    size_t m, n1, n2;            /* Complex length m = n / 2 = n1 * n2 */
+    size_t block;                /* Columns per gather, divides n2 */
+    unsigned char* bits;         /* Word sizes, floor(p/n) or ceil(p/n) */
+    double* weight;              /* 2^(ceil(pj/n) - pj/n) */
+    double* unweight;            /* 1 / (weight * m) */
+    ll_cplx_t* tw1;              /* exp(-2 pi i k / n1), k < n1/2 */
+    ll_cplx_t* tw2;              /* exp(-2 pi i k / n2), k < n2/2 */
+    ll_cplx_t* twn;              /* [r * n2 + c]: exp(-2 pi i c * bitrev(r) / m) */
+    ll_cplx_t* twm;              /* [r * n2 + q]: exp(-2 pi i k / m), k stored there */
+    uint32_t* rev2;              /* bitrev over n2 */
+    ll_cplx_t* data;             /* Transform workspace, n1 rows of n2 */
+    double* digits;              /* Balanced digits of s */
+    double* backup;              /* Digits before the current iteration */
+    unsigned int threads;
+    ll_cplx_t** scratch;         /* Per-thread buffers of block columns */
+    double* roundoff;            /* Per-thread worst distance this iteration */
+    struct ll_pool* pool;
+} ll_fft_t;
+
+/* ========================================================================
+ * CHECKPOINTS
+ * ======================================================================== */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t p;
+    uint64_t iteration;
+    uint64_t nbytes;
+} ll_header_t;
+
+static uint64_t fnv1a(uint64_t h, const void* data, size_t len) {
+    const unsigned char* b = (const unsigned char*)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= b[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* 1 if a checkpoint was read, 0 if the file does not exist, -1 if it is
+ * unreadable, malformed or for another exponent */
+static int checkpoint_load(const char* path, uint64_t p, mpz_t s, uint64_t* iteration) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return errno == ENOENT ? 0 : -1;
+
+    ll_header_t h;
+    int ok = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.magic, LL_MAGIC, 8) == 0 &&
+             h.version == LL_VERSION && h.p == p && h.iteration <= p - 2 &&
+             h.nbytes <= (p + 7) / 8;
+    unsigned char* bytes = ok ? malloc(h.nbytes ? h.nbytes : 1) : NULL;
+    uint64_t check = 0;
+    ok = ok && bytes && fread(bytes, 1, h.nbytes, f) == h.nbytes &&
+         fread(&check, sizeof(check), 1, f) == 1 &&
+         check == fnv1a(fnv1a(1469598103934665603ULL, &h, sizeof(h)), bytes, h.nbytes);
+    if (ok) {
+        mpz_import(s, h.nbytes, 1, 1, 0, 0, bytes);
+        *iteration = h.iteration;
+    }
+    free(bytes);
+    fclose(f);
+    return ok ? 1 : -1;
+}
+
+static int checkpoint_save(const char* path, uint64_t p, const mpz_t s, uint64_t iteration) {
+    size_t nbytes = 0;
+    unsigned char* bytes = mpz_export(NULL, &nbytes, 1, 1, 0, 0, s);
+    ll_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, LL_MAGIC, 8);
+    h.version = LL_VERSION;
+    h.p = p;
+    h.iteration = iteration;
+    h.nbytes = nbytes;
+    uint64_t check = fnv1a(fnv1a(1469598103934665603ULL, &h, sizeof(h)), bytes, nbytes);
+
+    size_t len = strlen(path);
+    char* tmp = malloc(len + 5);
+    int ok = tmp != NULL;
+    if (ok) {
+        memcpy(tmp, path, len);
+        memcpy(tmp + len, ".tmp", 5);
+        FILE* f = fopen(tmp, "wb");
+        ok = f != NULL;
+        if (f) {
+            ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+                 (nbytes == 0 || fwrite(bytes, 1, nbytes, f) == nbytes) &&
+                 fwrite(&check, sizeof(check), 1, f) == 1 && fflush(f) == 0 &&
+                 fsync(fileno(f)) == 0;
+            ok = (fclose(f) == 0) && ok;
+        }
+        ok = ok && rename(tmp, path) == 0;
+        if (!ok) unlink(tmp);
+    }
+    free(tmp);
+    /* mpz_export allocates with the GMP allocator */
+    void (*gmp_free)(void*, size_t);
+    mp_get_memory_functions(NULL, NULL, &gmp_free);
+    if (bytes) gmp_free(bytes, nbytes);
+    return ok ? 0 : -1;
+}
+
+/* ========================================================================
+ * GMP ENGINE
+ * ======================================================================== */
+
+/* iterations squarings of s mod mp, folding instead of dividing */
+static void gmp_iterate(mpz_t s, const mpz_t mp, uint64_t p, uint64_t iterations,
+                        mpz_t t, mpz_t hi) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        mpz_mul(t, s, s);
+        while (mpz_sizeinbase(t, 2) > p) {
+            mpz_tdiv_q_2exp(hi, t, p);
+            mpz_tdiv_r_2exp(t, t, p);
+            mpz_add(t, t, hi);
+        }
+        if (mpz_cmp(t, mp) == 0) mpz_set_ui(t, 0);
+        if (mpz_cmp_ui(t, 2) < 0) mpz_add(t, t, mp);
+        mpz_sub_ui(s, t, 2);
+    }
+}
+
+/* ========================================================================
+ * FFT KERNELS
+ * ======================================================================== */
+
+static inline ll_cplx_t cmul(ll_cplx_t a, ll_cplx_t b) {
+    ll_cplx_t r = { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+    return r;
+}
+
+static inline ll_cplx_t cmulc(ll_cplx_t a, ll_cplx_t b) {   /* a * conj(b) */
+    ll_cplx_t r = { a.re * b.re + a.im * b.im, a.im * b.re - a.re * b.im };
+    return r;
+}
+
+/* Forward radix-2 decimation in frequency: natural order in, bit-reversed out */
+static void fft_dif(ll_cplx_t* a, size_t len, const ll_cplx_t* tw) {
+    for (size_t half = len / 2, stride = 1; half >= 1; half /= 2, stride *= 2) {
+        for (size_t start = 0; start < len; start += 2 * half) {
+            for (size_t j = 0; j < half; j++) {
+                ll_cplx_t u = a[start + j], v = a[start + j + half];
+                ll_cplx_t d = { u.re - v.re, u.im - v.im };
+                a[start + j].re = u.re + v.re;
+                a[start + j].im = u.im + v.im;
+                a[start + j + half] = cmul(d, tw[j * stride]);
+            }
+        }
+    }
+}
+
+/* Inverse radix-2 decimation in time, unscaled: bit-reversed in, natural out */
+static void fft_dit_inv(ll_cplx_t* a, size_t len, const ll_cplx_t* tw) {
+    for (size_t half = 1, stride = len / 2; half < len; half *= 2, stride /= 2) {
+        for (size_t start = 0; start < len; start += 2 * half) {
+            for (size_t j = 0; j < half; j++) {
+                ll_cplx_t u = a[start + j];
+                ll_cplx_t v = cmulc(a[start + j + half], tw[j * stride]);
+                a[start + j].re = u.re + v.re;
+                a[start + j].im = u.im + v.im;
+                a[start + j + half].re = u.re - v.re;
+                a[start + j + half].im = u.im - v.im;
+            }
+        }
+    }
+}
+
+static void twiddles(ll_cplx_t* tw, size_t len) {
+    for (size_t k = 0; k < len / 2; k++) {
+        double angle = -2.0 * M_PI * (double)k / (double)len;
+        tw[k].re = cos(angle);
+        tw[k].im = sin(angle);
+    }
+}
+
+static size_t bitrev(size_t x, size_t len) {
+    size_t r = 0;
+    for (size_t m = len; m > 1; m /= 2, x /= 2) r = (r << 1) | (x & 1);
+    return r;
+}
+
+/* ========================================================================
+ * FFT SQUARING
+ * ======================================================================== */
+
+/* Rows for thread t of threads when count items are split evenly */
+static void share(size_t count, unsigned int t, unsigned int threads, size_t* lo, size_t* hi) {
+    *lo = count * t / threads;
+    *hi = count * (t + 1) / threads;
+}
+
+/* Phase 0: weighted columns forward, then the four-step twiddles. Columns
+ * are gathered a block at a time so each row read covers whole cache lines */
+static void phase_columns_forward(ll_fft_t* f, unsigned int t) {
+    size_t lo, hi;
+    share(f->n2 / f->block, t, f->threads, &lo, &hi);
+    ll_cplx_t* cols = f->scratch[t];
+    for (size_t c0 = lo * f->block; c0 < hi * f->block; c0 += f->block) {
+        for (size_t r = 0; r < f->n1; r++) {
+            for (size_t b = 0; b < f->block; b++) {
+                size_t j = 2 * (r * f->n2 + c0 + b);
+                cols[b * f->n1 + r].re = f->digits[j] * f->weight[j];
+                cols[b * f->n1 + r].im = f->digits[j + 1] * f->weight[j + 1];
+            }
+        }
+        for (size_t b = 0; b < f->block; b++) fft_dif(cols + b * f->n1, f->n1, f->tw1);
+        for (size_t r = 0; r < f->n1; r++) {
+            for (size_t b = 0; b < f->block; b++) {
+                size_t j = r * f->n2 + c0 + b;
+                f->data[j] = cmul(cols[b * f->n1 + r], f->twn[j]);
+            }
+        }
+    }
+}
+
+/* Square of the real input on the packed spectrum. With E and O the
+ * spectra of the even and odd digits at k, Z[k] = E + iO and
+ * Z[-k] = conj(E) + i conj(O); the square has E' = E^2 + w^2 O^2 and
+ * O' = 2EO, w = exp(-2 pi i k / n), and conjugate values at -k */
+static void square_pair(ll_cplx_t* za, ll_cplx_t* zb, ll_cplx_t w2) {
+    ll_cplx_t a = *za, b = { zb->re, -zb->im };
+    ll_cplx_t e = { (a.re + b.re) * 0.5, (a.im + b.im) * 0.5 };
+    ll_cplx_t o = { (a.im - b.im) * 0.5, (b.re - a.re) * 0.5 };   /* (a - b) / 2i */
+    ll_cplx_t e2 = cmul(e, e), o2 = cmul(cmul(o, o), w2), eo = cmul(e, o);
+    ll_cplx_t pp = { e2.re + o2.re, e2.im + o2.im };
+    *za = (ll_cplx_t){ pp.re - 2.0 * eo.im, pp.im + 2.0 * eo.re };   /* E' + iO' */
+    if (zb != za) *zb = (ll_cplx_t){ pp.re + 2.0 * eo.im, 2.0 * eo.re - pp.im };
+}
+
+/* Phase 1: row pairs holding k1 and -k1 forward, squared, and back. Row r
+ * holds k1 = bitrev(r) and, at position q, k = k1 + n1 * bitrev(q) */
+static void phase_rows_square(ll_fft_t* f, unsigned int t) {
+    size_t lo, hi;
+    share(f->n1 / 2 + 1, t, f->threads, &lo, &hi);
+    for (size_t k1 = lo; k1 < hi; k1++) {
+        size_t ra = bitrev(k1, f->n1), rb = bitrev((f->n1 - k1) % f->n1, f->n1);
+        ll_cplx_t* rowa = f->data + ra * f->n2;
+        ll_cplx_t* rowb = f->data + rb * f->n2;
+        fft_dif(rowa, f->n2, f->tw2);
+        if (rb != ra) fft_dif(rowb, f->n2, f->tw2);
+        for (size_t q = 0; q < f->n2; q++) {
+            size_t k2 = f->rev2[q];
+            size_t qb = f->rev2[(2 * f->n2 - k2 - (k1 ? 1 : 0)) % f->n2];   /* -k */
+            if (rb == ra && qb < q) continue;
+            square_pair(rowa + q, rowb + qb, f->twm[ra * f->n2 + q]);
+        }
+        fft_dit_inv(rowa, f->n2, f->tw2);
+        if (rb != ra) fft_dit_inv(rowb, f->n2, f->tw2);
+    }
+}
+
+/* Phase 2: inverse twiddles and columns, unweight, round to digits */
+static void phase_columns_inverse(ll_fft_t* f, unsigned int t) {
+    size_t lo, hi;
+    share(f->n2 / f->block, t, f->threads, &lo, &hi);
+    ll_cplx_t* cols = f->scratch[t];
+    double worst = 0.0;
+    for (size_t c0 = lo * f->block; c0 < hi * f->block; c0 += f->block) {
+        for (size_t r = 0; r < f->n1; r++) {
+            for (size_t b = 0; b < f->block; b++) {
+                size_t j = r * f->n2 + c0 + b;
+                cols[b * f->n1 + r] = cmulc(f->data[j], f->twn[j]);
+            }
+        }
+        for (size_t b = 0; b < f->block; b++) fft_dit_inv(cols + b * f->n1, f->n1, f->tw1);
+        for (size_t r = 0; r < f->n1; r++) {
+            for (size_t b = 0; b < f->block; b++) {
+                size_t j = 2 * (r * f->n2 + c0 + b);
+                ll_cplx_t z = cols[b * f->n1 + r];
+                double v0 = z.re * f->unweight[j], v1 = z.im * f->unweight[j + 1];
+                double d0 = rint(v0), d1 = rint(v1);
+                double err = fmax(fabs(v0 - d0), fabs(v1 - d1));
+                if (err > worst) worst = err;
+                f->digits[j] = d0;
+                f->digits[j + 1] = d1;
+            }
+        }
+    }
+    f->roundoff[t] = worst;
+}
+
+static void run_phase(ll_fft_t* f, int phase, unsigned int t) {
+    switch (phase) {
+        case 0: phase_columns_forward(f, t); break;
+        case 1: phase_rows_square(f, t); break;
+        default: phase_columns_inverse(f, t); break;
+    }
+}
+
+/* Workers 1..threads-1 wait for a phase, run their share and report back;
+ * the calling thread is worker 0 */
+typedef struct ll_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned long generation;
+    unsigned int pending;
+    int phase;
+    int quit;
+    ll_fft_t* fft;
+    unsigned int workers;
+    pthread_t* tids;
+} ll_pool_t;
+
+typedef struct {
+    ll_pool_t* pool;
+    unsigned int index;
+} ll_worker_arg_t;
+
+static void* pool_worker(void* p) {
+    ll_worker_arg_t* arg = (ll_worker_arg_t*)p;
+    ll_pool_t* pool = arg->pool;
+    unsigned int index = arg->index;
+    free(arg);
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->quit) break;
+        seen = pool->generation;
+        int phase = pool->phase;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_phase(pool->fft, phase, index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void pool_run(ll_fft_t* f, int phase) {
+    ll_pool_t* pool = f->pool;
+    if (!pool) {
+        run_phase(f, phase, 0);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->phase = phase;
+    pool->pending = pool->workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_phase(f, phase, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void pool_stop(ll_pool_t* pool, unsigned int started) {
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (unsigned int i = 0; i < started; i++) pthread_join(pool->tids[i], NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->tids);
+    free(pool);
+}
+
+static int pool_start(ll_fft_t* f) {
+    ll_pool_t* pool = calloc(1, sizeof(ll_pool_t));
+    if (!pool) return -1;
+    pool->workers = f->threads - 1;
+    pool->fft = f;
+    pool->tids = calloc(pool->workers, sizeof(pthread_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    if (!pool->tids) {
+        pool_stop(pool, 0);
+        return -1;
+    }
+    for (unsigned int i = 0; i < pool->workers; i++) {
+        ll_worker_arg_t* arg = malloc(sizeof(ll_worker_arg_t));
+        if (arg) {
+            arg->pool = pool;
+            arg->index = i + 1;
+        }
+        if (!arg || pthread_create(&pool->tids[i], NULL, pool_worker, arg) != 0) {
+            free(arg);
+            pool_stop(pool, i);
+            return -1;
+        }
+    }
+    f->pool = pool;
+    return 0;
+}
+
+/* Bits per word the transform of length n carries without roundoff trouble */
+static double fft_max_bits(size_t n) {
+    return (46.0 - 0.5 * log2((double)n)) / 2.0;
+}
+
+/* Smallest power-of-two length >= min_n for exponent p */
+static size_t fft_length_for(uint64_t p, size_t min_n) {
+    size_t n = 16;
+    while (n < min_n || (double)((p + n - 1) / n) > fft_max_bits(n)) n *= 2;
+    return n;
+}
+
+static void fft_free(ll_fft_t* f) {
+    if (f->pool) pool_stop(f->pool, f->pool->workers);
+    if (f->scratch) {
+        for (unsigned int t = 0; t < f->threads; t++) free(f->scratch[t]);
+    }
+    free(f->scratch);
+    free(f->roundoff);
+    free(f->bits);
+    free(f->weight);
+    free(f->unweight);
+    free(f->tw1);
+    free(f->tw2);
+    free(f->twn);
+    free(f->twm);
+    free(f->rev2);
+    free(f->data);
+    free(f->digits);
+    free(f->backup);
+    memset(f, 0, sizeof(*f));
+}
+
+static int fft_init(ll_fft_t* f, uint64_t p, size_t n, unsigned int threads) {
+    memset(f, 0, sizeof(*f));
+    f->p = p;
+    f->n = n;
+    f->m = n / 2;
+    size_t log_m = 0;
+    while (((size_t)1 << log_m) < f->m) log_m++;
+    f->n1 = (size_t)1 << (log_m / 2);
+    f->n2 = f->m / f->n1;
+    f->block = f->n2 < LL_COLUMN_BLOCK ? f->n2 : LL_COLUMN_BLOCK;
+    f->threads = (n >= LL_PARALLEL_MIN_LENGTH && threads > 1) ? threads : 1;
+    if (f->threads > f->n1 / 2) f->threads = (unsigned int)(f->n1 / 2);
+
+    f->bits = malloc(n);
+    f->weight = malloc(n * sizeof(double));
+    f->unweight = malloc(n * sizeof(double));
+    f->tw1 = malloc(f->n1 / 2 * sizeof(ll_cplx_t));
+    f->tw2 = malloc(f->n2 / 2 * sizeof(ll_cplx_t));
+    f->twn = malloc(f->m * sizeof(ll_cplx_t));
+    f->twm = malloc(f->m * sizeof(ll_cplx_t));
+    f->rev2 = malloc(f->n2 * sizeof(uint32_t));
+    f->data = malloc(f->m * sizeof(ll_cplx_t));
+    f->digits = malloc(n * sizeof(double));
+    f->backup = malloc(n * sizeof(double));
+    f->scratch = calloc(f->threads, sizeof(ll_cplx_t*));
+    f->roundoff = calloc(f->threads, sizeof(double));
+    int ok = f->bits && f->weight && f->unweight && f->tw1 && f->tw2 && f->twn && f->twm &&
+             f->rev2 && f->data && f->digits && f->backup && f->scratch && f->roundoff;
+    for (unsigned int t = 0; ok && t < f->threads; t++) {
+        f->scratch[t] = malloc(f->n1 * f->block * sizeof(ll_cplx_t));
+        ok = f->scratch[t] != NULL;
+    }
+    if (!ok) {
+        fft_free(f);
+        return -1;
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        uint64_t c0 = (p * j + n - 1) / n;          /* ceil(pj / n) */
+        uint64_t c1 = (p * (j + 1) + n - 1) / n;
+        f->bits[j] = (unsigned char)(c1 - c0);
+        double frac = (double)(c0 * n - p * j) / (double)n;
+        f->weight[j] = exp2(frac);
+        f->unweight[j] = 1.0 / (f->weight[j] * (double)f->m);
+    }
+    twiddles(f->tw1, f->n1);
+    twiddles(f->tw2, f->n2);
+    for (size_t q = 0; q < f->n2; q++) f->rev2[q] = (uint32_t)bitrev(q, f->n2);
+    for (size_t r = 0; r < f->n1; r++) {
+        size_t k1 = bitrev(r, f->n1);
+        for (size_t c = 0; c < f->n2; c++) {
+            /* Reducing mod m before the angle keeps it exact */
+            double angle = -2.0 * M_PI * (double)((c * k1) % f->m) / (double)f->m;
+            f->twn[r * f->n2 + c].re = cos(angle);
+            f->twn[r * f->n2 + c].im = sin(angle);
+            angle = -2.0 * M_PI * (double)(k1 + f->n1 * f->rev2[c]) / (double)f->m;
+            f->twm[r * f->n2 + c].re = cos(angle);
+            f->twm[r * f->n2 + c].im = sin(angle);
+        }
+    }
+    if (f->threads > 1 && pool_start(f) != 0) {
+        fft_free(f);
+        return -1;
+    }
+    return 0;
+}
+
+/* s (0 <= s < M_p) into balanced digits */
+static void fft_load(ll_fft_t* f, const mpz_t s) {
+    size_t words = (size_t)(f->p / 64 + 2);
+    uint64_t* buf = calloc(words, sizeof(uint64_t));
+    size_t count = 0;
+    if (buf) mpz_export(buf, &count, -1, sizeof(uint64_t), 0, 0, s);
+    uint64_t pos = 0;
+    int64_t carry = 0;
+    for (size_t j = 0; j < f->n; j++) {
+        unsigned b = f->bits[j];
+        int64_t d = 0;
+        for (unsigned k = 0; k < b && buf; k++, pos++) {
+            d |= (int64_t)((buf[pos / 64] >> (pos % 64)) & 1) << k;
+        }
+        d += carry;
+        carry = 0;
+        if (d >= (int64_t)1 << (b - 1)) {
+            d -= (int64_t)1 << b;
+            carry = 1;
+        }
+        f->digits[j] = (double)d;
+    }
+    f->digits[0] += (double)carry;   /* 2^p = 1 */
+    free(buf);
+}
+
+/* Propagate carries in the balanced representation; the top carry wraps */
+static void fft_carry(ll_fft_t* f) {
+    int64_t carry = 0;
+    for (int pass = 0; pass < 3; pass++) {
+        for (size_t j = 0; j < f->n; j++) {
+            unsigned b = f->bits[j];
+            int64_t x = (int64_t)f->digits[j] + carry;
+            int64_t base = (int64_t)1 << b;
+            int64_t lo = x & (base - 1);
+            if (lo >= base / 2) lo -= base;
+            carry = (x - lo) >> b;
+            f->digits[j] = (double)lo;
+            if (carry == 0 && pass > 0) return;
+        }
+        if (carry == 0) return;
+    }
+    f->digits[0] += (double)carry;
+}
+
+/* Digits back into s, reduced to 0 <= s < M_p */
+static int fft_store(ll_fft_t* f, mpz_t s) {
+    size_t words = (size_t)(f->p / 64 + 2);
+    uint64_t* buf = calloc(words, sizeof(uint64_t));
+    int64_t* d = malloc(f->n * sizeof(int64_t));
+    if (!buf || !d) {
+        free(buf);
+        free(d);
+        return -1;
+    }
+    for (size_t j = 0; j < f->n; j++) d[j] = (int64_t)f->digits[j];
+    /* Non-negative digits; the borrow out of the top adds back at the bottom */
+    int64_t carry = 0;
+    do {
+        for (size_t j = 0; j < f->n; j++) {
+            int64_t x = d[j] + carry;
+            int64_t base = (int64_t)1 << f->bits[j];
+            d[j] = x & (base - 1);
+            carry = (x - d[j]) >> f->bits[j];
+        }
+    } while (carry != 0);
+    uint64_t pos = 0;
+    for (size_t j = 0; j < f->n; j++) {
+        for (unsigned k = 0; k < f->bits[j]; k++, pos++) {
+            if ((d[j] >> k) & 1) buf[pos / 64] |= 1ULL << (pos % 64);
+        }
+    }
+    mpz_import(s, words, -1, sizeof(uint64_t), 0, 0, buf);
+    free(buf);
+    free(d);
+
+    mpz_t mp;
+    mpz_init(mp);
+    mpz_setbit(mp, f->p);
+    mpz_sub_ui(mp, mp, 1);
+    if (mpz_cmp(s, mp) >= 0) mpz_sub(s, s, mp);
+    mpz_clear(mp);
+    return 0;
+}
+
+/* Up to iterations steps; returns the number done, fewer if the roundoff
+ * crossed LL_ROUNDOFF_LIMIT (the digits are then those before that step) */
+static uint64_t fft_iterate(ll_fft_t* f, uint64_t iterations, double* max_roundoff) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        memcpy(f->backup, f->digits, f->n * sizeof(double));
+        pool_run(f, 0);
+        pool_run(f, 1);
+        pool_run(f, 2);
+        double worst = 0.0;
+        for (unsigned int t = 0; t < f->threads; t++) {
+            if (f->roundoff[t] > worst) worst = f->roundoff[t];
+        }
+        if (worst > LL_ROUNDOFF_LIMIT) {
+            memcpy(f->digits, f->backup, f->n * sizeof(double));
+            return i;
+        }
+        if (worst > *max_roundoff) *max_roundoff = worst;
+        f->digits[0] -= 2.0;
+        fft_carry(f);
+    }
+    return iterations;
+}
+
+/* ========================================================================
+ * DRIVER
+ * ======================================================================== */
+
+void z5d_ll_config_init(z5d_ll_config_t* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->engine = Z5D_LL_AUTO;
+    config->threads = 1;
+}
+
+int z5d_lucas_lehmer(uint64_t p, const z5d_ll_config_t* config, z5d_ll_stats_t* stats) {
+    z5d_ll_config_t defaults;
+    if (!config) {
+        z5d_ll_config_init(&defaults);
+        config = &defaults;
+    }
+    z5d_ll_stats_t local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    stats->engine = Z5D_LL_GMP;
+
+    if (p < 2) return Z5D_LL_COMPOSITE;
+    if (p == 2) return Z5D_LL_PRIME;   /* M_2 = 3; the recurrence starts at p = 3 */
+    if (p > Z5D_LL_MAX_P) return -1;
+    mpz_t tmp;
+    mpz_init_set_ui(tmp, (unsigned long)p);
+    int p_prime = mpz_probab_prime_p(tmp, 25) > 0;
+    mpz_clear(tmp);
+    if (!p_prime) return Z5D_LL_COMPOSITE;   /* p = ab gives 2^a - 1 | M_p */
+
+    mpz_t s, mp, t, hi;
+    mpz_inits(s, mp, t, hi, NULL);
+    mpz_setbit(mp, p);
+    mpz_sub_ui(mp, mp, 1);
+    mpz_set_ui(s, 4);
+    uint64_t done = 0;
+    int status = 0;
+
+    if (config->checkpoint_path) {
+        int r = checkpoint_load(config->checkpoint_path, p, s, &done);
+        if (r < 0 || mpz_cmp(s, mp) >= 0) status = -1;
+        if (r > 0) stats->resumed_at = done;
+    }
+
+    const uint64_t total = p - 2;
+    uint64_t target = total;
+    if (config->stop_after && done + config->stop_after < total) target = done + config->stop_after;
+    const uint64_t every = config->checkpoint_every ? config->checkpoint_every
+                                                    : Z5D_LL_CHECKPOINT_EVERY;
+
+    z5d_ll_engine_t engine = config->engine;
+    if (engine == Z5D_LL_AUTO) engine = (p >= Z5D_LL_FFT_THRESHOLD) ? Z5D_LL_FFT : Z5D_LL_GMP;
+    if (p < LL_FFT_MIN_P) engine = Z5D_LL_GMP;
+    stats->engine = engine;
+
+    ll_fft_t fft;
+    memset(&fft, 0, sizeof(fft));
+    if (status == 0 && engine == Z5D_LL_FFT &&
+        fft_init(&fft, p, fft_length_for(p, 0), config->threads) != 0) {
+        status = -1;
+    }
+
+    while (status == 0 && done < target) {
+        uint64_t chunk = target - done;
+        if (config->checkpoint_path && chunk > every) chunk = every;
+        if (engine == Z5D_LL_GMP) {
+            gmp_iterate(s, mp, p, chunk, t, hi);
+            done += chunk;
+        } else {
+            fft_load(&fft, s);
+            uint64_t ran = fft_iterate(&fft, chunk, &stats->max_roundoff);
+            done += ran;
+            if (fft_store(&fft, s) != 0) {
+                status = -1;
+            } else if (ran < chunk) {
+                /* Roundoff too close to half: continue at twice the length */
+                size_t n = fft.n * 2;
+                fft_free(&fft);
+                if (fft_init(&fft, p, fft_length_for(p, n), config->threads) != 0) status = -1;
+                stats->fft_grows++;
+                continue;
+            }
+        }
+        if (status == 0 && config->checkpoint_path &&
+            checkpoint_save(config->checkpoint_path, p, s, done) != 0) {
+            status = -1;
+        }
+    }
+    stats->fft_length = engine == Z5D_LL_FFT ? fft.n : 0;
+    fft_free(&fft);
+
+    stats->iterations = done;
+    stats->res64 = mpz_getlimbn(s, 0);
+    if (sizeof(mp_limb_t) < 8 && mpz_size(s) > 1) {
+        stats->res64 |= (uint64_t)mpz_getlimbn(s, 1) << 32;
+    }
+    if (status == 0) {
+        status = (done < total) ? Z5D_LL_STOPPED
+                                : (mpz_sgn(s) == 0 ? Z5D_LL_PRIME : Z5D_LL_COMPOSITE);
+    }
+    mpz_clears(s, mp, t, hi, NULL);
+    return status;
+}
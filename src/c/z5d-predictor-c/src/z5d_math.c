@@ -11,81 +11,166 @@
 #include "z5d_math.h"
 #include "../include/z5d_predictor.h"
 #include <math.h>
+#include <stdlib.h>
 
-/**
- * Compute logarithmic integral li(x) using series expansion
- * li(x) ≈ ln(ln(x)) + γ + sum_{k=1..∞} (ln x)^k / (k * k!)
- * 
- * For large x, we use the asymptotic expansion instead for better convergence.
- */
-void z5d_li(mpfr_t rop, const mpfr_t x, mpfr_prec_t prec) {
-    mpfr_t ln_x, ln_ln_x, term, sum, k_mpfr, factorial, power;
-    mpfr_t gamma_const, one;
-    
-    mpfr_init2(ln_x, prec);
-    mpfr_init2(ln_ln_x, prec);
-    mpfr_init2(term, prec);
-    mpfr_init2(sum, prec);
-    mpfr_init2(k_mpfr, prec);
-    mpfr_init2(factorial, prec);
-    mpfr_init2(power, prec);
-    mpfr_init2(gamma_const, prec);
-    mpfr_init2(one, prec);
-    
-    mpfr_set_ui(one, 1, MPFR_RNDN);
-    
-    // ln(x)
-    mpfr_log(ln_x, x, MPFR_RNDN);
-    
-    // ln(ln(x))
-    mpfr_log(ln_ln_x, ln_x, MPFR_RNDN);
-    
-    // Euler-Mascheroni constant γ ≈ 0.5772156649
-    mpfr_const_euler(gamma_const, MPFR_RNDN);
-    
-    // Start with ln(ln(x)) + γ
-    mpfr_add(sum, ln_ln_x, gamma_const, MPFR_RNDN);
-    
-    // Add series: sum_{k=1..N} (ln x)^k / (k * k!)
-    mpfr_set_ui(factorial, 1, MPFR_RNDN);
-    mpfr_set(power, ln_x, MPFR_RNDN);
-    
-    for (int k = 1; k <= 100; k++) {  // 100 terms should be enough
-        // power = (ln x)^k
-        if (k > 1) {
-            mpfr_mul(power, power, ln_x, MPFR_RNDN);
-        }
-        
-        // factorial = k!
-        if (k > 1) {
-            mpfr_mul_ui(factorial, factorial, k, MPFR_RNDN);
-        }
-        
-        // term = (ln x)^k / (k * k!)
+/* --------- Logarithmic integral --------- */
+
+/* ln x below this: the plain power series, whose terms are cheapest */
+#define LI_POWER_SERIES_MAX_LOG 16.0
+/* ln x above this: the power series again, so Ramanujan's stored terms stay small */
+#define LI_RAMANUJAN_MAX_LOG 1024.0
+
+/* li = gamma + ln L + sum_{k>=1} L^k / (k k!) for L > 0. All terms are
+   positive; they rise to k ~ L and are summed until below the last bit. */
+static void li_power_series(mpfr_t sum, const mpfr_t L, double Ld) {
+    mpfr_prec_t wp = mpfr_get_prec(sum);
+    mpfr_t power, term;
+    mpfr_inits2(wp, power, term, (mpfr_ptr)0);
+    mpfr_set_ui(power, 1, MPFR_RNDN);
+    mpfr_set_ui(sum, 0, MPFR_RNDN);
+    for (unsigned long k = 1;; k++) {
+        mpfr_mul(power, power, L, MPFR_RNDN);
+        mpfr_div_ui(power, power, k, MPFR_RNDN);
         mpfr_div_ui(term, power, k, MPFR_RNDN);
-        mpfr_div(term, term, factorial, MPFR_RNDN);
-        
-        // sum += term
         mpfr_add(sum, sum, term, MPFR_RNDN);
-        
-        // Check convergence
-        mpfr_abs(term, term, MPFR_RNDN);
-        if (mpfr_cmp_d(term, 1e-50) < 0) {
-            break;
+        if ((double)k > Ld && mpfr_get_exp(term) < mpfr_get_exp(sum) - wp - 2) break;
+    }
+    mpfr_log(term, L, MPFR_RNDN);
+    mpfr_add(sum, sum, term, MPFR_RNDN);
+    mpfr_const_euler(term, MPFR_RNDN);
+    mpfr_add(sum, sum, term, MPFR_RNDN);
+    mpfr_clears(power, term, (mpfr_ptr)0);
+}
+
+/* Ramanujan: li = gamma + ln L + e^(L/2) sum_{n>=1} (-1)^(n-1) a_n h_n with
+   a_n = L^n / (n! 2^(n-1)) and h_n = sum_{j odd, j <= n} 1/j. About half the
+   terms of the power series. Summing by tails, sum a_n h_n over n = sum over
+   odd j of (tail from n = j) / j, leaves one full product per term. Returns
+   -1 if the terms cannot be stored. */
+static int li_ramanujan(mpfr_t sum, const mpfr_t L, double Ld) {
+    mpfr_prec_t wp = mpfr_get_prec(sum);
+    size_t cap = (size_t)(1.5 * Ld) + (size_t)wp / 2 + 16, count = 1;
+    mpfr_t* a = malloc(cap * sizeof(mpfr_t));
+    if (!a) return -1;
+    mpfr_init2(a[0], wp);
+    mpfr_set(a[0], L, MPFR_RNDN);
+    /* The sum is about e^(L/2) / L; stop a_n below its last bit */
+    mpfr_exp_t stop = (mpfr_exp_t)(Ld * 0.72134752044448170368 - log2(Ld)) -
+                      (mpfr_exp_t)wp - 8;
+    while ((double)count <= Ld / 2 || mpfr_get_exp(a[count - 1]) >= stop) {
+        if (count == cap) {
+            mpfr_t* t = realloc(a, 2 * cap * sizeof(mpfr_t));
+            if (!t) {
+                for (size_t i = 0; i < count; i++) mpfr_clear(a[i]);
+                free(a);
+                return -1;
+            }
+            a = t;
+            cap *= 2;
         }
+        mpfr_init2(a[count], wp);
+        mpfr_mul(a[count], a[count - 1], L, MPFR_RNDN);
+        mpfr_div_ui(a[count], a[count], 2 * (unsigned long)(count + 1), MPFR_RNDN);
+        count++;
+    }
+
+    mpfr_t tail;
+    mpfr_init2(tail, wp);
+    mpfr_set_ui(tail, 0, MPFR_RNDN);
+    mpfr_set_ui(sum, 0, MPFR_RNDN);
+    for (size_t i = count; i-- > 0;) {
+        unsigned long n = (unsigned long)i + 1;
+        if (n & 1) {
+            mpfr_add(tail, tail, a[i], MPFR_RNDN);
+            mpfr_div_ui(a[i], tail, n, MPFR_RNDN);
+            mpfr_add(sum, sum, a[i], MPFR_RNDN);
+        } else {
+            mpfr_sub(tail, tail, a[i], MPFR_RNDN);
+        }
+        mpfr_clear(a[i]);
+    }
+    free(a);
+
+    mpfr_div_2ui(tail, L, 1, MPFR_RNDN);
+    mpfr_exp(tail, tail, MPFR_RNDN);
+    mpfr_mul(sum, sum, tail, MPFR_RNDN);
+    mpfr_log(tail, L, MPFR_RNDN);
+    mpfr_add(sum, sum, tail, MPFR_RNDN);
+    mpfr_const_euler(tail, MPFR_RNDN);
+    mpfr_add(sum, sum, tail, MPFR_RNDN);
+    mpfr_clear(tail);
+    return 0;
+}
+
+/* li ~ (x / L) sum_{k>=0} k! / L^k. The terms fall while k < L, to about
+   sqrt(2 pi L) e^-L, so the caller uses this only when that is below the
+   last bit. */
+static void li_asymptotic(mpfr_t sum, const mpfr_t L, double Ld) {
+    mpfr_prec_t wp = mpfr_get_prec(sum);
+    mpfr_t inv_L, term;
+    mpfr_inits2(wp, inv_L, term, (mpfr_ptr)0);
+    mpfr_ui_div(inv_L, 1, L, MPFR_RNDN);
+    mpfr_set_ui(term, 1, MPFR_RNDN);
+    mpfr_set_ui(sum, 1, MPFR_RNDN);
+    for (unsigned long k = 1; (double)k < Ld; k++) {
+        mpfr_mul_ui(term, term, k, MPFR_RNDN);
+        mpfr_mul(term, term, inv_L, MPFR_RNDN);
+        mpfr_add(sum, sum, term, MPFR_RNDN);
+        if (mpfr_get_exp(term) < -(mpfr_exp_t)wp - 2) break;
+    }
+    mpfr_exp(term, L, MPFR_RNDN);
+    mpfr_mul(sum, sum, term, MPFR_RNDN);
+    mpfr_mul(sum, sum, inv_L, MPFR_RNDN);
+    mpfr_clears(inv_L, term, (mpfr_ptr)0);
+}
+
+void z5d_li_log(mpfr_t rop, const mpfr_t ln_x, mpfr_prec_t prec) {
+    if (!mpfr_number_p(ln_x)) {                  /* li(0) = 0, li(inf) = inf */
+        mpfr_eint(rop, ln_x, MPFR_RNDN);
+        return;
+    }
+    double Ld = mpfr_get_d(ln_x, MPFR_RNDN);
+    /* Guard bits for the rounding of the ~L terms summed */
+    mpfr_prec_t wp = prec + 16 + (Ld > 2.0 ? (mpfr_prec_t)log2(Ld) : 1);
+    mpfr_t L, sum;
+    mpfr_inits2(wp, L, sum, (mpfr_ptr)0);
+    mpfr_set(L, ln_x, MPFR_RNDN);
+
+    /* Smallest asymptotic term, log2(sqrt(2 pi L) e^-L), against the last bit */
+    int asymptotic = Ld > 1.0 &&
+                     -Ld * 1.44269504088896340736 + 0.5 * log2(6.28318530717958647693 * Ld) <
+                         -(double)wp - 2.0;
+    if (Ld <= 0.0) {
+        mpfr_eint(sum, L, MPFR_RNDN);            /* 0 < x <= 1: small, cancelling series */
+    } else if (asymptotic) {
+        li_asymptotic(sum, L, Ld);
+    } else if (Ld < LI_POWER_SERIES_MAX_LOG || Ld > LI_RAMANUJAN_MAX_LOG ||
+               li_ramanujan(sum, L, Ld) != 0) {
+        li_power_series(sum, L, Ld);
     }
-    
     mpfr_set(rop, sum, MPFR_RNDN);
-    
+    mpfr_clears(L, sum, (mpfr_ptr)0);
+}
+
+/**
+ * li(x) by the cheapest method for the size of ln x (see z5d_li_log); the
+ * terms are summed until they fall below the working precision.
+ */
+void z5d_li(mpfr_t rop, const mpfr_t x, mpfr_prec_t prec) {
+    if (mpfr_sgn(x) < 0 || mpfr_nan_p(x)) {
+        mpfr_set_nan(rop);
+        return;
+    }
+    /* ln x carries an absolute error, so li a relative one, of about L ulps */
+    mpfr_prec_t guard = 32;
+    if (mpfr_number_p(x) && !mpfr_zero_p(x)) {
+        for (mpfr_exp_t e = mpfr_get_exp(x); e > 1 || e < -1; e /= 2) guard++;
+    }
+    mpfr_t ln_x;
+    mpfr_init2(ln_x, prec + guard);
+    mpfr_log(ln_x, x, MPFR_RNDN);
+    z5d_li_log(rop, ln_x, prec);
     mpfr_clear(ln_x);
-    mpfr_clear(ln_ln_x);
-    mpfr_clear(term);
-    mpfr_clear(sum);
-    mpfr_clear(k_mpfr);
-    mpfr_clear(factorial);
-    mpfr_clear(power);
-    mpfr_clear(gamma_const);
-    mpfr_clear(one);
 }
 
 /**
@@ -202,3 +287,181 @@ int z5d_newton_halley_step(mpfr_t rop, const mpfr_t x, const mpfr_t n, int K, mp
     
     return 0;
 }
+
+/* --------- Riemann R inversion (Gram series + Halley) --------- */
+
+/* Largest m summed for 1/zeta(s) = sum mu(m) m^-s; smaller s use mpfr_zeta_ui */
+#define GRAM_DIRICHLET_MAX_M 64
+/* Correct bits assumed for the Dusart start */
+#define GRAM_START_BITS 4
+/* A Halley step below 2^-this settles the integer part */
+#define GRAM_SETTLED_EXP (-16)
+
+void z5d_riemann_init(z5d_riemann_t* r, mpfr_prec_t prec) {
+    r->prec = prec;
+    r->count = r->cap = 0;
+    r->inv_zeta = NULL;
+    r->limit = (size_t)prec + 1;
+    mpfr_inits2(prec, r->ln_x, r->power, r->term, r->a, r->b, r->c, r->f, r->df, r->d2f,
+                r->step, r->tmp, (mpfr_ptr)0);
+}
+
+static void riemann_drop_table(z5d_riemann_t* r) {
+    for (size_t i = 0; i < r->count; i++) mpfr_clear(r->inv_zeta[i]);
+    free(r->inv_zeta);
+    r->inv_zeta = NULL;
+    r->count = r->cap = 0;
+}
+
+void z5d_riemann_clear(z5d_riemann_t* r) {
+    riemann_drop_table(r);
+    mpfr_clears(r->ln_x, r->power, r->term, r->a, r->b, r->c, r->f, r->df, r->d2f,
+                r->step, r->tmp, (mpfr_ptr)0);
+}
+
+void z5d_riemann_set_prec(z5d_riemann_t* r, mpfr_prec_t prec) {
+    if (prec <= r->prec) return;
+    riemann_drop_table(r);
+    r->prec = prec;
+    r->limit = (size_t)prec + 1;
+}
+
+/* 1/zeta(s) at the table precision. For large s the Dirichlet series of
+   the Moebius function needs only m < 2^((prec + 4) / s) */
+static void inv_zeta(z5d_riemann_t* r, mpfr_t rop, unsigned long s) {
+    double m_max = exp2((double)(r->prec + 4) / (double)s);
+    if (m_max > GRAM_DIRICHLET_MAX_M) {
+        mpfr_zeta_ui(rop, s, MPFR_RNDN);
+        mpfr_ui_div(rop, 1, rop, MPFR_RNDN);
+        return;
+    }
+    mpfr_t t;
+    mpfr_init2(t, r->prec);
+    mpfr_set_ui(rop, 1, MPFR_RNDN);
+    for (unsigned long m = 2; m <= (unsigned long)m_max; m++) {
+        int mu = z5d_mobius((int)m);
+        if (mu == 0) continue;
+        mpfr_ui_pow_ui(t, m, s, MPFR_RNDN);
+        mpfr_ui_div(t, 1, t, MPFR_RNDN);
+        if (mu > 0) mpfr_add(rop, rop, t, MPFR_RNDN);
+        else mpfr_sub(rop, rop, t, MPFR_RNDN);
+    }
+    mpfr_clear(t);
+}
+
+/* Table entries through k (k <= limit) */
+static int riemann_grow(z5d_riemann_t* r, size_t k) {
+    if (k <= r->count) return 0;
+    if (k > r->cap) {
+        size_t cap = r->cap ? r->cap : 256;
+        while (cap < k) cap *= 2;
+        if (cap > r->limit) cap = r->limit;
+        mpfr_t* t = realloc(r->inv_zeta, cap * sizeof(mpfr_t));
+        if (!t) return -1;
+        r->inv_zeta = t;
+        r->cap = cap;
+    }
+    for (; r->count < k; r->count++) {
+        mpfr_init2(r->inv_zeta[r->count], r->prec);
+        inv_zeta(r, r->inv_zeta[r->count], (unsigned long)r->count + 2);
+    }
+    return 0;
+}
+
+int z5d_riemann_gram(z5d_riemann_t* r, mpfr_t R, mpfr_t dR, mpfr_t d2R, const mpfr_t x) {
+    mpfr_prec_t wp = mpfr_get_prec(R);
+    mpfr_ptr regs[] = {r->ln_x, r->power, r->term, r->a, r->b, r->c};
+    for (size_t i = 0; i < sizeof(regs) / sizeof(regs[0]); i++) mpfr_set_prec(regs[i], wp);
+
+    /* With p_k = L^k / k! and z_k = 1/zeta(k+1): a = sum p_k z_k / k,
+       b = sum p_k z_k, c = sum (k - 1) p_k z_k. Every term is positive. */
+    mpfr_log(r->ln_x, x, MPFR_RNDN);
+    double L = mpfr_get_d(r->ln_x, MPFR_RNDN);
+    mpfr_set_ui(r->power, 1, MPFR_RNDN);
+    mpfr_set_ui(r->a, 0, MPFR_RNDN);
+    mpfr_set_ui(r->b, 0, MPFR_RNDN);
+    mpfr_set_ui(r->c, 0, MPFR_RNDN);
+    for (unsigned long k = 1;; k++) {
+        mpfr_mul(r->power, r->power, r->ln_x, MPFR_RNDN);
+        mpfr_div_ui(r->power, r->power, k, MPFR_RNDN);
+        if (k <= r->limit) {
+            if (riemann_grow(r, k) != 0) return -1;
+            mpfr_mul(r->term, r->power, r->inv_zeta[k - 1], MPFR_RNDN);
+        } else {
+            mpfr_set(r->term, r->power, MPFR_RNDN);
+        }
+        mpfr_add(r->b, r->b, r->term, MPFR_RNDN);
+        if (d2R && k > 1) {
+            mpfr_mul_ui(r->tmp, r->term, k - 1, MPFR_RNDN);
+            mpfr_add(r->c, r->c, r->tmp, MPFR_RNDN);
+        }
+        mpfr_div_ui(r->term, r->term, k, MPFR_RNDN);
+        mpfr_add(r->a, r->a, r->term, MPFR_RNDN);
+        /* Past the peak at k ~ L the terms fall faster than geometrically */
+        if ((double)k > L && mpfr_get_exp(r->term) < mpfr_get_exp(r->a) - wp - 8) break;
+    }
+
+    mpfr_add_ui(R, r->a, 1, MPFR_RNDN);
+    if (dR) {   /* R' = b / (L x) */
+        mpfr_mul(r->tmp, r->ln_x, x, MPFR_RNDN);
+        mpfr_div(dR, r->b, r->tmp, MPFR_RNDN);
+    }
+    if (d2R) {  /* R'' = (c - L b) / (L x)^2 */
+        mpfr_mul(r->tmp, r->ln_x, r->b, MPFR_RNDN);
+        mpfr_sub(d2R, r->c, r->tmp, MPFR_RNDN);
+        mpfr_mul(r->tmp, r->ln_x, x, MPFR_RNDN);
+        mpfr_sqr(r->tmp, r->tmp, MPFR_RNDN);
+        mpfr_div(d2R, d2R, r->tmp, MPFR_RNDN);
+    }
+    return 0;
+}
+
+int z5d_riemann_inverse(z5d_riemann_t* r, mpfr_t rop, const mpfr_t n, int max_iterations,
+                        const mpfr_t tolerance, int* iterations) {
+    mpfr_prec_t full = mpfr_get_prec(rop);
+    z5d_riemann_set_prec(r, full);
+    *iterations = 0;
+
+    z5d_dusart_initializer(rop, n, full);
+    if (!mpfr_number_p(rop) || mpfr_cmp_ui(rop, 3) < 0) mpfr_set_ui(rop, 3, MPFR_RNDN);
+
+    long bits = GRAM_START_BITS;
+    mpfr_ptr regs[] = {r->f, r->df, r->d2f, r->step};
+    while (*iterations < max_iterations) {
+        mpfr_prec_t wp = (mpfr_prec_t)(3 * bits + 32);
+        if (wp < 64) wp = 64;
+        if (wp > full) wp = full;
+        for (size_t i = 0; i < sizeof(regs) / sizeof(regs[0]); i++) mpfr_set_prec(regs[i], wp);
+        mpfr_set_prec(r->tmp, wp);
+
+        /* Halley: step = 2 f f' / (2 f'^2 - f f''), f = R(x) - n */
+        if (z5d_riemann_gram(r, r->f, r->df, r->d2f, rop) != 0) return -1;
+        mpfr_sub(r->f, r->f, n, MPFR_RNDN);
+        mpfr_mul(r->step, r->f, r->df, MPFR_RNDN);
+        mpfr_mul_2ui(r->step, r->step, 1, MPFR_RNDN);
+        mpfr_sqr(r->tmp, r->df, MPFR_RNDN);
+        mpfr_mul_2ui(r->tmp, r->tmp, 1, MPFR_RNDN);
+        mpfr_mul(r->d2f, r->d2f, r->f, MPFR_RNDN);
+        mpfr_sub(r->tmp, r->tmp, r->d2f, MPFR_RNDN);
+        mpfr_div(r->step, r->step, r->tmp, MPFR_RNDN);
+        mpfr_sub(rop, rop, r->step, MPFR_RNDN);
+        (*iterations)++;
+
+        /* Bits the step leaves correct; each step about triples them */
+        long step_bits = mpfr_zero_p(r->step)
+                             ? (long)wp
+                             : (long)(mpfr_get_exp(rop) - mpfr_get_exp(r->step));
+        bits = 3 * step_bits - 2;
+        if (bits > (long)wp - 8) bits = (long)wp - 8;
+        if (wp < full) continue;
+
+        if (mpfr_zero_p(r->step) || mpfr_get_exp(r->step) < GRAM_SETTLED_EXP ||
+            step_bits >= (long)full - 8) {
+            return 1;
+        }
+        mpfr_abs(r->step, r->step, MPFR_RNDN);
+        mpfr_mul(r->tmp, rop, tolerance, MPFR_RNDN);
+        if (mpfr_cmp(r->step, r->tmp) <= 0) return 1;
+    }
+    return 0;
+}
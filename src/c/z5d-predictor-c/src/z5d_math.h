@@ -17,11 +17,23 @@
  * Compute logarithmic integral li(x) using MPFR
  * 
  * @param rop Output value
- * @param x Input value
+ * @param x Input value (>= 0)
  * @param prec MPFR precision
  */
 void z5d_li(mpfr_t rop, const mpfr_t x, mpfr_prec_t prec);
 
+/**
+ * li(x) from L = ln x, the method picked by the size of L: the power series
+ * for L < 16, the asymptotic expansion once its smallest term is below the
+ * last bit (L above about prec * ln 2), Ramanujan's series between, and
+ * mpfr_eint for x <= 1. Terms are summed until they fall below prec bits.
+ *
+ * @param rop Output value
+ * @param ln_x ln x
+ * @param prec MPFR precision
+ */
+void z5d_li_log(mpfr_t rop, const mpfr_t ln_x, mpfr_prec_t prec);
+
 /**
  * Compute Dusart initializer for nth prime
  * x0 = n * (ln n + ln ln n - 1 + (ln ln n - 2)/ln n)
@@ -45,4 +57,70 @@ void z5d_dusart_initializer(mpfr_t rop, const mpfr_t n, mpfr_prec_t prec);
  */
 int z5d_newton_halley_step(mpfr_t rop, const mpfr_t x, const mpfr_t n, int K, mpfr_prec_t prec);
 
+/**
+ * Riemann R inversion state: 1/zeta(k+1) for the Gram series, grown on
+ * demand, and scratch registers. Kept per context (ctx->riemann).
+ */
+typedef struct {
+    mpfr_prec_t prec;        /* Precision of the table entries */
+    size_t count, cap;       /* inv_zeta[k - 1] = 1/zeta(k + 1), k = 1..count */
+    mpfr_t* inv_zeta;
+    size_t limit;            /* Past k = limit, 1/zeta(k+1) rounds to 1 at prec */
+    mpfr_t ln_x, power, term, a, b, c, f, df, d2f, step, tmp;
+} z5d_riemann_t;
+
+/**
+ * Initialize the inversion state (empty table)
+ *
+ * @param r State to initialize
+ * @param prec Table precision
+ */
+void z5d_riemann_init(z5d_riemann_t* r, mpfr_prec_t prec);
+
+/**
+ * Release the inversion state
+ *
+ * @param r State
+ */
+void z5d_riemann_clear(z5d_riemann_t* r);
+
+/**
+ * Raise the table precision to at least prec; a rise drops the table, a
+ * lower prec keeps the more precise entries
+ *
+ * @param r State
+ * @param prec Table precision
+ */
+void z5d_riemann_set_prec(z5d_riemann_t* r, mpfr_prec_t prec);
+
+/**
+ * R(x), R'(x) and R''(x) from the Gram series
+ * R(x) = 1 + sum_{k>=1} (ln x)^k / (k * k! * zeta(k+1)),
+ * sharing one ln x and the powers across the three sums
+ *
+ * @param r State (table at least as precise as the outputs)
+ * @param R Output R(x)
+ * @param dR Output R'(x), or NULL
+ * @param d2R Output R''(x), or NULL
+ * @param x Argument (> 1)
+ * @return 0 on success, -1 on allocation failure
+ */
+int z5d_riemann_gram(z5d_riemann_t* r, mpfr_t R, mpfr_t dR, mpfr_t d2R, const mpfr_t x);
+
+/**
+ * Solve R(x) = n by Halley's method from z5d_dusart_initializer. Early steps
+ * run at reduced precision (each step about triples the correct bits); the
+ * last runs at the precision of rop.
+ *
+ * @param r State (its table precision is raised to that of rop)
+ * @param rop Output x
+ * @param n Target (> 0)
+ * @param max_iterations Step limit
+ * @param tolerance Stop once |step| <= tolerance * x (or below 2^-16)
+ * @param iterations Output steps taken
+ * @return 1 if converged, 0 if the step limit was reached, -1 on allocation failure
+ */
+int z5d_riemann_inverse(z5d_riemann_t* r, mpfr_t rop, const mpfr_t n, int max_iterations,
+                        const mpfr_t tolerance, int* iterations);
+
 #endif /* Z5D_MATH_H */
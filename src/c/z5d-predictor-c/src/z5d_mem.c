@@ -0,0 +1,203 @@
+/**
+ * Z5D Allocation Hooks - Counted and Thread-Cached GMP/MPFR Storage
+ * =================================================================
+ *
+ * GMP and MPFR take all limb storage through mp_set_memory_functions,
+ * MPFR's scratch registers included. This module installs a hook there in
+ * one of two modes:
+ *
+ *   Z5D_MEM_COUNT  forwards to the functions installed before it and counts
+ *                  the calls per thread;
+ *   Z5D_MEM_POOL   also keeps per-thread free lists of blocks in power-of-
+ *                  two size classes, so steady-state predictions recycle
+ *                  blocks and never reach malloc or its locks.
+ *
+ * GMP passes the size of a block to free and realloc, so the pool needs no
+ * block header: the class is recomputed from that size, and every block is
+ * a plain malloc of its class size. A realloc within one class returns the
+ * block itself. A thread's lists hold at most Z5D_MEM_CACHE_BLOCKS blocks
+ * per class and are returned to malloc when the thread exits. A block may
+ * be freed on another thread than the one that allocated it.
+ *
+ * @file z5d_mem.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define MEM_MIN_CLASS_SHIFT 4   /* 16 bytes */
+#define MEM_CLASSES 13          /* 16 B .. Z5D_MEM_MAX_CLASS_BYTES = 64 KiB */
+
+typedef struct mem_block {
+    struct mem_block* next;
+} mem_block_t;
+
+typedef struct {
+    z5d_mem_stats_t stats;
+    mem_block_t* free_list[MEM_CLASSES];
+    unsigned int free_count[MEM_CLASSES];
+    int registered;              /* Exit destructor set for this thread */
+} mem_thread_t;
+
+static __thread mem_thread_t tl_mem;
+
+static int g_mode = -1;          /* z5d_mem_mode_t once installed */
+static void* (*g_alloc)(size_t);
+static void* (*g_realloc)(void*, size_t, size_t);
+static void (*g_free)(void*, size_t);
+static pthread_mutex_t g_install_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t g_exit_key;
+
+static void out_of_memory(size_t size) {
+    fprintf(stderr, "z5d: cannot allocate %zu bytes\n", size);
+    abort();
+}
+
+static void* system_alloc(size_t size) {
+    tl_mem.stats.mallocs++;
+    void* p = malloc(size);
+    if (!p) out_of_memory(size);
+    return p;
+}
+
+/* Class of a block of size bytes, or -1 above the largest class */
+static int size_class(size_t size) {
+    if (size > Z5D_MEM_MAX_CLASS_BYTES) return -1;
+    int c = 0;
+    while (((size_t)1 << (c + MEM_MIN_CLASS_SHIFT)) < size) c++;
+    return c;
+}
+
+/* --------- Z5D_MEM_COUNT --------- */
+
+static void* count_alloc(size_t size) {
+    tl_mem.stats.allocs++;
+    tl_mem.stats.mallocs++;
+    return g_alloc(size);
+}
+
+static void* count_realloc(void* p, size_t old_size, size_t new_size) {
+    tl_mem.stats.allocs++;
+    tl_mem.stats.mallocs++;
+    return g_realloc(p, old_size, new_size);
+}
+
+static void count_free(void* p, size_t size) {
+    tl_mem.stats.frees++;
+    g_free(p, size);
+}
+
+/* --------- Z5D_MEM_POOL --------- */
+
+static void thread_exit(void* arg) {
+    (void)arg;
+    z5d_mem_thread_trim();
+    /* Other destructors (the default context's among them) may free after
+       this one; the next give re-arms the key and POSIX runs another pass */
+    tl_mem.registered = 0;
+}
+
+static void* take(size_t size) {
+    int c = size_class(size);
+    if (c < 0) return system_alloc(size);
+    mem_block_t* b = tl_mem.free_list[c];
+    if (!b) return system_alloc((size_t)1 << (c + MEM_MIN_CLASS_SHIFT));
+    tl_mem.free_list[c] = b->next;
+    tl_mem.free_count[c]--;
+    tl_mem.stats.cached_bytes -= (size_t)1 << (c + MEM_MIN_CLASS_SHIFT);
+    return b;
+}
+
+static void give(void* p, size_t size) {
+    int c = size_class(size);
+    if (c < 0 || tl_mem.free_count[c] >= Z5D_MEM_CACHE_BLOCKS) {
+        free(p);
+        return;
+    }
+    if (!tl_mem.registered) {
+        /* The destructor needs a non-NULL value to run */
+        pthread_setspecific(g_exit_key, &tl_mem);
+        tl_mem.registered = 1;
+    }
+    mem_block_t* b = (mem_block_t*)p;
+    b->next = tl_mem.free_list[c];
+    tl_mem.free_list[c] = b;
+    tl_mem.free_count[c]++;
+    tl_mem.stats.cached_bytes += (size_t)1 << (c + MEM_MIN_CLASS_SHIFT);
+}
+
+static void* pool_alloc(size_t size) {
+    tl_mem.stats.allocs++;
+    return take(size);
+}
+
+static void* pool_realloc(void* p, size_t old_size, size_t new_size) {
+    tl_mem.stats.allocs++;
+    int old_c = size_class(old_size), new_c = size_class(new_size);
+    if (old_c >= 0 && old_c == new_c) return p;
+    if (old_c < 0 && new_c < 0) {
+        tl_mem.stats.mallocs++;
+        void* q = realloc(p, new_size);
+        if (!q) out_of_memory(new_size);
+        return q;
+    }
+    void* q = take(new_size);
+    memcpy(q, p, old_size < new_size ? old_size : new_size);
+    give(p, old_size);
+    return q;
+}
+
+static void pool_free(void* p, size_t size) {
+    tl_mem.stats.frees++;
+    give(p, size);
+}
+
+/* --------- API --------- */
+
+int z5d_mem_install(z5d_mem_mode_t mode) {
+    if (mode != Z5D_MEM_COUNT && mode != Z5D_MEM_POOL) return -1;
+    pthread_mutex_lock(&g_install_lock);
+    int ret = 0;
+    int cur = __atomic_load_n(&g_mode, __ATOMIC_ACQUIRE);
+    if (cur >= 0) {
+        ret = (cur == (int)mode) ? 0 : -1;
+    } else if (mode == Z5D_MEM_POOL) {
+        if (pthread_key_create(&g_exit_key, thread_exit) != 0) {
+            ret = -1;
+        } else {
+            mp_set_memory_functions(pool_alloc, pool_realloc, pool_free);
+        }
+    } else {
+        mp_get_memory_functions(&g_alloc, &g_realloc, &g_free);
+        mp_set_memory_functions(count_alloc, count_realloc, count_free);
+    }
+    if (cur < 0 && ret == 0) __atomic_store_n(&g_mode, (int)mode, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_install_lock);
+    return ret;
+}
+
+int z5d_mem_mode(void) {
+    return __atomic_load_n(&g_mode, __ATOMIC_ACQUIRE);
+}
+
+void z5d_mem_thread_stats(z5d_mem_stats_t* stats) {
+    *stats = tl_mem.stats;
+}
+
+void z5d_mem_thread_trim(void) {
+    for (int c = 0; c < MEM_CLASSES; c++) {
+        mem_block_t* b = tl_mem.free_list[c];
+        while (b) {
+            mem_block_t* next = b->next;
+            free(b);
+            b = next;
+        }
+        tl_mem.free_list[c] = NULL;
+        tl_mem.free_count[c] = 0;
+    }
+    tl_mem.stats.cached_bytes = 0;
+}
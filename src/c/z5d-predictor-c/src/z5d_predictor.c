@@ -7,23 +7,34 @@
  * and adds a deterministic refinement layer that *always* returns a
  * probable prime (with a strict final GMP check).
  *
+ * All mutable state lives in a z5d_ctx_t (precision, cached constants,
+ * scratch registers, stats). The context-free entry points run on a
+ * per-thread default context, so the library keeps no process-wide state
+ * and never touches MPFR's global default precision.
+ *
  * The refinement logic is adapted from unified-framework/src/c/z5d_prime_gen.c.
  */
 
 #include "../include/z5d_predictor.h"
 #include "z5d_math.h"
+#include "z5d_fast.h"
+#include "z5d_sieve.h"
+#include "z5d_exact.h"
+#include "z5d_async.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
+#include <pthread.h>
 
-/* ---- Constants (synchronized with unified-framework z_framework_params.h) --- */
-#define Z5D_C_CAL_STR        "-0.00016667"
-#define Z5D_KAPPA_STAR_STR   "0.06500000"
-
-/* Static flag for initialization */
-static int z5d_initialized = 0;
+/* ---- Built-in calibration ----
+   Z5D_DEFAULT_C_CAL and Z5D_DEFAULT_KAPPA_STAR as reduced fractions, for the
+   cheap "is this the default" test of the fast tier and the cache */
+#define Z5D_C_CAL_NUM        (-16667L)
+#define Z5D_C_CAL_DEN        100000000UL
+#define Z5D_KAPPA_STAR_NUM   13L
+#define Z5D_KAPPA_STAR_DEN   200UL
 
 static double now_ms(void) {
     struct timeval tv;
@@ -31,18 +42,97 @@ static double now_ms(void) {
     return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
 }
 
-void z5d_init(void) {
-    if (!z5d_initialized) {
-        mpfr_set_default_prec(Z5D_DEFAULT_PRECISION);
-        z5d_initialized = 1;
+/* ---- Opt-in per-call stage stats (-DZ5D_ENABLE_STATS) ----
+   With the flag off Z5D_STATS is 0 and every block guarded by it is dead
+   code, so the hot path reads no clocks and bumps no per-call counters. */
+#ifdef Z5D_ENABLE_STATS
+#define Z5D_STATS 1
+static double stat_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+#else
+#define Z5D_STATS 0
+static inline double stat_now(void) { return 0.0; }
+#endif
+
+int z5d_stats_enabled(void) {
+    return Z5D_STATS;
+}
+
+static void stats_begin(z5d_ctx_t* ctx) {
+    if (Z5D_STATS) memset(&ctx->last_call, 0, sizeof(ctx->last_call));
+    if (z5d_mem_mode() >= 0) z5d_mem_thread_stats(&ctx->mem_mark);
+}
+
+static void stats_predict(z5d_ctx_t* ctx, double ns, mpfr_prec_t prec) {
+    if (!Z5D_STATS) return;
+    ctx->last_call.predict_ns += ns;
+    if (prec > ctx->last_call.precision) ctx->last_call.precision = prec;
+}
+
+/* Fold the last call into the context sums */
+static void stats_commit(z5d_ctx_t* ctx) {
+    if (z5d_mem_mode() >= 0) {
+        /* Allocation counts are cheap, so they are kept without Z5D_STATS */
+        z5d_mem_stats_t now;
+        z5d_mem_thread_stats(&now);
+        ctx->stats.gmp_allocs += now.allocs - ctx->mem_mark.allocs;
+        ctx->stats.gmp_mallocs += now.mallocs - ctx->mem_mark.mallocs;
     }
+    if (!Z5D_STATS) return;
+    const z5d_call_stats_t* c = &ctx->last_call;
+    z5d_ctx_stats_t* s = &ctx->stats;
+    s->predict_ns += c->predict_ns;
+    s->round_ns += c->round_ns;
+    s->refine_ns += c->refine_ns;
+    s->distance += c->distance;
+    s->candidates += c->candidates;
+    s->sieve_survivors += c->sieve_survivors;
+    if (c->precision > s->max_precision) s->max_precision = c->precision;
+}
+
+/* ---- Per-thread default context behind the context-free API ---- */
+static pthread_key_t default_ctx_key;
+static pthread_once_t default_ctx_once = PTHREAD_ONCE_INIT;
+
+static void default_ctx_destroy(void* p) {
+    z5d_ctx_t* ctx = (z5d_ctx_t*)p;
+    z5d_ctx_clear(ctx);
+    free(ctx);
+}
+
+static void default_ctx_key_create(void) {
+    pthread_key_create(&default_ctx_key, default_ctx_destroy);
+}
+
+z5d_ctx_t* z5d_default_ctx(void) {
+    pthread_once(&default_ctx_once, default_ctx_key_create);
+    z5d_ctx_t* ctx = (z5d_ctx_t*)pthread_getspecific(default_ctx_key);
+    if (!ctx) {
+        ctx = (z5d_ctx_t*)malloc(sizeof(*ctx));
+        if (!ctx) return NULL;
+        z5d_ctx_init(ctx, NULL);
+        pthread_setspecific(default_ctx_key, ctx);
+    }
+    return ctx;
+}
+
+void z5d_init(void) {
+    (void)z5d_default_ctx();
 }
 
 void z5d_cleanup(void) {
-    if (z5d_initialized) {
-        mpfr_free_cache();
-        z5d_initialized = 0;
+    pthread_once(&default_ctx_once, default_ctx_key_create);
+    z5d_ctx_t* ctx = (z5d_ctx_t*)pthread_getspecific(default_ctx_key);
+    if (ctx) {
+        pthread_setspecific(default_ctx_key, NULL);
+        default_ctx_destroy(ctx);
     }
+    /* Only this thread's constant caches; other threads may still be predicting */
+    mpfr_free_cache2(MPFR_FREE_LOCAL_CACHE);
+    z5d_mem_thread_trim();
 }
 
 const char* z5d_get_version(void) {
@@ -51,14 +141,87 @@ const char* z5d_get_version(void) {
 
 void z5d_config_init(z5d_config_t* config) {
     config->precision = Z5D_DEFAULT_PRECISION;
+    config->engine = Z5D_ENGINE_CLOSED_FORM;
     config->K = Z5D_DEFAULT_K;
-    config->max_iterations = 1; /* unused in closed-form path */
+    config->max_iterations = Z5D_DEFAULT_MAX_ITERATIONS;
     mpfr_init2(config->tolerance, Z5D_DEFAULT_PRECISION);
-    mpfr_set_d(config->tolerance, 1e-50, MPFR_RNDN);
+    mpfr_set_ui(config->tolerance, 0, MPFR_RNDN);
+    config->sieve_limit = Z5D_DEFAULT_SIEVE_LIMIT;
+    config->threads = 1;
+    config->anchors = NULL;
+    config->cache = NULL;
+    mpq_init(config->c_cal);
+    mpq_init(config->kappa_star);
+    mpq_set_si(config->c_cal, Z5D_C_CAL_NUM, Z5D_C_CAL_DEN);
+    mpq_set_si(config->kappa_star, Z5D_KAPPA_STAR_NUM, Z5D_KAPPA_STAR_DEN);
 }
 
 void z5d_config_clear(z5d_config_t* config) {
     mpfr_clear(config->tolerance);
+    mpq_clear(config->c_cal);
+    mpq_clear(config->kappa_star);
+}
+
+/* Exact value of a decimal string: [+-]digits[.digits][(e|E)[+-]digits] */
+static int parse_decimal(mpq_t q, const char* s) {
+    const char* p = s;
+    int neg = (*p == '-');
+    if (*p == '-' || *p == '+') p++;
+    char digits[128];
+    size_t nd = 0;
+    long frac = 0;
+    int seen_dot = 0;
+    for (; *p && *p != 'e' && *p != 'E'; p++) {
+        if (*p == '.' && !seen_dot) {
+            seen_dot = 1;
+        } else if (*p >= '0' && *p <= '9' && nd + 1 < sizeof(digits)) {
+            digits[nd++] = *p;
+            frac += seen_dot;
+        } else {
+            return -1;
+        }
+    }
+    if (nd == 0) return -1;
+    digits[nd] = '\0';
+    long exp10 = 0;
+    if (*p) {
+        char* end;
+        exp10 = strtol(p + 1, &end, 10);
+        if (end == p + 1 || *end || exp10 < -4096 || exp10 > 4096) return -1;
+    }
+    exp10 -= frac;
+
+    mpz_t num, pow10;
+    mpz_inits(num, pow10, NULL);
+    mpz_set_str(num, digits, 10);
+    if (neg) mpz_neg(num, num);
+    mpz_ui_pow_ui(pow10, 10, (unsigned long)(exp10 < 0 ? -exp10 : exp10));
+    if (exp10 >= 0) {
+        mpz_mul(num, num, pow10);
+        mpz_set_ui(pow10, 1);
+    }
+    mpq_set_num(q, num);
+    mpq_set_den(q, pow10);
+    mpq_canonicalize(q);
+    mpz_clears(num, pow10, NULL);
+    return 0;
+}
+
+int z5d_config_set_calibration(z5d_config_t* config, const char* c, const char* kappa_star) {
+    mpq_t cq, kq;
+    mpq_inits(cq, kq, NULL);
+    int ok = (!c || parse_decimal(cq, c) == 0) && (!kappa_star || parse_decimal(kq, kappa_star) == 0);
+    if (ok) {
+        if (c) mpq_set(config->c_cal, cq);
+        if (kappa_star) mpq_set(config->kappa_star, kq);
+    }
+    mpq_clears(cq, kq, NULL);
+    return ok ? 0 : -1;
+}
+
+int z5d_config_default_calibration(const z5d_config_t* config) {
+    return mpq_cmp_si(config->c_cal, Z5D_C_CAL_NUM, Z5D_C_CAL_DEN) == 0 &&
+           mpq_cmp_si(config->kappa_star, Z5D_KAPPA_STAR_NUM, Z5D_KAPPA_STAR_DEN) == 0;
 }
 
 void z5d_result_init(z5d_result_t* result, mpfr_prec_t precision) {
@@ -67,6 +230,7 @@ void z5d_result_init(z5d_result_t* result, mpfr_prec_t precision) {
     result->elapsed_ms = 0.0;
     result->iterations = 0;
     result->converged = 0;
+    result->precision_used = 0;
 }
 
 void z5d_result_clear(z5d_result_t* result) {
@@ -75,187 +239,936 @@ void z5d_result_clear(z5d_result_t* result) {
 }
 
 /* --------- Calibrated Z5D predictor (MPFR) --------- */
-static void z5d_predict_mpfr(mpfr_t res, const mpfr_t k_mp, mpfr_prec_t prec) {
-    mpfr_t ln_k, ln_ln_k, pnt, ln_pnt, d_term, e_term, tmp, correction, c_cal, k_star, e_fourth;
-    mpfr_inits2(prec, ln_k, ln_ln_k, pnt, ln_pnt, d_term, e_term, tmp, correction, c_cal, k_star, e_fourth, (mpfr_ptr)0);
-
-    /* Initialize constants with full precision from strings/calculation */
-    mpfr_set_str(c_cal, Z5D_C_CAL_STR, 10, MPFR_RNDN);
-    mpfr_set_str(k_star, Z5D_KAPPA_STAR_STR, 10, MPFR_RNDN);
-    
+
+/* The workspace (z5d_workspace_t, embedded in every context) holds the
+   scratch registers plus the constants of the closed form at one working
+   precision. Setting it up (11 inits, exp(4), -1/3) costs more than the
+   log/pow work itself at small and mid n, so it is kept alive and only
+   re-prepared when the precision or the calibration changes. */
+static void z5d_workspace_load_constants(z5d_workspace_t* ws) {
+    /* Calibration rounded once from its exact value */
+    mpfr_set_q(ws->c_cal, ws->c_q, MPFR_RNDN);
+    mpfr_set_q(ws->k_star, ws->k_q, MPFR_RNDN);
+
     /* Calculate e^4 exactly in MPFR precision */
-    mpfr_set_ui(tmp, 4, MPFR_RNDN);
-    mpfr_exp(e_fourth, tmp, MPFR_RNDN);
+    mpfr_set_ui(ws->tmp, 4, MPFR_RNDN);
+    mpfr_exp(ws->e_fourth, ws->tmp, MPFR_RNDN);
+
+    /* Calculate exact -1/3 */
+    mpfr_set_si(ws->neg_third, -1, MPFR_RNDN);
+    mpfr_div_ui(ws->neg_third, ws->neg_third, 3, MPFR_RNDN);
+}
+
+static void z5d_workspace_init(z5d_workspace_t* ws, mpfr_prec_t prec) {
+    ws->prec = prec;
+    mpfr_inits2(prec, ws->ln_k, ws->ln_ln_k, ws->pnt, ws->ln_pnt, ws->d_term, ws->e_term,
+                ws->tmp, ws->correction, ws->c_cal, ws->k_star, ws->e_fourth, ws->neg_third,
+                ws->k_mp, ws->pred, (mpfr_ptr)0);
+    mpq_init(ws->c_q);
+    mpq_init(ws->k_q);
+    mpq_set_si(ws->c_q, Z5D_C_CAL_NUM, Z5D_C_CAL_DEN);
+    mpq_set_si(ws->k_q, Z5D_KAPPA_STAR_NUM, Z5D_KAPPA_STAR_DEN);
+    z5d_workspace_load_constants(ws);
+}
+
+/* Re-prepare the workspace for a new precision; a no-op if unchanged. */
+static void z5d_workspace_set_prec(z5d_workspace_t* ws, mpfr_prec_t prec) {
+    if (ws->prec == prec) return;
+    ws->prec = prec;
+    mpfr_ptr regs[] = {ws->ln_k, ws->ln_ln_k, ws->pnt, ws->ln_pnt, ws->d_term, ws->e_term,
+                       ws->tmp, ws->correction, ws->c_cal, ws->k_star, ws->e_fourth,
+                       ws->neg_third, ws->k_mp, ws->pred};
+    for (size_t i = 0; i < sizeof(regs)/sizeof(regs[0]); ++i) mpfr_set_prec(regs[i], prec);
+    z5d_workspace_load_constants(ws);
+}
 
-    mpfr_log(ln_k, k_mp, MPFR_RNDN);
-    mpfr_log(ln_ln_k, ln_k, MPFR_RNDN);
+/* Load the calibration of config into the workspace; a no-op if unchanged. */
+static void z5d_workspace_set_cal(z5d_workspace_t* ws, const z5d_config_t* config) {
+    if (mpq_equal(ws->c_q, config->c_cal) && mpq_equal(ws->k_q, config->kappa_star)) return;
+    mpq_set(ws->c_q, config->c_cal);
+    mpq_set(ws->k_q, config->kappa_star);
+    mpfr_set_q(ws->c_cal, ws->c_q, MPFR_RNDN);
+    mpfr_set_q(ws->k_star, ws->k_q, MPFR_RNDN);
+}
+
+static void z5d_workspace_clear(z5d_workspace_t* ws) {
+    mpfr_clears(ws->ln_k, ws->ln_ln_k, ws->pnt, ws->ln_pnt, ws->d_term, ws->e_term,
+                ws->tmp, ws->correction, ws->c_cal, ws->k_star, ws->e_fourth, ws->neg_third,
+                ws->k_mp, ws->pred, (mpfr_ptr)0);
+    mpq_clear(ws->c_q);
+    mpq_clear(ws->k_q);
+}
+
+/* Unrounded closed form (clamped to pnt if negative). res may be at any
+   precision; all intermediates run at ws->prec. */
+static void z5d_closed_form_mpfr(z5d_workspace_t* ws, mpfr_t res, const mpfr_t k_mp) {
+    mpfr_log(ws->ln_k, k_mp, MPFR_RNDN);
+    mpfr_log(ws->ln_ln_k, ws->ln_k, MPFR_RNDN);
 
     /* pnt = k*(ln k + ln ln k - 1 + (ln ln k - 2)/ln k) */
-    mpfr_add(tmp, ln_k, ln_ln_k, MPFR_RNDN);
-    mpfr_sub_ui(tmp, tmp, 1, MPFR_RNDN);
-    mpfr_sub_ui(correction, ln_ln_k, 2, MPFR_RNDN);
-    mpfr_div(correction, correction, ln_k, MPFR_RNDN);
-    mpfr_add(tmp, tmp, correction, MPFR_RNDN);
-    mpfr_mul(pnt, k_mp, tmp, MPFR_RNDN);
+    mpfr_add(ws->tmp, ws->ln_k, ws->ln_ln_k, MPFR_RNDN);
+    mpfr_sub_ui(ws->tmp, ws->tmp, 1, MPFR_RNDN);
+    mpfr_sub_ui(ws->correction, ws->ln_ln_k, 2, MPFR_RNDN);
+    mpfr_div(ws->correction, ws->correction, ws->ln_k, MPFR_RNDN);
+    mpfr_add(ws->tmp, ws->tmp, ws->correction, MPFR_RNDN);
+    mpfr_mul(ws->pnt, k_mp, ws->tmp, MPFR_RNDN);
 
     /* d_term = ((ln pnt / e^4)^2) * pnt * c */
-    mpfr_set_ui(d_term, 0, MPFR_RNDN);
-    mpfr_log(ln_pnt, pnt, MPFR_RNDN);
-    if (mpfr_cmp_ui(ln_pnt, 0) > 0) {
-        mpfr_div(tmp, ln_pnt, e_fourth, MPFR_RNDN);
-        mpfr_mul(d_term, tmp, tmp, MPFR_RNDN);
-        mpfr_mul(d_term, d_term, pnt, MPFR_RNDN);
-        mpfr_mul(d_term, d_term, c_cal, MPFR_RNDN);
+    mpfr_set_ui(ws->d_term, 0, MPFR_RNDN);
+    mpfr_log(ws->ln_pnt, ws->pnt, MPFR_RNDN);
+    if (mpfr_cmp_ui(ws->ln_pnt, 0) > 0) {
+        mpfr_div(ws->tmp, ws->ln_pnt, ws->e_fourth, MPFR_RNDN);
+        mpfr_mul(ws->d_term, ws->tmp, ws->tmp, MPFR_RNDN);
+        mpfr_mul(ws->d_term, ws->d_term, ws->pnt, MPFR_RNDN);
+        mpfr_mul(ws->d_term, ws->d_term, ws->c_cal, MPFR_RNDN);
     }
 
     /* e_term = pnt^(-1/3) * pnt * k_star */
-    mpfr_set_ui(e_term, 0, MPFR_RNDN);
-    if (mpfr_cmp_ui(pnt, 0) > 0) {
-        mpfr_set_si(tmp, -1, MPFR_RNDN);
-        mpfr_div_ui(tmp, tmp, 3, MPFR_RNDN); /* Calculate exact -1/3 */
-        mpfr_pow(e_term, pnt, tmp, MPFR_RNDN);
-        mpfr_mul(e_term, e_term, pnt, MPFR_RNDN);
-        mpfr_mul(e_term, e_term, k_star, MPFR_RNDN);
+    mpfr_set_ui(ws->e_term, 0, MPFR_RNDN);
+    if (mpfr_cmp_ui(ws->pnt, 0) > 0) {
+        mpfr_pow(ws->e_term, ws->pnt, ws->neg_third, MPFR_RNDN);
+        mpfr_mul(ws->e_term, ws->e_term, ws->pnt, MPFR_RNDN);
+        mpfr_mul(ws->e_term, ws->e_term, ws->k_star, MPFR_RNDN);
     }
 
-    mpfr_add(res, pnt, d_term, MPFR_RNDN);
-    mpfr_add(res, res, e_term, MPFR_RNDN);
-    if (mpfr_sgn(res) < 0) mpfr_set(res, pnt, MPFR_RNDN); /* clamp */
-    mpfr_round(res, res);
+    mpfr_add(res, ws->pnt, ws->d_term, MPFR_RNDN);
+    mpfr_add(res, res, ws->e_term, MPFR_RNDN);
+    if (mpfr_sgn(res) < 0) mpfr_set(res, ws->pnt, MPFR_RNDN); /* clamp */
+}
 
-    mpfr_clears(ln_k, ln_ln_k, pnt, ln_pnt, d_term, e_term, tmp, correction, c_cal, k_star, e_fourth, (mpfr_ptr)0);
+/* Riemann engine state of ctx, created on first use (NULL if out of memory) */
+static z5d_riemann_t* riemann_state(z5d_ctx_t* ctx) {
+    if (!ctx->riemann) {
+        z5d_riemann_t* r = malloc(sizeof(*r));
+        if (!r) return NULL;
+        z5d_riemann_init(r, ctx->ws.prec);
+        ctx->riemann = r;
+    }
+    return (z5d_riemann_t*)ctx->riemann;
 }
 
-/* --------- Refinement: forward probable prime (GMP) --------- */
-static void refine_to_prime(const mpfr_t x0, const mpfr_t k_mp, mpz_t out_prime) {
-    (void)k_mp; /* currently unused */
+/* Unrounded estimate of p_n, n in ws->k_mp, by the engine of config into res
+   (any precision); intermediates run at ws->prec. The Riemann engine falls
+   back to the closed form if its state cannot be allocated. Returns the
+   iterations taken and sets *converged. */
+static int engine_mpfr(z5d_ctx_t* ctx, const z5d_config_t* config, mpfr_t res,
+                       int* converged) {
+    z5d_workspace_t* ws = &ctx->ws;
+    *converged = 1;
+    if (config->engine == Z5D_ENGINE_RIEMANN_R) {
+        z5d_riemann_t* r = riemann_state(ctx);
+        int steps = 0;
+        int rc = r ? z5d_riemann_inverse(r, ws->tmp, ws->k_mp, config->max_iterations,
+                                         config->tolerance, &steps)
+                   : -1;
+        ctx->stats.halley_steps += (uint64_t)steps;
+        if (rc >= 0) {
+            *converged = rc;
+            mpfr_set(res, ws->tmp, MPFR_RNDN);
+            return steps;
+        }
+    }
+    z5d_workspace_set_cal(ws, config);
+    z5d_closed_form_mpfr(ws, res, ws->k_mp);
+    return 1;
+}
 
-    mpz_t candidate;
-    mpz_init(candidate);
-    mpfr_get_z(candidate, x0, MPFR_RNDN);
-    if (mpz_cmp_ui(candidate, 2) < 0) mpz_set_ui(candidate, 2);
+/* The hardware tier evaluates the closed form with the built-in calibration only */
+static int fast_tier_ok(const z5d_config_t* config) {
+    return config->engine == Z5D_ENGINE_CLOSED_FORM &&
+           config->precision >= Z5D_FAST_MIN_PRECISION && z5d_config_default_calibration(config);
+}
+
+/* --------- Refinement: forward probable prime (GMP) --------- */
+/* out_prime and start may alias. Returns 1, with out_prime untouched, if
+   ctx->sieve.stop ended the search; searches below Z5D_SIEVE_MIN_BITS are
+   too short to need the check and always finish. */
+static int refine_to_prime(z5d_ctx_t* ctx, mpz_t out_prime, const mpz_t start) {
+    size_t bits = mpz_sizeinbase(start, 2);
+    if (bits <= 64 && mpz_sgn(start) >= 0) {
+        /* Word-sized search; 0 only past the largest 64-bit prime */
+        uint64_t p = z5d_next_prime_u64(mpz_get_ui(start), &ctx->stats.prp_tests);
+        if (p) {
+            mpz_set_ui(out_prime, p);
+            return 0;
+        }
+    }
+    if (ctx->config.threads > 1 && bits >= Z5D_SIEVE_PARALLEL_MIN_BITS) {
+        ctx->stats.prp_tests += z5d_sieve_next_prime_parallel(&ctx->sieve, out_prime, start,
+                                                              ctx->config.threads);
+        return ctx->sieve.stopped;
+    }
+    /* mpz_nextprime cannot be interrupted, so a stoppable search takes the
+       sieve even with the presieve off (depth 0: every odd candidate) */
+    if ((ctx->sieve.limit >= 3 || ctx->sieve.stop) && bits >= Z5D_SIEVE_MIN_BITS) {
+        ctx->stats.prp_tests += z5d_sieve_next_prime(&ctx->sieve, out_prime, start);
+        return ctx->sieve.stopped;
+    }
 
     /* GMP's nextprime returns the next prime strictly greater than n,
-       so step back one to include n itself if already prime. */
-    mpz_sub_ui(candidate, candidate, 1);
-    mpz_nextprime(out_prime, candidate);
-    mpz_clear(candidate);
+       so step back one to include n itself if already prime. In place,
+       so the hot path allocates no temporary. */
+    if (mpz_cmp_ui(start, 2) < 0) {
+        mpz_set_ui(out_prime, 1);
+    } else {
+        mpz_sub_ui(out_prime, start, 1);
+    }
+    mpz_nextprime(out_prime, out_prime);
+    return 0;
+}
+
+/* refine_to_prime plus its stage record. out and start may alias.
+   Returns 1 if the search was stopped (nothing is recorded). */
+static int refine_stage(z5d_ctx_t* ctx, mpz_t out_prime, const mpz_t start) {
+    if (!Z5D_STATS) return refine_to_prime(ctx, out_prime, start);
+    z5d_call_stats_t* c = &ctx->last_call;
+    int parallel = ctx->config.threads > 1 &&
+                   mpz_sizeinbase(start, 2) >= Z5D_SIEVE_PARALLEL_MIN_BITS;
+    mpz_ptr from = ctx->stat_from, t = ctx->stat_tmp;
+    mpz_set(from, start);
+    uint64_t tests0 = ctx->stats.prp_tests;
+    double t0 = stat_now();
+    if (refine_to_prime(ctx, out_prime, start)) return 1;
+    c->refine_ns += stat_now() - t0;
+
+    uint64_t tests = ctx->stats.prp_tests - tests0;
+    c->prp_tests += tests;
+    mpz_sub(t, out_prime, from);
+    c->distance += mpz_get_ui(t);
+    /* Odd integers in [from, prime]: (prime - from + (from odd) + 1) / 2 */
+    if (mpz_odd_p(from)) mpz_add_ui(t, t, 1);
+    c->candidates += (mpz_get_ui(t) + 1) / 2;
+    /* Serial searches test exactly the survivors; parallel ones may test past the prime */
+    c->sieve_survivors += parallel ? z5d_sieve_count_survivors(&ctx->sieve, from, out_prime)
+                                   : tests;
+    return 0;
+}
+
+/* --------- Contexts --------- */
+void z5d_ctx_init(z5d_ctx_t* ctx, const z5d_config_t* config) {
+    z5d_config_init(&ctx->config);
+    if (config) {
+        ctx->config.precision = config->precision;
+        ctx->config.engine = config->engine;
+        ctx->config.K = config->K;
+        ctx->config.max_iterations = config->max_iterations;
+        mpfr_set_prec(ctx->config.tolerance, mpfr_get_prec(config->tolerance));
+        mpfr_set(ctx->config.tolerance, config->tolerance, MPFR_RNDN);
+        ctx->config.sieve_limit = config->sieve_limit;
+        ctx->config.threads = config->threads;
+        ctx->config.anchors = config->anchors;
+        ctx->config.cache = config->cache;
+        mpq_set(ctx->config.c_cal, config->c_cal);
+        mpq_set(ctx->config.kappa_star, config->kappa_star);
+    }
+    z5d_workspace_init(&ctx->ws, ctx->config.precision);
+    z5d_sieve_init(&ctx->sieve, ctx->config.sieve_limit);
+    mpz_init(ctx->n_tmp);
+    mpz_inits(ctx->stat_from, ctx->stat_tmp, NULL);
+    ctx->walk = NULL;
+    ctx->riemann = NULL;
+    z5d_ctx_reset_stats(ctx);
+}
+
+void z5d_ctx_clear(z5d_ctx_t* ctx) {
+    z5d_workspace_clear(&ctx->ws);
+    z5d_sieve_clear(&ctx->sieve);
+    mpz_clear(ctx->n_tmp);
+    mpz_clears(ctx->stat_from, ctx->stat_tmp, NULL);
+    if (ctx->walk) {
+        z5d_walk_clear((z5d_walk_t*)ctx->walk);
+        free(ctx->walk);
+        ctx->walk = NULL;
+    }
+    if (ctx->riemann) {
+        z5d_riemann_clear((z5d_riemann_t*)ctx->riemann);
+        free(ctx->riemann);
+        ctx->riemann = NULL;
+    }
+    z5d_config_clear(&ctx->config);
+}
+
+void z5d_ctx_reset_stats(z5d_ctx_t* ctx) {
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    memset(&ctx->last_call, 0, sizeof(ctx->last_call));
 }
 
 /* --------- Public API: MPFR prediction (approx) --------- */
-int z5d_predict_nth_prime(z5d_result_t* result, uint64_t n) {
-    z5d_config_t config;
-    z5d_config_init(&config);
-    int ret = z5d_predict_nth_prime_ex(result, n, &config);
-    z5d_config_clear(&config);
-    return ret;
+int z5d_predict_nth_prime_ctx(z5d_ctx_t* ctx, z5d_result_t* result, uint64_t n) {
+    return z5d_predict_nth_prime_ex_ctx(ctx, result, n, NULL);
 }
 
-int z5d_predict_nth_prime_ex(z5d_result_t* result, uint64_t n, const z5d_config_t* config) {
+int z5d_predict_nth_prime_ex_ctx(z5d_ctx_t* ctx, z5d_result_t* result, uint64_t n,
+                                 const z5d_config_t* config) {
     if (n == 0) return -1;
-    if (!z5d_initialized) z5d_init();
+    if (!config) config = &ctx->config;
 
     double t0 = now_ms();
+    stats_begin(ctx);
+    double ts = stat_now();
 
-    mpfr_t k_mp;
-    mpfr_init2(k_mp, config->precision);
-    mpfr_set_ui(k_mp, n, MPFR_RNDN);
+    /* Hardware-float tier; falls through to MPFR when its error bound
+       cannot settle the rounding. */
+    uint64_t fast;
+    double err_bound;
+    int iterations = 1, converged = 1;
+    if (fast_tier_ok(config) && n >= Z5D_FAST_MIN_N && n < Z5D_FAST_MAX_N) {
+        int tier = z5d_fast_predict(n, &fast, &err_bound);
+        if (tier) {
+            mpfr_set_ui(result->predicted_prime, fast, MPFR_RNDN);
+            mpfr_set_d(result->error, err_bound, MPFR_RNDU);
+            result->precision_used = tier;
+            ctx->stats.fast_hits++;
+            stats_predict(ctx, stat_now() - ts, tier);
+            goto done;
+        }
+        ctx->stats.fast_fallbacks++;
+    }
 
-    z5d_predict_mpfr(result->predicted_prime, k_mp, config->precision);
+    z5d_workspace_set_prec(&ctx->ws, config->precision);
+    mpfr_set_ui(ctx->ws.k_mp, n, MPFR_RNDN);
 
-    result->iterations = 1;
-    result->converged  = 1;
+    iterations = engine_mpfr(ctx, config, result->predicted_prime, &converged);
+    double tr = stat_now();
+    stats_predict(ctx, tr - ts, config->precision);
+    mpfr_round(result->predicted_prime, result->predicted_prime);
+    if (Z5D_STATS) ctx->last_call.round_ns += stat_now() - tr;
     mpfr_set_ui(result->error, 0, MPFR_RNDN);
+    result->precision_used = config->precision;
+
+done:
+    result->iterations = iterations;
+    result->converged  = converged;
     result->elapsed_ms = now_ms() - t0;
 
-    mpfr_clear(k_mp);
+    ctx->stats.calls++;
+    ctx->stats.predictions++;
+    ctx->stats.elapsed_ms += result->elapsed_ms;
+    stats_commit(ctx);
     return 0;
 }
 
-/* --------- Public API: exact-ish prime (mpz) via refinement --------- */
-int z5d_predict_nth_prime_mpz_big(mpz_t prime_out, const mpz_t n) {
-    if (mpz_sgn(n) <= 0) return -1;
-    if (!z5d_initialized) z5d_init();
-
-    /* Fast path table for small benchmarks (works when n fits in uint64_t) */
-    if (mpz_sizeinbase(n, 2) <= 63) {
-        uint64_t n_u64 = mpz_get_ui(n);
-        static const struct { uint64_t n; const char* p_str; } KNOWN[] = {
-            {1ULL, "2"},
-            {10ULL, "29"},
-            {100ULL, "541"},
-            {1000ULL, "7919"},
-            {10000ULL, "104729"},
-            {100000ULL, "1299709"},
-            {1000000ULL, "15485863"},
-            {10000000ULL, "179424673"},
-            {100000000ULL, "2038074743"},
-            {1000000000ULL, "22801763489"},
-            {10000000000ULL, "252097800623"},
-            {100000000000ULL, "2760727302517"},
-            {1000000000000ULL, "29996224275833"},
-            {10000000000000ULL, "323780508946331"},
-            {100000000000000ULL, "3475385758524527"},
-            {1000000000000000ULL, "37124508045065437"},
-            {10000000000000000ULL, "394906913903735329"},
-            {100000000000000000ULL, "4185296581467695669"},
-            {1000000000000000000ULL, "44211790234832169331"},
-        };
-        for (size_t i = 0; i < sizeof(KNOWN)/sizeof(KNOWN[0]); ++i) {
-            if (KNOWN[i].n == n_u64) {
-                mpz_set_str(prime_out, KNOWN[i].p_str, 10);
-                return 0;
+int z5d_predict_nth_prime(z5d_result_t* result, uint64_t n) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_nth_prime_ctx(ctx, result, n);
+}
+
+int z5d_predict_nth_prime_ex(z5d_result_t* result, uint64_t n, const z5d_config_t* config) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_nth_prime_ex_ctx(ctx, result, n, config);
+}
+
+/* --------- Public API: grids of rounded predictions --------- */
+
+/* Rounded closed form at n as z5d_predict_nth_prime_ex_ctx computes it.
+   Returns -1 if it does not fit in 64 bits. */
+static int predict_u64(z5d_ctx_t* ctx, uint64_t n, uint64_t* out) {
+    double err_bound;
+    if (fast_tier_ok(&ctx->config) && n >= Z5D_FAST_MIN_N && n < Z5D_FAST_MAX_N) {
+        int tier = z5d_fast_predict(n, out, &err_bound);
+        if (tier) {
+            ctx->stats.fast_hits++;
+            stats_predict(ctx, 0.0, tier);
+            return 0;
+        }
+        ctx->stats.fast_fallbacks++;
+    }
+    z5d_workspace_t* ws = &ctx->ws;
+    z5d_workspace_set_prec(ws, ctx->config.precision);
+    mpfr_set_ui(ws->k_mp, n, MPFR_RNDN);
+    int converged;
+    engine_mpfr(ctx, &ctx->config, ws->pred, &converged);
+    mpfr_round(ws->pred, ws->pred);
+    stats_predict(ctx, 0.0, ctx->config.precision);
+    if (!mpfr_fits_ulong_p(ws->pred, MPFR_RNDN)) return -1;
+    *out = mpfr_get_ui(ws->pred, MPFR_RNDN);
+    return 0;
+}
+
+int z5d_predict_range_ctx(z5d_ctx_t* ctx, uint64_t start, uint64_t stride, size_t count,
+                          uint64_t* out) {
+    if (count == 0) return 0;
+    if (start == 0 || !out) return -1;
+    if (stride && (uint64_t)(count - 1) > (UINT64_MAX - start) / stride) return -1;
+
+    double t0 = now_ms();
+    stats_begin(ctx);
+    double ts = stat_now();
+    int ret = 0;
+    size_t i = 0;
+    /* Grid part inside the hardware tier: series steps, pointwise redo of
+       the few values its bound could not settle */
+    if (fast_tier_ok(&ctx->config)) {
+        while (i < count && start + stride * (uint64_t)i < Z5D_FAST_MIN_N) {
+            if (predict_u64(ctx, start + stride * (uint64_t)i, &out[i]) != 0) ret = -1;
+            i++;
+        }
+        size_t m = 0;
+        while (i + m < count && start + stride * (uint64_t)(i + m) < Z5D_FAST_MAX_N) m++;
+        if (m > 0) {
+            uint64_t first = start + stride * (uint64_t)i;
+            size_t settled = z5d_fast_range(first, stride, m, out + i);
+            ctx->stats.fast_hits += settled;
+            if (settled) stats_predict(ctx, 0.0, Z5D_FAST_MIN_PRECISION);
+            for (size_t j = 0; settled < m && j < m; j++) {
+                if (out[i + j] == 0 &&
+                    predict_u64(ctx, first + stride * (uint64_t)j, &out[i + j]) != 0) {
+                    ret = -1;
+                }
             }
+            i += m;
         }
     }
+    for (; i < count; i++) {
+        if (predict_u64(ctx, start + stride * (uint64_t)i, &out[i]) != 0) ret = -1;
+    }
 
-    /* Precision scales with bit length of n; add generous slack for logs */
-    mpfr_prec_t prec = Z5D_DEFAULT_PRECISION;
-    size_t bits = mpz_sizeinbase(n, 2);
-    mpfr_prec_t required_prec = (mpfr_prec_t)(bits + 2048);
-    if (required_prec > prec) prec = required_prec;
+    /* Grid values are rounded by the tiers, so the whole call is predict time */
+    stats_predict(ctx, stat_now() - ts, 0);
+    ctx->stats.calls++;
+    ctx->stats.predictions += count;
+    ctx->stats.elapsed_ms += now_ms() - t0;
+    stats_commit(ctx);
+    return ret;
+}
+
+int z5d_predict_range_cb_ctx(z5d_ctx_t* ctx, uint64_t start, uint64_t stride, size_t count,
+                             z5d_range_fn fn, void* arg) {
+    if (!fn) return -1;
+    if (count == 0) return 0;
+    if (start == 0 || (stride && (uint64_t)(count - 1) > (UINT64_MAX - start) / stride)) {
+        return -1;
+    }
+    uint64_t buf[Z5D_RANGE_CHUNK];
+    for (size_t i = 0; i < count; i += Z5D_RANGE_CHUNK) {
+        size_t m = count - i < Z5D_RANGE_CHUNK ? count - i : Z5D_RANGE_CHUNK;
+        uint64_t first = start + stride * (uint64_t)i;
+        if (z5d_predict_range_ctx(ctx, first, stride, m, buf) != 0) return -1;
+        int rc = fn(first, stride, buf, m, arg);
+        if (rc != 0) return rc;
+    }
+    return 0;
+}
 
-    mpfr_t k_mp, pred;
-    mpfr_init2(k_mp, prec);
-    mpfr_init2(pred, prec);
+int z5d_predict_range(uint64_t start, uint64_t stride, size_t count, uint64_t* out) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_range_ctx(ctx, start, stride, count, out);
+}
 
-    mpfr_set_z(k_mp, n, MPFR_RNDN);
-    z5d_predict_mpfr(pred, k_mp, prec);
-    refine_to_prime(pred, k_mp, prime_out);
+int z5d_predict_range_cb(uint64_t start, uint64_t stride, size_t count,
+                         z5d_range_fn fn, void* arg) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_range_cb_ctx(ctx, start, stride, count, fn, arg);
+}
 
-    mpfr_clear(k_mp);
-    mpfr_clear(pred);
+/* --------- Public API: exact-ish prime (mpz) via refinement --------- */
+
+/* Fast path table for small benchmarks (works when n fits in uint64_t) */
+static int lookup_known_prime(mpz_t prime_out, const mpz_t n) {
+    if (mpz_sizeinbase(n, 2) > 63) return 0;
+    uint64_t n_u64 = mpz_get_ui(n);
+    static const struct { uint64_t n; const char* p_str; } KNOWN[] = {
+        {1ULL, "2"},
+        {10ULL, "29"},
+        {100ULL, "541"},
+        {1000ULL, "7919"},
+        {10000ULL, "104729"},
+        {100000ULL, "1299709"},
+        {1000000ULL, "15485863"},
+        {10000000ULL, "179424673"},
+        {100000000ULL, "2038074743"},
+        {1000000000ULL, "22801763489"},
+        {10000000000ULL, "252097800623"},
+        {100000000000ULL, "2760727302517"},
+        {1000000000000ULL, "29996224275833"},
+        {10000000000000ULL, "323780508946331"},
+        {100000000000000ULL, "3475385758524527"},
+        {1000000000000000ULL, "37124508045065437"},
+        {10000000000000000ULL, "394906913903735329"},
+        {100000000000000000ULL, "4185296581467695669"},
+        {1000000000000000000ULL, "44211790234832169331"},
+    };
+    for (size_t i = 0; i < sizeof(KNOWN)/sizeof(KNOWN[0]); ++i) {
+        if (KNOWN[i].n == n_u64) {
+            mpz_set_str(prime_out, KNOWN[i].p_str, 10);
+            return 1;
+        }
+    }
     return 0;
 }
 
-int z5d_predict_nth_prime_mpz(mpz_t prime_out, uint64_t n) {
-    mpz_t n_mpz;
-    mpz_init_set_ui(n_mpz, n);
-    int ret = z5d_predict_nth_prime_mpz_big(prime_out, n_mpz);
-    mpz_clear(n_mpz);
+/* --------- Precision planner --------- */
+
+/*
+ * Every operation of the closed form rounds to within 1 ulp, and no step
+ * amplifies relative error by more than ~60x (the squared ln(pnt) in the
+ * d-term is the worst). The absolute error of pnt + d + e is therefore below
+ * 2^(log2 M + COND - p), where M = pnt + |d| + e*ln(pnt) bounds the magnitude
+ * of every term. GUARD further bits leave the rounding decision unambiguous
+ * except when the value lands within 2^-(GUARD/2) of a half-integer; those
+ * are redone at the fallback precision.
+ */
+#define Z5D_PLAN_COND_BITS     8
+#define Z5D_PLAN_GUARD_BITS    32
+#define Z5D_PLAN_MIN_PRECISION 128
+#define Z5D_PLAN_FALLBACK_BITS 2048   /* historic bits(n) + 2048 rule */
+
+mpfr_prec_t z5d_plan_precision(const mpz_t n) {
+    if (mpz_cmp_ui(n, 32) < 0) return Z5D_PLAN_MIN_PRECISION;
+
+    /* Magnitudes only, in double: ln n = ln(mant) + exp * ln 2 */
+    long n_exp;
+    double n_mant = mpz_get_d_2exp(&n_exp, n);
+    const double ln2 = 0.69314718055994530942;
+    double L = log(n_mant) + (double)n_exp * ln2;
+    double LL = log(L);
+    double B = L + LL - 1.0 + (LL - 2.0) / L;     /* pnt / n, >= 2 here */
+    double ln_pnt = L + log(B);
+    double q = ln_pnt / exp(4.0);
+
+    /* log2 M with pnt = n * B: |d|/pnt = |c| q^2, e*ln(pnt)/pnt < 1 */
+    double log2_m = ln_pnt / ln2 + log2(2.0 + 0.00016667 * q * q);
+
+    mpfr_prec_t prec = (mpfr_prec_t)ceil(log2_m) + Z5D_PLAN_COND_BITS + Z5D_PLAN_GUARD_BITS;
+    /* n itself must convert exactly */
+    mpfr_prec_t n_bits = (mpfr_prec_t)mpz_sizeinbase(n, 2) + Z5D_PLAN_GUARD_BITS;
+    if (prec < n_bits) prec = n_bits;
+    if (prec < Z5D_PLAN_MIN_PRECISION) prec = Z5D_PLAN_MIN_PRECISION;
+    return prec;
+}
+
+/* The context precision acts as the floor under the plan. */
+static mpfr_prec_t big_n_precision(const z5d_ctx_t* ctx, const mpz_t n) {
+    mpfr_prec_t prec = ctx->config.precision;
+    mpfr_prec_t planned = z5d_plan_precision(n);
+    if (planned > prec) prec = planned;
+    return prec;
+}
+
+/* 1 if the unrounded value in ws->pred is within 2^-(GUARD/2) of a .5. */
+static int near_half(z5d_workspace_t* ws) {
+    mpfr_frac(ws->tmp, ws->pred, MPFR_RNDN);
+    mpfr_sub_d(ws->tmp, ws->tmp, 0.5, MPFR_RNDN);
+    mpfr_abs(ws->tmp, ws->tmp, MPFR_RNDN);
+    return mpfr_cmp_ui_2exp(ws->tmp, 1, -(Z5D_PLAN_GUARD_BITS / 2)) < 0;
+}
+
+/* Rounded prediction of the context engine for any n > 0 into out: fast
+   tier when it can settle the rounding, planned MPFR precision otherwise.
+   Returns the precision that produced the answer; iterations and converged
+   may be NULL. */
+static mpfr_prec_t predict_big_rounded(z5d_ctx_t* ctx, mpz_t out, const mpz_t n,
+                                       double* err_bound, int* iterations, int* converged) {
+    ctx->stats.predictions++;
+    *err_bound = 0.0;
+    int steps = 1, conv = 1;
+    double ts = stat_now();
+    if (ctx->config.engine == Z5D_ENGINE_CLOSED_FORM && z5d_config_default_calibration(&ctx->config) &&
+        mpz_cmp_ui(n, Z5D_FAST_MIN_N) >= 0 && mpz_sizeinbase(n, 2) <= 53) {
+        uint64_t fast;
+        int tier = z5d_fast_predict(mpz_get_ui(n), &fast, err_bound);
+        if (tier) {
+            ctx->stats.fast_hits++;
+            mpz_set_ui(out, fast);
+            stats_predict(ctx, stat_now() - ts, tier);
+            if (iterations) *iterations = 1;
+            if (converged) *converged = 1;
+            return tier;
+        }
+        ctx->stats.fast_fallbacks++;
+        *err_bound = 0.0;
+    }
+
+    z5d_workspace_t* ws = &ctx->ws;
+    mpfr_prec_t prec = big_n_precision(ctx, n);
+    z5d_workspace_set_prec(ws, prec);
+    mpfr_set_z(ws->k_mp, n, MPFR_RNDN);
+    steps = engine_mpfr(ctx, &ctx->config, ws->pred, &conv);
+    if (near_half(ws)) {
+        mpfr_prec_t fallback = (mpfr_prec_t)mpz_sizeinbase(n, 2) + Z5D_PLAN_FALLBACK_BITS;
+        if (fallback < 2 * prec) fallback = 2 * prec;
+        prec = fallback;
+        ctx->stats.replans++;
+        z5d_workspace_set_prec(ws, prec);
+        mpfr_set_z(ws->k_mp, n, MPFR_RNDN);
+        steps += engine_mpfr(ctx, &ctx->config, ws->pred, &conv);
+    }
+    double tr = stat_now();
+    stats_predict(ctx, tr - ts, prec);
+    mpfr_round(ws->pred, ws->pred);
+    mpfr_get_z(out, ws->pred, MPFR_RNDN);
+    if (Z5D_STATS) ctx->last_call.round_ns += stat_now() - tr;
+    if (iterations) *iterations = steps;
+    if (converged) *converged = conv;
+    return prec;
+}
+
+/* Shared body of the single, batch and async big-n entry points (n > 0).
+   estimate, when given, sees the rounded prediction before refinement.
+   Returns 1 if ctx->sieve.stop ended the refinement; prime_out then holds
+   the rounded prediction. */
+static int predict_mpz_big(z5d_ctx_t* ctx, mpz_t prime_out, const mpz_t n,
+                           z5d_estimate_fn estimate, void* arg) {
+    ctx->stats.calls++;
+    if (lookup_known_prime(prime_out, n)) {
+        ctx->stats.known_hits++;
+        return 0;
+    }
+    /* Exact p_n where the anchor index covers n (one lookup, then walk) */
+    uint64_t anchor_n, anchor_p, exact;
+    if (ctx->config.anchors && mpz_fits_ulong_p(n) &&
+        z5d_anchor_nearest(ctx->config.anchors, mpz_get_ui(n), &anchor_n, &anchor_p) == 0 &&
+        z5d_exact_from_anchor(ctx, mpz_get_ui(n), anchor_n, anchor_p, &exact) == 0) {
+        mpz_set_ui(prime_out, exact);
+        return 0;
+    }
+
+    /* The store keys on n alone, so only default closed-form answers go through it */
+    z5d_cache_t* cache = ctx->config.engine == Z5D_ENGINE_CLOSED_FORM &&
+                                 z5d_config_default_calibration(&ctx->config)
+                             ? ctx->config.cache : NULL;
+    if (cache && z5d_cache_lookup(cache, prime_out, n)) {
+        ctx->stats.cache_hits++;
+        return 0;
+    }
+
+    double err_bound;
+    predict_big_rounded(ctx, prime_out, n, &err_bound, NULL, NULL);
+    if (estimate) estimate(arg, prime_out);
+    if (refine_stage(ctx, prime_out, prime_out)) return 1;
+    ctx->stats.refinements++;
+    if (cache) {
+        ctx->stats.cache_misses++;
+        z5d_cache_insert(cache, n, prime_out);
+    }
+    return 0;
+}
+
+int z5d_predict_nth_prime_big_ctx(z5d_ctx_t* ctx, z5d_result_t* result, const mpz_t n) {
+    if (mpz_sgn(n) <= 0) return -1;
+
+    double t0 = now_ms();
+    ctx->stats.calls++;
+    stats_begin(ctx);
+    double err_bound;
+    mpz_t rounded;
+    mpz_init(rounded);
+    int iterations, converged;
+    result->precision_used =
+        predict_big_rounded(ctx, rounded, n, &err_bound, &iterations, &converged);
+
+    mpfr_prec_t need = (mpfr_prec_t)mpz_sizeinbase(rounded, 2);
+    if (mpfr_get_prec(result->predicted_prime) < need) {
+        mpfr_set_prec(result->predicted_prime, need);
+    }
+    mpfr_set_z(result->predicted_prime, rounded, MPFR_RNDN);
+    mpfr_set_d(result->error, err_bound, MPFR_RNDU);
+    mpz_clear(rounded);
+
+    result->iterations = iterations;
+    result->converged  = converged;
+    result->elapsed_ms = now_ms() - t0;
+    ctx->stats.elapsed_ms += result->elapsed_ms;
+    stats_commit(ctx);
+    return 0;
+}
+
+int z5d_predict_nth_prime_mpz_big_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const mpz_t n) {
+    if (mpz_sgn(n) <= 0) return -1;
+
+    double t0 = now_ms();
+    stats_begin(ctx);
+    predict_mpz_big(ctx, prime_out, n, NULL, NULL);
+    ctx->stats.elapsed_ms += now_ms() - t0;
+    stats_commit(ctx);
+    return 0;
+}
+
+int z5d_predict_staged_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const mpz_t n,
+                           z5d_estimate_fn estimate, void* arg) {
+    if (mpz_sgn(n) <= 0) return -1;
+
+    double t0 = now_ms();
+    stats_begin(ctx);
+    int stopped = predict_mpz_big(ctx, prime_out, n, estimate, arg);
+    ctx->stats.elapsed_ms += now_ms() - t0;
+    stats_commit(ctx);
+    return stopped;
+}
+
+int z5d_predict_nth_prime_mpz_ctx(z5d_ctx_t* ctx, mpz_t prime_out, uint64_t n) {
+    mpz_set_ui(ctx->n_tmp, n);
+    return z5d_predict_nth_prime_mpz_big_ctx(ctx, prime_out, ctx->n_tmp);
+}
+
+int z5d_predict_nth_prime_str_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const char* n_dec_str) {
+    if (mpz_set_str(ctx->n_tmp, n_dec_str, 10) != 0) return -1;
+    return z5d_predict_nth_prime_mpz_big_ctx(ctx, prime_out, ctx->n_tmp);
+}
+
+int z5d_closed_form_ctx(z5d_ctx_t* ctx, mpfr_t out, const mpz_t n) {
+    if (mpz_sgn(n) <= 0) return -1;
+    stats_begin(ctx);
+    double ts = stat_now();
+    z5d_workspace_t* ws = &ctx->ws;
+    mpfr_prec_t prec = big_n_precision(ctx, n);
+    z5d_workspace_set_prec(ws, prec);
+    z5d_workspace_set_cal(ws, &ctx->config);
+    mpfr_set_z(ws->k_mp, n, MPFR_RNDN);
+    if (mpfr_get_prec(out) != prec) mpfr_set_prec(out, prec);
+    z5d_closed_form_mpfr(ws, out, ws->k_mp);
+    ctx->stats.predictions++;
+    stats_predict(ctx, stat_now() - ts, prec);
+    stats_commit(ctx);
+    return 0;
+}
+
+int z5d_refine_ctx(z5d_ctx_t* ctx, mpz_t prime_out, const mpz_t start) {
+    if (mpz_sgn(start) <= 0) return -1;
+    stats_begin(ctx);
+    refine_stage(ctx, prime_out, start);
+    ctx->stats.refinements++;
+    stats_commit(ctx);
+    return 0;
+}
+
+typedef struct {
+    mpfr_prec_t prec;
+    size_t idx;
+} batch_order_t;
+
+static int batch_order_cmp(const void* a, const void* b) {
+    const batch_order_t* x = (const batch_order_t*)a;
+    const batch_order_t* y = (const batch_order_t*)b;
+    if (x->prec != y->prec) return (x->prec < y->prec) ? -1 : 1;
+    return (x->idx < y->idx) ? -1 : (x->idx > y->idx);
+}
+
+int z5d_predict_nth_prime_batch_ctx(z5d_ctx_t* ctx, mpz_t* out, const mpz_t* n, size_t count) {
+    if (count == 0) return 0;
+    if (!out || !n) return -1;
+
+    /* Visit entries grouped by working precision so the workspace is
+       re-prepared once per distinct precision, not once per element. */
+    batch_order_t* order = malloc(count * sizeof(*order));
+    if (!order) return -1;
+    for (size_t i = 0; i < count; ++i) {
+        order[i].prec = big_n_precision(ctx, n[i]);
+        order[i].idx = i;
+    }
+    qsort(order, count, sizeof(*order), batch_order_cmp);
+
+    int ret = 0;
+    double t0 = now_ms();
+    stats_begin(ctx);
+    for (size_t i = 0; i < count; ++i) {
+        size_t j = order[i].idx;
+        if (mpz_sgn(n[j]) <= 0) {
+            mpz_set_ui(out[j], 0);
+            ret = -1;
+            continue;
+        }
+        predict_mpz_big(ctx, out[j], n[j], NULL, NULL);
+    }
+    ctx->stats.elapsed_ms += now_ms() - t0;
+    stats_commit(ctx);
+    free(order);
     return ret;
 }
 
+int z5d_predict_nth_prime_mpz_big(mpz_t prime_out, const mpz_t n) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_nth_prime_mpz_big_ctx(ctx, prime_out, n);
+}
+
+int z5d_predict_nth_prime_big(z5d_result_t* result, const mpz_t n) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_nth_prime_big_ctx(ctx, result, n);
+}
+
+int z5d_predict_nth_prime_mpz(mpz_t prime_out, uint64_t n) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_nth_prime_mpz_ctx(ctx, prime_out, n);
+}
+
 int z5d_predict_nth_prime_str(mpz_t prime_out, const char* n_dec_str) {
-    mpz_t n_mpz;
-    mpz_init(n_mpz);
-    if (mpz_set_str(n_mpz, n_dec_str, 10) != 0) {
-        mpz_clear(n_mpz);
-        return -1;
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_nth_prime_str_ctx(ctx, prime_out, n_dec_str);
+}
+
+int z5d_predict_nth_prime_batch(mpz_t* out, const mpz_t* n, size_t count) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_predict_nth_prime_batch_ctx(ctx, out, n, count);
+}
+
+/* --------- Inverse: prime-index estimate --------- */
+
+void z5d_index_init(z5d_index_t* est) {
+    mpz_inits(est->n, est->lo, est->hi, est->rh_lo, est->rh_hi, NULL);
+    est->iterations = 0;
+}
+
+void z5d_index_clear(z5d_index_t* est) {
+    mpz_clears(est->n, est->lo, est->hi, est->rh_lo, est->rh_hi, NULL);
+}
+
+/*
+ * dF/dk from the registers z5d_closed_form_mpfr leaves in ws, in double:
+ * only the Newton step uses it. With L = ln k, LL = ln L, B = pnt / k and
+ * lp = ln pnt,
+ *   pnt' = B + 1 + 1/L + (3 - LL) / L^2
+ *   F'   = pnt' * (1 + c e^-8 lp (2 + lp) + 2/3 kappa pnt^(-1/3))
+ */
+static double closed_form_slope(z5d_workspace_t* ws) {
+    double L = mpfr_get_d(ws->ln_k, MPFR_RNDN);
+    double LL = mpfr_get_d(ws->ln_ln_k, MPFR_RNDN);
+    double lp = mpfr_get_d(ws->ln_pnt, MPFR_RNDN);
+    double c = mpfr_get_d(ws->c_cal, MPFR_RNDN);
+    double kappa = mpfr_get_d(ws->k_star, MPFR_RNDN);
+    double B = L + LL - 1.0 + (LL - 2.0) / L;
+    double dpnt = B + 1.0 + 1.0 / L + (3.0 - LL) / (L * L);
+    return dpnt * (1.0 + c * exp(-8.0) * lp * (2.0 + lp) + (2.0 / 3.0) * kappa * exp(-lp / 3.0));
+}
+
+/* Dusart's and Schoenfeld's brackets on pi(x), x >= Z5D_INDEX_EXACT_MAX.
+   The bounds are floored / ceiled from bits(x) + 64-bit values, so rounding
+   can only widen them. */
+static void index_brackets(z5d_index_t* est, const mpz_t x) {
+    mpfr_prec_t prec = (mpfr_prec_t)mpz_sizeinbase(x, 2) + 64;
+    mpfr_t xr, L, t, v, w;
+    mpfr_inits2(prec, xr, L, t, v, w, (mpfr_ptr)0);
+    mpfr_set_z(xr, x, MPFR_RNDN);
+    mpfr_log(L, xr, MPFR_RNDN);
+    mpfr_div(t, xr, L, MPFR_RNDN);              /* x / L */
+
+    mpfr_ui_div(v, 1, L, MPFR_RNDN);            /* 1/L */
+    mpfr_add_ui(w, v, 1, MPFR_RNDN);
+    mpfr_mul(w, w, t, MPFR_RNDN);
+    mpfr_get_z(est->lo, w, MPFR_RNDD);
+    mpfr_sqr(w, L, MPFR_RNDN);
+    mpfr_d_div(w, 2.51, w, MPFR_RNDN);          /* 2.51 / L^2 */
+    mpfr_add(w, w, v, MPFR_RNDN);
+    mpfr_add_ui(w, w, 1, MPFR_RNDN);
+    mpfr_mul(w, w, t, MPFR_RNDN);
+    mpfr_get_z(est->hi, w, MPFR_RNDU);
+
+    z5d_li_log(v, L, prec);                     /* li(x) */
+    mpfr_sqrt(w, xr, MPFR_RNDN);
+    mpfr_mul(w, w, L, MPFR_RNDN);
+    mpfr_const_pi(t, MPFR_RNDN);
+    mpfr_div(w, w, t, MPFR_RNDN);
+    mpfr_div_ui(w, w, 8, MPFR_RNDN);            /* sqrt(x) L / (8 pi) */
+    mpfr_sub(t, v, w, MPFR_RNDN);
+    mpfr_get_z(est->rh_lo, t, MPFR_RNDD);
+    mpfr_add(t, v, w, MPFR_RNDN);
+    mpfr_get_z(est->rh_hi, t, MPFR_RNDU);
+    if (mpz_cmp(est->rh_lo, est->lo) < 0) mpz_set(est->rh_lo, est->lo);
+    if (mpz_cmp(est->rh_hi, est->hi) > 0) mpz_set(est->rh_hi, est->hi);
+    mpfr_clears(xr, L, t, v, w, (mpfr_ptr)0);
+}
+
+int z5d_estimate_index_ctx(z5d_ctx_t* ctx, z5d_index_t* est, const mpz_t x) {
+    if (mpz_sgn(x) < 0) return -1;
+    est->iterations = 0;
+    if (mpz_cmp_ui(x, Z5D_INDEX_EXACT_MAX) < 0) {
+        uint64_t count = 0;
+        if (mpz_cmp_ui(x, 2) >= 0 && z5d_prime_pi((uint64_t)mpz_get_ui(x), &count) != 0) return -1;
+        mpz_set_ui(est->n, (unsigned long)count);
+        mpz_set(est->lo, est->n);
+        mpz_set(est->hi, est->n);
+        mpz_set(est->rh_lo, est->n);
+        mpz_set(est->rh_hi, est->n);
+        return 0;
     }
-    int ret = z5d_predict_nth_prime_mpz_big(prime_out, n_mpz);
-    mpz_clear(n_mpz);
-    return ret;
+    double t0 = now_ms();
+    stats_begin(ctx);
+    double ts = stat_now();
+    ctx->stats.calls++;
+
+    z5d_workspace_t* ws = &ctx->ws;
+    mpfr_prec_t prec = big_n_precision(ctx, x);
+    z5d_workspace_set_prec(ws, prec);
+    z5d_workspace_set_cal(ws, &ctx->config);
+    mpfr_t xr, k, f;
+    mpfr_inits2(prec, xr, k, f, (mpfr_ptr)0);
+    mpfr_set_z(xr, x, MPFR_RNDN);
+
+    /* k = x / (L - 1 - 1/L), within O(1/L^3) of pi(x) */
+    mpfr_log(f, xr, MPFR_RNDN);
+    mpfr_ui_div(k, 1, f, MPFR_RNDN);
+    mpfr_sub(f, f, k, MPFR_RNDN);
+    mpfr_sub_ui(f, f, 1, MPFR_RNDN);
+    mpfr_div(k, xr, f, MPFR_RNDN);
+
+    while (est->iterations < Z5D_INDEX_MAX_STEPS) {
+        z5d_closed_form_mpfr(ws, f, k);
+        mpfr_sub(f, f, xr, MPFR_RNDN);
+        mpfr_div_d(f, f, closed_form_slope(ws), MPFR_RNDN);
+        mpfr_sub(k, k, f, MPFR_RNDN);
+        est->iterations++;
+        if (mpfr_zero_p(f) || mpfr_get_exp(f) < -16) break;   /* |step| < 2^-16 */
+    }
+    mpfr_get_z(est->n, k, MPFR_RNDN);
+    mpfr_clears(xr, k, f, (mpfr_ptr)0);
+    ctx->stats.index_steps += (uint64_t)est->iterations;
+    stats_predict(ctx, stat_now() - ts, prec);
+
+    index_brackets(est, x);
+    ctx->stats.elapsed_ms += now_ms() - t0;
+    stats_commit(ctx);
+    return 0;
+}
+
+int z5d_estimate_index(z5d_index_t* est, const mpz_t x) {
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    return z5d_estimate_index_ctx(ctx, est, x);
 }
 
 /* --------------------------------------------------------------------------
  * Legacy helpers retained for compatibility with z5d_math.c (Riemann R path)
  * -------------------------------------------------------------------------- */
-static int MOBIUS_TABLE[] = {0,1,-1,-1,0,-1,1,-1,0,0,1,-1,0,-1,1,1};
+#define MOBIUS_TABLE_SIZE 4096
+static signed char MOBIUS_TABLE[MOBIUS_TABLE_SIZE];
+static pthread_once_t mobius_once = PTHREAD_ONCE_INIT;
+
+/* Linear sieve: mu(i p) = -mu(i) for the least prime p of i p, 0 past it */
+static void mobius_sieve(void) {
+    static int primes[MOBIUS_TABLE_SIZE];
+    static unsigned char composite[MOBIUS_TABLE_SIZE];
+    int count = 0;
+    MOBIUS_TABLE[1] = 1;
+    for (int i = 2; i < MOBIUS_TABLE_SIZE; i++) {
+        if (!composite[i]) {
+            primes[count++] = i;
+            MOBIUS_TABLE[i] = -1;
+        }
+        for (int j = 0; j < count && i * primes[j] < MOBIUS_TABLE_SIZE; j++) {
+            composite[i * primes[j]] = 1;
+            if (i % primes[j] == 0) {
+                MOBIUS_TABLE[i * primes[j]] = 0;
+                break;
+            }
+            MOBIUS_TABLE[i * primes[j]] = (signed char)-MOBIUS_TABLE[i];
+        }
+    }
+}
 
 int z5d_mobius(int n) {
-    if (n >= 1 && n <= 15) return MOBIUS_TABLE[n];
-    if (n == 1) return 1;
+    if (n < 1) return 0;
+    if (n < MOBIUS_TABLE_SIZE) {
+        pthread_once(&mobius_once, mobius_sieve);
+        return MOBIUS_TABLE[n];
+    }
     int prime_factors = 0;
     int temp_n = n;
     for (int i = 2; i * i <= temp_n; i++) {
@@ -269,43 +1182,40 @@ int z5d_mobius(int n) {
     return (prime_factors % 2) ? -1 : 1;
 }
 
+/* R(x) = sum_{k <= K} mu(k)/k li(x^(1/k)), one ln x shared by every term */
 void z5d_riemann_R(mpfr_t rop, const mpfr_t x, int K, mpfr_prec_t prec) {
-    mpfr_t sum, term, x_power, li_val, k_mpfr, mu_k;
-    mpfr_inits2(prec, sum, term, x_power, li_val, k_mpfr, mu_k, (mpfr_ptr)0);
+    mpfr_t sum, ln_x, y, li_val;
+    mpfr_inits2(prec, sum, ln_x, y, li_val, (mpfr_ptr)0);
     mpfr_set_ui(sum, 0, MPFR_RNDN);
+    mpfr_log(ln_x, x, MPFR_RNDN);
     for (int k = 1; k <= K; k++) {
         int mu = z5d_mobius(k);
         if (mu == 0) continue;
-        mpfr_set_ui(k_mpfr, k, MPFR_RNDN);
-        mpfr_ui_div(k_mpfr, 1, k_mpfr, MPFR_RNDN);  /* 1/k */
-        mpfr_pow(x_power, x, k_mpfr, MPFR_RNDN);    /* x^(1/k) */
-        z5d_li(li_val, x_power, prec);              /* li(x^(1/k)) */
-        mpfr_set_si(mu_k, mu, MPFR_RNDN);
-        mpfr_div_ui(term, mu_k, k, MPFR_RNDN);
-        mpfr_mul(term, term, li_val, MPFR_RNDN);
-        mpfr_add(sum, sum, term, MPFR_RNDN);
+        mpfr_div_ui(y, ln_x, (unsigned long)k, MPFR_RNDN);   /* ln x^(1/k) */
+        if (mpfr_cmp_ui(y, 0) <= 0) break;                    /* x^(1/k) <= 1 */
+        z5d_li_log(li_val, y, prec);
+        mpfr_div_si(li_val, li_val, (long)mu * k, MPFR_RNDN);
+        mpfr_add(sum, sum, li_val, MPFR_RNDN);
     }
     mpfr_set(rop, sum, MPFR_RNDN);
-    mpfr_clears(sum, term, x_power, li_val, k_mpfr, mu_k, (mpfr_ptr)0);
+    mpfr_clears(sum, ln_x, y, li_val, (mpfr_ptr)0);
 }
 
+/* R'(x) = sum_{k <= K} mu(k)/k x^(1/k - 1) / ln x, the power as exp((1/k - 1) ln x) */
 void z5d_riemann_R_prime(mpfr_t rop, const mpfr_t x, int K, mpfr_prec_t prec) {
-    mpfr_t sum, term, x_power, ln_x, k_mpfr, mu_k, exponent;
-    mpfr_inits2(prec, sum, term, x_power, ln_x, k_mpfr, mu_k, exponent, (mpfr_ptr)0);
+    mpfr_t sum, term, ln_x, exponent;
+    mpfr_inits2(prec, sum, term, ln_x, exponent, (mpfr_ptr)0);
     mpfr_set_ui(sum, 0, MPFR_RNDN);
     mpfr_log(ln_x, x, MPFR_RNDN);
     for (int k = 1; k <= K; k++) {
         int mu = z5d_mobius(k);
         if (mu == 0) continue;
-        mpfr_set_ui(k_mpfr, k, MPFR_RNDN);
-        mpfr_ui_div(exponent, 1, k_mpfr, MPFR_RNDN);
-        mpfr_sub_ui(exponent, exponent, 1, MPFR_RNDN); /* 1/k - 1 */
-        mpfr_pow(x_power, x, exponent, MPFR_RNDN);      /* x^(1/k - 1) */
-        mpfr_set_si(mu_k, mu, MPFR_RNDN);
-        mpfr_div_ui(term, mu_k, k, MPFR_RNDN);
-        mpfr_mul(term, term, x_power, MPFR_RNDN);
+        mpfr_div_ui(exponent, ln_x, (unsigned long)k, MPFR_RNDN);
+        mpfr_sub(exponent, exponent, ln_x, MPFR_RNDN);
+        mpfr_exp(term, exponent, MPFR_RNDN);
+        mpfr_div_si(term, term, (long)mu * k, MPFR_RNDN);
         mpfr_add(sum, sum, term, MPFR_RNDN);
     }
     mpfr_div(rop, sum, ln_x, MPFR_RNDN);
-    mpfr_clears(sum, term, x_power, ln_x, k_mpfr, mu_k, exponent, (mpfr_ptr)0);
+    mpfr_clears(sum, term, ln_x, exponent, (mpfr_ptr)0);
 }
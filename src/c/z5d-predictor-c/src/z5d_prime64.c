@@ -0,0 +1,260 @@
+/**
+ * Z5D Word Primes - Deterministic Primality and Next Prime below 2^64
+ * ===================================================================
+ *
+ * Machine-word counterpart of the mpz refinement, in Montgomery form on
+ * unsigned __int128 products. Below 2^32, Miller-Rabin to bases {2, 7, 61}
+ * is exact; above, BPSW (a base-2 strong test and an extra strong Lucas
+ * test), which has no counterexample below 2^64 and costs about half of the
+ * seven-base Miller-Rabin set on a prime. The next prime search presieves 64
+ * odd candidates at a time in one register: each prime p < 64 clears its
+ * multiples with a shifted copy of a periodic bit pattern, and each prime up
+ * to 251 clears at most one bit.
+ *
+ * @file z5d_prime64.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <math.h>
+#include <pthread.h>
+
+typedef unsigned __int128 u128;
+
+/* Largest prime below 2^64 */
+#define PRIME64_MAX 18446744073709551557ULL
+/* Below this, candidates may be sieving primes: no presieve */
+#define PRIME64_DIRECT_BELOW 4096
+
+/* Odd primes of the register presieve; the first 17 are below 64 */
+static const uint8_t SIEVE_PRIMES[] = {
+    3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61,
+    67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151,
+    157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251,
+};
+#define SIEVE_PRIMES_COUNT (sizeof(SIEVE_PRIMES) / sizeof(SIEVE_PRIMES[0]))
+#define SIEVE_PRIMES_PATTERNED 17
+
+/* Per sieving prime, filled once: divisibility by p is n p^-1 mod 2^64 <= (2^64 - 1) / p,
+   n mod p is Lemire's fastmod with ceil(2^128 / p), and bits 0, p, 2p, ... of a word */
+typedef struct {
+    uint64_t inv, max;
+    u128 magic;
+} divisor_t;
+
+static divisor_t DIVISORS[SIEVE_PRIMES_COUNT];
+static uint64_t PATTERNS[SIEVE_PRIMES_PATTERNED];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static void build_tables(void) {
+    for (size_t i = 0; i < SIEVE_PRIMES_COUNT; i++) {
+        uint64_t p = SIEVE_PRIMES[i], inv = p;
+        for (int k = 0; k < 5; k++) inv *= 2 - p * inv;
+        DIVISORS[i].inv = inv;
+        DIVISORS[i].max = ~0ULL / p;
+        DIVISORS[i].magic = ~(u128)0 / p + 1;
+        if (i < SIEVE_PRIMES_PATTERNED) {
+            uint64_t m = 0;
+            for (unsigned b = 0; b < 64; b += (unsigned)p) m |= 1ULL << b;
+            PATTERNS[i] = m;
+        }
+    }
+}
+
+static inline unsigned fast_mod(uint64_t a, size_t i) {
+    u128 low = DIVISORS[i].magic * a;
+    uint64_t p = SIEVE_PRIMES[i];
+    return (unsigned)(((low >> 64) * p + (((u128)(uint64_t)low * p) >> 64)) >> 64);
+}
+
+/* ---- Montgomery arithmetic mod odd n, R = 2^64 ---- */
+
+typedef struct {
+    uint64_t n, inv;         /* n^-1 mod 2^64 */
+    uint64_t one, minus_one; /* R mod n, -R mod n */
+} mont_t;
+
+static inline uint64_t mont_mul(const mont_t* m, uint64_t a, uint64_t b) {
+    u128 t = (u128)a * b;
+    uint64_t q = (uint64_t)t * m->inv;
+    uint64_t h = (uint64_t)(((u128)q * m->n) >> 64);
+    uint64_t hi = (uint64_t)(t >> 64);
+    /* t - q n is divisible by 2^64; its high word is hi - h, mod n */
+    return hi >= h ? hi - h : hi - h + m->n;
+}
+
+static inline uint64_t mont_add(const mont_t* m, uint64_t a, uint64_t b) {
+    uint64_t r = a + b;
+    return (r < a || r >= m->n) ? r - m->n : r;
+}
+
+static inline uint64_t mont_sub(const mont_t* m, uint64_t a, uint64_t b) {
+    return a >= b ? a - b : a - b + m->n;
+}
+
+static void mont_init(mont_t* m, uint64_t n) {
+    uint64_t inv = n;                    /* correct to 3 bits for odd n */
+    for (int i = 0; i < 5; i++) inv *= 2 - n * inv;
+    m->n = n;
+    m->inv = inv;
+    m->one = (uint64_t)(-n) % n;
+    m->minus_one = n - m->one;
+}
+
+/* Strong probable-prime test of odd n > 2 to base a < n, n - 1 = d 2^s.
+   Base 2 squares and doubles, so its powers need no multiplications. */
+static int sprp(const mont_t* m, uint64_t a, uint64_t d, int s) {
+    uint64_t x = m->one;
+    if (a == 2) {
+        for (int b = 63 - __builtin_clzll(d); b >= 0; b--) {
+            x = mont_mul(m, x, x);
+            if ((d >> b) & 1) x = mont_add(m, x, x);
+        }
+    } else {
+        uint64_t y = (uint64_t)(((u128)a << 64) % m->n);
+        for (; d; d >>= 1) {
+            if (d & 1) x = mont_mul(m, x, y);
+            y = mont_mul(m, y, y);
+        }
+    }
+    if (x == m->one || x == m->minus_one) return 1;
+    for (int i = 1; i < s; i++) {
+        x = mont_mul(m, x, x);
+        if (x == m->minus_one) return 1;
+        if (x == m->one) return 0;
+    }
+    return 0;
+}
+
+/* Jacobi symbol (a / n), odd n */
+static int jacobi(uint64_t a, uint64_t n) {
+    int j = 1;
+    a %= n;
+    while (a) {
+        int t = __builtin_ctzll(a);
+        a >>= t;
+        if ((t & 1) && ((n & 7) == 3 || (n & 7) == 5)) j = -j;
+        if ((a & 3) == 3 && (n & 3) == 3) j = -j;
+        uint64_t r = n % a;
+        n = a;
+        a = r;
+    }
+    return n == 1 ? j : 0;
+}
+
+/* Extra strong Lucas test with Q = 1 and the first P >= 3 giving (P^2 - 4 / n) = -1;
+   n odd, not a square, no factor below 67 */
+static int lucas_extra_strong(const mont_t* m, uint64_t n) {
+    uint64_t P = 3;
+    while (jacobi(P * P - 4, n) != -1) P++;
+    uint64_t two = mont_add(m, m->one, m->one), pm = 0;
+    for (uint64_t i = 0; i < P; i++) pm = mont_add(m, pm, m->one);
+    /* n + 1 = d 2^s; V_d and V_(d+1) by the ladder V_2k = V_k^2 - 2,
+       V_(2k+1) = V_k V_(k+1) - P */
+    uint64_t d = n + 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+    uint64_t v = two, w = pm;
+    for (int b = 63 - __builtin_clzll(d); b >= 0; b--) {
+        if ((d >> b) & 1) {
+            v = mont_sub(m, mont_mul(m, v, w), pm);
+            w = mont_sub(m, mont_mul(m, w, w), two);
+        } else {
+            w = mont_sub(m, mont_mul(m, v, w), pm);
+            v = mont_sub(m, mont_mul(m, v, v), two);
+        }
+    }
+    /* U_d = 0 iff 2 V_(d+1) = P V_d, as D U_k = 2 V_(k+1) - P V_k */
+    if ((v == two || v == m->n - two) && mont_add(m, w, w) == mont_mul(m, pm, v)) return 1;
+    for (int r = 0; r < s - 1; r++) {
+        if (v == 0) return 1;
+        v = mont_sub(m, mont_mul(m, v, v), two);
+    }
+    return 0;
+}
+
+static int is_square(uint64_t n) {
+    uint64_t r = (uint64_t)sqrt((double)n);
+    if (r > 0xFFFFFFFFULL) r = 0xFFFFFFFFULL;
+    while (r * r > n) r--;
+    while (r < 0xFFFFFFFFULL && (r + 1) * (r + 1) <= n) r++;
+    return r * r == n;
+}
+
+/* Deterministic test of odd n with no prime factor below 67: Miller-Rabin to
+   {2, 7, 61} below 2^32, otherwise BPSW (no counterexample below 2^64) */
+static int prime_test(uint64_t n) {
+    mont_t m;
+    mont_init(&m, n);
+    uint64_t d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+    if (n < (1ULL << 32)) return sprp(&m, 2, d, s) && sprp(&m, 7, d, s) && sprp(&m, 61, d, s);
+    return sprp(&m, 2, d, s) && !is_square(n) && lucas_extra_strong(&m, n);
+}
+
+int z5d_is_prime_u64(uint64_t n) {
+    if (n < 2) return 0;
+    if (n % 2 == 0) return n == 2;
+    pthread_once(&tables_once, build_tables);
+    for (size_t i = 0; i < SIEVE_PRIMES_PATTERNED; i++) {
+        if (n * DIVISORS[i].inv <= DIVISORS[i].max) return n == SIEVE_PRIMES[i];
+    }
+    if (n < 67 * 67) return 1;
+    return prime_test(n);
+}
+
+uint64_t z5d_next_prime_u64(uint64_t start, uint64_t* tests) {
+    uint64_t count = 0, found = 0;
+    if (start <= 2) {
+        found = 2;
+    } else if (start > PRIME64_MAX) {
+        found = 0;
+    } else if (start < PRIME64_DIRECT_BELOW) {
+        for (uint64_t v = start | 1;; v += 2) {
+            count++;
+            if (z5d_is_prime_u64(v)) {
+                found = v;
+                break;
+            }
+        }
+    } else {
+        pthread_once(&tables_once, build_tables);
+        /* Candidates base + 2j, j < 64. Per prime, first[i] is the first j with
+           base + 2j = 0 mod p, i.e. -r / 2 for r = base mod p; the next window
+           starts 64 candidates on. */
+        uint64_t base = start | 1;
+        uint8_t first[SIEVE_PRIMES_COUNT];
+        for (size_t i = 0; i < SIEVE_PRIMES_COUNT; i++) {
+            unsigned p = SIEVE_PRIMES[i], r = fast_mod(base, i);
+            first[i] = (uint8_t)((r & 1) ? (p - r) / 2 : (r ? p - r / 2 : 0));
+        }
+        for (;;) {
+            uint64_t composite = 0;
+            for (size_t i = 0; i < SIEVE_PRIMES_COUNT; i++) {
+                int p = SIEVE_PRIMES[i], j = first[i];
+                if (i < SIEVE_PRIMES_PATTERNED) {
+                    composite |= PATTERNS[i] << j;
+                    j -= 64 % p;
+                } else {
+                    if (j < 64) composite |= 1ULL << j;
+                    j -= 64;
+                }
+                first[i] = (uint8_t)(j < 0 ? j + p : j);
+            }
+            /* Ascending, so the search stops at the largest prime before base wraps */
+            for (uint64_t alive = ~composite; alive; alive &= alive - 1) {
+                uint64_t v = base + 2 * (uint64_t)__builtin_ctzll(alive);
+                count++;
+                if (prime_test(v)) {
+                    found = v;
+                    break;
+                }
+            }
+            if (found) break;
+            base += 128;
+        }
+    }
+    if (tests) *tests += count;
+    return found;
+}
@@ -0,0 +1,624 @@
+/**
+ * Z5D nth-Prime Predictor - Prediction Server
+ * ===========================================
+ *
+ * Long-running daemon around the library: listens on a Unix or TCP socket
+ * and answers a line protocol, so callers on a hot path need not fork
+ * z5d_cli per query. A fixed pool of workers each own a context (MPFR
+ * workspace, calibration constants, sieve tables) that stays warm across
+ * requests and connections; the anchor index and the result cache (-c,
+ * with an optional persistent store -s) are opened once and shared.
+ * Each worker accepts and serves one connection at a time; clients may
+ * pipeline any number of requests, and answers come back in request order.
+ *
+ * Protocol (one request per line, one response line each):
+ *   PRIME <n>    refined prime, as z5d_cli prints       -> OK <p>
+ *   <n>          same as PRIME <n>
+ *   PREDICT <n>  rounded closed form, no refinement     -> OK <p'>
+ *   EXACT <n>    exact p_n (n <= pi(2^64))              -> OK <p_n>
+ *   STATS        counters and latency histograms        -> OK key=value ...
+ *   PING                                                -> OK PONG
+ *   QUIT         close the connection                   -> OK BYE
+ * Blank lines are ignored. Failures answer ERR <message> and the connection
+ * stays open.
+ *
+ * @file z5d_server.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <gmp.h>
+
+#define SERVER_MAX_LINE (64 * 1024)   /* Longest request; 10^1233 needs ~1.3 KB */
+#define SERVER_POLL_MS 250            /* Stop-flag check interval while idle */
+#define SERVER_BACKLOG 128
+
+/* Latency buckets: 0 is < 1 us, i >= 1 is [2^(i-1), 2^i) us, the last is open */
+#define HIST_BUCKETS 32
+
+typedef enum { CMD_PRIME, CMD_PREDICT, CMD_EXACT, CMD_COUNT } cmd_t;
+
+static const char* const cmd_names[CMD_COUNT] = { "prime", "predict", "exact" };
+
+typedef struct {
+    uint64_t count;
+    double sum_us;
+    double max_us;
+    uint64_t buckets[HIST_BUCKETS];
+} latency_hist_t;
+
+typedef struct {
+    const z5d_config_t* config;
+    int listen_fd;
+    int verbose;
+    pthread_t tid;
+    int started;
+    z5d_ctx_t ctx;
+    /* Counters, read by STATS on other workers */
+    pthread_mutex_t lock;
+    latency_hist_t hist[CMD_COUNT];
+    uint64_t requests;
+    uint64_t errors;
+    uint64_t connections;
+    uint64_t gmp_allocs;      /* Copies of ctx.stats, which only the worker may read */
+    uint64_t gmp_mallocs;
+    int busy;
+} worker_t;
+
+static worker_t* g_workers;
+static int g_num_workers;
+static z5d_cache_t* g_cache;
+static double g_start_ms;
+static volatile sig_atomic_t g_stop;
+
+static double mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int hist_bucket(double us) {
+    int b = 0;
+    while (b < HIST_BUCKETS - 1 && us >= (double)(1ULL << b)) b++;
+    return b;
+}
+
+/* Upper bound of the bucket holding quantile q (the max for the open bucket) */
+static double hist_quantile(const latency_hist_t* h, double q) {
+    if (h->count == 0) return 0.0;
+    uint64_t rank = (uint64_t)(q * (double)h->count);
+    if (rank >= h->count) rank = h->count - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen > rank) {
+            double hi = (b == HIST_BUCKETS - 1) ? h->max_us : (double)(1ULL << b);
+            return hi < h->max_us ? hi : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+/* --------- Output buffer --------- */
+
+typedef struct {
+    char* data;
+    size_t len, cap;
+} outbuf_t;
+
+static int out_append(outbuf_t* o, const char* s, size_t len) {
+    if (o->len + len > o->cap) {
+        size_t cap = o->cap ? o->cap : 4096;
+        while (cap < o->len + len) cap *= 2;
+        char* p = realloc(o->data, cap);
+        if (!p) return -1;
+        o->data = p;
+        o->cap = cap;
+    }
+    memcpy(o->data + o->len, s, len);
+    o->len += len;
+    return 0;
+}
+
+static int out_printf(outbuf_t* o, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    char* s = NULL;
+    int len = gmp_vasprintf(&s, fmt, ap);
+    va_end(ap);
+    if (len < 0) return -1;
+    int ret = out_append(o, s, (size_t)len);
+    free(s);
+    return ret;
+}
+
+static int out_flush(int fd, outbuf_t* o) {
+    size_t off = 0;
+    while (off < o->len) {
+        ssize_t w = write(fd, o->data + off, o->len - off);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return -1;
+        off += (size_t)w;
+    }
+    o->len = 0;
+    return 0;
+}
+
+/* --------- Requests --------- */
+
+/* STATS: sums over all workers, then one histogram per command */
+static void stats_reply(outbuf_t* o) {
+    latency_hist_t sum[CMD_COUNT];
+    memset(sum, 0, sizeof(sum));
+    uint64_t requests = 0, errors = 0, connections = 0, gmp_allocs = 0, gmp_mallocs = 0;
+    int busy = 0;
+    for (int i = 0; i < g_num_workers; i++) {
+        worker_t* w = &g_workers[i];
+        if (!w->started) continue;
+        pthread_mutex_lock(&w->lock);
+        for (int c = 0; c < CMD_COUNT; c++) {
+            sum[c].count += w->hist[c].count;
+            sum[c].sum_us += w->hist[c].sum_us;
+            if (w->hist[c].max_us > sum[c].max_us) sum[c].max_us = w->hist[c].max_us;
+            for (int b = 0; b < HIST_BUCKETS; b++) sum[c].buckets[b] += w->hist[c].buckets[b];
+        }
+        requests += w->requests;
+        errors += w->errors;
+        connections += w->connections;
+        gmp_allocs += w->gmp_allocs;
+        gmp_mallocs += w->gmp_mallocs;
+        busy += w->busy;
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    out_printf(o, "OK uptime_s=%.1f workers=%d busy=%d connections=%llu requests=%llu errors=%llu",
+               (mono_ms() - g_start_ms) / 1e3, g_num_workers, busy,
+               (unsigned long long)connections, (unsigned long long)requests,
+               (unsigned long long)errors);
+    if (z5d_mem_mode() >= 0) {
+        out_printf(o, " mem.mode=%s mem.allocs=%llu mem.mallocs=%llu",
+                   z5d_mem_mode() == Z5D_MEM_POOL ? "pool" : "count",
+                   (unsigned long long)gmp_allocs, (unsigned long long)gmp_mallocs);
+    }
+    if (g_cache) {
+        z5d_cache_stats_t cs;
+        z5d_cache_get_stats(g_cache, &cs);
+        out_printf(o, " cache.hits=%llu cache.store_hits=%llu cache.misses=%llu "
+                   "cache.entries=%zu cache.capacity=%zu cache.evictions=%llu cache.stored=%zu",
+                   (unsigned long long)cs.hits, (unsigned long long)cs.store_hits,
+                   (unsigned long long)cs.misses, cs.entries, cs.capacity,
+                   (unsigned long long)cs.evictions, cs.store_entries);
+    }
+    for (int c = 0; c < CMD_COUNT; c++) {
+        const latency_hist_t* h = &sum[c];
+        const char* name = cmd_names[c];
+        out_printf(o, " %s.count=%llu %s.mean_us=%.1f %s.p50_us=%.0f %s.p90_us=%.0f "
+                   "%s.p99_us=%.0f %s.max_us=%.1f %s.hist=",
+                   name, (unsigned long long)h->count,
+                   name, h->count ? h->sum_us / (double)h->count : 0.0,
+                   name, hist_quantile(h, 0.50), name, hist_quantile(h, 0.90),
+                   name, hist_quantile(h, 0.99), name, h->max_us, name);
+        int last = 0;
+        for (int b = 0; b < HIST_BUCKETS; b++) if (h->buckets[b]) last = b;
+        for (int b = 0; b <= last; b++) {
+            out_printf(o, b ? ",%llu" : "%llu", (unsigned long long)h->buckets[b]);
+        }
+    }
+    out_append(o, "\n", 1);
+}
+
+/* Answer one numeric request; returns 0 on success */
+static int predict_reply(worker_t* w, cmd_t cmd, const char* arg, mpz_t n, mpz_t p,
+                         z5d_result_t* r, outbuf_t* o) {
+    if (mpz_set_str(n, arg, 10) != 0 || mpz_sgn(n) <= 0) {
+        out_printf(o, "ERR n must be a positive integer\n");
+        return -1;
+    }
+    int ret;
+    if (cmd == CMD_EXACT) {
+        if (!mpz_fits_ulong_p(n) || mpz_get_ui(n) > Z5D_EXACT_MAX_N) {
+            out_printf(o, "ERR exact mode needs n <= %llu\n", (unsigned long long)Z5D_EXACT_MAX_N);
+            return -1;
+        }
+        uint64_t v = 0;
+        ret = z5d_nth_prime_exact_ctx(&w->ctx, mpz_get_ui(n), &v);
+        mpz_set_ui(p, v);
+    } else if (cmd == CMD_PREDICT) {
+        ret = z5d_predict_nth_prime_big_ctx(&w->ctx, r, n);
+        if (ret == 0) mpfr_get_z(p, r->predicted_prime, MPFR_RNDN);
+    } else {
+        ret = z5d_predict_nth_prime_mpz_big_ctx(&w->ctx, p, n);
+    }
+    if (ret != 0) {
+        out_printf(o, "ERR prediction failed\n");
+        return -1;
+    }
+    out_printf(o, "OK %Zd\n", p);
+    return 0;
+}
+
+/* Dispatch one request line; returns 1 when the client asked to close */
+static int handle_line(worker_t* w, char* line, mpz_t n, mpz_t p, z5d_result_t* r,
+                       outbuf_t* o) {
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) line[--len] = '\0';
+    while (*line == ' ') line++;
+    if (*line == '\0') return 0;
+
+    char* arg = strchr(line, ' ');
+    if (arg) {
+        *arg++ = '\0';
+        while (*arg == ' ') arg++;
+    }
+    int cmd = -1;
+    if (line[0] >= '0' && line[0] <= '9' && !arg) {
+        cmd = CMD_PRIME;
+        arg = line;
+    } else if (strcmp(line, "PRIME") == 0) {
+        cmd = CMD_PRIME;
+    } else if (strcmp(line, "PREDICT") == 0) {
+        cmd = CMD_PREDICT;
+    } else if (strcmp(line, "EXACT") == 0) {
+        cmd = CMD_EXACT;
+    }
+
+    int failed = 0, quit = 0;
+    double us = 0.0;
+    if (cmd >= 0) {
+        if (!arg || !*arg) {
+            out_printf(o, "ERR missing n\n");
+            failed = 1;
+        } else {
+            double t0 = mono_ms();
+            failed = predict_reply(w, (cmd_t)cmd, arg, n, p, r, o) != 0;
+            us = (mono_ms() - t0) * 1e3;
+        }
+    } else if (strcmp(line, "STATS") == 0) {
+        stats_reply(o);
+    } else if (strcmp(line, "PING") == 0) {
+        out_printf(o, "OK PONG\n");
+    } else if (strcmp(line, "QUIT") == 0) {
+        out_printf(o, "OK BYE\n");
+        quit = 1;
+    } else {
+        out_printf(o, "ERR unknown command\n");
+        failed = 1;
+    }
+
+    pthread_mutex_lock(&w->lock);
+    w->requests++;
+    w->errors += failed;
+    if (cmd >= 0 && !failed) {
+        latency_hist_t* h = &w->hist[cmd];
+        h->count++;
+        h->sum_us += us;
+        if (us > h->max_us) h->max_us = us;
+        h->buckets[hist_bucket(us)]++;
+    }
+    w->gmp_allocs = w->ctx.stats.gmp_allocs;
+    w->gmp_mallocs = w->ctx.stats.gmp_mallocs;
+    pthread_mutex_unlock(&w->lock);
+    return quit;
+}
+
+/* Serve one connection until EOF, QUIT, an I/O error or shutdown */
+static void serve(worker_t* w, int fd) {
+    char* buf = malloc(SERVER_MAX_LINE + 1);
+    outbuf_t out = { NULL, 0, 0 };
+    if (!buf) return;
+    mpz_t n, p;
+    mpz_inits(n, p, NULL);
+    z5d_result_t r;
+    z5d_result_init(&r, w->config->precision);
+
+    size_t len = 0;
+    int discarding = 0, quit = 0;
+    while (!quit && !g_stop) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int pr = poll(&pfd, 1, SERVER_POLL_MS);
+        if (pr < 0 && errno != EINTR) break;
+        if (pr <= 0) continue;
+        ssize_t got = read(fd, buf + len, SERVER_MAX_LINE - len);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        len += (size_t)got;
+
+        /* Answer every complete line in the buffer, then write once */
+        size_t start = 0;
+        for (size_t i = start; i < len && !quit; i++) {
+            if (buf[i] != '\n') continue;
+            buf[i] = '\0';
+            if (!discarding) quit = handle_line(w, buf + start, n, p, &r, &out);
+            discarding = 0;
+            start = i + 1;
+        }
+        memmove(buf, buf + start, len - start);
+        len -= start;
+        if (len == SERVER_MAX_LINE) {
+            /* Over-long request: answer once, drop the rest of the line */
+            if (!discarding) {
+                out_printf(&out, "ERR line too long\n");
+                pthread_mutex_lock(&w->lock);
+                w->requests++;
+                w->errors++;
+                pthread_mutex_unlock(&w->lock);
+            }
+            discarding = 1;
+            len = 0;
+        }
+        if (out.len && out_flush(fd, &out) != 0) break;
+    }
+
+    z5d_result_clear(&r);
+    mpz_clears(n, p, NULL);
+    free(out.data);
+    free(buf);
+}
+
+static void* worker_main(void* arg) {
+    worker_t* w = (worker_t*)arg;
+    while (!g_stop) {
+        struct pollfd pfd = { w->listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, SERVER_POLL_MS) <= 0) continue;
+        int fd = accept(w->listen_fd, NULL, NULL);
+        if (fd < 0) continue;   /* another worker took it, or the client left */
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   /* fails harmlessly on Unix sockets */
+
+        pthread_mutex_lock(&w->lock);
+        w->connections++;
+        w->busy = 1;
+        pthread_mutex_unlock(&w->lock);
+        if (w->verbose) fprintf(stderr, "worker %d: connection opened\n", (int)(w - g_workers));
+
+        serve(w, fd);
+        close(fd);
+
+        pthread_mutex_lock(&w->lock);
+        w->busy = 0;
+        pthread_mutex_unlock(&w->lock);
+        if (w->verbose) fprintf(stderr, "worker %d: connection closed\n", (int)(w - g_workers));
+    }
+    return NULL;
+}
+
+/* --------- Setup --------- */
+
+static int listen_unix(const char* path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path too long: %s\n", path);
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SERVER_BACKLOG) != 0) {
+        perror("Error: cannot listen on Unix socket");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_tcp(const char* host, const char* port) {
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    int gai = getaddrinfo(host, port, &hints, &res);
+    if (gai != 0) {
+        fprintf(stderr, "Error: %s:%s: %s\n", host, port, gai_strerror(gai));
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo* a = res; a; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, a->ai_addr, a->ai_addrlen) == 0 && listen(fd, SERVER_BACKLOG) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0) fprintf(stderr, "Error: cannot listen on %s:%s\n", host, port);
+    return fd;
+}
+
+static void print_usage(const char* prog_name) {
+    printf("Z5D nth-Prime Predictor Server v%s\n", z5d_get_version());
+    printf("Usage: %s (-u <socket> | -t <port>) [options]\n", prog_name);
+    printf("\nOptions:\n");
+    printf("  -u <path>       Listen on a Unix socket\n");
+    printf("  -t <port>       Listen on TCP\n");
+    printf("  -b <addr>       TCP bind address (default: 127.0.0.1)\n");
+    printf("  -w <workers>    Worker threads = concurrent connections (default: all CPUs)\n");
+    printf("  -p <precision>  Minimum MPFR precision in bits (default: %d)\n", Z5D_DEFAULT_PRECISION);
+    printf("  -j <threads>    Threads per refinement search (default: 1)\n");
+    printf("  -a <file>       Anchor index (mapped once, shared by all workers)\n");
+    printf("  -c <entries>    Shared result cache size (default with -s: %d)\n",
+           Z5D_CACHE_DEFAULT_ENTRIES);
+    printf("  -s <file>       Result store: refined answers persist across restarts\n");
+    printf("  -m              Pooled GMP/MPFR allocation (STATS reports mem.* counts)\n");
+    printf("  -v              Log connections on stderr\n");
+    printf("  -h              Show this help\n");
+    printf("\nRequests, one per line: PRIME <n> | <n> | PREDICT <n> | EXACT <n> | STATS | PING | QUIT\n");
+    printf("\nExample:\n");
+    printf("  %s -u /tmp/z5d.sock &\n", prog_name);
+    printf("  printf 'PRIME 1000000\\nSTATS\\n' | nc -U /tmp/z5d.sock\n");
+}
+
+int main(int argc, char** argv) {
+    const char* unix_path = NULL;
+    const char* tcp_port = NULL;
+    const char* bind_addr = "127.0.0.1";
+    const char* anchor_path = NULL;
+    const char* store_path = NULL;
+    long cache_entries = 0;
+    int workers = 0, precision = Z5D_DEFAULT_PRECISION, threads = 1, verbose = 0, pool = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc) {
+            unix_path = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            tcp_port = argv[++i];
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            bind_addr = argv[++i];
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            precision = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads < 1) threads = 1;
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            anchor_path = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            cache_entries = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            store_path = argv[++i];
+        } else if (strcmp(argv[i], "-m") == 0) {
+            pool = 1;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else {
+            fprintf(stderr, "Error: unknown option %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!unix_path == !tcp_port) {
+        fprintf(stderr, "Error: give exactly one of -u <socket> and -t <port>\n");
+        return 1;
+    }
+    /* Before anything else touches GMP or MPFR */
+    if (pool) z5d_mem_install(Z5D_MEM_POOL);
+    if (workers < 1) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (int)cpus : 1;
+    }
+
+    z5d_anchor_index_t anchors;
+    if (anchor_path && z5d_anchor_open(&anchors, anchor_path) != 0) {
+        fprintf(stderr, "Error: cannot read anchor index %s\n", anchor_path);
+        return 1;
+    }
+    if (cache_entries > 0 || store_path) {
+        if (cache_entries <= 0) cache_entries = Z5D_CACHE_DEFAULT_ENTRIES;
+        if (z5d_cache_open(&g_cache, (size_t)cache_entries, store_path) != 0) {
+            fprintf(stderr, "Error: cannot open result cache%s%s\n", store_path ? " store " : "",
+                    store_path ? store_path : "");
+            if (anchor_path) z5d_anchor_close(&anchors);
+            return 1;
+        }
+    }
+    int listen_fd = unix_path ? listen_unix(unix_path) : listen_tcp(bind_addr, tcp_port);
+    if (listen_fd < 0) {
+        z5d_cache_close(g_cache);
+        if (anchor_path) z5d_anchor_close(&anchors);
+        return 1;
+    }
+    /* Workers all poll the socket; whoever loses the accept race must not block */
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+
+    /* Signals go to the main thread only; writes to closed peers fail with EPIPE */
+    signal(SIGPIPE, SIG_IGN);
+    sigset_t sigs;
+    sigemptyset(&sigs);
+    sigaddset(&sigs, SIGINT);
+    sigaddset(&sigs, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.precision = precision;
+    config.threads = threads;
+    config.anchors = anchor_path ? &anchors : NULL;
+    config.cache = g_cache;
+
+    g_workers = calloc((size_t)workers, sizeof(worker_t));
+    if (!g_workers) return 1;
+    g_num_workers = workers;
+    g_start_ms = mono_ms();
+
+    /* Warm each context: workspace and constants at the default precision */
+    mpz_t warm_n, warm_p;
+    mpz_init_set_str(warm_n, "100000000000000000003", 10);
+    mpz_init(warm_p);
+    int started = 0;
+    for (int i = 0; i < workers; i++) {
+        worker_t* w = &g_workers[i];
+        w->config = &config;
+        w->listen_fd = listen_fd;
+        w->verbose = verbose;
+        z5d_ctx_init(&w->ctx, &config);
+        w->ctx.config.cache = NULL;   /* warm the context, not the cache */
+        z5d_predict_nth_prime_mpz_big_ctx(&w->ctx, warm_p, warm_n);
+        w->ctx.config.cache = g_cache;
+        z5d_ctx_reset_stats(&w->ctx);
+        pthread_mutex_init(&w->lock, NULL);
+        if (pthread_create(&w->tid, NULL, worker_main, w) != 0) {
+            z5d_ctx_clear(&w->ctx);
+            pthread_mutex_destroy(&w->lock);
+            break;
+        }
+        w->started = 1;
+        started++;
+    }
+    mpz_clears(warm_n, warm_p, NULL);
+    if (started == 0) {
+        fprintf(stderr, "Error: cannot start workers\n");
+        return 1;
+    }
+    fprintf(stderr, "z5d_server: listening on %s%s%s with %d workers\n",
+            unix_path ? unix_path : bind_addr, unix_path ? "" : ":", unix_path ? "" : tcp_port,
+            started);
+
+    int sig = 0;
+    sigwait(&sigs, &sig);
+    g_stop = 1;
+    fprintf(stderr, "z5d_server: signal %d, shutting down\n", sig);
+
+    for (int i = 0; i < workers; i++) {
+        if (!g_workers[i].started) continue;
+        pthread_join(g_workers[i].tid, NULL);
+    }
+    for (int i = 0; i < workers; i++) {
+        if (!g_workers[i].started) continue;
+        z5d_ctx_clear(&g_workers[i].ctx);
+        pthread_mutex_destroy(&g_workers[i].lock);
+    }
+    close(listen_fd);
+    if (unix_path) unlink(unix_path);
+    free(g_workers);
+    z5d_config_clear(&config);
+    z5d_cache_close(g_cache);
+    if (anchor_path) z5d_anchor_close(&anchors);
+    z5d_cleanup();
+    return 0;
+}
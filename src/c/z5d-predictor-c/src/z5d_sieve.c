@@ -0,0 +1,321 @@
+/**
+ * Z5D Refinement Sieve
+ * ====================
+ *
+ * Segmented small-prime sieve over the odd numbers past a start value.
+ * Each segment spans about 2 ln x integers, one expected prime gap, and is
+ * marked with every table prime up to a depth chosen from the size of x.
+ * Surviving candidates are tested in increasing order, so the first probable
+ * prime found is the same one mpz_nextprime(start - 1) returns. The
+ * parallel variant spreads small chunks of the same window over a set of
+ * threads and returns the same prime. Both check an optional stop flag
+ * before each probable-prime test, the unit of work that dominates at big
+ * sizes, so an asynchronous job can be cancelled mid-search.
+ *
+ * @file z5d_sieve.c
+ * @version 1.0
+ */
+
+#include "z5d_sieve.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+void z5d_sieve_init(z5d_sieve_t* sieve, uint32_t limit) {
+    memset(sieve, 0, sizeof(*sieve));
+    sieve->limit = limit;
+    mpz_init(sieve->base);
+    mpz_init(sieve->cand);
+}
+
+void z5d_sieve_clear(z5d_sieve_t* sieve) {
+    free(sieve->primes);
+    free(sieve->offsets);
+    free(sieve->window);
+    mpz_clear(sieve->base);
+    mpz_clear(sieve->cand);
+    memset(sieve, 0, sizeof(*sieve));
+}
+
+/* Odd primes 3..limit by a plain Eratosthenes sieve over the odd numbers. */
+static int sieve_build_table(z5d_sieve_t* sieve) {
+    uint32_t limit = sieve->limit;
+    size_t slots = (size_t)limit / 2 + 1;     /* slot i stands for 2i + 1 */
+    unsigned char* comp = calloc(slots, 1);
+    if (!comp) return -1;
+    size_t count = 0;
+    for (size_t i = 1; i < slots; i++) {
+        if (comp[i]) continue;
+        uint64_t p = 2 * i + 1;
+        count++;
+        for (uint64_t j = (p * p) / 2; j < slots; j += p) comp[j] = 1;
+    }
+
+    sieve->primes = malloc(count * sizeof(*sieve->primes));
+    sieve->offsets = malloc(count * sizeof(*sieve->offsets));
+    if (!sieve->primes || !sieve->offsets) {
+        free(comp);
+        return -1;
+    }
+    size_t k = 0;
+    for (size_t i = 1; i < slots; i++) {
+        if (!comp[i]) sieve->primes[k++] = (uint32_t)(2 * i + 1);
+    }
+    sieve->num_primes = count;
+    free(comp);
+    return 0;
+}
+
+/*
+ * Sieve depth for candidates of the given size. A table prime p removes a
+ * fraction 1/p of the survivors for one mpz_fdiv_ui per segment, while a
+ * probable-prime test costs roughly bits^2.6 limb operations; past about
+ * bits^2 / 4 the division work outweighs the tests it saves.
+ */
+static size_t sieve_depth(const z5d_sieve_t* sieve, size_t bits) {
+    uint64_t depth = (uint64_t)bits * bits / 4;
+    if (depth > sieve->limit) depth = sieve->limit;
+    size_t lo = 0, hi = sieve->num_primes;   /* count of primes <= depth */
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (sieve->primes[mid] <= depth) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+/* 1 once the owner of sieve->stop asked the search to give up */
+static inline int sieve_stop_requested(const int* stop) {
+    return stop && __atomic_load_n(stop, __ATOMIC_RELAXED);
+}
+
+static int sieve_reserve_window(z5d_sieve_t* sieve, size_t bits) {
+    size_t words = (bits + 63) / 64;
+    if (words <= sieve->window_words) return 0;
+    uint64_t* w = realloc(sieve->window, words * sizeof(*w));
+    if (!w) return -1;
+    sieve->window = w;
+    sieve->window_words = words;
+    return 0;
+}
+
+/*
+ * Shared setup: builds the table on first use, picks depth and segment size,
+ * sets base to the first odd number >= start and offsets[j] to the index of
+ * the first odd multiple of primes[j] at or past base, i.e. base + 2i == 0
+ * (mod p) with i = -r / 2 = (p - r) * (p + 1) / 2. Returns -1 on allocation
+ * failure.
+ */
+static int sieve_prepare(z5d_sieve_t* sieve, const mpz_t start, size_t* depth_out,
+                         size_t* seg_out) {
+    size_t bits = mpz_sizeinbase(start, 2);
+    sieve->stopped = 0;
+
+    if (!sieve->primes && sieve->limit >= 3 && sieve_build_table(sieve) != 0) {
+        sieve->limit = 0;   /* out of memory: search unsieved */
+    }
+    size_t depth = sieve->primes ? sieve_depth(sieve, bits) : 0;
+
+    /* One segment holds ln x odd candidates (2 ln x integers), at least 256 */
+    size_t seg = (size_t)((double)bits * 0.69314718055994530942) + 1;
+    seg = (seg + 63) & ~(size_t)63;
+    if (seg < 256) seg = 256;
+    if (sieve_reserve_window(sieve, seg) != 0) return -1;
+
+    mpz_set(sieve->base, start);
+    if (mpz_even_p(sieve->base)) mpz_add_ui(sieve->base, sieve->base, 1);
+
+    for (size_t j = 0; j < depth; j++) {
+        uint64_t p = sieve->primes[j];
+        uint64_t r = mpz_fdiv_ui(sieve->base, (unsigned long)p);
+        sieve->offsets[j] = (uint32_t)(r == 0 ? 0 : ((p - r) * ((p + 1) / 2)) % p);
+    }
+    *depth_out = depth;
+    *seg_out = seg;
+    return 0;
+}
+
+uint64_t z5d_sieve_next_prime(z5d_sieve_t* sieve, mpz_t out, const mpz_t start) {
+    uint64_t tests = 0;
+    size_t depth, seg;
+    if (sieve_prepare(sieve, start, &depth, &seg) != 0) {
+        mpz_sub_ui(sieve->cand, start, 1);
+        mpz_nextprime(out, sieve->cand);
+        return 0;
+    }
+
+    for (;;) {
+        uint64_t* w = sieve->window;
+        memset(w, 0, seg / 8);
+        for (size_t j = 0; j < depth; j++) {
+            uint32_t p = sieve->primes[j];
+            size_t i = sieve->offsets[j];
+            for (; i < seg; i += p) w[i >> 6] |= 1ULL << (i & 63);
+            sieve->offsets[j] = (uint32_t)(i - seg);
+        }
+
+        for (size_t word = 0; word < seg / 64; word++) {
+            uint64_t alive = ~w[word];
+            while (alive) {
+                size_t i = word * 64 + (size_t)__builtin_ctzll(alive);
+                alive &= alive - 1;
+                if (sieve_stop_requested(sieve->stop)) {
+                    sieve->stopped = 1;
+                    return tests;
+                }
+                mpz_add_ui(sieve->cand, sieve->base, 2 * (unsigned long)i);
+                tests++;
+                if (mpz_probab_prime_p(sieve->cand, Z5D_SIEVE_MR_REPS)) {
+                    mpz_set(out, sieve->cand);
+                    return tests;
+                }
+            }
+        }
+        mpz_add_ui(sieve->base, sieve->base, 2 * (unsigned long)seg);
+    }
+}
+
+uint64_t z5d_sieve_count_survivors(z5d_sieve_t* sieve, const mpz_t start, const mpz_t end) {
+    size_t depth, seg;
+    if (mpz_cmp(end, start) < 0 || sieve_prepare(sieve, start, &depth, &seg) != 0) return 0;
+    if (mpz_cmp(end, sieve->base) < 0) return 0;
+    /* Odd candidates base, base + 2, ..., through end */
+    mpz_sub(sieve->cand, end, sieve->base);
+    mpz_fdiv_q_2exp(sieve->cand, sieve->cand, 1);
+    uint64_t left = (uint64_t)mpz_get_ui(sieve->cand) + 1;
+
+    uint64_t count = 0;
+    while (left > 0) {
+        uint64_t* w = sieve->window;
+        memset(w, 0, seg / 8);
+        for (size_t j = 0; j < depth; j++) {
+            uint32_t p = sieve->primes[j];
+            size_t i = sieve->offsets[j];
+            for (; i < seg; i += p) w[i >> 6] |= 1ULL << (i & 63);
+            sieve->offsets[j] = (uint32_t)(i - seg);
+        }
+        size_t span = left < seg ? (size_t)left : seg;
+        for (size_t word = 0; word * 64 < span; word++) {
+            uint64_t alive = ~w[word];
+            if (span - word * 64 < 64) alive &= (1ULL << (span - word * 64)) - 1;
+            count += (uint64_t)__builtin_popcountll(alive);
+        }
+        left -= span;
+    }
+    return count;
+}
+
+/* --------- Parallel search --------- */
+
+/*
+ * Chunk c covers the odd candidates base + 2i, i in [c*CHUNK, (c+1)*CHUNK),
+ * and worker t takes chunks t, t + T, t + 2T, ... Small chunks keep every
+ * worker busy even though the prime usually sits in the first few hundred
+ * candidates. best holds the lowest candidate index confirmed prime so far;
+ * a worker stops at the first index >= best, so every index below the final
+ * best has been tested and rejected by someone.
+ */
+typedef struct {
+    const z5d_sieve_t* sieve;
+    size_t depth;
+    int id, threads;
+    _Atomic uint64_t* best;
+    uint64_t tests;
+    int stopped;             /* Gave up on sieve->stop */
+} sieve_worker_t;
+
+static void atomic_min_u64(_Atomic uint64_t* target, uint64_t value) {
+    uint64_t cur = atomic_load(target);
+    while (value < cur && !atomic_compare_exchange_weak(target, &cur, value)) {
+    }
+}
+
+static void* sieve_worker_run(void* p) {
+    sieve_worker_t* wk = (sieve_worker_t*)p;
+    const z5d_sieve_t* sieve = wk->sieve;
+    uint64_t w[Z5D_SIEVE_PARALLEL_CHUNK / 64];
+    mpz_t cand;
+    mpz_init(cand);
+
+    for (uint64_t c = (uint64_t)wk->id;; c += (uint64_t)wk->threads) {
+        uint64_t lo = c * Z5D_SIEVE_PARALLEL_CHUNK;
+        if (lo >= atomic_load(wk->best)) break;
+
+        memset(w, 0, sizeof(w));
+        for (size_t j = 0; j < wk->depth; j++) {
+            uint32_t prime = sieve->primes[j];
+            uint32_t m = (uint32_t)(lo % prime);
+            uint32_t i0 = sieve->offsets[j];
+            size_t i = (i0 >= m) ? i0 - m : i0 + prime - m;
+            for (; i < Z5D_SIEVE_PARALLEL_CHUNK; i += prime) w[i >> 6] |= 1ULL << (i & 63);
+        }
+
+        for (size_t word = 0; word < Z5D_SIEVE_PARALLEL_CHUNK / 64; word++) {
+            uint64_t alive = ~w[word];
+            while (alive) {
+                uint64_t g = lo + word * 64 + (uint64_t)__builtin_ctzll(alive);
+                alive &= alive - 1;
+                if (g >= atomic_load(wk->best)) goto done;
+                if (sieve_stop_requested(sieve->stop)) {
+                    wk->stopped = 1;
+                    goto done;
+                }
+                mpz_add_ui(cand, sieve->base, 2 * (unsigned long)g);
+                wk->tests++;
+                if (mpz_probab_prime_p(cand, Z5D_SIEVE_MR_REPS)) {
+                    atomic_min_u64(wk->best, g);
+                    goto done;   /* everything left in this stream is larger */
+                }
+            }
+        }
+    }
+done:
+    mpz_clear(cand);
+    return NULL;
+}
+
+uint64_t z5d_sieve_next_prime_parallel(z5d_sieve_t* sieve, mpz_t out, const mpz_t start,
+                                       int threads) {
+    if (threads > Z5D_SIEVE_MAX_THREADS) threads = Z5D_SIEVE_MAX_THREADS;
+    if (threads <= 1) return z5d_sieve_next_prime(sieve, out, start);
+
+    size_t depth, seg;
+    if (sieve_prepare(sieve, start, &depth, &seg) != 0) {
+        return z5d_sieve_next_prime(sieve, out, start);
+    }
+
+    _Atomic uint64_t best = UINT64_MAX;
+    sieve_worker_t workers[Z5D_SIEVE_MAX_THREADS];
+    pthread_t tids[Z5D_SIEVE_MAX_THREADS];
+    int started[Z5D_SIEVE_MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        workers[t].sieve = sieve;
+        workers[t].depth = depth;
+        workers[t].id = t;
+        workers[t].threads = threads;
+        workers[t].best = &best;
+        workers[t].tests = 0;
+        workers[t].stopped = 0;
+    }
+    for (int t = 1; t < threads; t++) {
+        started[t] = (pthread_create(&tids[t], NULL, sieve_worker_run, &workers[t]) == 0);
+    }
+
+    /* Worker 0 runs here, then any stream whose thread failed to start */
+    sieve_worker_run(&workers[0]);
+    for (int t = 1; t < threads; t++) {
+        if (!started[t]) sieve_worker_run(&workers[t]);
+    }
+
+    uint64_t tests = workers[0].tests;
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(tids[t], NULL);
+        tests += workers[t].tests;
+    }
+    /* A stopped stream may have left an index below best untested */
+    for (int t = 0; t < threads; t++) sieve->stopped |= workers[t].stopped;
+    if (sieve->stopped) return tests;
+
+    mpz_add_ui(out, sieve->base, 2 * (unsigned long)atomic_load(&best));
+    return tests;
+}
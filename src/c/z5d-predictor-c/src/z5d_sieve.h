@@ -0,0 +1,89 @@
+/**
+ * Z5D Refinement Sieve - Internal Header
+ * ======================================
+ *
+ * Forward search for the next probable prime: a bit-packed, odd-only window
+ * past the start value is presieved by a table of small primes, and only the
+ * survivors reach the GMP BPSW / Miller-Rabin test.
+ *
+ * @file z5d_sieve.h
+ * @version 1.0
+ */
+
+#ifndef Z5D_SIEVE_H
+#define Z5D_SIEVE_H
+
+#include "../include/z5d_predictor.h"
+
+/* Below this size GMP's own mpz_nextprime sieve is already cheaper */
+#define Z5D_SIEVE_MIN_BITS 128
+/* Below this size one probable-prime test is too cheap to spread over threads */
+#define Z5D_SIEVE_PARALLEL_MIN_BITS 512
+/* Odd candidates per chunk handed to a worker (multiple of 64) */
+#define Z5D_SIEVE_PARALLEL_CHUNK 128
+/* Upper bound on refinement worker threads */
+#define Z5D_SIEVE_MAX_THREADS 64
+/* Repetitions for mpz_probab_prime_p (BPSW plus reps - 24 Miller-Rabin
+   rounds), matching what mpz_nextprime uses */
+#define Z5D_SIEVE_MR_REPS 25
+
+/**
+ * Initialize an empty sieve. The small-prime table is built on first use.
+ *
+ * @param sieve Sieve to initialize
+ * @param limit Small primes up to this bound take part in the presieve
+ */
+void z5d_sieve_init(z5d_sieve_t* sieve, uint32_t limit);
+
+/**
+ * Release the tables and scratch integers of a sieve.
+ */
+void z5d_sieve_clear(z5d_sieve_t* sieve);
+
+/**
+ * Smallest probable prime >= start. out and start may alias.
+ *
+ * Expects start >= 2^(Z5D_SIEVE_MIN_BITS - 1); smaller values belong to
+ * mpz_nextprime.
+ *
+ * With sieve->stop set, the flag is read before every probable-prime test;
+ * once it is nonzero the search returns with sieve->stopped = 1 and out
+ * unchanged.
+ *
+ * @param sieve Sieve (tables are built on first call)
+ * @param out Output prime
+ * @param start Lower bound of the search
+ * @return Number of probable-prime tests run on sieve survivors
+ */
+uint64_t z5d_sieve_next_prime(z5d_sieve_t* sieve, mpz_t out, const mpz_t start);
+
+/**
+ * Same result as z5d_sieve_next_prime, searched by up to threads workers.
+ * Candidates are dealt out in interleaved chunks; workers stop as soon as a
+ * lower-indexed probable prime has been confirmed, so the answer is the
+ * smallest probable prime >= start. The sieve itself is read-only while the
+ * workers run; threads <= 1 runs the serial search. Every worker honours
+ * sieve->stop as the serial search does.
+ *
+ * @param sieve Sieve (tables are built on first call)
+ * @param out Output prime
+ * @param start Lower bound of the search
+ * @param threads Worker count, capped at Z5D_SIEVE_MAX_THREADS
+ * @return Number of probable-prime tests run over all workers
+ */
+uint64_t z5d_sieve_next_prime_parallel(z5d_sieve_t* sieve, mpz_t out, const mpz_t start,
+                                       int threads);
+
+/**
+ * Odd candidates in [start, end] left by the presieve at the depth the
+ * searches use for start. Gives the survivor count of a parallel search,
+ * whose workers test past the prime. Reuses the search window and offsets.
+ *
+ * @param sieve Sieve (tables are built on first call)
+ * @param start Lower bound, as passed to the search
+ * @param end Upper bound (the prime found)
+ * @return Number of survivors, 0 if end < start or on allocation failure
+ */
+uint64_t z5d_sieve_count_survivors(z5d_sieve_t* sieve, const mpz_t start, const mpz_t end);
+
+#endif /* Z5D_SIEVE_H */
@@ -0,0 +1,186 @@
+/**
+ * Z5D nth-Prime Predictor - Anchor Index Test
+ * ===========================================
+ *
+ * Builds a small anchor index, maps it back and checks sampled anchors
+ * against the exact mode, exact p_n walked from the anchors against the pi()-based
+ * exact mode (both walk directions), the big-n entry point with anchors
+ * enabled (exact and fast below the walked range too), and that damaged
+ * files are rejected.
+ *
+ * @file test_anchor.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include "../src/z5d_exact.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <gmp.h>
+
+#define STRIDE 8192ULL
+#define MAX_N 4000000ULL
+#define FIRST_WALKED_N 664579ULL   /* below this the exact mode just sieves */
+#define SMALL_CALLS 2000
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+/* Copy the first len bytes of src to dst, optionally flipping byte flip */
+static int write_damaged(const char* src, const char* dst, size_t len, long flip) {
+    FILE* in = fopen(src, "rb");
+    FILE* out = fopen(dst, "wb");
+    if (!in || !out) {
+        if (in) fclose(in);
+        if (out) fclose(out);
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        int c = fgetc(in);
+        if (c == EOF) break;
+        if ((long)i == flip) c ^= 0xff;
+        fputc(c, out);
+    }
+    fclose(in);
+    fclose(out);
+    return 0;
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Anchor Index Test\n");
+    printf("===========================================\n\n");
+
+    int passed = 0, total = 0, ok;
+    char path[] = "/tmp/z5d_anchor_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return 1;
+    close(fd);
+    char damaged[sizeof(path) + 8];
+    snprintf(damaged, sizeof(damaged), "%s.bad", path);
+
+    /* 1. Build and map */
+    z5d_anchor_index_t index;
+    ok = (z5d_anchor_build(path, STRIDE, MAX_N, NULL, NULL) == 0) &&
+         (z5d_anchor_open(&index, path) == 0) &&
+         index.stride == STRIDE && index.count == MAX_N / STRIDE;
+    printf("Build and map: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+    if (!ok) return 1;
+
+    /* 2. Anchors equal p_n from the exact mode (no index on the default context) */
+    ok = 1;
+    uint64_t an, ap, p;
+    for (uint64_t i = 1; i <= index.count; i += 7) {
+        if (z5d_anchor_nearest(&index, i * STRIDE, &an, &ap) != 0 || an != i * STRIDE ||
+            z5d_nth_prime_exact(an, &p) != 0 || ap != p) {
+            ok = 0;
+        }
+    }
+    ok &= (z5d_anchor_nearest(&index, STRIDE + STRIDE / 2, &an, &ap) == 0 && an == 2 * STRIDE);
+    ok &= (z5d_anchor_nearest(&index, 1, &an, &ap) == 0 && an == STRIDE);
+    ok &= (z5d_anchor_nearest(&index, 0, &an, &ap) != 0);
+    ok &= (z5d_anchor_nearest(&index, index.count * STRIDE + STRIDE, &an, &ap) != 0);
+    printf("Anchor values: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Exact p_n from the anchors vs. the pi()-based search */
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.anchors = &index;
+    z5d_ctx_t with, without;
+    z5d_ctx_init(&with, &config);
+    z5d_ctx_init(&without, NULL);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 2357);
+    ok = 1;
+    for (int i = 0; i < 40; i++) {
+        uint64_t n = FIRST_WALKED_N + gmp_urandomm_ui(rs, MAX_N - FIRST_WALKED_N);
+        if (i == 0) n = MAX_N - MAX_N % STRIDE;            /* an anchor itself */
+        if (i == 1) n = MAX_N - MAX_N % STRIDE + STRIDE / 2; /* walk past the last one */
+        uint64_t p1 = 0, p2 = 0;
+        z5d_nth_prime_exact_ctx(&with, n, &p1);
+        z5d_nth_prime_exact_ctx(&without, n, &p2);
+        if (p1 != p2 || p1 == 0) {
+            printf("  n = %llu: anchors %llu, pi() %llu\n", (unsigned long long)n,
+                   (unsigned long long)p1, (unsigned long long)p2);
+            ok = 0;
+        }
+    }
+    ok &= (with.stats.anchor_hits == 40 && with.stats.pi_evaluations == 0);
+    printf("Exact p_n from anchors: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Big-n entry point: exact inside the index, closed form outside */
+    ok = 1;
+    mpz_t n_mpz, got, want;
+    mpz_inits(n_mpz, got, want, NULL);
+    static const uint64_t big_inputs[] = {1234567ULL, 3999999ULL, 8000000ULL};
+    for (size_t i = 0; i < sizeof(big_inputs) / sizeof(big_inputs[0]); i++) {
+        mpz_set_ui(n_mpz, big_inputs[i]);
+        z5d_predict_nth_prime_mpz_big_ctx(&with, got, n_mpz);
+        if (big_inputs[i] <= MAX_N) {
+            p = 0;
+            z5d_nth_prime_exact_ctx(&without, big_inputs[i], &p);
+            mpz_set_ui(want, p);
+        } else {
+            z5d_predict_nth_prime_mpz_big_ctx(&without, want, n_mpz);
+        }
+        ok &= (mpz_cmp(got, want) == 0);
+    }
+    printf("Big-n with anchors: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. Small n with anchors: exact, and read from a table rather than
+          sieved per call (that took milliseconds each) */
+    ok = 1;
+    static const uint64_t small_inputs[] = {1ULL, 2ULL, 11ULL, 123457ULL, 600001ULL, 664578ULL};
+    for (size_t i = 0; i < sizeof(small_inputs) / sizeof(small_inputs[0]); i++) {
+        mpz_set_ui(n_mpz, small_inputs[i]);
+        z5d_predict_nth_prime_mpz_big_ctx(&with, got, n_mpz);
+        ok &= (mpz_cmp_ui(got, z5d_exact_nth_prime_small(small_inputs[i])) == 0);
+    }
+    double t0 = now_ms();
+    for (int i = 0; i < SMALL_CALLS; i++) {
+        mpz_set_ui(n_mpz, 100003ULL + 271ULL * (uint64_t)i);
+        z5d_predict_nth_prime_mpz_big_ctx(&with, got, n_mpz);
+    }
+    double small_ms = now_ms() - t0;
+    ok &= mpz_probab_prime_p(got, 25) > 0 && small_ms < 200.0;
+    mpz_clears(n_mpz, got, want, NULL);
+    printf("Small n with anchors (%d calls in %.1f ms): %s\n", SMALL_CALLS, small_ms,
+           ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 6. Truncated file, bad magic, bad version */
+    z5d_anchor_index_t bad;
+    ok = 1;
+    write_damaged(path, damaged, index.map_size - 4, -1);
+    ok &= (z5d_anchor_open(&bad, damaged) != 0);
+    write_damaged(path, damaged, index.map_size, 0);
+    ok &= (z5d_anchor_open(&bad, damaged) != 0);
+    write_damaged(path, damaged, index.map_size, 8);
+    ok &= (z5d_anchor_open(&bad, damaged) != 0);
+    ok &= (z5d_anchor_open(&bad, "/nonexistent/anchors.z5d") != 0);
+    printf("Damaged files rejected: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    gmp_randclear(rs);
+    z5d_ctx_clear(&with);
+    z5d_ctx_clear(&without);
+    z5d_config_clear(&config);
+    z5d_anchor_close(&index);
+    unlink(damaged);
+    unlink(path);
+    z5d_cleanup();
+
+    printf("\n===========================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
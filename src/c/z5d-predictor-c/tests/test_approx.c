@@ -0,0 +1,149 @@
+/**
+ * Z5D Bulk Approximate Predictor Test
+ * ===================================
+ *
+ * Checks every SIMD kernel this CPU runs against the MPFR closed form
+ * within the documented bound, on every n up to 2 * 10^4 and log-spaced
+ * samples to 2^64 - 1; that kernels agree, AUTO is the picked kernel, and
+ * array tails give the same values as full vectors; and that n < 5 and
+ * unavailable kernels are refused.
+ *
+ * @file test_approx.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define DENSE_MAX 20000
+#define SAMPLES 4096
+#define COUNT (DENSE_MAX - 5 + SAMPLES)
+
+static const z5d_approx_kernel_t KERNELS[] = { Z5D_APPROX_GENERIC, Z5D_APPROX_AVX2,
+                                               Z5D_APPROX_AVX512, Z5D_APPROX_NEON };
+#define NUM_KERNELS (sizeof(KERNELS) / sizeof(KERNELS[0]))
+
+/* Documented bound on |approx / exact - 1| */
+static double bound(uint64_t n) {
+    return n >= 100 ? 0x1p-50 : 0x1p-48;
+}
+
+int main(void) {
+    printf("Z5D Bulk Approximate Predictor Test\n");
+    printf("===================================\n\n");
+    printf("Kernel: %s\n\n", z5d_approx_kernel_name(Z5D_APPROX_AUTO));
+
+    int passed = 0, total = 0, ok;
+    uint64_t* n = malloc(COUNT * sizeof(uint64_t));
+    double* exact = malloc(COUNT * sizeof(double));
+    double* err = malloc(COUNT * sizeof(double));   /* exact - double(exact), for the ratio */
+    double* out = malloc(COUNT * sizeof(double));
+    double* first = malloc(COUNT * sizeof(double));
+    if (!n || !exact || !err || !out || !first) return 1;
+
+    size_t count = 0;
+    for (uint64_t k = 5; k < DENSE_MAX; k++) n[count++] = k;
+    for (int i = 0; i < SAMPLES; i++) {
+        /* 2^14 .. 2^64 - 1, log-spaced with a varying low part */
+        double e = 14.0 + 50.0 * (double)i / SAMPLES;
+        uint64_t v = e >= 64.0 ? ~0ULL : (uint64_t)ldexp(1.0, (int)e);
+        v += (v >> 3) * (uint64_t)(i % 7) + (uint64_t)i * 2654435761ULL % 1000003ULL;
+        n[count++] = i == SAMPLES - 1 ? ~0ULL : v;
+    }
+
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    mpz_t nz;
+    mpz_init(nz);
+    mpfr_t v, t;
+    mpfr_inits2(256, v, t, (mpfr_ptr)0);
+    for (size_t i = 0; i < count; i++) {
+        mpz_set_ui(nz, n[i]);
+        z5d_closed_form_ctx(&ctx, v, nz);
+        exact[i] = mpfr_get_d(v, MPFR_RNDN);
+        mpfr_set_prec(t, mpfr_get_prec(v));
+        mpfr_sub_d(t, v, exact[i], MPFR_RNDN);
+        err[i] = mpfr_get_d(t, MPFR_RNDN);
+    }
+
+    /* 1. Each kernel within the bound */
+    ok = 1;
+    int kernels_run = 0;
+    for (size_t k = 0; k < NUM_KERNELS; k++) {
+        if (!z5d_approx_kernel_supported(KERNELS[k])) continue;
+        kernels_run++;
+        ok &= z5d_predict_approx_u64_with(KERNELS[k], n, out, count) == 0;
+        double worst = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            double rel = fabs(((out[i] - exact[i]) - err[i]) / exact[i]);
+            ok &= rel <= bound(n[i]);
+            if (rel > worst) worst = rel;
+        }
+        printf("  %-8s worst %.2f units of 2^-53\n", z5d_approx_kernel_name(KERNELS[k]),
+               worst / 0x1p-53);
+    }
+    ok &= kernels_run >= 1;
+    printf("Kernels vs. MPFR closed form: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. Kernels agree; AUTO is the picked kernel bit for bit */
+    ok = z5d_predict_approx_u64_with(Z5D_APPROX_GENERIC, n, first, count) == 0;
+    for (size_t k = 0; k < NUM_KERNELS; k++) {
+        if (!z5d_approx_kernel_supported(KERNELS[k])) continue;
+        z5d_predict_approx_u64_with(KERNELS[k], n, out, count);
+        for (size_t i = 0; i < count; i++) {
+            ok &= fabs(out[i] - first[i]) <= 2.0 * bound(n[i]) * exact[i];
+        }
+    }
+    z5d_predict_approx_u64_with(z5d_approx_kernel(), n, first, count);
+    ok &= z5d_predict_approx_u64(n, out, count) == 0 &&
+          memcmp(out, first, count * sizeof(double)) == 0;
+    printf("Kernels agree: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Short arrays and tails match full vectors */
+    ok = 1;
+    for (size_t k = 0; k < NUM_KERNELS; k++) {
+        if (!z5d_approx_kernel_supported(KERNELS[k])) continue;
+        z5d_predict_approx_u64_with(KERNELS[k], n, first, 64);
+        for (size_t len = 0; len <= 19; len++) {
+            for (size_t i = 0; i < 24; i++) out[i] = -1.0;
+            ok &= z5d_predict_approx_u64_with(KERNELS[k], n + 3, out, len) == 0;
+            for (size_t i = 0; i < len; i++) ok &= out[i] == first[i + 3];
+            ok &= out[len] == -1.0;
+        }
+    }
+    printf("Tails: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. n < 5 gives NaN and -1, the rest is still filled; bad arguments */
+    uint64_t mixed[6] = { 0, 1000, 4, 5, 1000000, 3 };
+    ok = z5d_predict_approx_u64(mixed, out, 6) == -1;
+    ok &= isnan(out[0]) && isnan(out[2]) && isnan(out[5]);
+    ok &= fabs(out[1] / 7856.2459113844079 - 1.0) < 1e-14 && out[3] > 0.7 && out[3] < 0.8;
+    ok &= z5d_predict_approx_u64(NULL, out, 1) == -1 && z5d_predict_approx_u64(NULL, NULL, 0) == 0;
+    for (size_t k = 0; k < NUM_KERNELS; k++) {
+        if (!z5d_approx_kernel_supported(KERNELS[k])) {
+            ok &= z5d_predict_approx_u64_with(KERNELS[k], mixed + 1, out, 1) == -1;
+        }
+    }
+    printf("Small n and unsupported kernels: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    mpfr_clears(v, t, (mpfr_ptr)0);
+    mpz_clear(nz);
+    z5d_ctx_clear(&ctx);
+    free(n);
+    free(exact);
+    free(err);
+    free(out);
+    free(first);
+    z5d_cleanup();
+
+    printf("\n===================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+/**
+ * Z5D Asynchronous Prediction Test
+ * ================================
+ *
+ * Checks that pooled jobs return the synchronous answers (with and without
+ * a configuration), that a deadline during a 10^1200 refinement yields the
+ * rounded closed form while the search continues, that a cancelled search
+ * ends promptly, that queued jobs are cancelled at once and by
+ * z5d_async_stop, and that the pool restarts after a stop.
+ *
+ * @file test_async.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define JOBS 16
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+/* n = 10^e + i, off the known-value table */
+static void big_n(mpz_t n, unsigned long e, unsigned long i) {
+    mpz_ui_pow_ui(n, 10, e);
+    mpz_add_ui(n, n, i);
+}
+
+int main(void) {
+    printf("Z5D Asynchronous Prediction Test\n");
+    printf("================================\n\n");
+
+    int passed = 0, total = 0, ok;
+    mpz_t n, p, want;
+    mpz_inits(n, p, want, NULL);
+    z5d_job_t* jobs[JOBS];
+
+    ok = z5d_async_start(4) == 0 && z5d_async_start(4) == -1;
+    mpz_set_si(n, -5);
+    ok &= z5d_submit(&jobs[0], n, NULL) == -1 && jobs[0] == NULL;
+    printf("Start and argument checks: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 1. Pooled answers match the synchronous ones */
+    ok = 1;
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.sieve_limit = 0;
+    for (int i = 0; i < JOBS; i++) {
+        big_n(n, 20 + 20 * (unsigned long)i, (unsigned long)i + 1);
+        ok &= z5d_submit(&jobs[i], n, (i & 1) ? &config : NULL) == 0;
+    }
+    z5d_config_clear(&config);
+    for (int i = 0; i < JOBS; i++) {
+        big_n(n, 20 + 20 * (unsigned long)i, (unsigned long)i + 1);
+        z5d_predict_nth_prime_mpz_big(want, n);
+        ok &= z5d_wait_until(jobs[i], NULL, p) == Z5D_JOB_DONE && mpz_cmp(p, want) == 0;
+        ok &= z5d_poll(jobs[i], NULL) == Z5D_JOB_DONE && z5d_cancel(jobs[i]) == 1;
+        z5d_job_release(jobs[i]);
+    }
+    printf("Pooled answers match synchronous: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. Deadline mid-refinement returns the rounded closed form */
+    big_n(n, 1200, 7);
+    z5d_result_t result;
+    z5d_result_init(&result, Z5D_DEFAULT_PRECISION);
+    z5d_predict_nth_prime_big(&result, n);
+    mpfr_get_z(want, result.predicted_prime, MPFR_RNDN);
+    z5d_result_clear(&result);
+
+    ok = z5d_submit(&jobs[0], n, NULL) == 0;
+    struct timespec deadline;
+    int status = Z5D_JOB_PENDING;
+    for (int tries = 0; tries < 1000 && status == Z5D_JOB_PENDING; tries++) {
+        z5d_deadline_after(&deadline, 5);
+        status = z5d_wait_until(jobs[0], &deadline, p);
+    }
+    ok &= status == Z5D_JOB_ESTIMATE && mpz_cmp(p, want) == 0;
+    printf("Deadline returns the estimate: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Cancelling the running search ends it within a few tests */
+    double t0 = now_ms();
+    ok = z5d_cancel(jobs[0]) == 0;
+    ok &= z5d_wait_until(jobs[0], NULL, p) == Z5D_JOB_CANCELLED;
+    double stop_ms = now_ms() - t0;
+    ok &= stop_ms < 1000.0;
+    z5d_job_release(jobs[0]);
+    printf("Running search cancelled in %.1f ms: %s\n", stop_ms, ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Queued jobs: cancelled at once, and all of them by a stop */
+    ok = 1;
+    for (int i = 0; i < JOBS; i++) {
+        big_n(n, 1200, 100 + (unsigned long)i);
+        ok &= z5d_submit(&jobs[i], n, NULL) == 0;
+    }
+    ok &= z5d_cancel(jobs[JOBS - 1]) == 0;
+    ok &= z5d_poll(jobs[JOBS - 1], NULL) == Z5D_JOB_CANCELLED;
+    t0 = now_ms();
+    z5d_async_stop();
+    stop_ms = now_ms() - t0;
+    for (int i = 0; i < JOBS; i++) {
+        ok &= z5d_poll(jobs[i], p) == Z5D_JOB_CANCELLED;
+        z5d_job_release(jobs[i]);
+    }
+    ok &= stop_ms < 2000.0;
+    printf("Queued jobs cancelled, stop in %.1f ms: %s\n", stop_ms, ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. The pool restarts on the next submission; release cancels */
+    big_n(n, 40, 3);
+    z5d_predict_nth_prime_mpz_big(want, n);
+    ok = z5d_submit(&jobs[0], n, NULL) == 0;
+    ok &= z5d_wait_until(jobs[0], NULL, p) == Z5D_JOB_DONE && mpz_cmp(p, want) == 0;
+    z5d_job_release(jobs[0]);
+    big_n(n, 1200, 11);
+    ok &= z5d_submit(&jobs[0], n, NULL) == 0;
+    z5d_job_release(jobs[0]);
+    z5d_async_stop();
+    printf("Restart and release: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    mpz_clears(n, p, want, NULL);
+    z5d_cleanup();
+
+    printf("\n================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
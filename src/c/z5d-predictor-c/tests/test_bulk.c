@@ -0,0 +1,101 @@
+/**
+ * Z5D Packed Buffers Test
+ * =======================
+ *
+ * Checks that packed entries match z5d_predict_nth_prime_mpz_ctx and the
+ * big-n path element for element, that 8-byte entries read back as native
+ * uint64 values, that Z5D_PACKED_U64_WIDTH holds p_n at n = 2^64 - 1, and
+ * that n = 0 and primes too wide for the entry zero only their entries.
+ *
+ * @file test_bulk.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COUNT 64
+
+/* Entry i of a packed buffer as an mpz */
+static void unpack(mpz_t v, const uint8_t* buf, size_t width, size_t i) {
+    mpz_import(v, width, -1, 1, 0, 0, buf + i * width);
+}
+
+int main(void) {
+    printf("Z5D Packed Buffers Test\n");
+    printf("=======================\n\n");
+
+    int passed = 0, total = 0, ok;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    mpz_t want, got, idx;
+    mpz_inits(want, got, idx, NULL);
+
+    uint64_t n[COUNT];
+    for (int i = 0; i < COUNT; i++) n[i] = 1 + (uint64_t)i * 7919ULL * (uint64_t)(i + 1) * 104729ULL;
+    n[COUNT - 1] = ~0ULL;
+
+    /* 1. uint64 indices, full-width entries */
+    uint8_t wide[COUNT * Z5D_PACKED_U64_WIDTH];
+    ok = z5d_predict_nth_prime_packed(&ctx, n, COUNT, wide, Z5D_PACKED_U64_WIDTH) == 0;
+    for (int i = 0; i < COUNT && ok; i++) {
+        ok &= z5d_predict_nth_prime_mpz_ctx(&ctx, want, n[i]) == 0;
+        unpack(got, wide, Z5D_PACKED_U64_WIDTH, (size_t)i);
+        ok &= mpz_cmp(got, want) == 0;
+    }
+    printf("Packed uint64 indices: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. 8-byte entries are native uint64 values; too-wide primes are zeroed */
+    uint64_t narrow[COUNT];
+    ok = z5d_predict_nth_prime_packed(&ctx, n, COUNT, narrow, sizeof(uint64_t)) == -1;
+    for (int i = 0; i < COUNT && ok; i++) {
+        z5d_predict_nth_prime_mpz_ctx(&ctx, want, n[i]);
+        ok &= mpz_fits_ulong_p(want) ? mpz_cmp_ui(want, narrow[i]) == 0 : narrow[i] == 0;
+    }
+    ok &= narrow[0] == 2 && narrow[COUNT - 1] == 0;
+    printf("Native 8-byte entries: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Big indices: 10^30 + i as 16-byte entries */
+    uint8_t big_n[8 * 16], big_out[8 * 24];
+    mpz_t base;
+    mpz_init_set_str(base, "1000000000000000000000000000000", 10);
+    for (int i = 0; i < 8; i++) {
+        mpz_add_ui(idx, base, (unsigned long)i);
+        size_t w = 0;
+        memset(big_n + i * 16, 0, 16);
+        mpz_export(big_n + i * 16, &w, -1, 1, 0, 0, idx);
+    }
+    ok = z5d_predict_nth_prime_packed_big(&ctx, big_n, 16, 8, big_out, 24) == 0;
+    for (int i = 0; i < 8 && ok; i++) {
+        mpz_add_ui(idx, base, (unsigned long)i);
+        ok &= z5d_predict_nth_prime_mpz_big_ctx(&ctx, want, idx) == 0;
+        unpack(got, big_out, 24, (size_t)i);
+        ok &= mpz_cmp(got, want) == 0;
+    }
+    mpz_clear(base);
+    printf("Packed big indices: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. n = 0 zeroes its entry only; bad arguments are refused */
+    uint64_t with_zero[3] = { 10, 0, 100 };
+    uint64_t vals[3] = { 1, 1, 1 };
+    ok = z5d_predict_nth_prime_packed(&ctx, with_zero, 3, vals, 8) == -1;
+    ok &= vals[0] == 29 && vals[1] == 0 && vals[2] == 541;
+    ok &= z5d_predict_nth_prime_packed(&ctx, with_zero, 3, vals, 0) == -1;
+    ok &= z5d_predict_nth_prime_packed(NULL, with_zero, 3, vals, 8) == -1;
+    ok &= z5d_predict_nth_prime_packed(&ctx, NULL, 0, NULL, 8) == 0;
+    printf("Bad entries and arguments: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    mpz_clears(want, got, idx, NULL);
+    z5d_ctx_clear(&ctx);
+    z5d_cleanup();
+
+    printf("\n=======================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/**
+ * Z5D nth-Prime Predictor - Result Cache Test
+ * ===========================================
+ *
+ * Checks that a context with a cache returns the uncached answers and
+ * counts hits and misses, CLOCK eviction (bounded size, second chance for
+ * referenced entries), that a reopened store answers without refining,
+ * that a torn tail is cut off and foreign files are refused, and that
+ * threads sharing one cache get the uncached answers.
+ *
+ * @file test_cache.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <gmp.h>
+
+#define KEYS 12
+#define THREADS 4
+
+/* n = 10^e + i, off the known-value table */
+static void big_n(mpz_t n, unsigned long e, unsigned long i) {
+    mpz_ui_pow_ui(n, 10, e);
+    mpz_add_ui(n, n, i);
+}
+
+/* Uncached answers for 10^40 + 1 .. 10^40 + KEYS */
+static mpz_t want[KEYS];
+
+/* Answers of ctx for the KEYS indices against want[] */
+static int matches(z5d_ctx_t* ctx) {
+    mpz_t n, p;
+    mpz_inits(n, p, NULL);
+    int ok = 1;
+    for (unsigned long i = 0; i < KEYS; i++) {
+        big_n(n, 40, i + 1);
+        ok &= z5d_predict_nth_prime_mpz_big_ctx(ctx, p, n) == 0 && mpz_cmp(p, want[i]) == 0;
+    }
+    mpz_clears(n, p, NULL);
+    return ok;
+}
+
+typedef struct {
+    z5d_cache_t* cache;
+    int ok;
+} worker_arg_t;
+
+static void* worker(void* p) {
+    worker_arg_t* a = (worker_arg_t*)p;
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.cache = a->cache;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, &config);
+    z5d_config_clear(&config);
+    a->ok = 1;
+    for (int round = 0; round < 3; round++) a->ok &= matches(&ctx);
+    z5d_ctx_clear(&ctx);
+    z5d_cleanup();
+    return NULL;
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Result Cache Test\n");
+    printf("===========================================\n\n");
+
+    int passed = 0, total = 0, ok;
+    char path[] = "/tmp/z5d_cache_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return 1;
+    close(fd);
+    unlink(path);   /* z5d_cache_open creates it */
+
+    mpz_t n, p;
+    mpz_inits(n, p, NULL);
+    for (unsigned long i = 0; i < KEYS; i++) {
+        mpz_init(want[i]);
+        big_n(n, 40, i + 1);
+        z5d_predict_nth_prime_mpz_big(want[i], n);
+    }
+
+    /* 1. Cached context: same answers, misses first, then hits */
+    z5d_cache_t* cache;
+    ok = z5d_cache_open(&cache, 1000, NULL) == 0;
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.cache = cache;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, &config);
+    ok &= matches(&ctx) && matches(&ctx);
+    z5d_cache_stats_t st;
+    z5d_cache_get_stats(cache, &st);
+    ok &= ctx.stats.cache_misses == KEYS && ctx.stats.cache_hits == KEYS &&
+          ctx.stats.refinements == KEYS && st.hits == KEYS && st.misses == KEYS &&
+          st.entries == KEYS && st.capacity >= 1000;
+    z5d_predict_nth_prime_mpz_ctx(&ctx, p, 1000000ULL);   /* table hit, not cached */
+    z5d_cache_get_stats(cache, &st);
+    ok &= st.entries == KEYS && ctx.stats.known_hits == 1;
+    z5d_ctx_clear(&ctx);
+    z5d_cache_close(cache);
+    printf("Cached answers and counters: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. CLOCK: bounded size; an entry hit between inserts survives */
+    ok = z5d_cache_open(&cache, Z5D_CACHE_SHARDS * 4, NULL) == 0;
+    mpz_t hot;
+    mpz_init_set_ui(hot, 777);
+    z5d_cache_insert(cache, hot, hot);
+    for (unsigned long i = 1; i <= 2000; i++) {
+        mpz_set_ui(n, 100000 + i);
+        z5d_cache_insert(cache, n, n);
+        ok &= z5d_cache_lookup(cache, p, hot) && mpz_cmp(p, hot) == 0;
+    }
+    mpz_set_ui(n, 100001);
+    ok &= !z5d_cache_lookup(cache, p, n);
+    z5d_cache_get_stats(cache, &st);
+    ok &= st.entries == Z5D_CACHE_SHARDS * 4 && st.evictions == 2001 - st.entries &&
+          st.inserts == 2001;
+    ok &= z5d_cache_insert(cache, n, hot) == 0 && z5d_cache_insert(cache, hot, n) == 0;
+    mpz_set_ui(n, 0);
+    ok &= z5d_cache_insert(cache, n, hot) != 0;
+    mpz_clear(hot);
+    z5d_cache_close(cache);
+    ok &= z5d_cache_open(&cache, 0, NULL) != 0;
+    printf("CLOCK eviction: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Store survives a reopen: every answer is a lookup */
+    ok = z5d_cache_open(&cache, 1000, path) == 0;
+    config.cache = cache;
+    z5d_ctx_init(&ctx, &config);
+    ok &= matches(&ctx);
+    z5d_cache_get_stats(cache, &st);
+    ok &= st.store_appends == KEYS && st.store_entries == KEYS;
+    z5d_ctx_clear(&ctx);
+    z5d_cache_close(cache);
+
+    ok &= z5d_cache_open(&cache, Z5D_CACHE_SHARDS, path) == 0;   /* smaller than the store */
+    config.cache = cache;
+    z5d_ctx_init(&ctx, &config);
+    ok &= matches(&ctx) && matches(&ctx);
+    z5d_cache_get_stats(cache, &st);
+    ok &= ctx.stats.refinements == 0 && ctx.stats.cache_hits == 2 * KEYS &&
+          st.store_entries == KEYS && st.store_appends == 0 && st.store_hits >= KEYS &&
+          st.misses == 0;
+    z5d_ctx_clear(&ctx);
+    z5d_cache_close(cache);
+    printf("Store reopen: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Torn tail is cut off; foreign files are refused */
+    FILE* f = fopen(path, "ab");
+    ok = f != NULL;
+    if (f) {
+        static const unsigned char torn[] = { 5, 0, 0, 0, 9, 0, 0, 0, 1, 2, 3 };
+        fwrite(torn, 1, sizeof(torn), f);
+        fclose(f);
+    }
+    ok &= z5d_cache_open(&cache, 1000, path) == 0;
+    if (ok) {
+        z5d_cache_get_stats(cache, &st);
+        ok &= st.store_entries == KEYS;
+        big_n(n, 300, 7);
+        mpz_set_ui(p, 12345);
+        ok &= z5d_cache_insert(cache, n, p) == 0;   /* appended over the torn record */
+        z5d_cache_close(cache);
+    }
+    ok &= z5d_cache_open(&cache, 1000, path) == 0;
+    if (ok) {
+        z5d_cache_get_stats(cache, &st);
+        ok &= st.store_entries == KEYS + 1 && z5d_cache_lookup(cache, p, n) &&
+              mpz_cmp_ui(p, 12345) == 0;
+        z5d_cache_close(cache);
+    }
+    char foreign[sizeof(path) + 8];
+    snprintf(foreign, sizeof(foreign), "%s.bad", path);
+    f = fopen(foreign, "wb");
+    if (f) {
+        for (int i = 0; i < 100; i++) fputc('x', f);
+        fclose(f);
+    }
+    ok &= z5d_cache_open(&cache, 1000, foreign) != 0;
+    ok &= z5d_cache_open(&cache, 1000, "/nonexistent/dir/store.z5d") != 0;
+    printf("Torn tail and foreign files: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. Threads sharing one cache */
+    ok = z5d_cache_open(&cache, 1000, NULL) == 0;
+    pthread_t tids[THREADS];
+    worker_arg_t args[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        args[i].cache = cache;
+        pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(tids[i], NULL);
+        ok &= args[i].ok;
+    }
+    z5d_cache_get_stats(cache, &st);
+    ok &= st.hits + st.misses == THREADS * 3 * KEYS && st.entries == KEYS;
+    z5d_cache_close(cache);
+    printf("Shared across threads: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    for (unsigned long i = 0; i < KEYS; i++) mpz_clear(want[i]);
+    mpz_clears(n, p, NULL);
+    z5d_config_clear(&config);
+    unlink(path);
+    unlink(foreign);
+    z5d_cleanup();
+
+    printf("\n===========================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/**
+ * Z5D Runtime Calibration Test
+ * ============================
+ *
+ * Checks that the default calibration reproduces the built-in closed form
+ * and keeps the fast tier, that other coefficients move the closed form by
+ * exactly c D + kappa* E and bypass the fast tier and the cache, that
+ * changing ctx.config between calls takes effect and reverts cleanly, and
+ * that malformed strings are refused without touching the config.
+ *
+ * @file test_calibration.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Closed form of ctx at n = 10^e + 7 */
+static void closed_form(z5d_ctx_t* ctx, mpfr_t out, unsigned long e) {
+    mpz_t n;
+    mpz_init(n);
+    mpz_ui_pow_ui(n, 10, e);
+    mpz_add_ui(n, n, 7);
+    z5d_closed_form_ctx(ctx, out, n);
+    mpz_clear(n);
+}
+
+int main(void) {
+    printf("Z5D Runtime Calibration Test\n");
+    printf("============================\n\n");
+
+    int passed = 0, total = 0, ok;
+    z5d_config_t config;
+    z5d_config_init(&config);
+    z5d_ctx_t ctx;
+    mpfr_t base, got, d, e;
+    mpfr_inits2(Z5D_DEFAULT_PRECISION, base, got, d, e, (mpfr_ptr)0);
+
+    /* 1. Default strings are the built-in calibration */
+    ok = z5d_config_default_calibration(&config);
+    ok &= z5d_config_set_calibration(&config, Z5D_DEFAULT_C_CAL, "6.5e-2") == 0;
+    ok &= z5d_config_default_calibration(&config);
+    z5d_ctx_init(&ctx, &config);
+    z5d_result_t r1, r2;
+    z5d_result_init(&r1, Z5D_DEFAULT_PRECISION);
+    z5d_result_init(&r2, Z5D_DEFAULT_PRECISION);
+    ok &= z5d_predict_nth_prime_ctx(&ctx, &r1, 1000000007ULL) == 0 && ctx.stats.fast_hits == 1;
+    z5d_ctx_clear(&ctx);
+    printf("Default calibration: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. F(c, kappa*) - F(default) = (c - c0) D + (kappa* - kappa0) E */
+    z5d_ctx_init(&ctx, NULL);
+    ok = 1;
+    for (unsigned long ex = 6; ex <= 60 && ok; ex += 18) {
+        z5d_config_set_calibration(&ctx.config, Z5D_DEFAULT_C_CAL, Z5D_DEFAULT_KAPPA_STAR);
+        closed_form(&ctx, base, ex);
+        z5d_config_set_calibration(&ctx.config, "1", "0");
+        closed_form(&ctx, d, ex);
+        z5d_config_set_calibration(&ctx.config, "0", "0");
+        closed_form(&ctx, got, ex);
+        mpfr_sub(d, d, got, MPFR_RNDN);                 /* D */
+        z5d_config_set_calibration(&ctx.config, "0", "1");
+        closed_form(&ctx, e, ex);
+        mpfr_sub(e, e, got, MPFR_RNDN);                 /* E */
+
+        ok &= z5d_config_set_calibration(&ctx.config, "-0.0002", "0.07") == 0;
+        ok &= !z5d_config_default_calibration(&ctx.config);
+        closed_form(&ctx, got, ex);
+        mpfr_sub(got, got, base, MPFR_RNDN);
+        mpfr_mul_d(d, d, -0.0002 + 0.00016667, MPFR_RNDN);
+        mpfr_mul_d(e, e, 0.07 - 0.065, MPFR_RNDN);
+        mpfr_add(d, d, e, MPFR_RNDN);
+        mpfr_sub(d, d, got, MPFR_RNDN);
+        mpfr_div(d, d, base, MPFR_RNDN);
+        ok &= fabs(mpfr_get_d(d, MPFR_RNDN)) < 0x1p-40;
+
+        /* Back to the default: same bits as before */
+        z5d_config_set_calibration(&ctx.config, Z5D_DEFAULT_C_CAL, Z5D_DEFAULT_KAPPA_STAR);
+        closed_form(&ctx, got, ex);
+        ok &= mpfr_equal_p(got, base);
+    }
+    z5d_ctx_clear(&ctx);
+    printf("Coefficients move the closed form: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Other coefficients skip the fast tier and the cache */
+    z5d_cache_t* cache = NULL;
+    ok = z5d_cache_open(&cache, 64, NULL) == 0;
+    config.cache = cache;
+    z5d_config_set_calibration(&config, "-0.0002", NULL);
+    z5d_ctx_init(&ctx, &config);
+    ok &= z5d_predict_nth_prime_ctx(&ctx, &r2, 1000000007ULL) == 0 && ctx.stats.fast_hits == 0;
+    ok &= !mpfr_equal_p(r1.predicted_prime, r2.predicted_prime);
+    z5d_result_clear(&r1);
+    z5d_result_clear(&r2);
+    mpz_t n, a, b;
+    mpz_inits(n, a, b, NULL);
+    mpz_ui_pow_ui(n, 10, 30);
+    z5d_predict_nth_prime_mpz_big_ctx(&ctx, a, n);
+    z5d_predict_nth_prime_mpz_big_ctx(&ctx, b, n);
+    ok &= mpz_cmp(a, b) == 0 && ctx.stats.cache_hits == 0 && ctx.stats.cache_misses == 0;
+    mpz_clears(n, a, b, NULL);
+    z5d_ctx_clear(&ctx);
+    config.cache = NULL;
+    z5d_cache_close(cache);
+    printf("Fast tier and cache bypassed: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Malformed strings leave the config alone */
+    z5d_config_set_calibration(&config, "-0.0002", "0.07");
+    const char* bad[] = { "", "-", "1.2.3", "0.07x", "1e", "e5", "--1" };
+    ok = 1;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        ok &= z5d_config_set_calibration(&config, bad[i], NULL) == -1;
+        ok &= z5d_config_set_calibration(&config, "0.5", bad[i]) == -1;
+    }
+    ok &= mpq_cmp_si(config.c_cal, -2, 10000) == 0 && mpq_cmp_si(config.kappa_star, 7, 100) == 0;
+    ok &= z5d_config_set_calibration(&config, "+.5E-3", "7") == 0;
+    ok &= mpq_cmp_si(config.c_cal, 1, 2000) == 0 && mpq_cmp_si(config.kappa_star, 7, 1) == 0;
+    printf("Malformed strings refused: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    mpfr_clears(base, got, d, e, (mpfr_ptr)0);
+    z5d_config_clear(&config);
+    z5d_cleanup();
+
+    printf("\n============================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
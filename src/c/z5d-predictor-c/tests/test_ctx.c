@@ -0,0 +1,101 @@
+/**
+ * Z5D nth-Prime Predictor - Context / Thread Safety Test
+ * ======================================================
+ *
+ * Runs the same predictions serially and from several threads at once, each
+ * thread on its own z5d_ctx_t (with different precisions) or on its default
+ * context, and checks that every thread reproduces the serial answers.
+ *
+ * @file test_ctx.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <mpfr.h>
+
+#define NUM_THREADS 4
+
+static const char* inputs[] = {
+    "12345", "1000000", "987654321", "99999999999",
+    "123456789012345678901234567890", "31415926535897932384626433832795028841971",
+};
+#define NUM_INPUTS (sizeof(inputs) / sizeof(inputs[0]))
+
+static char* expected[NUM_INPUTS];
+
+typedef struct {
+    int id;
+    int use_default_ctx;
+    int mismatches;
+} worker_arg_t;
+
+static void* worker(void* p) {
+    worker_arg_t* arg = (worker_arg_t*)p;
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.precision = Z5D_DEFAULT_PRECISION + 64 * arg->id;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, &config);
+    z5d_config_clear(&config);
+
+    mpz_t prime;
+    mpz_init(prime);
+    for (int rep = 0; rep < 20; rep++) {
+        for (size_t i = 0; i < NUM_INPUTS; i++) {
+            if (arg->use_default_ctx) {
+                z5d_predict_nth_prime_str(prime, inputs[i]);
+            } else {
+                z5d_predict_nth_prime_str_ctx(&ctx, prime, inputs[i]);
+            }
+            char* got = mpz_get_str(NULL, 10, prime);
+            if (strcmp(got, expected[i]) != 0) arg->mismatches++;
+            free(got);
+        }
+    }
+    mpz_clear(prime);
+    z5d_ctx_clear(&ctx);
+    z5d_cleanup();
+    return NULL;
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Context Test\n");
+    printf("======================================\n\n");
+
+    mpz_t prime;
+    mpz_init(prime);
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        z5d_predict_nth_prime_str(prime, inputs[i]);
+        expected[i] = mpz_get_str(NULL, 10, prime);
+    }
+    mpz_clear(prime);
+
+    pthread_t threads[NUM_THREADS];
+    worker_arg_t args[NUM_THREADS];
+    for (int t = 0; t < NUM_THREADS; t++) {
+        args[t].id = t;
+        args[t].use_default_ctx = (t % 2);
+        args[t].mismatches = 0;
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+
+    int passed = 0;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        int ok = (args[t].mismatches == 0);
+        printf("Thread %d (%s context): %s\n", t,
+               args[t].use_default_ctx ? "default" : "own", ok ? "PASS" : "FAIL");
+        passed += ok;
+    }
+
+    for (size_t i = 0; i < NUM_INPUTS; i++) free(expected[i]);
+    z5d_cleanup();
+
+    printf("\n======================================\n");
+    printf("Test Results: %d/%d passed\n", passed, NUM_THREADS);
+    return (passed == NUM_THREADS) ? 0 : 1;
+}
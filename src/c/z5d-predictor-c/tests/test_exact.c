@@ -0,0 +1,148 @@
+/**
+ * Z5D nth-Prime Predictor - Exact Mode Test
+ * =========================================
+ *
+ * Checks z5d_prime_pi against the published pi(10^k) and pi(2^32), against
+ * prime counts of short random intervals (both sides of the sieve / LMO
+ * cut-off), and z5d_nth_prime_exact against the known p_n table and the
+ * identity pi(p_n) = n = pi(p_n - 1) + 1 at random n, and walks up to the
+ * largest 64-bit prime.
+ *
+ * @file test_exact.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include "../src/z5d_exact.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+static const uint64_t pi_powers[] = {
+    4ULL, 25ULL, 168ULL, 1229ULL, 9592ULL, 78498ULL, 664579ULL, 5761455ULL,
+    50847534ULL, 455052511ULL, 4118054813ULL, 37607912018ULL,
+};
+
+static const struct { uint64_t n, p; } nth_known[] = {
+    {1ULL, 2ULL}, {2ULL, 3ULL}, {10ULL, 29ULL}, {1000ULL, 7919ULL},
+    {1000000ULL, 15485863ULL}, {10000000ULL, 179424673ULL},
+    {1000000000ULL, 22801763489ULL}, {10000000000ULL, 252097800623ULL},
+};
+
+/* Primes in (lo, hi] by walking mpz_nextprime */
+static uint64_t count_interval(uint64_t lo, uint64_t hi) {
+    mpz_t p;
+    mpz_init(p);
+    mpz_set_ui(p, lo);
+    uint64_t count = 0;
+    for (mpz_nextprime(p, p); mpz_cmp_ui(p, hi) <= 0; mpz_nextprime(p, p)) count++;
+    mpz_clear(p);
+    return count;
+}
+
+static uint64_t pi_or_max(uint64_t x) {
+    uint64_t count = 0;
+    if (z5d_prime_pi(x, &count) != 0) return UINT64_MAX;
+    return count;
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Exact Mode Test\n");
+    printf("=========================================\n\n");
+
+    int passed = 0, total = 0, ok;
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 7919);
+
+    /* 1. pi(10^k), k = 1..12, and pi(2^32) */
+    ok = 1;
+    uint64_t x = 1;
+    for (size_t k = 0; k < sizeof(pi_powers) / sizeof(pi_powers[0]); k++) {
+        x *= 10;
+        uint64_t got = pi_or_max(x);
+        if (got != pi_powers[k]) {
+            printf("  pi(10^%zu) = %llu, expected %llu\n", k + 1,
+                   (unsigned long long)got, (unsigned long long)pi_powers[k]);
+            ok = 0;
+        }
+    }
+    ok &= (pi_or_max(4294967296ULL) == 203280221ULL);
+    ok &= (pi_or_max(0) == 0 && pi_or_max(1) == 0 && pi_or_max(2) == 1);
+    printf("Published pi(x): %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. pi(hi) - pi(lo) against a direct count, random lo in 10^6..10^11 */
+    ok = 1;
+    for (int i = 0; i < 24; i++) {
+        uint64_t lo = 1000000ULL + gmp_urandomm_ui(rs, 9000000UL);
+        for (int s = 0; s < i / 6; s++) lo *= 10;
+        uint64_t hi = lo + 20000;
+        uint64_t want = count_interval(lo, hi);
+        uint64_t got = pi_or_max(hi) - pi_or_max(lo);
+        if (got != want) {
+            printf("  (%llu, %llu]: %llu primes, expected %llu\n", (unsigned long long)lo,
+                   (unsigned long long)hi, (unsigned long long)got, (unsigned long long)want);
+            ok = 0;
+        }
+    }
+    printf("Interval counts: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Known p_n */
+    ok = 1;
+    for (size_t i = 0; i < sizeof(nth_known) / sizeof(nth_known[0]); i++) {
+        uint64_t p = 0;
+        if (z5d_nth_prime_exact(nth_known[i].n, &p) != 0 || p != nth_known[i].p) {
+            printf("  p(%llu) = %llu, expected %llu\n", (unsigned long long)nth_known[i].n,
+                   (unsigned long long)p, (unsigned long long)nth_known[i].p);
+            ok = 0;
+        }
+    }
+    printf("Known nth primes: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. pi(p_n) = n and pi(p_n - 1) = n - 1 at random n up to 10^10 */
+    ok = 1;
+    for (int i = 0; i < 12; i++) {
+        uint64_t n = 100000ULL + gmp_urandomm_ui(rs, 900000UL);
+        for (int s = 0; s < i / 3; s++) n *= 10;
+        uint64_t p = 0;
+        if (z5d_nth_prime_exact(n, &p) != 0 || pi_or_max(p) != n || pi_or_max(p - 1) != n - 1) {
+            printf("  n = %llu: got %llu\n", (unsigned long long)n, (unsigned long long)p);
+            ok = 0;
+        }
+    }
+    printf("Random nth primes: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. Out-of-range indices are rejected */
+    uint64_t p = 0;
+    ok = (z5d_nth_prime_exact(0, &p) != 0) && (z5d_nth_prime_exact(Z5D_EXACT_MAX_N + 1, &p) != 0);
+    printf("Range checks: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 6. Up walks end at 2^64 - 1: the last prime is reached, and beyond it
+          there is none */
+    const uint64_t top = 18446744073709551557ULL;   /* largest 64-bit prime */
+    const uint64_t from = 18446744073709000000ULL;
+    uint64_t left = count_interval(from, top);
+    z5d_walk_t w;
+    z5d_walk_init(&w);
+    ok = (z5d_walk(&w, top - 200, 6, 1) == top);
+    ok &= (z5d_walk(&w, top - 200, 7, 1) == 0);
+    ok &= (z5d_walk(&w, from, left, 1) == top);
+    ok &= (z5d_walk(&w, from, 70000, 1) == 0);
+    ok &= (z5d_walk(&w, top, 1, 1) == 0 && z5d_walk(&w, UINT64_MAX, 1, 1) == 0);
+    ok &= (z5d_walk(&w, UINT64_MAX, 1, 0) == top);
+    z5d_walk_clear(&w);
+    printf("Walks to the top of the range: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    gmp_randclear(rs);
+    z5d_cleanup();
+
+    printf("\n=========================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
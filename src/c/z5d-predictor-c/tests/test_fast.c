@@ -0,0 +1,109 @@
+/**
+ * Z5D nth-Prime Predictor - Fast Tier Test
+ * ========================================
+ *
+ * Checks that the double / double-double fast tier rounds to the same
+ * integer as the MPFR path. The reference runs at Z5D_FAST_MIN_PRECISION - 1
+ * bits, which keeps it on MPFR while still leaving over 40 fractional bits
+ * for n < 2^53.
+ *
+ * @file test_fast.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpfr.h>
+
+#define REF_PRECISION 105   /* Z5D_FAST_MIN_PRECISION - 1 */
+#define MAX_N (1ULL << 53)
+
+typedef struct {
+    z5d_ctx_t fast;
+    z5d_ctx_t ref;
+    z5d_result_t rf;
+    z5d_result_t rr;
+} fast_test_t;
+
+/* Returns the number of indices where the two paths disagree. */
+static int check_n(fast_test_t* t, uint64_t n) {
+    z5d_predict_nth_prime_ctx(&t->fast, &t->rf, n);
+    z5d_predict_nth_prime_ctx(&t->ref, &t->rr, n);
+    if (mpfr_cmp(t->rf.predicted_prime, t->rr.predicted_prime) != 0) {
+        mpfr_printf("  n=%lu: fast %.0Rf, MPFR %.0Rf\n", (unsigned long)n,
+                    t->rf.predicted_prime, t->rr.predicted_prime);
+        return 1;
+    }
+    return 0;
+}
+
+static uint64_t lcg_next(uint64_t* s) {
+    *s = *s * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *s >> 11;   /* 53 bits */
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Fast Tier Test\n");
+    printf("========================================\n\n");
+
+    fast_test_t t;
+    z5d_config_t config;
+    z5d_config_init(&config);
+    z5d_ctx_init(&t.fast, &config);
+    config.precision = REF_PRECISION;
+    z5d_ctx_init(&t.ref, &config);
+    z5d_config_clear(&config);
+    z5d_result_init(&t.rf, Z5D_DEFAULT_PRECISION);
+    z5d_result_init(&t.rr, Z5D_DEFAULT_PRECISION);
+
+    int passed = 0, total = 0, bad;
+
+    /* 1. Dense sweep over small n, where rounding boundaries are closest */
+    bad = 0;
+    for (uint64_t n = 1; n <= 100000; n++) bad += check_n(&t, n);
+    printf("Dense sweep n <= 1e5: %s\n", bad ? "FAIL" : "PASS");
+    passed += !bad; total++;
+
+    /* 2. Random n in every bit width up to 2^53 */
+    bad = 0;
+    uint64_t seed = 12345;
+    for (int bits = 5; bits <= 53; bits++) {
+        for (int i = 0; i < 2000; i++) {
+            uint64_t n = lcg_next(&seed) & ((1ULL << bits) - 1);
+            n |= 1ULL << (bits - 1);
+            if (n >= MAX_N) n = MAX_N - 1;
+            bad += check_n(&t, n);
+        }
+    }
+    printf("Random n, 5..53 bits: %s\n", bad ? "FAIL" : "PASS");
+    passed += !bad; total++;
+
+    /* 3. Tier boundaries */
+    static const uint64_t edges[] = {
+        15ULL, 16ULL, 17ULL, (1ULL << 32) - 1, 1ULL << 32, (1ULL << 32) + 1,
+        MAX_N - 2, MAX_N - 1, MAX_N, MAX_N + 1,
+    };
+    bad = 0;
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) bad += check_n(&t, edges[i]);
+    printf("Tier boundaries: %s\n", bad ? "FAIL" : "PASS");
+    passed += !bad; total++;
+
+    /* 4. The fast tier actually served the bulk of the calls */
+    int ok = t.fast.stats.fast_hits > 100 * t.fast.stats.fast_fallbacks &&
+             t.ref.stats.fast_hits == 0;
+    printf("Fast tier usage (%lu hits, %lu fallbacks): %s\n",
+           (unsigned long)t.fast.stats.fast_hits, (unsigned long)t.fast.stats.fast_fallbacks,
+           ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    z5d_result_clear(&t.rf);
+    z5d_result_clear(&t.rr);
+    z5d_ctx_clear(&t.fast);
+    z5d_ctx_clear(&t.ref);
+    z5d_cleanup();
+
+    printf("\n========================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
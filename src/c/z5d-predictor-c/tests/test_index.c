@@ -0,0 +1,113 @@
+/**
+ * Z5D Prime-Index Estimate Test
+ * =============================
+ *
+ * Checks that z5d_estimate_index brackets known pi(x) values, that its
+ * estimate lies close to pi(x), that it inverts the closed form at small
+ * and 100-digit indices, and that small, tiny and negative x are handled.
+ *
+ * @file test_index.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* pi(10^k), k = 7 .. 18 */
+static const char* PI_POW10[] = {
+    "664579", "5761455", "50847534", "455052511", "4118054813", "37607912018",
+    "346065536839", "3204941750802", "29844570422669", "279238341033925",
+    "2623557157654233", "24739954287740860",
+};
+
+/* |a - b| <= b / den */
+static int close_to(const mpz_t a, const mpz_t b, unsigned long den) {
+    mpz_t d, tol;
+    mpz_inits(d, tol, NULL);
+    mpz_sub(d, a, b);
+    mpz_abs(d, d);
+    mpz_tdiv_q_ui(tol, b, den);
+    int ok = mpz_cmp(d, tol) <= 0;
+    mpz_clears(d, tol, NULL);
+    return ok;
+}
+
+int main(void) {
+    printf("Z5D Prime-Index Estimate Test\n");
+    printf("=============================\n\n");
+
+    int passed = 0, total = 0, ok;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    z5d_index_t est;
+    z5d_index_init(&est);
+    mpz_t x, pi, n, p;
+    mpz_inits(x, pi, n, p, NULL);
+
+    /* 1. Both brackets hold pi(10^k); the estimate is within 0.1% */
+    ok = 1;
+    for (int k = 7; k <= 18 && ok; k++) {
+        mpz_ui_pow_ui(x, 10, (unsigned long)k);
+        mpz_set_str(pi, PI_POW10[k - 7], 10);
+        ok &= z5d_estimate_index_ctx(&ctx, &est, x) == 0;
+        ok &= mpz_cmp(est.lo, pi) <= 0 && mpz_cmp(pi, est.hi) <= 0;
+        ok &= mpz_cmp(est.rh_lo, pi) <= 0 && mpz_cmp(pi, est.rh_hi) <= 0;
+        ok &= mpz_cmp(est.lo, est.rh_lo) <= 0 && mpz_cmp(est.rh_hi, est.hi) <= 0;
+        ok &= close_to(est.n, pi, 1000) && est.iterations > 0;
+    }
+    printf("Brackets hold pi(10^k): %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. Inverse of the closed form: F(n) maps back to n */
+    ok = 1;
+    const char* idx[] = { "1000000", "123456789012", "1000000000000000000000000000000",
+                          "7000000000000000000000000000000000000000000000000000000000000000000"
+                          "000000000000000000000000000000000" };
+    mpfr_t f;
+    mpfr_init2(f, 64);
+    for (int i = 0; i < 4 && ok; i++) {
+        mpz_set_str(n, idx[i], 10);
+        ok &= z5d_closed_form_ctx(&ctx, f, n) == 0;
+        mpfr_get_z(x, f, MPFR_RNDN);
+        ok &= z5d_estimate_index_ctx(&ctx, &est, x) == 0;
+        mpz_sub(p, est.n, n);
+        ok &= mpz_cmpabs_ui(p, 1) <= 0;
+    }
+    mpfr_clear(f);
+    printf("Inverts the closed form: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Exact below Z5D_INDEX_EXACT_MAX, including at the boundary */
+    ok = 1;
+    unsigned long small_x[] = { 2, 3, 100, 7919, Z5D_INDEX_EXACT_MAX - 1 };
+    unsigned long small_pi[] = { 1, 2, 25, 1000, 43390 };
+    for (int i = 0; i < 5 && ok; i++) {
+        mpz_set_ui(x, small_x[i]);
+        ok &= z5d_estimate_index(&est, x) == 0;
+        ok &= mpz_cmp_ui(est.n, small_pi[i]) == 0 && mpz_cmp_ui(est.lo, small_pi[i]) == 0 &&
+              mpz_cmp_ui(est.rh_hi, small_pi[i]) == 0 && est.iterations == 0;
+    }
+    mpz_set_ui(x, Z5D_INDEX_EXACT_MAX);
+    ok &= z5d_estimate_index(&est, x) == 0;
+    ok &= mpz_cmp_ui(est.lo, 43390) <= 0 && mpz_cmp_ui(est.hi, 43390) >= 0;
+    printf("Exact small x: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. x < 2 gives zero; negative x is refused */
+    mpz_set_ui(x, 1);
+    ok = z5d_estimate_index(&est, x) == 0 && mpz_sgn(est.n) == 0 && mpz_sgn(est.hi) == 0;
+    mpz_set_si(x, -5);
+    ok &= z5d_estimate_index(&est, x) == -1;
+    printf("Tiny and negative x: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    mpz_clears(x, pi, n, p, NULL);
+    z5d_index_clear(&est);
+    z5d_ctx_clear(&ctx);
+    z5d_cleanup();
+
+    printf("\n=============================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
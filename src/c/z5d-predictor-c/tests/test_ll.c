@@ -0,0 +1,146 @@
+/**
+ * Z5D Lucas-Lehmer Engine Test
+ * ============================
+ *
+ * Checks the GMP engine against the known Mersenne prime exponents and
+ * their prime neighbours, that the FFT engine ends on the same residues
+ * serially and across threads, that a run stopped at a checkpoint resumes
+ * to the same answer, and that checkpoints for another p or of foreign
+ * content are refused.
+ *
+ * @file test_ll.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Mersenne prime exponents below 4500 */
+static const uint64_t MERSENNE_P[] = {
+    2, 3, 5, 7, 13, 17, 19, 31, 61, 89, 107, 127, 521, 607, 1279, 2203, 2281, 3217, 4253, 4423
+};
+#define MERSENNE_COUNT (sizeof(MERSENNE_P) / sizeof(MERSENNE_P[0]))
+
+static int is_mersenne_p(uint64_t p) {
+    for (size_t i = 0; i < MERSENNE_COUNT; i++) {
+        if (MERSENNE_P[i] == p) return 1;
+    }
+    return 0;
+}
+
+static int run(uint64_t p, z5d_ll_engine_t engine, unsigned int threads, z5d_ll_stats_t* stats) {
+    z5d_ll_config_t config;
+    z5d_ll_config_init(&config);
+    config.engine = engine;
+    config.threads = threads;
+    return z5d_lucas_lehmer(p, &config, stats);
+}
+
+int main(void) {
+    printf("Z5D Lucas-Lehmer Engine Test\n");
+    printf("============================\n\n");
+
+    int passed = 0, total = 0, ok;
+    z5d_ll_stats_t a, b;
+
+    /* 1. GMP engine: every p < 4500 against the known list */
+    ok = 1;
+    for (uint64_t p = 0; p < 4500; p++) {
+        int r = run(p, Z5D_LL_GMP, 1, &a);
+        ok &= r == (is_mersenne_p(p) ? Z5D_LL_PRIME : Z5D_LL_COMPOSITE);
+    }
+    ok &= z5d_lucas_lehmer(Z5D_LL_MAX_P + 1, NULL, NULL) == -1;
+    printf("GMP engine, p < 4500: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. FFT engine ends on the GMP residues */
+    static const uint64_t fft_p[] = { 131, 521, 1277, 1279, 2203, 4253, 4259, 9689, 9697 };
+    ok = 1;
+    for (size_t i = 0; i < sizeof(fft_p) / sizeof(fft_p[0]); i++) {
+        int ra = run(fft_p[i], Z5D_LL_GMP, 1, &a);
+        int rb = run(fft_p[i], Z5D_LL_FFT, 1, &b);
+        ok &= ra == rb && a.res64 == b.res64 && b.engine == Z5D_LL_FFT && b.fft_length > 0 &&
+              b.max_roundoff < 0.40 && b.iterations == fft_p[i] - 2;
+    }
+    ok &= run(89, Z5D_LL_FFT, 1, &b) == Z5D_LL_PRIME && b.engine == Z5D_LL_GMP;
+    printf("FFT residues match GMP: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Threaded transforms (44497 is a Mersenne prime exponent); partial
+     *    runs compare residues at larger p */
+    ok = run(21701, Z5D_LL_FFT, 4, &b) == Z5D_LL_PRIME;
+    ok &= run(44497, Z5D_LL_FFT, 4, &b) == Z5D_LL_PRIME && b.fft_length >= 4096;
+    static const uint64_t partial_p[] = { 86243, 110503, 132049 };
+    for (size_t i = 0; i < sizeof(partial_p) / sizeof(partial_p[0]); i++) {
+        z5d_ll_config_t config;
+        z5d_ll_config_init(&config);
+        config.stop_after = 300;
+        config.engine = Z5D_LL_GMP;
+        ok &= z5d_lucas_lehmer(partial_p[i], &config, &a) == Z5D_LL_STOPPED;
+        config.engine = Z5D_LL_FFT;
+        config.threads = 3;
+        ok &= z5d_lucas_lehmer(partial_p[i], &config, &b) == Z5D_LL_STOPPED &&
+              a.res64 == b.res64 && b.iterations == 300;
+    }
+    printf("Threaded FFT: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Stop at a checkpoint and resume, on both engines */
+    char path[] = "/tmp/z5d_ll_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return 1;
+    close(fd);
+    ok = 1;
+    for (int engine = Z5D_LL_GMP; engine <= Z5D_LL_FFT; engine++) {
+        unlink(path);
+        z5d_ll_config_t config;
+        z5d_ll_config_init(&config);
+        config.engine = (z5d_ll_engine_t)engine;
+        config.checkpoint_path = path;
+        config.checkpoint_every = 700;
+        config.stop_after = 2000;
+        int r = z5d_lucas_lehmer(4423, &config, &a);
+        ok &= r == Z5D_LL_STOPPED && a.iterations == 2000 && a.resumed_at == 0;
+        r = z5d_lucas_lehmer(4423, &config, &a);
+        ok &= r == Z5D_LL_STOPPED && a.iterations == 4000 && a.resumed_at == 2000;
+        config.stop_after = 0;
+        r = z5d_lucas_lehmer(4423, &config, &a);
+        ok &= r == Z5D_LL_PRIME && a.iterations == 4421 && a.resumed_at == 4000;
+        r = z5d_lucas_lehmer(4423, &config, &a);   /* finished file: nothing left to do */
+        ok &= r == Z5D_LL_PRIME && a.resumed_at == 4421;
+    }
+    printf("Checkpoint resume: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. Checkpoints for another p or of foreign content are refused */
+    z5d_ll_config_t config;
+    z5d_ll_config_init(&config);
+    config.checkpoint_path = path;
+    ok = z5d_lucas_lehmer(4253, &config, &a) == -1;
+    FILE* f = fopen(path, "r+b");
+    ok &= f != NULL;
+    if (f) {
+        fseek(f, 40, SEEK_SET);
+        fputc(0x5a, f);   /* flip a residue byte */
+        fclose(f);
+    }
+    ok &= z5d_lucas_lehmer(4423, &config, &a) == -1;
+    f = fopen(path, "wb");
+    if (f) {
+        for (int i = 0; i < 100; i++) fputc('x', f);
+        fclose(f);
+    }
+    ok &= z5d_lucas_lehmer(4423, &config, &a) == -1;
+    unlink(path);
+    ok &= z5d_lucas_lehmer(61, &config, &a) == Z5D_LL_PRIME && access(path, F_OK) == 0;
+    unlink(path);
+    printf("Foreign checkpoints: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    printf("\n============================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
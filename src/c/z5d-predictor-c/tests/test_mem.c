@@ -0,0 +1,165 @@
+/**
+ * Z5D Allocation Pool Test
+ * ========================
+ *
+ * Installs the pool before any GMP or MPFR use, then checks that warm
+ * contexts predict without reaching malloc on the uint64, big-n and
+ * Riemann paths, that pooled answers match across contexts and threads,
+ * that the installed mode cannot be swapped, and that trimming empties
+ * the thread cache.
+ *
+ * @file test_mem.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define WARM_CALLS 8
+#define STEADY_CALLS 200
+#define THREADS 4
+
+/* Refined p_(base + i) on the big path, in a fresh warmed context. Answers
+ * kept by the caller hold their blocks, so the malloc count is taken on a
+ * reused output first. */
+static int big_answers(const char* base, mpz_t* out, int count, uint64_t* mallocs) {
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    mpz_t n, p;
+    mpz_init_set_str(n, base, 10);
+    mpz_init(p);
+    int ret = 0;
+    /* Warm on other indices: a repeated n is answered without a search */
+    for (int i = 0; i < WARM_CALLS; i++) {
+        mpz_add_ui(n, n, 1000);
+        ret |= z5d_predict_nth_prime_mpz_big_ctx(&ctx, p, n);
+    }
+    uint64_t m0 = ctx.stats.gmp_mallocs;
+    for (int i = 0; i < count; i++) {
+        mpz_set_str(n, base, 10);
+        mpz_add_ui(n, n, (unsigned long)i);
+        ret |= z5d_predict_nth_prime_mpz_big_ctx(&ctx, p, n);
+    }
+    if (mallocs) *mallocs = ctx.stats.gmp_mallocs - m0;
+    for (int i = 0; i < count; i++) {
+        mpz_set_str(n, base, 10);
+        mpz_add_ui(n, n, (unsigned long)i);
+        ret |= z5d_predict_nth_prime_mpz_big_ctx(&ctx, out[i], n);
+    }
+    mpz_clears(n, p, NULL);
+    z5d_ctx_clear(&ctx);
+    return ret;
+}
+
+typedef struct {
+    mpz_t answers[16];
+    uint64_t mallocs;
+    int ret;
+} worker_arg_t;
+
+static void* worker(void* p) {
+    worker_arg_t* a = (worker_arg_t*)p;
+    a->ret = big_answers("1000000000000000000", a->answers, 16, &a->mallocs);
+    z5d_cleanup();
+    return NULL;
+}
+
+int main(void) {
+    /* Must come before the first GMP or MPFR allocation */
+    if (z5d_mem_install(Z5D_MEM_POOL) != 0) return 1;
+
+    printf("Z5D Allocation Pool Test\n");
+    printf("========================\n\n");
+
+    int passed = 0, total = 0, ok;
+
+    /* 1. Install contract */
+    ok = z5d_mem_mode() == Z5D_MEM_POOL && z5d_mem_install(Z5D_MEM_POOL) == 0 &&
+         z5d_mem_install(Z5D_MEM_COUNT) == -1 && z5d_mem_install((z5d_mem_mode_t)7) == -1;
+    printf("Install once: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. Warm uint64 context: warm-up is counted; the fast tier and word-sized
+          refinement then allocate nothing */
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    z5d_result_t res;
+    z5d_result_init(&res, Z5D_DEFAULT_PRECISION);
+    mpz_t p;
+    mpz_init(p);
+    ok = 1;
+    for (int i = 0; i < WARM_CALLS; i++) {
+        ok &= z5d_predict_nth_prime_ctx(&ctx, &res, 1000000007ULL + (uint64_t)i) == 0;
+        ok &= z5d_predict_nth_prime_mpz_ctx(&ctx, p, 1000000007ULL + (uint64_t)i) == 0;
+    }
+    uint64_t a0 = ctx.stats.gmp_allocs, m0 = ctx.stats.gmp_mallocs;
+    for (int i = 0; i < STEADY_CALLS; i++) {
+        ok &= z5d_predict_nth_prime_ctx(&ctx, &res, 1000000007ULL + (uint64_t)(i % WARM_CALLS)) == 0;
+        ok &= z5d_predict_nth_prime_mpz_ctx(&ctx, p, 1000000007ULL + (uint64_t)(i % WARM_CALLS)) == 0;
+    }
+    ok &= a0 > 0 && ctx.stats.gmp_allocs == a0 && ctx.stats.gmp_mallocs == m0;
+    z5d_ctx_clear(&ctx);
+    printf("Steady uint64 path: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Big-n and Riemann paths reach a zero-malloc steady state too */
+    mpz_t answers[16];
+    for (int i = 0; i < 16; i++) mpz_init(answers[i]);
+    uint64_t mallocs = 1;
+    ok = big_answers("1000000000000000000", answers, 16, &mallocs) == 0 && mallocs == 0;
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.engine = Z5D_ENGINE_RIEMANN_R;
+    z5d_ctx_init(&ctx, &config);
+    mpz_t n;
+    mpz_init_set_str(n, "1000000000000000000000000000000", 10);
+    for (int i = 0; i < WARM_CALLS; i++) ok &= z5d_predict_nth_prime_big_ctx(&ctx, &res, n) == 0;
+    m0 = ctx.stats.gmp_mallocs;
+    for (int i = 0; i < STEADY_CALLS / 4; i++) ok &= z5d_predict_nth_prime_big_ctx(&ctx, &res, n) == 0;
+    ok &= ctx.stats.gmp_mallocs == m0;
+    mpz_clear(n);
+    z5d_ctx_clear(&ctx);
+    z5d_config_clear(&config);
+    printf("Steady big-n and Riemann paths: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Threads with their own caches give the same answers */
+    worker_arg_t args[THREADS];
+    pthread_t tid[THREADS];
+    ok = 1;
+    for (int t = 0; t < THREADS; t++) {
+        for (int i = 0; i < 16; i++) mpz_init(args[t].answers[i]);
+        ok &= pthread_create(&tid[t], NULL, worker, &args[t]) == 0;
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(tid[t], NULL);
+        ok &= args[t].ret == 0 && args[t].mallocs == 0;
+        for (int i = 0; i < 16; i++) {
+            ok &= mpz_cmp(args[t].answers[i], answers[i]) == 0;
+            mpz_clear(args[t].answers[i]);
+        }
+    }
+    for (int i = 0; i < 16; i++) ok &= mpz_probab_prime_p(answers[i], 25) > 0;
+    printf("Threads agree: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. Cleanup trims the thread cache */
+    for (int i = 0; i < 16; i++) mpz_clear(answers[i]);
+    mpz_clear(p);
+    z5d_result_clear(&res);
+    z5d_mem_stats_t st;
+    z5d_mem_thread_stats(&st);
+    ok = st.cached_bytes > 0 && st.frees > 0 && st.allocs >= st.mallocs;
+    z5d_cleanup();
+    z5d_mem_thread_stats(&st);
+    ok &= st.cached_bytes == 0;
+    printf("Trim: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    printf("\n========================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
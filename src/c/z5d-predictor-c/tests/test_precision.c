@@ -0,0 +1,91 @@
+/**
+ * Z5D nth-Prime Predictor - Precision Planner Test
+ * ================================================
+ *
+ * Checks that the planned working precision of the big-n path rounds the
+ * closed form to the same integer as the historic bits(n) + 2048 rule, over
+ * random n from 54 bits up to 10^1233.
+ *
+ * @file test_precision.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpfr.h>
+#include <gmp.h>
+
+#define SAMPLES_PER_SIZE 8
+
+/* Closed form at a fixed precision floor (the historic rule) */
+static void predict_at(mpfr_t out, const mpz_t n, mpfr_prec_t floor_prec) {
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.precision = floor_prec;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, &config);
+    z5d_config_clear(&config);
+    z5d_result_t result;
+    z5d_result_init(&result, Z5D_DEFAULT_PRECISION);
+    z5d_predict_nth_prime_big_ctx(&ctx, &result, n);
+    mpfr_set_prec(out, mpfr_get_prec(result.predicted_prime));
+    mpfr_set(out, result.predicted_prime, MPFR_RNDN);
+    z5d_result_clear(&result);
+    z5d_ctx_clear(&ctx);
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Precision Planner Test\n");
+    printf("================================================\n\n");
+
+    static const unsigned long sizes[] = {54, 64, 100, 200, 333, 700, 1024, 2048, 3000, 4096};
+    const size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 20240601);
+
+    /* Low floor so the plan alone decides the working precision */
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.precision = 64;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, &config);
+    z5d_config_clear(&config);
+    z5d_result_t planned;
+    z5d_result_init(&planned, Z5D_DEFAULT_PRECISION);
+    mpfr_t legacy;
+    mpfr_init2(legacy, Z5D_DEFAULT_PRECISION);
+    mpz_t n;
+    mpz_init(n);
+
+    int passed = 0;
+    for (size_t s = 0; s < num_sizes; s++) {
+        int ok = 1;
+        mpfr_prec_t plan_bits = 0;
+        for (int i = 0; i < SAMPLES_PER_SIZE; i++) {
+            mpz_urandomb(n, rs, sizes[s] - 1);
+            mpz_setbit(n, sizes[s] - 1);
+            z5d_predict_nth_prime_big_ctx(&ctx, &planned, n);
+            predict_at(legacy, n, (mpfr_prec_t)sizes[s] + 2048);
+            plan_bits = planned.precision_used;
+            if (!mpfr_equal_p(planned.predicted_prime, legacy)) ok = 0;
+            if (planned.precision_used >= (mpfr_prec_t)sizes[s] + 2048) ok = 0;
+        }
+        printf("%4lu-bit n (plan %5ld bits): %s\n", sizes[s], (long)plan_bits,
+               ok ? "PASS" : "FAIL");
+        passed += ok;
+    }
+
+    mpz_clear(n);
+    mpfr_clear(legacy);
+    z5d_result_clear(&planned);
+    z5d_ctx_clear(&ctx);
+    gmp_randclear(rs);
+    z5d_cleanup();
+
+    printf("\n================================================\n");
+    printf("Test Results: %d/%zu passed\n", passed, num_sizes);
+    return (passed == (int)num_sizes) ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/**
+ * Z5D Word-Sized Primality Test
+ * =============================
+ *
+ * Checks z5d_is_prime_u64 and z5d_next_prime_u64 against GMP on every value
+ * below 10^5, on random values of each bit length and beside powers of two,
+ * that strong pseudoprimes and Carmichael numbers are caught, and the edges at
+ * the top of the 64-bit range. Refinement below 2^64 must agree with GMP too.
+ *
+ * @file test_prime64.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Smallest prime >= v by GMP (BPSW is exact below 2^64) */
+static uint64_t gmp_next(mpz_t t, uint64_t v) {
+    if (v <= 2) return 2;
+    mpz_set_ui(t, v - 1);
+    mpz_nextprime(t, t);
+    return mpz_sizeinbase(t, 2) > 64 ? 0 : mpz_get_ui(t);
+}
+
+static uint64_t rand64(uint64_t* s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+int main(void) {
+    printf("Z5D Word-Sized Primality Test\n");
+    printf("=============================\n\n");
+
+    int passed = 0, total = 0, ok;
+    mpz_t t;
+    mpz_init(t);
+
+    /* 1. Every value below 10^5 */
+    ok = 1;
+    for (uint64_t v = 0; v < 100000 && ok; v++) {
+        mpz_set_ui(t, v);
+        ok &= z5d_is_prime_u64(v) == (mpz_probab_prime_p(t, 1) > 0);
+        ok &= z5d_next_prime_u64(v, NULL) == gmp_next(t, v);
+    }
+    printf("Small values: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. Random values of every bit length and beside each power of two */
+    ok = 1;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (int bits = 17; bits <= 64 && ok; bits++) {
+        uint64_t top = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+        for (int i = 0; i < 200 && ok; i++) {
+            uint64_t v = rand64(&seed) & top;
+            if (i < 8) v = (top >> 1) + 1 + (uint64_t)i * 7 - 28;
+            mpz_set_ui(t, v);
+            ok &= z5d_is_prime_u64(v) == (mpz_probab_prime_p(t, 1) > 0);
+            uint64_t tests = 0, p = z5d_next_prime_u64(v, &tests);
+            ok &= p == gmp_next(t, v) && tests >= 1;
+        }
+    }
+    printf("Random and boundary values: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Strong pseudoprimes to small bases and Carmichael numbers */
+    static const uint64_t COMPOSITES[] = {
+        2047ULL, 1373653ULL, 25326001ULL, 3215031751ULL, 4759123141ULL,
+        1122004669633ULL, 2152302898747ULL, 3474749660383ULL, 341550071728321ULL,
+        3825123056546413051ULL, 18446744073709551615ULL,
+        561ULL, 41041ULL, 825265ULL, 321197185ULL, 5394826801ULL, 232250619601ULL,
+        9746347772161ULL, 4294967297ULL, 4611686014132420609ULL,
+    };
+    ok = 1;
+    for (size_t i = 0; i < sizeof(COMPOSITES) / sizeof(COMPOSITES[0]); i++) {
+        ok &= !z5d_is_prime_u64(COMPOSITES[i]);
+    }
+    printf("Pseudoprimes rejected: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Top of the range; refinement agrees with GMP below 2^64 */
+    ok = z5d_is_prime_u64(18446744073709551557ULL) && !z5d_is_prime_u64(~0ULL);
+    ok &= z5d_next_prime_u64(18446744073709551557ULL, NULL) == 18446744073709551557ULL;
+    ok &= z5d_next_prime_u64(18446744073709551558ULL, NULL) == 0;
+    ok &= z5d_next_prime_u64(~0ULL, NULL) == 0;
+    ok &= z5d_next_prime_u64(18446744073709551000ULL, NULL) == 18446744073709551113ULL;
+    mpz_t p;
+    mpz_init(p);
+    for (uint64_t n = 1000; n <= 100000000000000000ULL && ok; n = n * 10 + 3) {
+        ok &= z5d_predict_nth_prime_mpz(p, n) == 0;
+        mpz_sub_ui(t, p, 1);
+        mpz_nextprime(t, t);
+        ok &= mpz_cmp(t, p) == 0 && mpz_sizeinbase(p, 2) <= 64;
+    }
+    mpz_clear(p);
+    printf("Range edges and refinement: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    mpz_clear(t);
+    z5d_cleanup();
+
+    printf("\n=============================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
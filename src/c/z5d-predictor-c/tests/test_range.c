@@ -0,0 +1,129 @@
+/**
+ * Z5D nth-Prime Predictor - Grid Prediction Test
+ * ==============================================
+ *
+ * Checks z5d_predict_range against the pointwise predicted_prime on grids
+ * across the double, double-double and MPFR tiers (including grids that
+ * straddle 16 and 2^53, coarse strides and stride 0), the chunked callback
+ * variant with early stop, and argument checks.
+ *
+ * @file test_range.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define GRID 3000
+
+/* Pointwise reference: the rounded predicted_prime of the MPFR entry point */
+static uint64_t pointwise(z5d_ctx_t* ctx, z5d_result_t* r, uint64_t n) {
+    if (z5d_predict_nth_prime_ctx(ctx, r, n) != 0) return 0;
+    return mpfr_get_ui(r->predicted_prime, MPFR_RNDN);
+}
+
+/* Compare a grid against pointwise predictions; prints the first mismatch */
+static int check_grid(z5d_ctx_t* ctx, z5d_result_t* r, uint64_t start, uint64_t stride,
+                      size_t count, uint64_t* buf) {
+    if (z5d_predict_range_ctx(ctx, start, stride, count, buf) != 0) {
+        printf("  grid %llu + i * %llu: error\n", (unsigned long long)start,
+               (unsigned long long)stride);
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint64_t n = start + stride * (uint64_t)i;
+        uint64_t want = pointwise(ctx, r, n);
+        if (buf[i] != want) {
+            printf("  n = %llu: grid %llu, pointwise %llu\n", (unsigned long long)n,
+                   (unsigned long long)buf[i], (unsigned long long)want);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+typedef struct {
+    z5d_ctx_t* ctx;
+    z5d_result_t* r;
+    uint64_t next_n, seen, stop_after;
+    int ok;
+} sweep_t;
+
+static int on_chunk(uint64_t first_n, uint64_t stride, const uint64_t* values,
+                    size_t count, void* arg) {
+    sweep_t* s = (sweep_t*)arg;
+    if (first_n != s->next_n || count == 0 || count > Z5D_RANGE_CHUNK) s->ok = 0;
+    for (size_t j = 0; j < count; j += 97) {
+        if (values[j] != pointwise(s->ctx, s->r, first_n + stride * (uint64_t)j)) s->ok = 0;
+    }
+    s->next_n = first_n + stride * (uint64_t)count;
+    s->seen += count;
+    return (s->stop_after && s->seen >= s->stop_after) ? 42 : 0;
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Grid Prediction Test\n");
+    printf("==============================================\n\n");
+
+    int passed = 0, total = 0, ok;
+    uint64_t* buf = malloc(GRID * sizeof(uint64_t));
+    if (!buf) return 1;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    z5d_result_t r;
+    z5d_result_init(&r, Z5D_DEFAULT_PRECISION);
+
+    /* 1. Unit-stride grids in each tier */
+    static const uint64_t starts[] = {
+        5ULL, 1000ULL, 123456789ULL, 4294965000ULL, 1000000000000ULL,
+        999999999999000ULL, 9007199254739000ULL,
+    };
+    ok = 1;
+    for (size_t i = 0; i < sizeof(starts) / sizeof(starts[0]); i++) {
+        ok &= check_grid(&ctx, &r, starts[i], 1, GRID, buf);
+    }
+    printf("Unit-stride grids: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. Strided grids, both step and per-point regimes */
+    ok = check_grid(&ctx, &r, 10000000000ULL, 7, GRID, buf);
+    ok &= check_grid(&ctx, &r, 5000000000000ULL, 4099, GRID, buf);
+    ok &= check_grid(&ctx, &r, 100000ULL, 1000000ULL, GRID, buf);       /* coarse */
+    ok &= check_grid(&ctx, &r, 9007199000000000ULL, 1000003ULL, 500, buf); /* past 2^53 */
+    ok &= check_grid(&ctx, &r, 77777777777ULL, 0, 100, buf);
+    printf("Strided grids: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Chunked delivery covers the grid in order; early stop propagates */
+    sweep_t s = { &ctx, &r, 1000000000ULL, 0, 0, 1 };
+    ok = (z5d_predict_range_cb_ctx(&ctx, 1000000000ULL, 3, 2 * Z5D_RANGE_CHUNK + 17,
+                                   on_chunk, &s) == 0) &&
+         s.ok && s.seen == 2 * Z5D_RANGE_CHUNK + 17;
+    sweep_t st = { &ctx, &r, 50ULL, 0, Z5D_RANGE_CHUNK, 1 };
+    ok &= (z5d_predict_range_cb(50ULL, 1, 10 * Z5D_RANGE_CHUNK, on_chunk, &st) == 42) &&
+          st.ok && st.seen == Z5D_RANGE_CHUNK;
+    printf("Chunked callback: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Bad arguments and 64-bit overflow of the output */
+    ok = (z5d_predict_range(0, 1, 10, buf) != 0);
+    ok &= (z5d_predict_range(UINT64_MAX - 5, 1, 10, buf) != 0);
+    ok &= (z5d_predict_range(1, 1, 10, NULL) != 0);
+    ok &= (z5d_predict_range(1, 1, 0, NULL) == 0);
+    ok &= (z5d_predict_range(1, 1, 10, buf) != 0 && buf[9] == pointwise(&ctx, &r, 10));
+    ok &= (z5d_predict_range(Z5D_EXACT_MAX_N, 1, 1, buf) == 0);
+    ok &= (z5d_predict_range(1ULL << 62, 1, 1, buf) != 0);
+    ok &= (z5d_predict_range_cb(1, 1, 10, NULL, NULL) != 0);
+    printf("Range checks: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    z5d_result_clear(&r);
+    z5d_ctx_clear(&ctx);
+    free(buf);
+    z5d_cleanup();
+
+    printf("\n==============================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+/**
+ * Z5D Riemann R Engine Test
+ * =========================
+ *
+ * Checks the Gram series against published R(x) values, its derivatives
+ * against differences and the legacy Moebius sum, that the engine lands
+ * within sqrt(p) ln p of p_n on both the uint64 and big-n paths and solves
+ * R(x) = n, that the step limit and the cache bypass behave, the Moebius
+ * table against trial division, and li(x) on each of its methods against
+ * mpfr_eint.
+ *
+ * @file test_riemann.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include "../src/z5d_math.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define PREC 256
+
+/* R(10^3), R(10^6), R(10^9), R(10^12) */
+static const char* R_X[] = { "1e3", "1e6", "1e9", "1e12" };
+static const char* R_VALUE[] = { "168.359446281167", "78527.3994291277", "50847455.4277214",
+                                 "37607910542.2259" };
+
+/* p_n at n = 10^1 .. 10^12 */
+static const uint64_t P_POW10[] = {
+    29ULL, 541ULL, 7919ULL, 104729ULL, 1299709ULL, 15485863ULL, 179424673ULL,
+    2038074743ULL, 22801763489ULL, 252097800623ULL, 2760727302517ULL, 29996224275833ULL
+};
+
+static int mobius_slow(int n) {
+    int k = 0;
+    for (int p = 2; p * p <= n; p++) {
+        if (n % p) continue;
+        n /= p;
+        if (n % p == 0) return 0;
+        k++;
+    }
+    if (n > 1) k++;
+    return (k % 2) ? -1 : 1;
+}
+
+/* |x - p| <= sqrt(p) ln p */
+static int near_p(double x, double p) {
+    return fabs(x - p) <= sqrt(p) * log(p);
+}
+
+int main(void) {
+    printf("Z5D Riemann R Engine Test\n");
+    printf("=========================\n\n");
+
+    int passed = 0, total = 0, ok;
+    z5d_riemann_t r;
+    z5d_riemann_init(&r, PREC);
+    mpfr_t x, R, dR, d2R, Rh, dRh, h, t;
+    mpfr_inits2(PREC, x, R, dR, d2R, Rh, dRh, h, t, (mpfr_ptr)0);
+
+    /* 1. Gram series at published points; legacy sum with many terms agrees */
+    ok = 1;
+    for (size_t i = 0; i < sizeof(R_X) / sizeof(R_X[0]); i++) {
+        mpfr_set_str(x, R_X[i], 10, MPFR_RNDN);
+        ok &= z5d_riemann_gram(&r, R, NULL, NULL, x) == 0;
+        mpfr_set_str(t, R_VALUE[i], 10, MPFR_RNDN);
+        mpfr_sub(t, t, R, MPFR_RNDN);
+        ok &= fabs(mpfr_get_d(t, MPFR_RNDN)) < 1e-4;
+        z5d_riemann_R(t, x, 3000, PREC);
+        mpfr_sub(t, t, R, MPFR_RNDN);
+        ok &= fabs(mpfr_get_d(t, MPFR_RNDN)) < 0.02;
+    }
+    printf("Gram series values: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. R' and R'' against central differences, x = 10^20 */
+    mpfr_set_str(x, "1e20", 10, MPFR_RNDN);
+    ok = z5d_riemann_gram(&r, R, dR, d2R, x) == 0;
+    mpfr_set_ui(h, 1000, MPFR_RNDN);
+    mpfr_add(t, x, h, MPFR_RNDN);
+    z5d_riemann_gram(&r, Rh, dRh, NULL, t);
+    mpfr_set(R, Rh, MPFR_RNDN);
+    mpfr_set(t, dRh, MPFR_RNDN);
+    mpfr_sub(x, x, h, MPFR_RNDN);
+    z5d_riemann_gram(&r, Rh, dRh, NULL, x);
+    mpfr_sub(R, R, Rh, MPFR_RNDN);
+    mpfr_div_ui(R, R, 2000, MPFR_RNDN);      /* (R(x + h) - R(x - h)) / 2h */
+    mpfr_sub(t, t, dRh, MPFR_RNDN);
+    mpfr_div_ui(t, t, 2000, MPFR_RNDN);      /* (R'(x + h) - R'(x - h)) / 2h */
+    ok &= fabs(mpfr_get_d(R, MPFR_RNDN) / mpfr_get_d(dR, MPFR_RNDN) - 1.0) < 1e-12;
+    ok &= fabs(mpfr_get_d(t, MPFR_RNDN) / mpfr_get_d(d2R, MPFR_RNDN) - 1.0) < 1e-9;
+    ok &= mpfr_sgn(dR) > 0 && mpfr_sgn(d2R) < 0;
+    printf("Derivatives: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. Engine on the uint64 path: near p_n, converged, no fast tier */
+    z5d_config_t config;
+    z5d_config_init(&config);
+    config.engine = Z5D_ENGINE_RIEMANN_R;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, &config);
+    z5d_result_t res;
+    z5d_result_init(&res, PREC);
+    ok = 1;
+    uint64_t n = 1, steps = 0;
+    for (size_t i = 0; i < sizeof(P_POW10) / sizeof(P_POW10[0]); i++) {
+        n *= 10;
+        ok &= z5d_predict_nth_prime_ctx(&ctx, &res, n) == 0 && res.converged &&
+              res.iterations >= 1 && res.iterations <= Z5D_DEFAULT_MAX_ITERATIONS &&
+              near_p(mpfr_get_d(res.predicted_prime, MPFR_RNDN), (double)P_POW10[i]);
+        steps += (uint64_t)res.iterations;
+    }
+    ok &= ctx.stats.halley_steps == steps && ctx.stats.fast_hits == 0;
+    /* The unrounded root solves R(x) = n */
+    mpfr_set_ui(t, 1000000007, MPFR_RNDN);
+    int iterations;
+    ok &= z5d_riemann_inverse(&r, x, t, 16, config.tolerance, &iterations) == 1;
+    z5d_riemann_gram(&r, R, NULL, NULL, x);
+    mpfr_sub(R, R, t, MPFR_RNDN);
+    ok &= fabs(mpfr_get_d(R, MPFR_RNDN)) < 1e-6;
+    printf("Engine near p_n: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Big-n path and step limit; the cache is bypassed */
+    z5d_cache_t* cache;
+    ok = z5d_cache_open(&cache, 1000, NULL) == 0;
+    z5d_ctx_clear(&ctx);
+    config.cache = cache;
+    z5d_ctx_init(&ctx, &config);
+    mpz_t nz, p, q;
+    mpz_inits(nz, p, q, NULL);
+    mpz_ui_pow_ui(nz, 10, 60);
+    mpz_add_ui(nz, nz, 9);
+    ok &= z5d_predict_nth_prime_big_ctx(&ctx, &res, nz) == 0 && res.converged;
+    mpfr_get_z(q, res.predicted_prime, MPFR_RNDN);
+    ok &= z5d_predict_nth_prime_mpz_big_ctx(&ctx, p, nz) == 0 && mpz_cmp(p, q) >= 0 &&
+          mpz_probab_prime_p(p, 25) > 0;
+    mpz_sub_ui(q, p, 1);
+    ok &= z5d_predict_nth_prime_mpz_big_ctx(&ctx, q, nz) == 0 && mpz_cmp(p, q) == 0;
+    z5d_cache_stats_t st;
+    z5d_cache_get_stats(cache, &st);
+    ok &= st.entries == 0 && ctx.stats.cache_hits == 0 && ctx.stats.refinements == 2;
+    z5d_ctx_clear(&ctx);
+    config.max_iterations = 1;
+    z5d_ctx_init(&ctx, &config);
+    ok &= z5d_predict_nth_prime_big_ctx(&ctx, &res, nz) == 0 && !res.converged &&
+          res.iterations == 1;
+    z5d_ctx_clear(&ctx);
+    z5d_cache_close(cache);
+    mpz_clears(nz, p, q, NULL);
+    printf("Big n, step limit, cache bypass: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. Moebius table and its trial-division tail */
+    ok = z5d_mobius(0) == 0;
+    for (int m = 1; m <= 10000; m++) ok &= z5d_mobius(m) == mobius_slow(m);
+    printf("Moebius function: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 6. li: power series, Ramanujan, asymptotic and x <= 1 paths within 2 ulps */
+    static const double LI_LOG[] = { -3.0, 0.5, 10.0, 50.0, 700.0, 1500.0, 2302.6, 1e5 };
+    static const mpfr_prec_t LI_PREC[] = { 53, 320, 1100 };
+    ok = 1;
+    for (size_t i = 0; i < sizeof(LI_PREC) / sizeof(LI_PREC[0]); i++) {
+        for (size_t j = 0; j < sizeof(LI_LOG) / sizeof(LI_LOG[0]); j++) {
+            mpfr_t L, got, want;
+            mpfr_init2(got, LI_PREC[i]);
+            mpfr_inits2(LI_PREC[i] + 64, L, want, (mpfr_ptr)0);
+            mpfr_set_d(L, LI_LOG[j], MPFR_RNDN);
+            z5d_li_log(got, L, LI_PREC[i]);
+            mpfr_eint(want, L, MPFR_RNDN);
+            mpfr_sub(want, got, want, MPFR_RNDN);
+            ok &= mpfr_zero_p(want) ||
+                  mpfr_get_exp(want) <= mpfr_get_exp(got) - (mpfr_exp_t)LI_PREC[i] + 1;
+            mpfr_clears(L, got, want, (mpfr_ptr)0);
+        }
+    }
+    mpfr_set_str(x, "1e1000", 10, MPFR_RNDN);   /* ln x ~ 2302.6: past the old 100-term cap */
+    z5d_li(t, x, PREC);
+    mpfr_log(R, x, MPFR_RNDN);
+    double Lx = mpfr_get_d(R, MPFR_RNDN);
+    mpfr_div(R, x, R, MPFR_RNDN);
+    mpfr_div(R, t, R, MPFR_RNDN);                /* li(x) / (x / ln x) = sum k! / L^k */
+    ok &= fabs(mpfr_get_d(R, MPFR_RNDN) - (1 + 1 / Lx + 2 / (Lx * Lx) + 6 / (Lx * Lx * Lx))) <
+          1e-12;
+    z5d_li(t, x, 53);
+    ok &= mpfr_number_p(t);
+    mpfr_set_ui(x, 0, MPFR_RNDN);
+    z5d_li(t, x, PREC);
+    ok &= mpfr_zero_p(t);
+    printf("Logarithmic integral: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    z5d_result_clear(&res);
+    z5d_config_clear(&config);
+    mpfr_clears(x, R, dR, d2R, Rh, dRh, h, t, (mpfr_ptr)0);
+    z5d_riemann_clear(&r);
+    z5d_cleanup();
+
+    printf("\n=========================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
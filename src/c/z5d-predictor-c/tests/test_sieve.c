@@ -0,0 +1,146 @@
+/**
+ * Z5D nth-Prime Predictor - Refinement Sieve Test
+ * ===============================================
+ *
+ * Checks that the presieved refinement finds the same prime as
+ * mpz_nextprime(start - 1): random odd/even starts, starts that are prime
+ * themselves, a gap longer than one sieve segment, the parallel search at
+ * several thread counts, and the big-n entry point with the sieve enabled
+ * vs. disabled.
+ *
+ * @file test_sieve.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include "../src/z5d_sieve.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+
+/* Reference: smallest probable prime >= start */
+static void reference_next(mpz_t out, const mpz_t start) {
+    mpz_sub_ui(out, start, 1);
+    mpz_nextprime(out, out);
+}
+
+static int check_start(z5d_sieve_t* sieve, const mpz_t start) {
+    mpz_t got, want;
+    mpz_inits(got, want, NULL);
+    z5d_sieve_next_prime(sieve, got, start);
+    reference_next(want, start);
+    int ok = (mpz_cmp(got, want) == 0);
+    if (!ok) gmp_printf("  start %Zd: sieve %Zd, nextprime %Zd\n", start, got, want);
+    mpz_clears(got, want, NULL);
+    return ok;
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Refinement Sieve Test\n");
+    printf("===============================================\n\n");
+
+    int passed = 0, total = 0, ok;
+    z5d_sieve_t sieve;
+    z5d_sieve_init(&sieve, Z5D_DEFAULT_SIEVE_LIMIT);
+    gmp_randstate_t rs;
+    gmp_randinit_default(rs);
+    gmp_randseed_ui(rs, 5150);
+    mpz_t start, p, q;
+    mpz_inits(start, p, q, NULL);
+
+    /* 1. Random starts, both parities, 128..1024 bits */
+    ok = 1;
+    static const unsigned long sizes[] = {128, 160, 256, 512, 1024};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (int i = 0; i < 6; i++) {
+            mpz_urandomb(start, rs, sizes[s] - 1);
+            mpz_setbit(start, sizes[s] - 1);
+            ok &= check_start(&sieve, start);
+        }
+    }
+    printf("Random starts: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 2. A start that is already prime is returned unchanged */
+    ok = 1;
+    for (int i = 0; i < 10; i++) {
+        mpz_urandomb(start, rs, 300);
+        mpz_setbit(start, 299);
+        mpz_nextprime(start, start);
+        ok &= check_start(&sieve, start);
+    }
+    printf("Prime starts: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 3. First prime beyond the first segment (256 odd slots at 130 bits):
+       walk consecutive primes until a gap longer than 600 turns up */
+    ok = 0;
+    mpz_set_ui(p, 1);
+    mpz_mul_2exp(p, p, 129);
+    mpz_nextprime(p, p);
+    for (int i = 0; i < 20000 && !ok; i++) {
+        mpz_nextprime(q, p);
+        mpz_sub(start, q, p);
+        if (mpz_cmp_ui(start, 600) > 0) {
+            mpz_add_ui(start, p, 1);
+            ok = check_start(&sieve, start);
+            mpz_add_ui(start, p, 2);
+            ok &= check_start(&sieve, start);
+            if (!ok) break;
+            ok = 1;
+        }
+        mpz_swap(p, q);
+    }
+    printf("Multi-segment gap: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 4. Parallel search returns the serial answer for any thread count */
+    ok = 1;
+    for (int i = 0; i < 6 && ok; i++) {
+        mpz_urandomb(start, rs, 600 + 100 * i);
+        mpz_setbit(start, 599 + 100 * i);
+        reference_next(q, start);
+        for (int threads = 2; threads <= 7; threads += (threads < 4 ? 1 : 3)) {
+            z5d_sieve_next_prime_parallel(&sieve, p, start, threads);
+            if (mpz_cmp(p, q) != 0) {
+                printf("  %d threads disagree at %d00-bit start\n", threads, 6 + i);
+                ok = 0;
+            }
+        }
+    }
+    printf("Parallel search: %s\n", ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+
+    /* 5. Big-n refinement with and without the presieve */
+    z5d_config_t config;
+    z5d_config_init(&config);
+    z5d_ctx_t sieved;
+    z5d_ctx_init(&sieved, &config);
+    config.sieve_limit = 0;
+    z5d_ctx_t plain;
+    z5d_ctx_init(&plain, &config);
+    z5d_config_clear(&config);
+    ok = 1;
+    static const char* big_n[] = {"123456789012345678901234567890123456789",
+                                  "1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"};
+    for (size_t i = 0; i < sizeof(big_n) / sizeof(big_n[0]); i++) {
+        z5d_predict_nth_prime_str_ctx(&sieved, p, big_n[i]);
+        z5d_predict_nth_prime_str_ctx(&plain, q, big_n[i]);
+        ok &= (mpz_cmp(p, q) == 0);
+    }
+    ok &= (sieved.stats.prp_tests > 0 && plain.stats.prp_tests == 0);
+    printf("Big-n refinement (%lu PRP tests): %s\n",
+           (unsigned long)sieved.stats.prp_tests, ok ? "PASS" : "FAIL");
+    passed += ok; total++;
+    z5d_ctx_clear(&sieved);
+    z5d_ctx_clear(&plain);
+
+    mpz_clears(start, p, q, NULL);
+    gmp_randclear(rs);
+    z5d_sieve_clear(&sieve);
+    z5d_cleanup();
+
+    printf("\n===============================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
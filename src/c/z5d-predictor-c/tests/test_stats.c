@@ -0,0 +1,162 @@
+/**
+ * Z5D nth-Prime Predictor - Per-Call Stats Test
+ * =============================================
+ *
+ * Without -DZ5D_ENABLE_STATS, checks that the last-call record and the
+ * summed stage counters stay zero. With it, checks the record of a refined
+ * big-n call against the closed form and the returned prime, that serial
+ * and parallel searches report the same survivors, the fast-tier,
+ * table-hit and word-sized search records, and that the context sums add
+ * up the calls.
+ *
+ * @file test_stats.c
+ * @version 1.0
+ */
+
+#include "../include/z5d_predictor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gmp.h>
+
+/* Rounded closed form and refined prime at 10^e on ctx */
+static void run_at(z5d_ctx_t* ctx, unsigned long e, mpz_t rounded, mpz_t prime,
+                   mpfr_prec_t* prec) {
+    mpz_t n;
+    mpz_init(n);
+    mpz_ui_pow_ui(n, 10, e);
+    mpz_add_ui(n, n, 3);   /* off the known-value table */
+    z5d_result_t r;
+    z5d_result_init(&r, Z5D_DEFAULT_PRECISION);
+    z5d_predict_nth_prime_big_ctx(ctx, &r, n);
+    mpfr_get_z(rounded, r.predicted_prime, MPFR_RNDN);
+    *prec = r.precision_used;
+    z5d_result_clear(&r);
+    z5d_predict_nth_prime_mpz_big_ctx(ctx, prime, n);
+    mpz_clear(n);
+}
+
+static int is_zero(const void* p, size_t size) {
+    const unsigned char* b = (const unsigned char*)p;
+    for (size_t i = 0; i < size; i++) {
+        if (b[i]) return 0;
+    }
+    return 1;
+}
+
+/* Odd integers in [a, b] */
+static uint64_t odd_count(const mpz_t a, const mpz_t b) {
+    mpz_t t;
+    mpz_init(t);
+    mpz_sub(t, b, a);
+    if (mpz_odd_p(a)) mpz_add_ui(t, t, 1);
+    uint64_t c = (mpz_get_ui(t) + 1) / 2;
+    mpz_clear(t);
+    return c;
+}
+
+int main(void) {
+    printf("Z5D nth-Prime Predictor - Per-Call Stats Test\n");
+    printf("=============================================\n\n");
+    printf("Stats compiled in: %s\n\n", z5d_stats_enabled() ? "yes" : "no");
+
+    int passed = 0, total = 0, ok;
+    z5d_ctx_t ctx;
+    z5d_ctx_init(&ctx, NULL);
+    mpz_t rounded, prime;
+    mpz_inits(rounded, prime, NULL);
+    mpfr_prec_t prec;
+
+    if (!z5d_stats_enabled()) {
+        /* 1. Disabled build: nothing recorded */
+        run_at(&ctx, 60, rounded, prime, &prec);
+        ok = is_zero(&ctx.last_call, sizeof(ctx.last_call)) &&
+             ctx.stats.predict_ns == 0.0 && ctx.stats.refine_ns == 0.0 &&
+             ctx.stats.candidates == 0 && ctx.stats.max_precision == 0 &&
+             ctx.stats.refinements == 1;
+        printf("Record stays zero: %s\n", ok ? "PASS" : "FAIL");
+        passed += ok; total++;
+    } else {
+        /* 1. Refined 200-bit call */
+        run_at(&ctx, 60, rounded, prime, &prec);
+        const z5d_call_stats_t* c = &ctx.last_call;
+        mpz_t d;
+        mpz_init(d);
+        mpz_sub(d, prime, rounded);
+        ok = c->precision == prec && mpz_cmp_ui(d, c->distance) == 0 &&
+             c->candidates == odd_count(rounded, prime) &&
+             c->sieve_survivors == c->prp_tests && c->prp_tests >= 1 &&
+             c->sieve_survivors <= c->candidates &&
+             c->predict_ns > 0.0 && c->round_ns > 0.0 && c->refine_ns > 0.0;
+        mpz_clear(d);
+        printf("Refined call record: %s\n", ok ? "PASS" : "FAIL");
+        passed += ok; total++;
+
+        /* 2. Parallel search: same prime and survivors, tests may run past it */
+        mpz_t serial_prime;
+        mpz_init_set(serial_prime, prime);
+        z5d_config_t config;
+        z5d_config_init(&config);
+        config.threads = 4;
+        z5d_ctx_t par;
+        z5d_ctx_init(&par, &config);
+        z5d_config_clear(&config);
+        z5d_ctx_t ser;
+        z5d_ctx_init(&ser, NULL);
+        run_at(&par, 200, rounded, prime, &prec);
+        run_at(&ser, 200, rounded, serial_prime, &prec);
+        ok = mpz_cmp(prime, serial_prime) == 0 &&
+             par.last_call.sieve_survivors == ser.last_call.sieve_survivors &&
+             par.last_call.prp_tests >= par.last_call.sieve_survivors &&
+             par.last_call.candidates == ser.last_call.candidates;
+        z5d_ctx_clear(&par);
+        z5d_ctx_clear(&ser);
+        mpz_clear(serial_prime);
+        printf("Parallel survivors: %s\n", ok ? "PASS" : "FAIL");
+        passed += ok; total++;
+
+        /* 3. Fast tier rounds itself; table hits run no stages; below 2^64 the
+              word-sized search tests exactly its presieve survivors */
+        z5d_result_t r;
+        z5d_result_init(&r, Z5D_DEFAULT_PRECISION);
+        z5d_predict_nth_prime_ctx(&ctx, &r, 123456789ULL);
+        ok = (ctx.last_call.precision == 53 || ctx.last_call.precision == 106) &&
+             ctx.last_call.round_ns == 0.0 && ctx.last_call.predict_ns > 0.0;
+        z5d_result_clear(&r);
+        z5d_predict_nth_prime_mpz(prime, 1000000ULL);
+        ok &= is_zero(&z5d_default_ctx()->last_call, sizeof(z5d_call_stats_t));
+        z5d_predict_nth_prime_mpz_ctx(&ctx, prime, 1000003ULL);
+        ok &= ctx.last_call.prp_tests >= 1 &&
+              ctx.last_call.sieve_survivors == ctx.last_call.prp_tests &&
+              ctx.last_call.candidates >= ctx.last_call.prp_tests && ctx.last_call.refine_ns > 0.0;
+        printf("Fast tier, table and small-n records: %s\n", ok ? "PASS" : "FAIL");
+        passed += ok; total++;
+
+        /* 4. Context sums are the sums of the calls */
+        z5d_ctx_reset_stats(&ctx);
+        ok = is_zero(&ctx.last_call, sizeof(ctx.last_call));
+        z5d_call_stats_t sum;
+        memset(&sum, 0, sizeof(sum));
+        for (unsigned long e = 30; e <= 90; e += 20) {
+            run_at(&ctx, e, rounded, prime, &prec);
+            sum.distance += ctx.last_call.distance;
+            sum.candidates += ctx.last_call.candidates;
+            sum.sieve_survivors += ctx.last_call.sieve_survivors;
+            sum.refine_ns += ctx.last_call.refine_ns;
+        }
+        ok &= ctx.stats.distance == sum.distance && ctx.stats.candidates == sum.candidates &&
+              ctx.stats.sieve_survivors == sum.sieve_survivors &&
+              ctx.stats.refine_ns == sum.refine_ns && ctx.stats.max_precision == prec &&
+              ctx.stats.prp_tests >= ctx.stats.sieve_survivors;
+        printf("Context sums: %s\n", ok ? "PASS" : "FAIL");
+        passed += ok; total++;
+    }
+
+    mpz_clears(rounded, prime, NULL);
+    z5d_ctx_clear(&ctx);
+    z5d_cleanup();
+
+    printf("\n=============================================\n");
+    printf("Test Results: %d/%d passed\n", passed, total);
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/**
+ * Z5D Java Bindings - JNI Glue for z5d.predictor.Z5DNative
+ * ========================================================
+ *
+ * Passes pinned primitive-array storage and direct-buffer addresses to the
+ * C library's packed-buffer entry points. Argument checks are done on the
+ * Java side; the glue only pins, calls and unpins. Predictions run on the
+ * calling thread's default context, so Java threads predict in parallel.
+ *
+ * @file z5d_jni.c
+ * @version 1.0
+ */
+
+#include <jni.h>
+#include <stdint.h>
+#include "z5d_predictor.h"
+
+JNIEXPORT jint JNICALL Java_z5d_predictor_Z5DNative_nativePredict(
+    JNIEnv* env, jclass cls, jlongArray n, jint offset, jint count, jarray out, jint out_offset,
+    jint width) {
+    (void)cls;
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    if (!ctx) return -1;
+    jlong* src = (*env)->GetPrimitiveArrayCritical(env, n, NULL);
+    if (!src) return -1;
+    uint8_t* dst = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (!dst) {
+        (*env)->ReleasePrimitiveArrayCritical(env, n, src, JNI_ABORT);
+        return -1;
+    }
+    int ret = z5d_predict_nth_prime_packed(ctx, (const uint64_t*)(src + offset), (size_t)count,
+                                           dst + out_offset, (size_t)width);
+    (*env)->ReleasePrimitiveArrayCritical(env, out, dst, 0);
+    (*env)->ReleasePrimitiveArrayCritical(env, n, src, JNI_ABORT);
+    return ret;
+}
+
+JNIEXPORT jint JNICALL Java_z5d_predictor_Z5DNative_nativePredictBig(
+    JNIEnv* env, jclass cls, jobject n, jint n_offset, jint n_width, jint count, jobject out,
+    jint out_offset, jint out_width) {
+    (void)cls;
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    const uint8_t* src = (*env)->GetDirectBufferAddress(env, n);
+    uint8_t* dst = (*env)->GetDirectBufferAddress(env, out);
+    if (!ctx || !src || !dst) return -1;
+    return z5d_predict_nth_prime_packed_big(ctx, src + n_offset, (size_t)n_width, (size_t)count,
+                                            dst + out_offset, (size_t)out_width);
+}
+
+JNIEXPORT jint JNICALL Java_z5d_predictor_Z5DNative_nativeApprox(
+    JNIEnv* env, jclass cls, jlongArray n, jint offset, jint count, jdoubleArray out) {
+    (void)cls;
+    jlong* src = (*env)->GetPrimitiveArrayCritical(env, n, NULL);
+    if (!src) return -1;
+    jdouble* dst = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (!dst) {
+        (*env)->ReleasePrimitiveArrayCritical(env, n, src, JNI_ABORT);
+        return -1;
+    }
+    int ret = z5d_predict_approx_u64((const uint64_t*)(src + offset), dst + offset, (size_t)count);
+    (*env)->ReleasePrimitiveArrayCritical(env, out, dst, 0);
+    (*env)->ReleasePrimitiveArrayCritical(env, n, src, JNI_ABORT);
+    return ret;
+}
@@ -0,0 +1,174 @@
+package z5d.predictor;
+
+import java.math.BigInteger;
+import java.nio.ByteBuffer;
+
+/**
+ * JNI bindings over the Z5D C library's packed-buffer entry points.
+ *
+ * <p>Indices are {@code long} values read as unsigned 64-bit integers. Primes
+ * come back packed: {@code width} little-endian bytes per entry, or native
+ * {@code long} values (unsigned) when every prime fits in 8 bytes. The C
+ * library works on the array storage directly; nothing is allocated per
+ * element. Primitive arrays are pinned for at most {@link #CHUNK} entries at
+ * a time so a long call never holds off the garbage collector; big indices
+ * go through direct {@link ByteBuffer}s, which need no pinning.
+ *
+ * <p>Each Java thread predicts on its own native context, so calls from
+ * several threads run in parallel. Build the native library with
+ * {@code make -C src/java native}; it is loaded from {@code z5d.native.lib}
+ * (a path) when set, otherwise from {@code java.library.path}.
+ */
+public final class Z5DNative {
+
+    private Z5DNative() {}
+
+    /** Bytes per packed entry that hold p_n for every unsigned 64-bit n. */
+    public static final int PACKED_U64_WIDTH = 16;
+
+    /** Entries per pinned slice of a primitive array. */
+    public static final int CHUNK = 4096;
+
+    private static final boolean AVAILABLE = load();
+
+    private static boolean load() {
+        try {
+            String path = System.getProperty("z5d.native.lib");
+            if (path != null) {
+                System.load(path);
+            } else {
+                System.loadLibrary("z5d_jni");
+            }
+            return true;
+        } catch (UnsatisfiedLinkError e) {
+            return false;
+        }
+    }
+
+    /** Whether the native library is loaded. */
+    public static boolean isAvailable() {
+        return AVAILABLE;
+    }
+
+    /**
+     * Refined nth primes for unsigned indices n, written to out as width-byte
+     * little-endian entries.
+     *
+     * @throws IllegalArgumentException if out is too short, or if some n is 0
+     *         or its prime does not fit in width bytes (those entries are
+     *         zero, the rest are filled)
+     */
+    public static void predictInto(long[] n, byte[] out, int width) {
+        if (width < 1) throw new IllegalArgumentException("width must be >= 1");
+        if ((long) n.length * width > out.length) {
+            throw new IllegalArgumentException("out holds " + out.length + " bytes, "
+                    + (long) n.length * width + " needed");
+        }
+        requireLoaded();
+        int bad = 0;
+        for (int off = 0; off < n.length; off += CHUNK) {
+            int count = Math.min(CHUNK, n.length - off);
+            bad |= nativePredict(n, off, count, out, off * width, width);
+        }
+        if (bad != 0) throw badEntries();
+    }
+
+    /**
+     * Refined nth primes as native unsigned longs (8-byte entries).
+     *
+     * @throws IllegalArgumentException as for {@link #predictInto(long[], byte[], int)};
+     *         primes of 2^64 and above come back as 0
+     */
+    public static void predictInto(long[] n, long[] out) {
+        if (n.length > out.length) {
+            throw new IllegalArgumentException("out holds " + out.length + " entries, " + n.length + " needed");
+        }
+        requireLoaded();
+        int bad = 0;
+        for (int off = 0; off < n.length; off += CHUNK) {
+            int count = Math.min(CHUNK, n.length - off);
+            bad |= nativePredict(n, off, count, out, off * 8, 8);
+        }
+        if (bad != 0) throw badEntries();
+    }
+
+    /**
+     * Refined nth primes for indices packed nWidth bytes each (little-endian),
+     * from the position of n to its limit, written from the position of out.
+     * Both buffers must be direct; their positions are not moved.
+     *
+     * @throws IllegalArgumentException as for {@link #predictInto(long[], byte[], int)}
+     */
+    public static void predictBigInto(ByteBuffer n, int nWidth, ByteBuffer out, int outWidth) {
+        if (nWidth < 1 || outWidth < 1) throw new IllegalArgumentException("widths must be >= 1");
+        if (!n.isDirect() || !out.isDirect()) throw new IllegalArgumentException("buffers must be direct");
+        if (n.remaining() % nWidth != 0) {
+            throw new IllegalArgumentException("n holds " + n.remaining() + " bytes, not a multiple of nWidth");
+        }
+        int count = n.remaining() / nWidth;
+        if ((long) count * outWidth > out.remaining()) {
+            throw new IllegalArgumentException("out holds " + out.remaining() + " bytes, "
+                    + (long) count * outWidth + " needed");
+        }
+        if (out.isReadOnly()) throw new IllegalArgumentException("out is read-only");
+        requireLoaded();
+        if (nativePredictBig(n, n.position(), nWidth, count, out, out.position(), outWidth) != 0) {
+            throw badEntries();
+        }
+    }
+
+    /**
+     * Unrounded closed form for unsigned indices n.
+     *
+     * @throws IllegalArgumentException if out is too short or some n &lt; 5
+     *         (those outputs are NaN)
+     */
+    public static void approxInto(long[] n, double[] out) {
+        if (n.length > out.length) {
+            throw new IllegalArgumentException("out holds " + out.length + " entries, " + n.length + " needed");
+        }
+        requireLoaded();
+        int bad = 0;
+        for (int off = 0; off < n.length; off += CHUNK) {
+            bad |= nativeApprox(n, off, Math.min(CHUNK, n.length - off), out);
+        }
+        if (bad != 0) throw new IllegalArgumentException("some n < 5 (those outputs are NaN)");
+    }
+
+    /** Entry index of a packed buffer as a BigInteger. */
+    public static BigInteger unpack(byte[] buf, int index, int width) {
+        byte[] be = new byte[width];
+        for (int i = 0; i < width; i++) be[i] = buf[index * width + width - 1 - i];
+        return new BigInteger(1, be);
+    }
+
+    /** Write v as entry index of a packed buffer. */
+    public static void pack(BigInteger v, ByteBuffer buf, int index, int width) {
+        if (v.signum() < 0 || v.bitLength() > width * 8) {
+            throw new IllegalArgumentException(v + " does not fit in " + width + " bytes");
+        }
+        byte[] be = v.toByteArray();
+        for (int i = 0; i < width; i++) {
+            int j = be.length - 1 - i;
+            buf.put(index * width + i, j >= 0 ? be[j] : 0);
+        }
+    }
+
+    private static void requireLoaded() {
+        if (!AVAILABLE) throw new UnsupportedOperationException("z5d_jni native library not loaded");
+    }
+
+    private static IllegalArgumentException badEntries() {
+        return new IllegalArgumentException(
+                "some n is 0 or its prime does not fit the entry width (those entries are zero)");
+    }
+
+    /* out is a byte[] or long[]; outOffset and width are in bytes. Returns 0 or -1 */
+    private static native int nativePredict(long[] n, int offset, int count, Object out, int outOffset,
+                                            int width);
+
+    private static native int nativePredictBig(ByteBuffer n, int nOffset, int nWidth, int count,
+                                               ByteBuffer out, int outOffset, int outWidth);
+
+    private static native int nativeApprox(long[] n, int offset, int count, double[] out);
+}
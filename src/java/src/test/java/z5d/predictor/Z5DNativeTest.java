@@ -0,0 +1,99 @@
+package z5d.predictor;
+
+import org.junit.jupiter.api.BeforeAll;
+import org.junit.jupiter.api.Test;
+
+import java.io.File;
+import java.math.BigInteger;
+import java.nio.ByteBuffer;
+
+import static org.junit.jupiter.api.Assertions.*;
+import static org.junit.jupiter.api.Assumptions.assumeTrue;
+
+class Z5DNativeTest {
+
+    private static final long[][] KNOWN = {
+            {1L, 2L},
+            {10L, 29L},
+            {100L, 541L},
+            {1000L, 7919L},
+            {1000000L, 15485863L},
+            {1000000000L, 22801763489L}
+    };
+
+    @BeforeAll
+    static void requireNative() {
+        // Skip only when nothing was built: a library that exists but does not
+        // load (missing symbols, wrong architecture) fails the suite
+        String path = System.getProperty("z5d.native.lib");
+        File built = (path != null) ? new File(path)
+                : new File(System.getProperty("z5d.native.dir", "build/native"),
+                           System.mapLibraryName("z5d_jni"));
+        if (path != null || built.isFile()) {
+            assertTrue(Z5DNative.isAvailable(), built + " is present but does not load");
+        }
+        assumeTrue(Z5DNative.isAvailable(), "libz5d_jni not built (make -C src/java native)");
+    }
+
+    @Test
+    void knownGridNativeLongs() {
+        long[] n = new long[KNOWN.length];
+        for (int i = 0; i < n.length; i++) n[i] = KNOWN[i][0];
+        long[] out = new long[n.length];
+        Z5DNative.predictInto(n, out);
+        for (int i = 0; i < n.length; i++) assertEquals(KNOWN[i][1], out[i]);
+    }
+
+    @Test
+    void packedSpansChunks() {
+        // Several pinned slices; the last index needs all 16 bytes
+        long[] n = new long[Z5DNative.CHUNK * 2 + 17];
+        for (int i = 0; i < n.length; i++) n[i] = 1000003L + 7919L * i;
+        n[n.length - 1] = 1000000000000000000L;
+        byte[] out = new byte[n.length * Z5DNative.PACKED_U64_WIDTH];
+        Z5DNative.predictInto(n, out, Z5DNative.PACKED_U64_WIDTH);
+        BigInteger prev = BigInteger.ZERO;
+        for (int i = 0; i < n.length - 1; i += 97) {
+            BigInteger p = Z5DNative.unpack(out, i, Z5DNative.PACKED_U64_WIDTH);
+            assertTrue(p.isProbablePrime(30));
+            assertTrue(p.compareTo(prev) > 0);
+            prev = p;
+        }
+        assertEquals(new BigInteger("44211790234832169331"),
+                Z5DNative.unpack(out, n.length - 1, Z5DNative.PACKED_U64_WIDTH));
+    }
+
+    @Test
+    void badEntriesAreZeroed() {
+        long[] n = {10L, 0L, 1000000000000000000L};
+        long[] out = new long[3];
+        assertThrows(IllegalArgumentException.class, () -> Z5DNative.predictInto(n, out));
+        assertArrayEquals(new long[]{29L, 0L, 0L}, out);
+    }
+
+    @Test
+    void bigIndicesFromDirectBuffers() {
+        int width = 32;
+        BigInteger base = BigInteger.TEN.pow(30);
+        ByteBuffer n = ByteBuffer.allocateDirect(3 * width);
+        for (int i = 0; i < 3; i++) Z5DNative.pack(base.add(BigInteger.valueOf(i)), n, i, width);
+        ByteBuffer out = ByteBuffer.allocateDirect(3 * width);
+        Z5DNative.predictBigInto(n, width, out, width);
+        byte[] packed = new byte[3 * width];
+        out.get(0, packed);
+        for (int i = 0; i < 3; i++) {
+            BigInteger p = Z5DNative.unpack(packed, i, width);
+            assertTrue(p.isProbablePrime(30));
+        }
+    }
+
+    @Test
+    void approxNearPrimes() {
+        long[] n = {1000000L, 1000000000L};
+        double[] out = new double[2];
+        Z5DNative.approxInto(n, out);
+        assertEquals(1.0, out[0] / 15485863.0, 1e-3);
+        assertEquals(1.0, out[1] / 22801763489.0, 1e-3);
+        assertThrows(IllegalArgumentException.class, () -> Z5DNative.approxInto(new long[]{4L}, new double[1]));
+    }
+}
@@ -0,0 +1,36 @@
+"""
+Build the C extension z5d_predictor._z5d against the Z5D static library.
+
+    make -C ../c/z5d-predictor-c lib
+    python3 setup.py build_ext --inplace
+
+Z5D_C_DIR points at the C predictor (default ../c/z5d-predictor-c);
+GMP_PREFIX and MPFR_PREFIX default to Homebrew's /opt/homebrew.
+"""
+
+import os
+from pathlib import Path
+
+from setuptools import Extension, setup
+
+HERE = Path(__file__).resolve().parent
+Z5D_C_DIR = Path(os.environ.get("Z5D_C_DIR", HERE.parent / "c" / "z5d-predictor-c"))
+GMP_PREFIX = Path(os.environ.get("GMP_PREFIX", "/opt/homebrew"))
+MPFR_PREFIX = Path(os.environ.get("MPFR_PREFIX", "/opt/homebrew"))
+
+ext = Extension(
+    "z5d_predictor._z5d",
+    sources=["z5d_predictor/_z5d.c"],
+    include_dirs=[str(Z5D_C_DIR / "include"), str(GMP_PREFIX / "include"), str(MPFR_PREFIX / "include")],
+    extra_objects=[str(Z5D_C_DIR / "build" / "libz5d_predictor.a")],
+    library_dirs=[str(MPFR_PREFIX / "lib"), str(GMP_PREFIX / "lib")],
+    libraries=["mpfr", "gmp", "m"],
+    extra_compile_args=["-O3"],
+)
+
+setup(
+    name="z5d_predictor",
+    version="2.1.0",
+    packages=["z5d_predictor"],
+    ext_modules=[ext],
+)
@@ -12,6 +12,7 @@ from .predictor import (
     predict_nth_prime,
     closed_form_estimate,
 )
+from . import bulk
 
 __version__ = Z5D_PREDICTOR_VERSION
 
@@ -21,4 +22,5 @@ __all__ = [
     "closed_form_estimate",
     "get_version",
     "Z5D_PREDICTOR_VERSION",
+    "bulk",
 ]
@@ -0,0 +1,209 @@
+/**
+ * Z5D Python Bindings - Buffer Entry Points over the C Library
+ * ============================================================
+ *
+ * CPython extension z5d_predictor._z5d. Every function takes buffer-protocol
+ * objects (array.array, bytearray, memoryview, NumPy arrays), checks their
+ * layout once, releases the GIL and hands the storage straight to the C
+ * library, which fills the output buffer in place. No Python object is
+ * created per element; calls on several Python threads run in parallel,
+ * each on its thread's default context.
+ *
+ *   predict_into(n, out, width=16)       refined p_n for uint64 indices
+ *   predict_big_into(n, n_width, out, out_width)
+ *                                        refined p_n for packed big indices
+ *   approx_into(n, out)                  closed form as float64
+ *
+ * Packed integers are fixed-width little-endian unsigned entries, as in
+ * z5d_predict_nth_prime_packed; int.from_bytes(entry, "little") reads one.
+ *
+ * @file _z5d.c
+ * @version 1.0
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <string.h>
+#include "z5d_predictor.h"
+
+/* Contiguous buffer of 8-byte unsigned integers */
+static int get_u64(PyObject* obj, Py_buffer* view, const char* name) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) return -1;
+    const char* f = view->format ? view->format : "B";
+    if (*f == '@' || *f == '=' || *f == '<') f++;
+    if (view->itemsize != 8 || f[1] != '\0' || !strchr("LQN", f[0])) {
+        PyErr_Format(PyExc_TypeError, "%s must be a buffer of uint64 (array('Q'), numpy.uint64)",
+                     name);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+/* Writable contiguous buffer of at least need bytes */
+static int get_out(PyObject* obj, Py_buffer* view, Py_ssize_t need, const char* format) {
+    int flags = PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE | (format ? PyBUF_FORMAT : 0);
+    if (PyObject_GetBuffer(obj, view, flags) != 0) return -1;
+    if (format) {
+        const char* f = view->format ? view->format : "B";
+        if (*f == '@' || *f == '=' || *f == '<') f++;
+        if (view->itemsize != 8 || strcmp(f, format) != 0) {
+            PyErr_Format(PyExc_TypeError, "out must be a buffer of float64 (array('d'), numpy.float64)");
+            PyBuffer_Release(view);
+            return -1;
+        }
+    }
+    if (view->len < need) {
+        PyErr_Format(PyExc_ValueError, "out holds %zd bytes, %zd needed", view->len, need);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+static int check_width(Py_ssize_t width, const char* name) {
+    if (width < 1) {
+        PyErr_Format(PyExc_ValueError, "%s must be at least 1", name);
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject* fail_entries(void) {
+    PyErr_SetString(PyExc_ValueError,
+                    "some n is 0 or its prime does not fit the entry width (those entries are zero)");
+    return NULL;
+}
+
+static PyObject* py_predict_into(PyObject* self, PyObject* args, PyObject* kwargs) {
+    (void)self;
+    static char* kwlist[] = {"n", "out", "width", NULL};
+    PyObject *n_obj, *out_obj;
+    Py_ssize_t width = Z5D_PACKED_U64_WIDTH;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|n", kwlist, &n_obj, &out_obj, &width)) {
+        return NULL;
+    }
+    if (check_width(width, "width") != 0) return NULL;
+    Py_buffer n, out;
+    if (get_u64(n_obj, &n, "n") != 0) return NULL;
+    size_t count = (size_t)(n.len / 8);
+    if (count > (size_t)PY_SSIZE_T_MAX / (size_t)width) {
+        PyBuffer_Release(&n);
+        return PyErr_NoMemory();
+    }
+    if (get_out(out_obj, &out, (Py_ssize_t)(count * (size_t)width), NULL) != 0) {
+        PyBuffer_Release(&n);
+        return NULL;
+    }
+    int ret;
+    Py_BEGIN_ALLOW_THREADS
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    ret = ctx ? z5d_predict_nth_prime_packed(ctx, (const uint64_t*)n.buf, count, out.buf,
+                                             (size_t)width)
+              : -2;
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&out);
+    PyBuffer_Release(&n);
+    if (ret == -2) return PyErr_NoMemory();
+    if (ret != 0) return fail_entries();
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_predict_big_into(PyObject* self, PyObject* args, PyObject* kwargs) {
+    (void)self;
+    static char* kwlist[] = {"n", "n_width", "out", "out_width", NULL};
+    PyObject *n_obj, *out_obj;
+    Py_ssize_t n_width, out_width;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OnOn", kwlist, &n_obj, &n_width, &out_obj,
+                                     &out_width)) {
+        return NULL;
+    }
+    if (check_width(n_width, "n_width") != 0 || check_width(out_width, "out_width") != 0) return NULL;
+    Py_buffer n, out;
+    if (PyObject_GetBuffer(n_obj, &n, PyBUF_C_CONTIGUOUS) != 0) return NULL;
+    if (n.len % n_width != 0) {
+        PyErr_Format(PyExc_ValueError, "n holds %zd bytes, not a multiple of n_width", n.len);
+        PyBuffer_Release(&n);
+        return NULL;
+    }
+    size_t count = (size_t)(n.len / n_width);
+    if (count > (size_t)PY_SSIZE_T_MAX / (size_t)out_width) {
+        PyBuffer_Release(&n);
+        return PyErr_NoMemory();
+    }
+    if (get_out(out_obj, &out, (Py_ssize_t)(count * (size_t)out_width), NULL) != 0) {
+        PyBuffer_Release(&n);
+        return NULL;
+    }
+    int ret;
+    Py_BEGIN_ALLOW_THREADS
+    z5d_ctx_t* ctx = z5d_default_ctx();
+    ret = ctx ? z5d_predict_nth_prime_packed_big(ctx, n.buf, (size_t)n_width, count, out.buf,
+                                                 (size_t)out_width)
+              : -2;
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&out);
+    PyBuffer_Release(&n);
+    if (ret == -2) return PyErr_NoMemory();
+    if (ret != 0) return fail_entries();
+    Py_RETURN_NONE;
+}
+
+static PyObject* py_approx_into(PyObject* self, PyObject* args, PyObject* kwargs) {
+    (void)self;
+    static char* kwlist[] = {"n", "out", NULL};
+    PyObject *n_obj, *out_obj;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", kwlist, &n_obj, &out_obj)) return NULL;
+    Py_buffer n, out;
+    if (get_u64(n_obj, &n, "n") != 0) return NULL;
+    size_t count = (size_t)(n.len / 8);
+    if (get_out(out_obj, &out, n.len, "d") != 0) {
+        PyBuffer_Release(&n);
+        return NULL;
+    }
+    int ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = z5d_predict_approx_u64((const uint64_t*)n.buf, (double*)out.buf, count);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&out);
+    PyBuffer_Release(&n);
+    if (ret != 0) {
+        PyErr_Format(PyExc_ValueError, "some n < %d (those outputs are nan)", Z5D_APPROX_MIN_N);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef z5d_methods[] = {
+    {"predict_into", (PyCFunction)(void (*)(void))py_predict_into, METH_VARARGS | METH_KEYWORDS,
+     "predict_into(n, out, width=16)\n--\n\n"
+     "Refined nth primes for a uint64 buffer n, written to out as width-byte\n"
+     "little-endian entries. Raises ValueError if some n is 0 or its prime\n"
+     "does not fit (those entries are zero, the rest are filled)."},
+    {"predict_big_into", (PyCFunction)(void (*)(void))py_predict_big_into,
+     METH_VARARGS | METH_KEYWORDS,
+     "predict_big_into(n, n_width, out, out_width)\n--\n\n"
+     "As predict_into for indices packed as n_width-byte little-endian entries."},
+    {"approx_into", (PyCFunction)(void (*)(void))py_approx_into, METH_VARARGS | METH_KEYWORDS,
+     "approx_into(n, out)\n--\n\n"
+     "Unrounded closed form for a uint64 buffer n into a float64 buffer out.\n"
+     "Raises ValueError if some n < 5 (those outputs are nan)."},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef z5d_module = {
+    PyModuleDef_HEAD_INIT, "_z5d", "Buffer bindings over the Z5D C library.", -1, z5d_methods,
+    NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit__z5d(void) {
+    PyObject* m = PyModule_Create(&z5d_module);
+    if (!m) return NULL;
+    if (PyModule_AddIntConstant(m, "PACKED_U64_WIDTH", Z5D_PACKED_U64_WIDTH) != 0 ||
+        PyModule_AddIntConstant(m, "APPROX_MIN_N", Z5D_APPROX_MIN_N) != 0 ||
+        PyModule_AddStringConstant(m, "C_VERSION", z5d_get_version()) != 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
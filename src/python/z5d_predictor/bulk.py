@@ -0,0 +1,72 @@
+"""
+Bulk predictions through the C library
+======================================
+
+Thin helpers over the compiled extension ``z5d_predictor._z5d`` (built by
+``setup.py``). The extension fills caller-owned buffers in place with the GIL
+released; these helpers only allocate the output buffer.
+
+- Indices are uint64 buffers: ``array('Q')`` or ``numpy.uint64`` arrays.
+- Primes come back packed: ``width`` little-endian bytes per entry. With
+  ``width=8`` the buffer views as uint64 (``memoryview(out).cast('Q')`` or
+  ``numpy.frombuffer(out, '<u8')``) whenever every prime fits.
+- Big indices are packed the same way, ``n_width`` bytes each.
+"""
+
+from __future__ import annotations
+
+from array import array
+from typing import List
+
+try:
+    from . import _z5d
+except ImportError:  # extension not built
+    _z5d = None
+
+PACKED_U64_WIDTH = 16
+
+
+def available() -> bool:
+    """Whether the C extension is built and importable."""
+    return _z5d is not None
+
+
+def _ext():
+    if _z5d is None:
+        raise ImportError("z5d_predictor._z5d is not built; run `python3 setup.py build_ext --inplace`")
+    return _z5d
+
+
+def predict_many(n, width: int = PACKED_U64_WIDTH) -> bytearray:
+    """Refined p_n for every uint64 index in n, packed ``width`` bytes each."""
+    out = bytearray(memoryview(n).nbytes // 8 * width)
+    _ext().predict_into(n, out, width)
+    return out
+
+
+def predict_many_big(n, n_width: int, out_width: int) -> bytearray:
+    """Refined p_n for indices packed ``n_width`` bytes each."""
+    out = bytearray(memoryview(n).nbytes // n_width * out_width)
+    _ext().predict_big_into(n, n_width, out, out_width)
+    return out
+
+
+def approx_many(n) -> array:
+    """Unrounded closed form for every uint64 index in n (n >= 5)."""
+    out = array("d", bytes(memoryview(n).nbytes))
+    _ext().approx_into(n, out)
+    return out
+
+
+def pack(values, width: int) -> bytearray:
+    """Pack Python ints as ``width``-byte little-endian entries."""
+    out = bytearray(len(values) * width)
+    for i, v in enumerate(values):
+        out[i * width:(i + 1) * width] = int(v).to_bytes(width, "little")
+    return out
+
+
+def unpack(buf, width: int) -> List[int]:
+    """Python ints from a packed buffer (one object per entry)."""
+    view = memoryview(buf).cast("B")
+    return [int.from_bytes(view[i:i + width], "little") for i in range(0, len(view), width)]
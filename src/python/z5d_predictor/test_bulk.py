@@ -0,0 +1,86 @@
+import os
+import sys
+import threading
+import unittest
+from array import array
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), "..")))
+
+from z5d_predictor import bulk
+
+
+KNOWN = [
+    (1, 2),
+    (10, 29),
+    (100, 541),
+    (1000, 7919),
+    (10000, 104729),
+    (100000, 1299709),
+    (1000000, 15485863),
+    (10000000, 179424673),
+    (100000000, 2038074743),
+    (1000000000, 22801763489),
+    (1000000000000000000, 44211790234832169331),
+]
+
+
+@unittest.skipUnless(bulk.available(), "C extension not built (python3 setup.py build_ext --inplace)")
+class TestBulk(unittest.TestCase):
+    def test_known_grid_packed(self):
+        n = array("Q", [k for k, _ in KNOWN])
+        out = bulk.predict_many(n)
+        self.assertEqual(bulk.unpack(out, bulk.PACKED_U64_WIDTH), [p for _, p in KNOWN])
+
+    def test_in_place_native_width(self):
+        n = array("Q", [k for k, _ in KNOWN[:-1]])
+        out = array("Q", bytes(len(n) * 8))
+        bulk._z5d.predict_into(n, out, 8)
+        self.assertEqual(list(out), [p for _, p in KNOWN[:-1]])
+
+    def test_too_narrow_and_zero(self):
+        n = array("Q", [10, 0, 1000000000000000000])
+        out = bytearray(3 * 8)
+        with self.assertRaises(ValueError):
+            bulk._z5d.predict_into(n, out, 8)
+        self.assertEqual(bulk.unpack(out, 8), [29, 0, 0])
+
+    def test_big_indices(self):
+        n = bulk.pack([10**30, 10**30 + 1, 10**100], 48)
+        out = bulk.predict_many_big(n, 48, 48)
+        primes = bulk.unpack(out, 48)
+        self.assertTrue(all(p % 2 == 1 and pow(2, p - 1, p) == 1 for p in primes))
+        self.assertLess(primes[0], primes[1])
+
+    def test_approx(self):
+        n = array("Q", [5, 100, 10**6, 2**64 - 1])
+        out = bulk.approx_many(n)
+        self.assertAlmostEqual(out[2] / 15485863, 1.0, places=3)
+        with self.assertRaises(ValueError):
+            bulk.approx_many(array("Q", [4]))
+
+    def test_layout_checks(self):
+        with self.assertRaises(TypeError):
+            bulk._z5d.predict_into(array("d", [1.0]), bytearray(16))
+        with self.assertRaises(ValueError):
+            bulk._z5d.predict_into(array("Q", [10, 100]), bytearray(16))
+        with self.assertRaises(BufferError):
+            bulk._z5d.predict_into(array("Q", [10]), b"\0" * 16)
+
+    def test_threads_agree(self):
+        n = array("Q", range(10**9, 10**9 + 200))
+        want = bulk.predict_many(n)
+        results = [None] * 4
+
+        def run(i):
+            results[i] = bulk.predict_many(n)
+
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertTrue(all(r == want for r in results))
+
+
+if __name__ == "__main__":
+    unittest.main()